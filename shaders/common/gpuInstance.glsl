@@ -0,0 +1,26 @@
+// Shared between the culling compute shader and the instanced vertex shader;
+// must match GpuInstance/GpuMesh in src/GpuCulling.h (std430 layout).
+
+struct Instance {
+    mat4 world;
+    vec4 boundingSphere; // world-space center, radius
+    uint mesh;
+    uint padding0;
+    uint padding1;
+    uint padding2;
+};
+
+struct Mesh {
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint padding;
+};
+
+struct DrawElementsIndirectCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
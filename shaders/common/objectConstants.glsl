@@ -0,0 +1,6 @@
+// Per-draw constants, one std140 block per draw sub-allocated from the
+// frame's GpuRingBuffer; must match ObjectConstants in src/DrawList.h.
+
+layout(std140, binding = 0) uniform ObjectConstants {
+    mat4 uMVPMatrix;
+};
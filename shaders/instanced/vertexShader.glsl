@@ -0,0 +1,19 @@
+#version 460 core
+
+#include "../common/gpuInstance.glsl"
+
+layout(std430, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout(location = 0) in vec4 aPosition;
+layout(location = 1) in vec4 aColor;
+layout(location = 0) out vec4 oColor;
+
+layout(location = 0) uniform mat4 uViewProjectionMatrix;
+
+void main(void)
+{
+    gl_Position = uViewProjectionMatrix * instances[gl_BaseInstance].world * aPosition;
+    oColor = aColor;
+}
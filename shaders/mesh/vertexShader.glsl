@@ -0,0 +1,27 @@
+#version 460 core
+
+#include "../common/objectConstants.glsl"
+
+// Quantized StaticMesh vertices (see src/MeshOptimizer.h). Positions arrive
+// as unorm16 in [0, 1]; the dequantization scale/offset is folded into
+// uMVPMatrix by the mesh's transform node.
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec2 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+layout(location = 3) in vec4 aColor;
+layout(location = 0) out vec4 oColor;
+
+vec3 octahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main(void)
+{
+    gl_Position = uMVPMatrix * vec4(aPosition, 1.0);
+    // No lighting yet: tint the vertex color by the object-space normal
+    oColor = aColor * vec4(octahedralDecode(aNormal) * 0.5 + 0.5, 1.0);
+}
@@ -0,0 +1,15 @@
+#version 460 core
+
+// R8 glyph coverage; panels and graph bars sample the atlas' solid cell
+layout(location = 1, binding = 0) uniform sampler2D uAtlas;
+
+layout(location = 0) in vec2 vTexel;
+layout(location = 1) in vec4 vColor;
+layout(location = 0) out vec4 FragColor;
+
+void main(void)
+{
+    // Glyphs are drawn at integer scales, so texel-exact fetches stay crisp
+    float coverage = texelFetch(uAtlas, ivec2(vTexel), 0).r;
+    FragColor = vec4(vColor.rgb, vColor.a * coverage);
+}
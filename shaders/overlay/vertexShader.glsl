@@ -0,0 +1,20 @@
+#version 460 core
+
+// PerfOverlay quads, positioned in pixels from the top-left corner with
+// atlas texel coordinates (see Vertex in src/PerfOverlay.h)
+layout(location = 0) in vec2 aPosition;
+layout(location = 1) in vec2 aTexel;
+layout(location = 2) in vec4 aColor;
+
+// xy = 2 / viewport size
+layout(location = 0) uniform vec4 uViewport;
+
+layout(location = 0) out vec2 vTexel;
+layout(location = 1) out vec4 vColor;
+
+void main(void)
+{
+    gl_Position = vec4(aPosition.x * uViewport.x - 1.0, 1.0 - aPosition.y * uViewport.y, 0.0, 1.0);
+    vTexel = aTexel;
+    vColor = aColor;
+}
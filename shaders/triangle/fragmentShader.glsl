@@ -1,8 +1,8 @@
 #version 460 core
 
-in vec4 oColor;
-out vec4 FragColor;
+layout(location = 0) in vec4 oColor;
+layout(location = 0) out vec4 FragColor;
 
 void main(void) {
     FragColor = oColor;
-};
+}
@@ -1,11 +1,14 @@
 #version 460 core
 
-in vec4 aPosition;
-in vec4 aColor;
-out vec4 oColor;
+#include "../common/objectConstants.glsl"
+
+// AMC_ATTRIBUTE_POSITION/COLOR in src/WindowManager.cpp
+layout(location = 0) in vec4 aPosition;
+layout(location = 1) in vec4 aColor;
+layout(location = 0) out vec4 oColor;
 
 void main(void)
 {
-    gl_Position = aPosition;
+    gl_Position = uMVPMatrix * aPosition;
     oColor = aColor;
-};
+}
@@ -0,0 +1,18 @@
+#ifndef ALLOCATOR_STATS_H
+#define ALLOCATOR_STATS_H
+
+#include <cstddef>
+
+// Counters shared by FrameArena, ObjectPool and ScratchAllocator. The
+// interesting one is heapAllocations: once the allocators have grown to the
+// steady-state working set it should stay at zero.
+struct AllocatorStats {
+    size_t allocations;     // requests served
+    size_t bytesInUse;      // bytes handed out and not yet released
+    size_t peakBytes;       // high-water mark of bytesInUse
+    size_t heapAllocations; // requests that had to go to malloc/new
+
+    AllocatorStats() : allocations(0), bytesInUse(0), peakBytes(0), heapAllocations(0) {}
+};
+
+#endif // ALLOCATOR_STATS_H
@@ -0,0 +1,111 @@
+#include "DrawList.h"
+#include "EntityRegistry.h"
+#include "SceneComponents.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Below this many candidates the thread pool handoff costs more than it saves
+const size_t ParallelCullThreshold = 32768;
+
+unsigned int selectLod(const MeshComponent& mesh, float worldScale, float distance, const LodSelection& selection) {
+    // Inside the bounds: always full detail
+    if (distance <= 0.0f) {
+        return 0;
+    }
+
+    const float pixelsPerUnit = selection.projectionScale * worldScale / distance;
+    const float refineAbove = selection.errorThreshold * (1.0f + selection.hysteresis);
+    const float coarsenBelow = selection.errorThreshold * (1.0f - selection.hysteresis);
+
+    unsigned int lod = std::min(mesh.currentLod, mesh.lodCount - 1);
+    while (lod > 0 && mesh.lods[lod].error * pixelsPerUnit > refineAbove) {
+        --lod;
+    }
+    while (lod + 1 < mesh.lodCount && mesh.lods[lod + 1].error * pixelsPerUnit < coarsenBelow) {
+        ++lod;
+    }
+    return lod;
+}
+
+bool drawItemLess(const DrawItem& a, const DrawItem& b) {
+    if (a.shader != b.shader) {
+        return a.shader < b.shader;
+    }
+    if (a.vao != b.vao) {
+        return a.vao < b.vao;
+    }
+    return a.transform < b.transform;
+}
+
+}
+
+DrawList::DrawList() : numElements(0), numFullDetailElements(0) {
+}
+
+void DrawList::build(EntityRegistry& registry, const TransformHierarchy& transforms, const mat4& viewProjection,
+                     const LodSelection& lodSelection, ThreadPool& threadPool) {
+    candidates.clear();
+    spheres.clear();
+    items.clear();
+    fullDetailCounts.clear();
+
+    ComponentPool<MeshComponent>& meshes = registry.getPool<MeshComponent>();
+    candidates.reserve(meshes.size());
+    spheres.reserve(meshes.size());
+
+    const mat4* worldMatrices = transforms.getWorldMatrices();
+    registry.each<MeshComponent, TransformComponent>(
+        [&](Entity, MeshComponent& mesh, const TransformComponent& transform) {
+            const mat4& world = worldMatrices[transform.node];
+            vec4 center = world * vec4(mesh.boundsCenter, 1.0f);
+
+            // Largest axis scale keeps the sphere conservative under non-uniform scale
+            float scaleSquared = std::max(dot(world[0].xyz(), world[0].xyz()),
+                                          std::max(dot(world[1].xyz(), world[1].xyz()),
+                                                   dot(world[2].xyz(), world[2].xyz())));
+            float worldScale = std::sqrt(scaleSquared);
+            float radius = mesh.boundsRadius * worldScale;
+            spheres.add(center.x, center.y, center.z, radius);
+
+            DrawItem item;
+            item.shader = mesh.shader;
+            item.vao = mesh.vao;
+            item.mode = mesh.mode;
+            item.indexType = mesh.indexType;
+            item.first = mesh.first;
+            item.count = mesh.count;
+            item.transform = transform.node;
+            fullDetailCounts.push_back(item.count);
+
+            if (mesh.lodCount > 0) {
+                float distance = length(center.xyz() - lodSelection.cameraPosition) - radius;
+                mesh.currentLod = selectLod(mesh, worldScale, distance, lodSelection);
+                item.first = static_cast<GLint>(mesh.lods[mesh.currentLod].firstIndex);
+                item.count = static_cast<GLsizei>(mesh.lods[mesh.currentLod].indexCount);
+                fullDetailCounts.back() = static_cast<GLsizei>(mesh.lods[0].indexCount);
+            }
+            candidates.push_back(item);
+        });
+
+    Frustum frustum = Frustum::fromMatrix(viewProjection.data());
+    visibleIndices.resize(spheres.size());
+    size_t numVisible;
+    if (spheres.size() >= ParallelCullThreshold) {
+        numVisible = culler.cullParallel(frustum, spheres, visibleIndices.data(), threadPool);
+    } else {
+        numVisible = culler.cull(frustum, spheres, visibleIndices.data());
+    }
+
+    items.reserve(numVisible);
+    numElements = 0;
+    numFullDetailElements = 0;
+    for (size_t i = 0; i < numVisible; ++i) {
+        items.push_back(candidates[visibleIndices[i]]);
+        numElements += items.back().count;
+        numFullDetailElements += fullDetailCounts[visibleIndices[i]];
+    }
+    std::sort(items.begin(), items.end(), drawItemLess);
+}
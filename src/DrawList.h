@@ -0,0 +1,82 @@
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+#include <vector>
+
+#include "FrustumCulling.h"
+#include "TransformHierarchy.h"
+#include "VectorMath.h"
+
+class EntityRegistry;
+class Shader;
+class ThreadPool;
+
+struct DrawItem {
+    Shader* shader; // nullptr for the default program
+    GLuint vao;
+    GLenum mode;
+    GLenum indexType; // 0 for glDrawArrays
+    GLint first;
+    GLsizei count;
+    TransformNode transform;
+};
+
+// Per-draw uniform block (std140), written into the frame's GpuRingBuffer;
+// matches shaders/common/objectConstants.glsl
+struct ObjectConstants {
+    mat4 modelViewProjection;
+};
+
+static_assert(sizeof(ObjectConstants) == 64, "ObjectConstants must match the std140 ObjectConstants block");
+
+// layout(binding = 0) of the ObjectConstants block
+const GLint ObjectConstantsBinding = 0;
+
+// Screen-space error LOD selection. A level's simplification error is
+// projected at the object's distance; the coarsest level under
+// errorThreshold pixels is drawn. hysteresis widens the band around the
+// threshold so objects sitting right at it do not flip every frame.
+struct LodSelection {
+    vec3 cameraPosition;
+    float projectionScale; // viewport height / (2 tan(fovY / 2)), pixels per unit at distance 1
+    float errorThreshold;  // pixels
+    float hysteresis;      // fraction of errorThreshold
+
+    LodSelection() : cameraPosition(0.0f), projectionScale(0.0f), errorThreshold(1.0f), hysteresis(0.25f) {}
+};
+
+// Per-frame extraction of visible meshes from the scene registry. build()
+// walks the TransformComponent/MeshComponent pairs, frustum culls their
+// world-space bounds, picks a level of detail for meshes that have LODs and
+// sorts the survivors by shader and vertex array, so the renderer only
+// rebinds state when it actually changes.
+class DrawList {
+public:
+    DrawList();
+
+    void build(EntityRegistry& registry, const TransformHierarchy& transforms, const mat4& viewProjection,
+               const LodSelection& lodSelection, ThreadPool& threadPool);
+
+    const std::vector<DrawItem>& getItems() const { return items; }
+    size_t getNumCandidates() const { return candidates.size(); }
+    size_t getNumVisible() const { return items.size(); }
+    // Elements (indices or vertices) of the visible items as drawn, and as
+    // they would be at full detail
+    size_t getNumElements() const { return numElements; }
+    size_t getNumFullDetailElements() const { return numFullDetailElements; }
+
+private:
+    FrustumCuller culler;
+    BoundingSphereSet spheres;
+    std::vector<DrawItem> candidates;
+    std::vector<uint32_t> visibleIndices;
+    std::vector<DrawItem> items;
+    std::vector<GLsizei> fullDetailCounts;
+    size_t numElements;
+    size_t numFullDetailElements;
+};
+
+#endif // DRAW_LIST_H
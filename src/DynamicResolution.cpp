@@ -0,0 +1,57 @@
+#include "DynamicResolution.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution()
+    : minScale(0.5f), maxScale(1.0f), overBudget(1.0), underBudget(0.8), framesToDecrease(3), framesToIncrease(30),
+      budgetMs(16.0), scale(1.0f), framesOver(0), framesUnder(0), smoothedGpuMs(0.0) {
+}
+
+void DynamicResolution::update(double gpuMs) {
+    // Light smoothing so one spike doesn't count as a trend
+    smoothedGpuMs = smoothedGpuMs == 0.0 ? gpuMs : smoothedGpuMs * 0.7 + gpuMs * 0.3;
+
+    if (smoothedGpuMs > budgetMs * overBudget) {
+        ++framesOver;
+        framesUnder = 0;
+    } else if (smoothedGpuMs < budgetMs * underBudget) {
+        ++framesUnder;
+        framesOver = 0;
+    } else {
+        framesOver = 0;
+        framesUnder = 0;
+    }
+
+    bool decrease = framesOver >= framesToDecrease && scale > minScale;
+    bool increase = framesUnder >= framesToIncrease && scale < maxScale;
+    if (!decrease && !increase) {
+        return;
+    }
+
+    // GPU cost is roughly proportional to pixel count, i.e. scale squared.
+    // Aim for the middle of the hysteresis band.
+    double target = budgetMs * (overBudget + underBudget) * 0.5;
+    float newScale = static_cast<float>(scale * std::sqrt(target / std::max(smoothedGpuMs, 0.01)));
+    // Grow slowly (avoid oscillating), shrink as fast as needed
+    if (increase) {
+        newScale = std::min(newScale, scale + 0.1f);
+    }
+    newScale = std::max(minScale, std::min(maxScale, newScale));
+
+    if (std::fabs(newScale - scale) >= 0.01f) {
+        logger.Debug("DynamicResolution: gpu %.2f ms (budget %.2f), scale %.2f -> %.2f", smoothedGpuMs, budgetMs,
+                     scale, newScale);
+        scale = newScale;
+    }
+    framesOver = 0;
+    framesUnder = 0;
+}
+
+void DynamicResolution::getRenderSize(int windowWidth, int windowHeight, int& renderWidth, int& renderHeight) const {
+    renderWidth = std::max(8, (static_cast<int>(windowWidth * scale) + 7) / 8 * 8);
+    renderHeight = std::max(8, (static_cast<int>(windowHeight * scale) + 7) / 8 * 8);
+    renderWidth = std::min(renderWidth, std::max(windowWidth, 8));
+    renderHeight = std::min(renderHeight, std::max(windowHeight, 8));
+}
@@ -0,0 +1,38 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+// Picks the scene render scale from measured GPU time against a frame budget.
+// The scale only moves after the GPU time has stayed outside the hysteresis
+// band for several consecutive samples, and render sizes are rounded to a
+// multiple of 8 pixels so the render-target pool sees a handful of sizes
+// instead of a new one every frame.
+class DynamicResolution {
+public:
+    DynamicResolution();
+
+    void setBudgetMs(double budgetMs) { this->budgetMs = budgetMs; }
+    double getBudgetMs() const { return budgetMs; }
+
+    // Feed one GPU time sample (ms)
+    void update(double gpuMs);
+
+    float getScale() const { return scale; }
+    void getRenderSize(int windowWidth, int windowHeight, int& renderWidth, int& renderHeight) const;
+
+    float minScale;
+    float maxScale;
+    // Scale down above budget * overBudget, up below budget * underBudget
+    double overBudget;
+    double underBudget;
+    int framesToDecrease;
+    int framesToIncrease;
+
+private:
+    double budgetMs;
+    float scale;
+    int framesOver;
+    int framesUnder;
+    double smoothedGpuMs;
+};
+
+#endif // DYNAMIC_RESOLUTION_H
@@ -0,0 +1,52 @@
+#include "EntityRegistry.h"
+
+EntityRegistry::EntityRegistry() {
+}
+
+Entity EntityRegistry::create() {
+    uint32_t index;
+    if (!freeIndices.empty()) {
+        index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        index = static_cast<uint32_t>(generations.size());
+        if (index > EntityIndexMask) {
+            return InvalidEntity;
+        }
+        generations.push_back(0);
+    }
+    return (static_cast<uint32_t>(generations[index]) << EntityIndexBits) | index;
+}
+
+void EntityRegistry::destroy(Entity entity) {
+    if (!isValid(entity)) {
+        return;
+    }
+
+    for (size_t i = 0; i < pools.size(); ++i) {
+        if (pools[i]) {
+            pools[i]->remove(entity);
+        }
+    }
+
+    // Generation 255 would make a recycled handle equal InvalidEntity at
+    // index 0xFFFFFF, so wrap before it
+    uint32_t index = entityIndex(entity);
+    generations[index] = static_cast<uint8_t>((generations[index] + 1) % 255);
+    freeIndices.push_back(index);
+}
+
+bool EntityRegistry::isValid(Entity entity) const {
+    uint32_t index = entityIndex(entity);
+    return entity != InvalidEntity && index < generations.size() && generations[index] == entityGeneration(entity);
+}
+
+void EntityRegistry::clear() {
+    for (size_t i = 0; i < pools.size(); ++i) {
+        if (pools[i]) {
+            pools[i]->clear();
+        }
+    }
+    generations.clear();
+    freeIndices.clear();
+}
@@ -0,0 +1,198 @@
+#ifndef ENTITY_REGISTRY_H
+#define ENTITY_REGISTRY_H
+
+#include <stdint.h>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "AlignedAllocator.h"
+
+// Entity handle: low 24 bits index, high 8 bits generation. The generation
+// is bumped when an index is recycled so stale handles fail isValid().
+typedef uint32_t Entity;
+const Entity InvalidEntity = 0xFFFFFFFFu;
+
+const uint32_t EntityIndexBits = 24;
+const uint32_t EntityIndexMask = (1u << EntityIndexBits) - 1;
+
+inline uint32_t entityIndex(Entity entity) { return entity & EntityIndexMask; }
+inline uint32_t entityGeneration(Entity entity) { return entity >> EntityIndexBits; }
+
+class ComponentPoolBase {
+public:
+    virtual ~ComponentPoolBase() {}
+
+    virtual bool contains(Entity entity) const = 0;
+    virtual void remove(Entity entity) = 0;
+    virtual void clear() = 0;
+    virtual size_t size() const = 0;
+};
+
+// Sparse set: `sparse` maps an entity index to a slot in the densely packed
+// `entities`/`components` arrays. Iteration walks the dense arrays only, and
+// removal swaps the last element into the hole so they stay contiguous.
+template <typename T>
+class ComponentPool : public ComponentPoolBase {
+public:
+    static const uint32_t InvalidSlot = 0xFFFFFFFFu;
+
+    bool contains(Entity entity) const override {
+        uint32_t index = entityIndex(entity);
+        return index < sparse.size() && sparse[index] != InvalidSlot && entities[sparse[index]] == entity;
+    }
+
+    T& insert(Entity entity, const T& component) {
+        uint32_t index = entityIndex(entity);
+        if (index >= sparse.size()) {
+            sparse.resize(index + 1, InvalidSlot);
+        }
+        if (sparse[index] != InvalidSlot && entities[sparse[index]] == entity) {
+            components[sparse[index]] = component;
+            return components[sparse[index]];
+        }
+        sparse[index] = static_cast<uint32_t>(entities.size());
+        entities.push_back(entity);
+        components.push_back(component);
+        return components.back();
+    }
+
+    void remove(Entity entity) override {
+        if (!contains(entity)) {
+            return;
+        }
+        uint32_t slot = sparse[entityIndex(entity)];
+        uint32_t last = static_cast<uint32_t>(entities.size() - 1);
+        if (slot != last) {
+            entities[slot] = entities[last];
+            components[slot] = std::move(components[last]);
+            sparse[entityIndex(entities[slot])] = slot;
+        }
+        entities.pop_back();
+        components.pop_back();
+        sparse[entityIndex(entity)] = InvalidSlot;
+    }
+
+    void clear() override {
+        sparse.clear();
+        entities.clear();
+        components.clear();
+    }
+
+    void reserve(size_t count) {
+        entities.reserve(count);
+        components.reserve(count);
+    }
+
+    size_t size() const override { return entities.size(); }
+
+    // Callers must check contains() first
+    T& get(Entity entity) { return components[sparse[entityIndex(entity)]]; }
+    const T& get(Entity entity) const { return components[sparse[entityIndex(entity)]]; }
+
+    Entity* getEntities() { return entities.data(); }
+    T* getComponents() { return components.data(); }
+    const Entity* getEntities() const { return entities.data(); }
+    const T* getComponents() const { return components.data(); }
+
+private:
+    std::vector<uint32_t> sparse;
+    std::vector<Entity> entities;
+    std::vector<T, AlignedAllocator<T, 16>> components;
+};
+
+template <typename T>
+const uint32_t ComponentPool<T>::InvalidSlot;
+
+// Owns entities and one ComponentPool per component type. Component types
+// are any copyable struct; each gets a small integer id on first use.
+class EntityRegistry {
+public:
+    EntityRegistry();
+
+    Entity create();
+    void destroy(Entity entity);
+    bool isValid(Entity entity) const;
+    void clear();
+
+    size_t getNumEntities() const { return generations.size() - freeIndices.size(); }
+
+    template <typename T>
+    T& emplace(Entity entity, const T& component = T()) {
+        return getPool<T>().insert(entity, component);
+    }
+
+    template <typename T>
+    void remove(Entity entity) {
+        getPool<T>().remove(entity);
+    }
+
+    template <typename T>
+    bool has(Entity entity) {
+        return getPool<T>().contains(entity);
+    }
+
+    template <typename T>
+    T& get(Entity entity) {
+        return getPool<T>().get(entity);
+    }
+
+    template <typename T>
+    ComponentPool<T>& getPool() {
+        size_t id = componentTypeId<T>();
+        if (id >= pools.size()) {
+            pools.resize(id + 1);
+        }
+        if (!pools[id]) {
+            pools[id].reset(new ComponentPool<T>());
+        }
+        return static_cast<ComponentPool<T>&>(*pools[id]);
+    }
+
+    // Calls function(entity, first&, rest&...) for every entity that has all
+    // of the listed components. The first component's pool drives iteration,
+    // so list the rarest component first. Adding or removing components of
+    // the iterated types from inside function is not allowed.
+    template <typename First, typename... Rest, typename Function>
+    void each(Function function) {
+        ComponentPool<First>& firstPool = getPool<First>();
+        const Entity* entities = firstPool.getEntities();
+        First* components = firstPool.getComponents();
+        const size_t count = firstPool.size();
+        for (size_t i = 0; i < count; ++i) {
+            Entity entity = entities[i];
+            if (hasAll<Rest...>(entity)) {
+                function(entity, components[i], getPool<Rest>().get(entity)...);
+            }
+        }
+    }
+
+private:
+    std::vector<uint8_t> generations;
+    std::vector<uint32_t> freeIndices;
+    std::vector<std::unique_ptr<ComponentPoolBase>> pools;
+
+    static size_t nextComponentTypeId() {
+        static size_t counter = 0;
+        return counter++;
+    }
+
+    template <typename T>
+    static size_t componentTypeId() {
+        static const size_t id = nextComponentTypeId();
+        return id;
+    }
+
+    template <typename... Components>
+    bool hasAll(Entity entity) {
+        bool results[] = {true, getPool<Components>().contains(entity)...};
+        for (size_t i = 1; i < sizeof(results) / sizeof(results[0]); ++i) {
+            if (!results[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif // ENTITY_REGISTRY_H
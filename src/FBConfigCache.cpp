@@ -0,0 +1,119 @@
+#include "FBConfigCache.h"
+#include "Logger.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+const char* FBConfigCache::cacheDirectory = "cache";
+const char* FBConfigCache::cacheFile = "cache/fbconfig.cache";
+
+FBConfigCache::FBConfigCache(Display* display, int screen, const int* attribs)
+    : display(display), screen(screen) {
+    // FNV-1a over the attribute list so a changed request never reuses a stale ID
+    unsigned int attribHash = 2166136261u;
+    for (const int* attrib = attribs; *attrib != None; attrib += 2) {
+        attribHash = (attribHash ^ static_cast<unsigned int>(attrib[0])) * 16777619u;
+        attribHash = (attribHash ^ static_cast<unsigned int>(attrib[1])) * 16777619u;
+    }
+
+    const char* serverVendor = glXQueryServerString(display, screen, GLX_VENDOR);
+    const char* serverVersion = glXQueryServerString(display, screen, GLX_VERSION);
+    const char* clientVendor = glXGetClientString(display, GLX_VENDOR);
+    const char* clientVersion = glXGetClientString(display, GLX_VERSION);
+
+    char hash[16];
+    snprintf(hash, sizeof(hash), "%08x", attribHash);
+
+    key = std::string(DisplayString(display)) + "|" + std::to_string(screen) + "|" +
+          (serverVendor ? serverVendor : "") + "|" + (serverVersion ? serverVersion : "") + "|" +
+          (clientVendor ? clientVendor : "") + "|" + (clientVersion ? clientVersion : "") + "|" + hash;
+
+    // The key is stored as one tab-separated line
+    for (size_t i = 0; i < key.size(); ++i) {
+        if (key[i] == '\t' || key[i] == '\n') {
+            key[i] = ' ';
+        }
+    }
+}
+
+GLXFBConfig FBConfigCache::lookup() {
+    FILE* file = fopen(cacheFile, "r");
+    if (!file) {
+        return 0;
+    }
+
+    int configID = -1;
+    char line[1024];
+    while (fgets(line, sizeof(line), file)) {
+        char* tab = strrchr(line, '\t');
+        if (tab && key.compare(0, std::string::npos, line, tab - line) == 0) {
+            configID = atoi(tab + 1);
+            break;
+        }
+    }
+    fclose(file);
+
+    if (configID < 0) {
+        return 0;
+    }
+
+    int attribs[] = {GLX_FBCONFIG_ID, configID, None};
+    int numFBConfigs = 0;
+    GLXFBConfig* configs = glXChooseFBConfig(display, screen, attribs, &numFBConfigs);
+    if (!configs) {
+        return 0;
+    }
+
+    GLXFBConfig config = numFBConfigs > 0 ? configs[0] : 0;
+    XFree(configs);
+
+    // Still needs a usable visual, otherwise fall back to the full scan
+    if (config) {
+        XVisualInfo* visualInfo = glXGetVisualFromFBConfig(display, config);
+        if (!visualInfo) {
+            return 0;
+        }
+        XFree(visualInfo);
+    }
+    return config;
+}
+
+void FBConfigCache::store(GLXFBConfig config) {
+    int configID = 0;
+    if (glXGetFBConfigAttrib(display, config, GLX_FBCONFIG_ID, &configID) != Success) {
+        return;
+    }
+
+    // Keep the entries for other displays/drivers, replace ours
+    std::vector<std::string> lines;
+    FILE* file = fopen(cacheFile, "r");
+    if (file) {
+        char line[1024];
+        while (fgets(line, sizeof(line), file)) {
+            char* tab = strrchr(line, '\t');
+            if (tab && key.compare(0, std::string::npos, line, tab - line) != 0) {
+                lines.push_back(line);
+            }
+        }
+        fclose(file);
+    }
+
+    mkdir(cacheDirectory, 0755);
+    file = fopen(cacheFile, "w");
+    if (!file) {
+        logger.Debug("FBConfig cache: cannot write %s", cacheFile);
+        return;
+    }
+    for (size_t i = 0; i < lines.size(); ++i) {
+        fputs(lines[i].c_str(), file);
+    }
+    fprintf(file, "%s\t%d\n", key.c_str(), configID);
+    fclose(file);
+}
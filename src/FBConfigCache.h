@@ -0,0 +1,28 @@
+#ifndef FB_CONFIG_CACHE_H
+#define FB_CONFIG_CACHE_H
+
+#include <GL/glx.h>
+#include <string>
+
+// Persists the GLX_FBCONFIG_ID picked by WindowManager::createWindow() so later
+// runs against the same display and driver skip the per-config visual/attribute
+// round trips. Entries are keyed by display string, screen, GLX client/server
+// vendor+version and a hash of the requested attributes.
+class FBConfigCache {
+public:
+    FBConfigCache(Display* display, int screen, const int* attribs);
+
+    // Returns the cached config or 0 if there is no (still valid) entry
+    GLXFBConfig lookup();
+    void store(GLXFBConfig config);
+
+private:
+    Display* display;
+    int screen;
+    std::string key;
+
+    static const char* cacheDirectory;
+    static const char* cacheFile;
+};
+
+#endif // FB_CONFIG_CACHE_H
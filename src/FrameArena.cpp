@@ -0,0 +1,85 @@
+#include "FrameArena.h"
+#include "MemoryBudget.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+
+inline size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+FrameArena::FrameArena(size_t initialCapacity)
+    : block(static_cast<unsigned char*>(malloc(initialCapacity))), capacity(initialCapacity), offset(0),
+      overflowBytes(0) {
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    memoryBudget.addHostBytes(MemoryCategory::HostFrame, static_cast<int64_t>(capacity));
+    // Spilling is the slow path anyway, but keep it from also growing this list
+    overflowBlocks.reserve(16);
+}
+
+FrameArena::~FrameArena() {
+    for (size_t i = 0; i < overflowBlocks.size(); ++i) {
+        free(overflowBlocks[i]);
+    }
+    free(block);
+    memoryBudget.addHostBytes(MemoryCategory::HostFrame, -static_cast<int64_t>(capacity + overflowBytes));
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    ++stats.allocations;
+
+    // malloc'd blocks are max_align_t aligned, so aligning the offset is enough
+    size_t aligned = alignUp(offset, alignment);
+    if (aligned + size <= capacity) {
+        offset = aligned + size;
+        stats.bytesInUse += size;
+        stats.peakBytes = std::max(stats.peakBytes, stats.bytesInUse);
+        return block + aligned;
+    }
+
+    void* memory = nullptr;
+    if (posix_memalign(&memory, std::max(alignment, sizeof(void*)), size) != 0) {
+        throw std::bad_alloc();
+    }
+    overflowBlocks.push_back(memory);
+    overflowBytes += size;
+    memoryBudget.addHostBytes(MemoryCategory::HostFrame, static_cast<int64_t>(size));
+    ++stats.heapAllocations;
+    stats.bytesInUse += size;
+    stats.peakBytes = std::max(stats.peakBytes, stats.bytesInUse);
+    return memory;
+}
+
+void FrameArena::reset() {
+    if (!overflowBlocks.empty()) {
+        for (size_t i = 0; i < overflowBlocks.size(); ++i) {
+            free(overflowBlocks[i]);
+        }
+        overflowBlocks.clear();
+        memoryBudget.addHostBytes(MemoryCategory::HostFrame, -static_cast<int64_t>(overflowBytes));
+        overflowBytes = 0;
+
+        // Room for the whole frame plus alignment padding and some headroom
+        size_t newCapacity = std::max(capacity * 2, alignUp(stats.bytesInUse + stats.bytesInUse / 2, 4096));
+        unsigned char* newBlock = static_cast<unsigned char*>(malloc(newCapacity));
+        if (newBlock) {
+            memoryBudget.addHostBytes(MemoryCategory::HostFrame, static_cast<int64_t>(newCapacity - capacity));
+            free(block);
+            block = newBlock;
+            capacity = newCapacity;
+        }
+    }
+
+    offset = 0;
+    lastFrameStats = stats;
+    stats = AllocatorStats();
+    // The high-water mark spans frames
+    stats.peakBytes = lastFrameStats.peakBytes;
+}
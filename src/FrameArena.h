@@ -0,0 +1,57 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "AllocatorStats.h"
+
+// Linear allocator for data that lives exactly one frame (render graph pass
+// callbacks, per-frame scratch arrays). allocate() bumps a pointer through
+// one block and reset() rewinds it; nothing is freed individually and no
+// destructors run, so only trivially destructible data, or objects the owner
+// destroys itself before reset(), belong here.
+//
+// A frame that outgrows the block spills into heap blocks, which are freed at
+// reset() and replace the block with one large enough for that frame, so the
+// arena settles after a few frames and steady-state frames never touch the heap.
+class FrameArena {
+public:
+    explicit FrameArena(size_t initialCapacity = 64 * 1024);
+    ~FrameArena();
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    // Value-initialized array of count elements
+    template <typename T>
+    T* allocateArray(size_t count) {
+        T* array = static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+        for (size_t i = 0; i < count; ++i) {
+            new (&array[i]) T();
+        }
+        return array;
+    }
+
+    // Invalidates everything allocated this frame
+    void reset();
+
+    size_t getCapacity() const { return capacity; }
+    // Counters of the frame in progress / of the last frame before reset()
+    const AllocatorStats& getStats() const { return stats; }
+    const AllocatorStats& getLastFrameStats() const { return lastFrameStats; }
+
+private:
+    unsigned char* block;
+    size_t capacity;
+    size_t offset;
+    std::vector<void*> overflowBlocks;
+    size_t overflowBytes;
+    AllocatorStats stats;
+    AllocatorStats lastFrameStats;
+
+    FrameArena(const FrameArena&);
+    FrameArena& operator=(const FrameArena&);
+};
+
+#endif // FRAME_ARENA_H
@@ -0,0 +1,115 @@
+#include "FrameReadback.h"
+#include "GLDebug.h"
+#include "Logger.h"
+#include "MemoryBudget.h"
+#include "GLHooks.h"
+
+#include <cstring>
+
+FrameReadback::FrameReadback(FrameWriter& frameWriter, int ringSize)
+    : frameWriter(frameWriter), nextSlot(0), frameIndex(0), framesSkipped(0) {
+    Slot slot = {0, 0, nullptr, 0, 0, 0};
+    slots.assign(ringSize > 1 ? ringSize : 2, slot);
+}
+
+FrameReadback::~FrameReadback() {
+    cleanup();
+}
+
+void FrameReadback::capture(int width, int height) {
+    ++frameIndex;
+
+    Slot& slot = slots[nextSlot];
+    if (slot.fence && !harvest(slot, 0)) {
+        // The oldest readback is still in flight; don't stall the pipeline for it
+        ++framesSkipped;
+        return;
+    }
+
+    size_t size = static_cast<size_t>(width) * height * 4;
+    if (slot.buffer == 0) {
+        glGenBuffers(1, &slot.buffer);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.capacity < size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        memoryBudget.trackBuffer(MemoryCategory::Readback, slot.buffer, static_cast<int64_t>(size));
+        glDebug.label(GL_BUFFER, slot.buffer, "FrameReadback");
+        slot.capacity = size;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = width;
+    slot.height = height;
+    slot.frameIndex = frameIndex;
+
+    nextSlot = (nextSlot + 1) % static_cast<int>(slots.size());
+}
+
+bool FrameReadback::harvest(Slot& slot, GLuint64 timeout) {
+    GLenum status = glClientWaitSync(slot.fence, timeout ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    if (status == GL_WAIT_FAILED) {
+        logger.Error("FrameReadback: glClientWaitSync failed");
+        return true;
+    }
+
+    size_t size = static_cast<size_t>(slot.width) * slot.height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (pixels) {
+        CapturedFrame* frame = frameWriter.acquireFrame();
+        frame->frameIndex = slot.frameIndex;
+        frame->width = slot.width;
+        frame->height = slot.height;
+        frame->pixels.resize(size);
+        memcpy(frame->pixels.data(), pixels, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        frameWriter.submit(frame);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void FrameReadback::poll() {
+    // Oldest first so frames reach the writer in order
+    for (size_t i = 0; i < slots.size(); ++i) {
+        Slot& slot = slots[(nextSlot + i) % slots.size()];
+        if (slot.fence && !harvest(slot, 0)) {
+            break;
+        }
+    }
+}
+
+void FrameReadback::flush() {
+    for (size_t i = 0; i < slots.size(); ++i) {
+        Slot& slot = slots[(nextSlot + i) % slots.size()];
+        while (slot.fence && !harvest(slot, 1000000000ull)) {
+        }
+    }
+}
+
+void FrameReadback::cleanup() {
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (slots[i].fence) {
+            glDeleteSync(slots[i].fence);
+            slots[i].fence = nullptr;
+        }
+        if (slots[i].buffer) {
+            memoryBudget.untrackBuffer(slots[i].buffer);
+            glDeleteBuffers(1, &slots[i].buffer);
+            slots[i].buffer = 0;
+            slots[i].capacity = 0;
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef FRAME_READBACK_H
+#define FRAME_READBACK_H
+
+#include <GL/glew.h>
+#include <vector>
+
+#include "FrameWriter.h"
+
+// Asynchronous framebuffer readback. capture() issues glReadPixels into the
+// next pixel-pack buffer of a small ring and fences it; poll() maps only the
+// buffers whose fence has already signaled (a few frames later) and hands the
+// pixels to the FrameWriter thread. Neither call waits on the GPU: when every
+// ring slot is still in flight the frame is skipped and counted.
+class FrameReadback {
+public:
+    explicit FrameReadback(FrameWriter& frameWriter, int ringSize = 3);
+    ~FrameReadback();
+
+    // Reads the color buffer of the bound read framebuffer
+    void capture(int width, int height);
+    void poll();
+    // Blocks until every pending readback has been handed to the writer
+    void flush();
+
+    void cleanup();
+
+    unsigned long getFramesSkipped() const { return framesSkipped; }
+
+private:
+    struct Slot {
+        GLuint buffer;
+        size_t capacity;
+        GLsync fence;
+        int width;
+        int height;
+        unsigned long frameIndex;
+    };
+
+    FrameWriter& frameWriter;
+    std::vector<Slot> slots;
+    int nextSlot;
+    unsigned long frameIndex;
+    unsigned long framesSkipped;
+
+    bool harvest(Slot& slot, GLuint64 timeout);
+};
+
+#endif // FRAME_READBACK_H
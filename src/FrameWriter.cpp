@@ -0,0 +1,217 @@
+#include "FrameWriter.h"
+#include "Logger.h"
+#include "PngWriter.h"
+
+#include <cstring>
+
+namespace {
+
+// Splits a png pattern around its one integer conversion (%d, %05d, %lu, ...);
+// "%%" is a literal percent sign. False when there is no conversion, more than
+// one, or one of another kind: the pattern is user input and never reaches
+// printf.
+bool splitPattern(const std::string& pattern, std::string& prefix, std::string& suffix, int& width, bool& zeroPad) {
+    std::string* part = &prefix;
+    bool found = false;
+    prefix.clear();
+    suffix.clear();
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        if (pattern[i] != '%') {
+            *part += pattern[i];
+            continue;
+        }
+        if (i + 1 < pattern.size() && pattern[i + 1] == '%') {
+            *part += '%';
+            ++i;
+            continue;
+        }
+        if (found) {
+            return false;
+        }
+
+        size_t j = i + 1;
+        zeroPad = j < pattern.size() && pattern[j] == '0';
+        width = 0;
+        while (j < pattern.size() && pattern[j] >= '0' && pattern[j] <= '9' && width < 64) {
+            width = width * 10 + (pattern[j++] - '0');
+        }
+        if (j < pattern.size() && pattern[j] == 'l') {
+            ++j;
+        }
+        if (j >= pattern.size() || (pattern[j] != 'd' && pattern[j] != 'i' && pattern[j] != 'u')) {
+            return false;
+        }
+        found = true;
+        part = &suffix;
+        i = j;
+    }
+    return found;
+}
+
+} // namespace
+
+FrameWriter::FrameWriter()
+    : maxQueuedFrames(8), mode(FrameWriterMode::Png), output(nullptr), streamWidth(0), streamHeight(0),
+      indexWidth(0), indexZeroPad(false), running(false), framesWritten(0), framesDropped(0) {
+}
+
+FrameWriter::~FrameWriter() {
+    close();
+    for (size_t i = 0; i < allFrames.size(); ++i) {
+        delete allFrames[i];
+    }
+}
+
+bool FrameWriter::open(const char* spec) {
+    const char* colon = strchr(spec, ':');
+    if (!colon) {
+        logger.Error("FrameWriter: expected png:<pattern>, raw:<file> or pipe:<command>, got '%s'", spec);
+        return false;
+    }
+
+    std::string kind(spec, colon - spec);
+    if (kind == "png") {
+        return open(FrameWriterMode::Png, colon + 1);
+    }
+    if (kind == "raw") {
+        return open(FrameWriterMode::Raw, colon + 1);
+    }
+    if (kind == "pipe") {
+        return open(FrameWriterMode::Pipe, colon + 1);
+    }
+
+    logger.Error("FrameWriter: unknown output kind '%s'", kind.c_str());
+    return false;
+}
+
+bool FrameWriter::open(FrameWriterMode mode, const char* target) {
+    close();
+
+    this->mode = mode;
+    this->target = target;
+    streamWidth = streamHeight = 0;
+
+    if (mode == FrameWriterMode::Png &&
+        !splitPattern(this->target, pathPrefix, pathSuffix, indexWidth, indexZeroPad)) {
+        logger.Error("FrameWriter: png pattern '%s' needs exactly one integer conversion for the frame index, "
+                     "e.g. frame%%05d.png",
+                     target);
+        return false;
+    }
+    if (mode == FrameWriterMode::Raw) {
+        output = fopen(target, "wb");
+    } else if (mode == FrameWriterMode::Pipe) {
+        output = popen(target, "w");
+    }
+    if (mode != FrameWriterMode::Png && !output) {
+        logger.Error("FrameWriter: failed to open '%s'", target);
+        return false;
+    }
+
+    running = true;
+    thread = std::thread(&FrameWriter::writerLoop, this);
+
+    logger.Info("FrameWriter: writing frames to '%s'", target);
+    return true;
+}
+
+void FrameWriter::close() {
+    if (!running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    condition.notify_all();
+    thread.join();
+
+    if (output) {
+        if (mode == FrameWriterMode::Pipe) {
+            pclose(output);
+        } else {
+            fclose(output);
+        }
+        output = nullptr;
+    }
+
+    logger.Info("FrameWriter: %lu frames written, %lu dropped", framesWritten.load(), framesDropped.load());
+}
+
+CapturedFrame* FrameWriter::acquireFrame() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!freeFrames.empty()) {
+        CapturedFrame* frame = freeFrames.back();
+        freeFrames.pop_back();
+        return frame;
+    }
+
+    CapturedFrame* frame = new CapturedFrame();
+    allFrames.push_back(frame);
+    return frame;
+}
+
+void FrameWriter::recycle(CapturedFrame* frame) {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeFrames.push_back(frame);
+}
+
+void FrameWriter::submit(CapturedFrame* frame) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.size() >= maxQueuedFrames) {
+            ++framesDropped;
+            freeFrames.push_back(frame);
+            return;
+        }
+        queue.push_back(frame);
+    }
+    condition.notify_one();
+}
+
+void FrameWriter::writerLoop() {
+    for (;;) {
+        CapturedFrame* frame = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return !running || !queue.empty(); });
+            if (queue.empty()) {
+                return; // stopping and drained
+            }
+            frame = queue.front();
+            queue.pop_front();
+        }
+
+        writeFrame(frame);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++framesWritten;
+        freeFrames.push_back(frame);
+    }
+}
+
+void FrameWriter::writeFrame(CapturedFrame* frame) {
+    if (mode == FrameWriterMode::Png) {
+        char index[96];
+        snprintf(index, sizeof(index), indexZeroPad ? "%0*lu" : "%*lu", indexWidth, frame->frameIndex);
+        std::string path = pathPrefix + index + pathSuffix;
+        PngWriter::write(path.c_str(), frame->pixels.data(), frame->width, frame->height, true);
+        return;
+    }
+
+    // Streams need a fixed frame size; frames after a resize are skipped
+    if (streamWidth == 0) {
+        streamWidth = frame->width;
+        streamHeight = frame->height;
+        logger.Info("FrameWriter: stream size %dx%d RGBA", streamWidth, streamHeight);
+    }
+    if (frame->width != streamWidth || frame->height != streamHeight) {
+        return;
+    }
+
+    const size_t rowBytes = static_cast<size_t>(frame->width) * 4;
+    for (int y = frame->height - 1; y >= 0; --y) {
+        fwrite(&frame->pixels[y * rowBytes], 1, rowBytes, output);
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef FRAME_WRITER_H
+#define FRAME_WRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A captured RGBA8 frame, rows bottom to top as returned by glReadPixels
+struct CapturedFrame {
+    unsigned long frameIndex;
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+};
+
+enum class FrameWriterMode {
+    Png,  // one PNG per frame, path pattern with one integer conversion for the frame index (frame%05d.png)
+    Raw,  // raw RGBA frames appended to one file, top to bottom
+    Pipe  // raw RGBA frames written to the stdin of a shell command
+};
+
+// Owns the thread that encodes and writes captured frames so the render
+// thread never waits on disk or an encoder. Frame buffers are recycled
+// through a free list; when the queue is full the newest frame is dropped.
+class FrameWriter {
+public:
+    FrameWriter();
+    ~FrameWriter();
+
+    // spec: "png:<pattern>", "raw:<file>" or "pipe:<command>"
+    bool open(const char* spec);
+    bool open(FrameWriterMode mode, const char* target);
+    void close();
+    bool isOpen() const { return running; }
+
+    // Returns a buffer to fill; give it back with submit() or recycle()
+    CapturedFrame* acquireFrame();
+    void submit(CapturedFrame* frame);
+    void recycle(CapturedFrame* frame);
+
+    unsigned long getFramesWritten() const { return framesWritten; }
+    unsigned long getFramesDropped() const { return framesDropped; }
+
+    size_t maxQueuedFrames;
+
+private:
+    FrameWriterMode mode;
+    std::string target;
+    FILE* output;
+    int streamWidth, streamHeight;
+    // Png: the pattern around its frame index conversion
+    std::string pathPrefix, pathSuffix;
+    int indexWidth;
+    bool indexZeroPad;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<CapturedFrame*> queue;
+    std::vector<CapturedFrame*> freeFrames;
+    std::vector<CapturedFrame*> allFrames;
+    bool running;
+
+    std::atomic<unsigned long> framesWritten;
+    std::atomic<unsigned long> framesDropped;
+
+    void writerLoop();
+    void writeFrame(CapturedFrame* frame);
+
+    FrameWriter(const FrameWriter&);
+    FrameWriter& operator=(const FrameWriter&);
+};
+
+#endif // FRAME_WRITER_H
@@ -0,0 +1,279 @@
+#include "FrustumCulling.h"
+#include "ThreadPool.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define XWGL_CULLING_X86 1
+#include <immintrin.h>
+#endif
+
+// Padding spheres: radius -FLT_MAX makes every plane test fail
+static const float InvisibleRadius = -FLT_MAX;
+
+Frustum Frustum::fromMatrix(const float m[16]) {
+    // Rows of the column-major matrix
+    float row[4][4];
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            row[r][c] = m[c * 4 + r];
+        }
+    }
+
+    Frustum frustum;
+    for (int c = 0; c < 4; ++c) {
+        frustum.planes[0][c] = row[3][c] + row[0][c]; // left
+        frustum.planes[1][c] = row[3][c] - row[0][c]; // right
+        frustum.planes[2][c] = row[3][c] + row[1][c]; // bottom
+        frustum.planes[3][c] = row[3][c] - row[1][c]; // top
+        frustum.planes[4][c] = row[3][c] + row[2][c]; // near
+        frustum.planes[5][c] = row[3][c] - row[2][c]; // far
+    }
+
+    // Normalize so the plane distance compares against the radius in world units
+    for (int p = 0; p < 6; ++p) {
+        float* plane = frustum.planes[p];
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            for (int c = 0; c < 4; ++c) {
+                plane[c] /= length;
+            }
+        }
+    }
+    return frustum;
+}
+
+BoundingSphereSet::BoundingSphereSet() : count(0) {
+}
+
+uint32_t BoundingSphereSet::add(float x, float y, float z, float r) {
+    uint32_t index = static_cast<uint32_t>(count++);
+    if (count > centerX.size()) {
+        size_t padded = (count + 7) & ~static_cast<size_t>(7);
+        centerX.resize(padded, 0.0f);
+        centerY.resize(padded, 0.0f);
+        centerZ.resize(padded, 0.0f);
+        radius.resize(padded, InvisibleRadius);
+    }
+    set(index, x, y, z, r);
+    return index;
+}
+
+void BoundingSphereSet::set(uint32_t index, float x, float y, float z, float r) {
+    centerX[index] = x;
+    centerY[index] = y;
+    centerZ[index] = z;
+    radius[index] = r;
+}
+
+void BoundingSphereSet::clear() {
+    count = 0;
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radius.clear();
+}
+
+void BoundingSphereSet::reserve(size_t capacity) {
+    size_t padded = (capacity + 7) & ~static_cast<size_t>(7);
+    centerX.reserve(padded);
+    centerY.reserve(padded);
+    centerZ.reserve(padded);
+    radius.reserve(padded);
+}
+
+// Scalar reference path
+
+static size_t cullScalar(const Frustum& frustum, const BoundingSphereSet& spheres, size_t begin, size_t end,
+                         uint32_t* visibleIndices) {
+    size_t numVisible = 0;
+    for (size_t i = begin; i < end; ++i) {
+        float x = spheres.centerX[i], y = spheres.centerY[i], z = spheres.centerZ[i], r = spheres.radius[i];
+        bool visible = true;
+        for (int p = 0; p < 6 && visible; ++p) {
+            const float* plane = frustum.planes[p];
+            visible = plane[0] * x + plane[1] * y + plane[2] * z + plane[3] >= -r;
+        }
+        visibleIndices[numVisible] = static_cast<uint32_t>(i);
+        numVisible += visible;
+    }
+    return numVisible;
+}
+
+#ifdef XWGL_CULLING_X86
+
+// 4 spheres per iteration (SSE2 is part of x86-64)
+
+static size_t cullSSE(const Frustum& frustum, const BoundingSphereSet& spheres, size_t begin, size_t end,
+                      uint32_t* visibleIndices) {
+    __m128 planes[6][4];
+    for (int p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+        }
+    }
+
+    const float* xs = spheres.centerX.data();
+    const float* ys = spheres.centerY.data();
+    const float* zs = spheres.centerZ.data();
+    const float* rs = spheres.radius.data();
+
+    size_t numVisible = 0;
+    for (size_t i = begin; i < end; i += 4) {
+        __m128 x = _mm_load_ps(xs + i);
+        __m128 y = _mm_load_ps(ys + i);
+        __m128 z = _mm_load_ps(zs + i);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_load_ps(rs + i));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(planes[p][0], x), _mm_mul_ps(planes[p][1], y)),
+                _mm_add_ps(_mm_mul_ps(planes[p][2], z), planes[p][3]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_ps(inside));
+        while (mask) {
+            visibleIndices[numVisible++] = static_cast<uint32_t>(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    return numVisible;
+}
+
+// 8 spheres per iteration; compiled for AVX2/FMA only in this function so the
+// rest of the binary keeps the baseline ISA
+
+__attribute__((target("avx2,fma")))
+static size_t cullAVX2(const Frustum& frustum, const BoundingSphereSet& spheres, size_t begin, size_t end,
+                       uint32_t* visibleIndices) {
+    __m256 planes[6][4];
+    for (int p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+        }
+    }
+
+    const float* xs = spheres.centerX.data();
+    const float* ys = spheres.centerY.data();
+    const float* zs = spheres.centerZ.data();
+    const float* rs = spheres.radius.data();
+
+    size_t numVisible = 0;
+    for (size_t i = begin; i < end; i += 8) {
+        __m256 x = _mm256_load_ps(xs + i);
+        __m256 y = _mm256_load_ps(ys + i);
+        __m256 z = _mm256_load_ps(zs + i);
+        __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_load_ps(rs + i));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m256 distance = _mm256_fmadd_ps(planes[p][0], x,
+                              _mm256_fmadd_ps(planes[p][1], y,
+                              _mm256_fmadd_ps(planes[p][2], z, planes[p][3])));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_ps(inside));
+        while (mask) {
+            visibleIndices[numVisible++] = static_cast<uint32_t>(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    return numVisible;
+}
+
+#endif // XWGL_CULLING_X86
+
+FrustumCuller::FrustumCuller() : path(detectPath()) {
+}
+
+CullingPath FrustumCuller::detectPath() {
+    CullingPath best = CullingPath::Scalar;
+#ifdef XWGL_CULLING_X86
+    best = CullingPath::SSE;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        best = CullingPath::AVX2;
+    }
+#endif
+
+    const char* override = getenv("XWGL_CULLING");
+    if (override != nullptr) {
+        if (strcmp(override, "scalar") == 0) {
+            return CullingPath::Scalar;
+        }
+        if (strcmp(override, "sse") == 0 && best != CullingPath::Scalar) {
+            return CullingPath::SSE;
+        }
+    }
+    return best;
+}
+
+void FrustumCuller::setPath(CullingPath path) {
+    // Never go wider than the CPU allows
+    CullingPath supported = detectPath();
+    this->path = static_cast<int>(path) > static_cast<int>(supported) ? supported : path;
+}
+
+const char* FrustumCuller::getPathName(CullingPath path) {
+    switch (path) {
+        case CullingPath::Scalar:
+            return "scalar";
+        case CullingPath::SSE:
+            return "sse";
+        case CullingPath::AVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+size_t FrustumCuller::cullRange(const Frustum& frustum, const BoundingSphereSet& spheres, size_t begin, size_t end,
+                                uint32_t* visibleIndices) const {
+#ifdef XWGL_CULLING_X86
+    // begin is a multiple of 8; the padding makes rounding end up safe
+    size_t paddedEnd = (end + 7) & ~static_cast<size_t>(7);
+    if (path == CullingPath::AVX2) {
+        return cullAVX2(frustum, spheres, begin, paddedEnd, visibleIndices);
+    }
+    if (path == CullingPath::SSE) {
+        return cullSSE(frustum, spheres, begin, paddedEnd, visibleIndices);
+    }
+#endif
+    return cullScalar(frustum, spheres, begin, end, visibleIndices);
+}
+
+size_t FrustumCuller::cull(const Frustum& frustum, const BoundingSphereSet& spheres, uint32_t* visibleIndices) const {
+    return cullRange(frustum, spheres, 0, spheres.size(), visibleIndices);
+}
+
+size_t FrustumCuller::cullParallel(const Frustum& frustum, const BoundingSphereSet& spheres, uint32_t* visibleIndices,
+                                   ThreadPool& threadPool, size_t minBlockSize) const {
+    const size_t count = spheres.size();
+    const size_t blockSize = ((minBlockSize > 8 ? minBlockSize : 8) + 7) & ~static_cast<size_t>(7);
+    const size_t numBlocks = (count + blockSize - 1) / blockSize;
+    if (numBlocks <= 1) {
+        return cull(frustum, spheres, visibleIndices);
+    }
+
+    // Each block writes its survivors at its own offset, then the blocks are compacted in order
+    std::vector<size_t> blockVisible(numBlocks, 0);
+    threadPool.parallelFor(numBlocks, 1, [&](size_t firstBlock, size_t lastBlock) {
+        for (size_t block = firstBlock; block < lastBlock; ++block) {
+            size_t begin = block * blockSize;
+            size_t end = begin + blockSize < count ? begin + blockSize : count;
+            blockVisible[block] = cullRange(frustum, spheres, begin, end, visibleIndices + begin);
+        }
+    });
+
+    size_t numVisible = blockVisible[0];
+    for (size_t block = 1; block < numBlocks; ++block) {
+        memmove(visibleIndices + numVisible, visibleIndices + block * blockSize, blockVisible[block] * sizeof(uint32_t));
+        numVisible += blockVisible[block];
+    }
+    return numVisible;
+}
@@ -0,0 +1,78 @@
+#ifndef FRUSTUM_CULLING_H
+#define FRUSTUM_CULLING_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "AlignedAllocator.h"
+
+class ThreadPool;
+
+typedef std::vector<float, AlignedAllocator<float, 32>> AlignedFloatArray;
+
+// Six planes (a, b, c, d) with normals pointing inside: a point p is inside
+// a plane when a*p.x + b*p.y + c*p.z + d >= 0.
+struct Frustum {
+    float planes[6][4];
+
+    // Gribb/Hartmann extraction from a column-major view-projection matrix
+    static Frustum fromMatrix(const float viewProjection[16]);
+};
+
+// Bounding spheres stored as structure-of-arrays. Arrays are padded to a
+// multiple of 8 with spheres that can never be visible, so the SIMD paths
+// never need a scalar tail.
+class BoundingSphereSet {
+public:
+    BoundingSphereSet();
+
+    uint32_t add(float x, float y, float z, float radius);
+    void set(uint32_t index, float x, float y, float z, float radius);
+    void clear();
+    void reserve(size_t count);
+
+    size_t size() const { return count; }
+
+    AlignedFloatArray centerX;
+    AlignedFloatArray centerY;
+    AlignedFloatArray centerZ;
+    AlignedFloatArray radius;
+
+private:
+    size_t count;
+};
+
+enum class CullingPath {
+    Scalar,
+    SSE,
+    AVX2
+};
+
+// Tests bounding spheres against a frustum and writes the indices of the
+// visible ones. The widest path the CPU supports is picked at runtime via
+// CPUID (overridable with XWGL_CULLING=scalar|sse|avx2).
+class FrustumCuller {
+public:
+    FrustumCuller();
+
+    CullingPath getPath() const { return path; }
+    void setPath(CullingPath path);
+    static const char* getPathName(CullingPath path);
+
+    // visibleIndices must hold spheres.size() entries; returns the visible count
+    size_t cull(const Frustum& frustum, const BoundingSphereSet& spheres, uint32_t* visibleIndices) const;
+
+    // Same, split across the thread pool in blocks of minBlockSize spheres
+    size_t cullParallel(const Frustum& frustum, const BoundingSphereSet& spheres, uint32_t* visibleIndices,
+                        ThreadPool& threadPool, size_t minBlockSize = 16384) const;
+
+    static CullingPath detectPath();
+
+private:
+    CullingPath path;
+
+    size_t cullRange(const Frustum& frustum, const BoundingSphereSet& spheres, size_t begin, size_t end,
+                     uint32_t* visibleIndices) const;
+};
+
+#endif // FRUSTUM_CULLING_H
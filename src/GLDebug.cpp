@@ -0,0 +1,228 @@
+#include "GLDebug.h"
+#include "Logger.h"
+
+#include <cstdlib>
+#include <cstring>
+
+// Definition of the global GL debug instance
+GLDebug glDebug;
+
+namespace {
+
+const char* sourceName(GLenum source) {
+    switch (source) {
+        case GL_DEBUG_SOURCE_API:
+            return "api";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+            return "window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER:
+            return "shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY:
+            return "third party";
+        case GL_DEBUG_SOURCE_APPLICATION:
+            return "application";
+        default:
+            return "other";
+    }
+}
+
+const char* typeName(GLenum type) {
+    switch (type) {
+        case GL_DEBUG_TYPE_ERROR:
+            return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+            return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+            return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY:
+            return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE:
+            return "performance";
+        case GL_DEBUG_TYPE_MARKER:
+            return "marker";
+        default:
+            return "other";
+    }
+}
+
+// FNV-1a over the identifying fields and the text: drivers reuse one id for
+// many different performance warnings
+uint64_t messageKey(GLenum source, GLenum type, GLuint id, const char* message, size_t length) {
+    uint64_t hash = 14695981039346656037ull;
+    const uint32_t fields[3] = {source, type, id};
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(fields);
+    for (size_t i = 0; i < sizeof(fields); ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(message[i])) * 1099511628211ull;
+    }
+    return hash;
+}
+
+}
+
+GLDebug::GLDebug()
+    : mode(GLDebugMode::Off), annotations(false), outputInstalled(false), maxPerSecond(20), windowCount(0),
+      windowDropped(0), totalDropped(0) {}
+
+void GLDebug::configure() {
+    const char* setting = getenv("XWGL_GL_DEBUG");
+    if (setting == nullptr || strcmp(setting, "0") == 0 || setting[0] == '\0') {
+        mode = GLDebugMode::Off;
+    } else if (strcmp(setting, "labels") == 0) {
+        mode = GLDebugMode::Labels;
+    } else {
+        mode = GLDebugMode::Output;
+    }
+
+    const char* rate = getenv("XWGL_GL_DEBUG_RATE");
+    if (rate != nullptr && atoi(rate) > 0) {
+        maxPerSecond = static_cast<unsigned int>(atoi(rate));
+    }
+}
+
+void GLDebug::initialize() {
+    if (mode == GLDebugMode::Off) {
+        return;
+    }
+    if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug) {
+        logger.Error("GLDebug: KHR_debug is not available, XWGL_GL_DEBUG ignored");
+        mode = GLDebugMode::Off;
+        return;
+    }
+    annotations = true;
+
+    if (mode != GLDebugMode::Output) {
+        return;
+    }
+
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) {
+        logger.Info("GLDebug: context has no debug flag, the driver may report fewer messages");
+    }
+
+    windowStart = std::chrono::steady_clock::now();
+    glEnable(GL_DEBUG_OUTPUT);
+    // Messages arrive on the GL thread, inside the call that caused them
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(callback, this);
+
+    // Notifications and low severity are noise (group push/pop, buffer
+    // placement info), except for performance warnings, which are the point
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_LOW, 0, nullptr, GL_FALSE);
+    glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_PERFORMANCE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+    outputInstalled = true;
+
+    logger.Info("GLDebug: debug output enabled, at most %u messages per second", maxPerSecond);
+}
+
+void GLDebug::shutdown() {
+    if (outputInstalled) {
+        glDebugMessageCallback(nullptr, nullptr);
+        glDisable(GL_DEBUG_OUTPUT);
+        outputInstalled = false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t repeated = 0;
+    for (std::unordered_map<uint64_t, MessageRecord>::const_iterator it = messages.begin(); it != messages.end();
+         ++it) {
+        if (it->second.count > 1) {
+            ++repeated;
+            logger.Info("GLDebug: %llu x %s: %s", static_cast<unsigned long long>(it->second.count),
+                        typeName(it->second.type), it->second.text.c_str());
+        }
+    }
+    if (!messages.empty()) {
+        logger.Info("GLDebug: %zu distinct messages (%llu repeated), %llu dropped by the rate limit",
+                    messages.size(), static_cast<unsigned long long>(repeated),
+                    static_cast<unsigned long long>(totalDropped));
+    }
+    messages.clear();
+}
+
+void GLDebug::pushGroup(const char* name) {
+    if (annotations) {
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+    }
+}
+
+void GLDebug::popGroup() {
+    if (annotations) {
+        glPopDebugGroup();
+    }
+}
+
+void GLDebug::label(GLenum identifier, GLuint name, const char* text) {
+    if (annotations && name != 0) {
+        glObjectLabel(identifier, name, -1, text);
+    }
+}
+
+void GLAPIENTRY GLDebug::callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                  const GLchar* message, const void* userParam) {
+    GLDebug* self = static_cast<GLDebug*>(const_cast<void*>(userParam));
+    size_t messageLength = length >= 0 ? static_cast<size_t>(length) : strlen(message);
+    self->handleMessage(source, type, id, severity, message, messageLength);
+}
+
+void GLDebug::handleMessage(GLenum source, GLenum type, GLuint id, GLenum severity, const char* message,
+                            size_t length) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Repeats are counted; the log gets the 1st, 10th, 100th, ... occurrence
+    uint64_t key = messageKey(source, type, id, message, length);
+    std::unordered_map<uint64_t, MessageRecord>::iterator it = messages.find(key);
+    if (it == messages.end()) {
+        MessageRecord record;
+        record.count = 0;
+        record.nextReport = 1;
+        record.type = type;
+        record.severity = severity;
+        record.text.assign(message, length);
+        it = messages.insert(std::make_pair(key, record)).first;
+    }
+    MessageRecord& record = it->second;
+    if (++record.count < record.nextReport) {
+        return;
+    }
+    record.nextReport *= 10;
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - windowStart >= std::chrono::seconds(1)) {
+        if (windowDropped > 0) {
+            logger.Info("GLDebug: %llu messages dropped by the rate limit in the last window",
+                        static_cast<unsigned long long>(windowDropped));
+        }
+        windowStart = now;
+        windowCount = 0;
+        windowDropped = 0;
+    }
+    if (windowCount >= maxPerSecond) {
+        ++windowDropped;
+        ++totalDropped;
+        return;
+    }
+    ++windowCount;
+
+    route(source, type, id, severity, record.text.c_str(), record.count);
+}
+
+void GLDebug::route(GLenum source, GLenum type, GLuint id, GLenum severity, const char* message,
+                    uint64_t repeats) {
+    char repeatNote[48] = "";
+    if (repeats > 1) {
+        snprintf(repeatNote, sizeof(repeatNote), " (seen %llu times)", static_cast<unsigned long long>(repeats));
+    }
+
+    if (type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH) {
+        logger.Error("GL %s %s [%u]%s: %s", sourceName(source), typeName(type), id, repeatNote, message);
+    } else if (type == GL_DEBUG_TYPE_PERFORMANCE) {
+        logger.Info("GL performance, %s [%u]%s: %s", sourceName(source), id, repeatNote, message);
+    } else {
+        logger.Debug("GL %s %s [%u]%s: %s", sourceName(source), typeName(type), id, repeatNote, message);
+    }
+}
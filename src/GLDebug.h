@@ -0,0 +1,76 @@
+#ifndef GL_DEBUG_H
+#define GL_DEBUG_H
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+enum class GLDebugMode {
+    Off,
+    Labels, // debug groups and object labels only, for capture tools
+    Output  // debug context, driver messages routed to the logger, plus labels
+};
+
+// KHR_debug integration, selected with XWGL_GL_DEBUG=1 (or =labels):
+//  - a debug context, with synchronous driver messages routed into the
+//    logger: errors and high severity to Error, performance warnings
+//    (implicit syncs, shader recompiles, slow paths) to Info, the rest of
+//    medium severity to Debug. Notifications are filtered out in the driver.
+//  - repeats of a message are counted rather than logged (the log shows the
+//    first one and then every 10x), and at most XWGL_GL_DEBUG_RATE messages
+//    per second (default 20) reach the logger; shutdown() logs the totals.
+//  - debug groups around render graph passes and labels on engine objects,
+//    so driver messages and capture tools name them.
+class GLDebug {
+public:
+    GLDebug();
+
+    // Reads the environment; call before the context is created
+    void configure();
+    GLDebugMode getMode() const { return mode; }
+    bool wantsDebugContext() const { return mode == GLDebugMode::Output; }
+
+    // Installs the callback and message filters; needs a current context and GLEW
+    void initialize();
+    void shutdown();
+
+    // No-ops unless enabled
+    void pushGroup(const char* name);
+    void popGroup();
+    void label(GLenum identifier, GLuint name, const char* text);
+
+private:
+    struct MessageRecord {
+        uint64_t count;
+        uint64_t nextReport;
+        GLenum type;
+        GLenum severity;
+        std::string text;
+    };
+
+    GLDebugMode mode;
+    bool annotations;
+    bool outputInstalled;
+    unsigned int maxPerSecond;
+
+    std::mutex mutex;
+    std::unordered_map<uint64_t, MessageRecord> messages;
+    std::chrono::steady_clock::time_point windowStart;
+    unsigned int windowCount;
+    uint64_t windowDropped;
+    uint64_t totalDropped;
+
+    static void GLAPIENTRY callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                    const GLchar* message, const void* userParam);
+    void handleMessage(GLenum source, GLenum type, GLuint id, GLenum severity, const char* message, size_t length);
+    void route(GLenum source, GLenum type, GLuint id, GLenum severity, const char* message, uint64_t repeats);
+};
+
+// Global instance of GLDebug
+extern GLDebug glDebug;
+
+#endif // GL_DEBUG_H
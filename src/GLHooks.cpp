@@ -0,0 +1,673 @@
+#define GL_HOOKS_IMPLEMENTATION
+#include "GLHooks.h"
+
+#ifdef XWGL_GL_HOOKS
+
+#include "GLStats.h"
+#include "GLTrace.h"
+
+#include <cstdlib>
+#include <string>
+
+void hookInitialize() {
+#ifdef XWGL_GL_STATS
+    glStats.initialize();
+#endif
+#ifdef XWGL_GL_CAPTURE
+    const char* capturePath = getenv("XWGL_CAPTURE");
+    if (capturePath != nullptr) {
+        const char* captureFrames = getenv("XWGL_CAPTURE_FRAMES");
+        glTraceWriter.open(capturePath, captureFrames ? atoi(captureFrames) : 0);
+    }
+#endif
+}
+
+void hookEndFrame() {
+#ifdef XWGL_GL_STATS
+    glStats.endFrame();
+#endif
+#ifdef XWGL_GL_CAPTURE
+    glTraceWriter.endFrame();
+#endif
+}
+
+void hookShutdown() {
+#ifdef XWGL_GL_STATS
+    glStats.shutdown();
+#endif
+#ifdef XWGL_GL_CAPTURE
+    glTraceWriter.close();
+#endif
+}
+
+#ifdef XWGL_GL_CAPTURE
+#define TRACE_BEGIN(op) if (glTraceWriter.isActive()) { glTraceWriter.beginRecord(GLTraceOp::op);
+#define TRACE_ARG(value) glTraceWriter.write(value);
+#define TRACE_END() glTraceWriter.endRecord(); }
+#else
+#define TRACE_BEGIN(op) if (false) {
+#define TRACE_ARG(value) (void)(value);
+#define TRACE_END() }
+#endif
+
+#ifdef XWGL_GL_STATS
+#define STATS(statement) ++glStats.current.calls; statement;
+#else
+#define STATS(statement)
+#endif
+
+// GL_UNPACK_ALIGNMENT as last set through the hooks, to size traced texture uploads
+static GLint unpackAlignment = 4;
+
+#ifdef XWGL_GL_STATS
+static uint64_t primitiveCount(GLenum mode, GLsizei count) {
+    switch (mode) {
+        case GL_TRIANGLES:
+            return count / 3;
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN:
+            return count > 2 ? count - 2 : 0;
+        default:
+            return 0;
+    }
+}
+#endif
+
+// Client bytes of a glTexSubImage2D upload for the formats the engine uses;
+// every row but the last is padded to rowAlignment (GL_UNPACK_ALIGNMENT)
+static uint64_t pixelBytes(GLenum format, GLenum type, GLsizei width, GLsizei height, GLint rowAlignment) {
+    uint64_t components = format == GL_RED || format == GL_RED_INTEGER ? 1
+                        : format == GL_RG || format == GL_RG_INTEGER   ? 2
+                        : format == GL_RGB || format == GL_BGR || format == GL_RGB_INTEGER ? 3
+                                                                                             : 4;
+    uint64_t componentSize = (type == GL_FLOAT || type == GL_UNSIGNED_INT || type == GL_INT) ? 4
+                           : (type == GL_HALF_FLOAT || type == GL_UNSIGNED_SHORT || type == GL_SHORT) ? 2 : 1;
+    uint64_t rowBytes = components * componentSize * static_cast<uint64_t>(width);
+    uint64_t paddedRowBytes = (rowBytes + rowAlignment - 1) / rowAlignment * rowAlignment;
+    return height > 0 ? paddedRowBytes * (height - 1) + rowBytes : 0;
+}
+
+// Gen*/Delete* calls: count followed by the names
+static void traceNames(GLTraceOp op, GLsizei n, const GLuint* names) {
+#ifdef XWGL_GL_CAPTURE
+    if (glTraceWriter.isActive()) {
+        glTraceWriter.beginRecord(op);
+        glTraceWriter.write(n);
+        glTraceWriter.write(names, sizeof(GLuint) * n);
+        glTraceWriter.endRecord();
+    }
+#endif
+}
+
+// Bytes referenced by a client-memory upload; null uploads only record the size
+static void traceBlob(GLsizeiptr size, const void* data) {
+#ifdef XWGL_GL_CAPTURE
+    uint8_t hasData = data != nullptr;
+    glTraceWriter.write(hasData);
+    if (hasData) {
+        glTraceWriter.write(data, static_cast<size_t>(size));
+    }
+#endif
+}
+
+// Shaders and programs
+
+GLuint hookCreateShader(GLenum type) {
+    GLuint shader = glCreateShader(type);
+    STATS()
+    TRACE_BEGIN(CreateShader) TRACE_ARG(type) TRACE_ARG(shader) TRACE_END()
+    return shader;
+}
+
+void hookShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) {
+    glShaderSource(shader, count, string, length);
+    STATS()
+    TRACE_BEGIN(ShaderSource)
+        std::string source;
+        for (GLsizei i = 0; i < count; ++i) {
+            if (length && length[i] >= 0) {
+                source.append(string[i], length[i]);
+            } else {
+                source.append(string[i]);
+            }
+        }
+        uint32_t sourceLength = static_cast<uint32_t>(source.size());
+        TRACE_ARG(shader) TRACE_ARG(sourceLength)
+        glTraceWriter.write(source.data(), source.size());
+    TRACE_END()
+}
+
+void hookCompileShader(GLuint shader) {
+    glCompileShader(shader);
+    STATS()
+    TRACE_BEGIN(CompileShader) TRACE_ARG(shader) TRACE_END()
+}
+
+void hookDeleteShader(GLuint shader) {
+    glDeleteShader(shader);
+    STATS()
+    TRACE_BEGIN(DeleteShader) TRACE_ARG(shader) TRACE_END()
+}
+
+GLuint hookCreateProgram(void) {
+    GLuint program = glCreateProgram();
+    STATS()
+    TRACE_BEGIN(CreateProgram) TRACE_ARG(program) TRACE_END()
+    return program;
+}
+
+void hookAttachShader(GLuint program, GLuint shader) {
+    glAttachShader(program, shader);
+    STATS()
+    TRACE_BEGIN(AttachShader) TRACE_ARG(program) TRACE_ARG(shader) TRACE_END()
+}
+
+void hookDetachShader(GLuint program, GLuint shader) {
+    glDetachShader(program, shader);
+    STATS()
+    TRACE_BEGIN(DetachShader) TRACE_ARG(program) TRACE_ARG(shader) TRACE_END()
+}
+
+void hookLinkProgram(GLuint program) {
+    glLinkProgram(program);
+    STATS()
+    TRACE_BEGIN(LinkProgram) TRACE_ARG(program) TRACE_END()
+}
+
+void hookUseProgram(GLuint program) {
+    glUseProgram(program);
+    STATS(++glStats.current.programBinds;
+          if (program == glStats.boundProgram) ++glStats.current.redundantProgramBinds;
+          glStats.boundProgram = program)
+    TRACE_BEGIN(UseProgram) TRACE_ARG(program) TRACE_END()
+}
+
+void hookDeleteProgram(GLuint program) {
+    glDeleteProgram(program);
+    STATS(if (program == glStats.boundProgram) glStats.boundProgram = 0)
+    TRACE_BEGIN(DeleteProgram) TRACE_ARG(program) TRACE_END()
+}
+
+// Buffers
+
+void hookGenBuffers(GLsizei n, GLuint* buffers) {
+    glGenBuffers(n, buffers);
+    STATS()
+    traceNames(GLTraceOp::GenBuffers, n, buffers);
+}
+
+void hookDeleteBuffers(GLsizei n, const GLuint* buffers) {
+    glDeleteBuffers(n, buffers);
+    STATS()
+    traceNames(GLTraceOp::DeleteBuffers, n, buffers);
+}
+
+void hookBindBuffer(GLenum target, GLuint buffer) {
+    glBindBuffer(target, buffer);
+    STATS(++glStats.current.bufferBinds)
+    TRACE_BEGIN(BindBuffer) TRACE_ARG(target) TRACE_ARG(buffer) TRACE_END()
+}
+
+void hookBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    glBindBufferBase(target, index, buffer);
+    STATS(++glStats.current.bufferBinds)
+    TRACE_BEGIN(BindBufferBase) TRACE_ARG(target) TRACE_ARG(index) TRACE_ARG(buffer) TRACE_END()
+}
+
+void hookBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    glBindBufferRange(target, index, buffer, offset, size);
+    STATS(++glStats.current.bufferBinds)
+    TRACE_BEGIN(BindBufferRange)
+        int64_t offset64 = offset;
+        int64_t size64 = size;
+        TRACE_ARG(target) TRACE_ARG(index) TRACE_ARG(buffer) TRACE_ARG(offset64) TRACE_ARG(size64)
+    TRACE_END()
+}
+
+void hookBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    glBufferData(target, size, data, usage);
+    STATS(if (data) { ++glStats.current.bufferUploads; glStats.current.bufferUploadBytes += size; })
+    TRACE_BEGIN(BufferData)
+        int64_t size64 = size;
+        TRACE_ARG(target) TRACE_ARG(size64) TRACE_ARG(usage)
+        traceBlob(size, data);
+    TRACE_END()
+}
+
+void hookBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    glBufferSubData(target, offset, size, data);
+    STATS(++glStats.current.bufferUploads; glStats.current.bufferUploadBytes += size)
+    TRACE_BEGIN(BufferSubData)
+        int64_t offset64 = offset;
+        int64_t size64 = size;
+        TRACE_ARG(target) TRACE_ARG(offset64) TRACE_ARG(size64)
+        traceBlob(size, data);
+    TRACE_END()
+}
+
+void hookClearBufferData(GLenum target, GLenum internalformat, GLenum format, GLenum type, const void* data) {
+    glClearBufferData(target, internalformat, format, type, data);
+    STATS()
+    TRACE_BEGIN(ClearBufferData)
+        // One element of the fill value; null clears to zero
+        uint32_t elementSize = static_cast<uint32_t>(pixelBytes(format, type, 1, 1, 1));
+        TRACE_ARG(target) TRACE_ARG(internalformat) TRACE_ARG(format) TRACE_ARG(type) TRACE_ARG(elementSize)
+        traceBlob(elementSize, data);
+    TRACE_END()
+}
+
+void hookBufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags) {
+    glBufferStorage(target, size, data, flags);
+    STATS(if (data) { ++glStats.current.bufferUploads; glStats.current.bufferUploadBytes += size; })
+    TRACE_BEGIN(BufferStorage)
+        int64_t size64 = size;
+        TRACE_ARG(target) TRACE_ARG(size64) TRACE_ARG(flags)
+        traceBlob(size, data);
+    TRACE_END()
+}
+
+void* hookMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    void* pointer = glMapBufferRange(target, offset, length, access);
+    STATS()
+    TRACE_BEGIN(MapBufferRange)
+        int64_t offset64 = offset;
+        int64_t length64 = length;
+        TRACE_ARG(target) TRACE_ARG(offset64) TRACE_ARG(length64) TRACE_ARG(access)
+    TRACE_END()
+    return pointer;
+}
+
+GLboolean hookUnmapBuffer(GLenum target) {
+    GLboolean result = glUnmapBuffer(target);
+    STATS()
+    TRACE_BEGIN(UnmapBuffer) TRACE_ARG(target) TRACE_END()
+    return result;
+}
+
+void hookMappedBufferWrite(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data) {
+#ifdef XWGL_GL_STATS
+    // Bytes only: the writes themselves were memcpys, not GL calls
+    glStats.current.bufferUploadBytes += size;
+#endif
+    TRACE_BEGIN(MappedBufferWrite)
+        int64_t offset64 = offset;
+        int64_t size64 = size;
+        TRACE_ARG(buffer) TRACE_ARG(offset64) TRACE_ARG(size64)
+        glTraceWriter.write(data, static_cast<size_t>(size));
+    TRACE_END()
+}
+
+// Vertex arrays
+
+void hookGenVertexArrays(GLsizei n, GLuint* arrays) {
+    glGenVertexArrays(n, arrays);
+    STATS()
+    traceNames(GLTraceOp::GenVertexArrays, n, arrays);
+}
+
+void hookDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
+    glDeleteVertexArrays(n, arrays);
+    STATS()
+    traceNames(GLTraceOp::DeleteVertexArrays, n, arrays);
+}
+
+void hookBindVertexArray(GLuint array) {
+    glBindVertexArray(array);
+    STATS(++glStats.current.vertexArrayBinds;
+          if (array == glStats.boundVertexArray) ++glStats.current.redundantVertexArrayBinds;
+          glStats.boundVertexArray = array)
+    TRACE_BEGIN(BindVertexArray) TRACE_ARG(array) TRACE_END()
+}
+
+void hookVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride,
+                             const void* pointer) {
+    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+    STATS()
+    TRACE_BEGIN(VertexAttribPointer)
+        // Only buffer offsets are supported; client-side arrays don't exist in core profile
+        uint64_t offset = reinterpret_cast<uintptr_t>(pointer);
+        TRACE_ARG(index) TRACE_ARG(size) TRACE_ARG(type) TRACE_ARG(normalized) TRACE_ARG(stride) TRACE_ARG(offset)
+    TRACE_END()
+}
+
+void hookEnableVertexAttribArray(GLuint index) {
+    glEnableVertexAttribArray(index);
+    STATS()
+    TRACE_BEGIN(EnableVertexAttribArray) TRACE_ARG(index) TRACE_END()
+}
+
+void hookDisableVertexAttribArray(GLuint index) {
+    glDisableVertexAttribArray(index);
+    STATS()
+    TRACE_BEGIN(DisableVertexAttribArray) TRACE_ARG(index) TRACE_END()
+}
+
+void hookVertexAttribFormat(GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset) {
+    glVertexAttribFormat(attribindex, size, type, normalized, relativeoffset);
+    STATS()
+    TRACE_BEGIN(VertexAttribFormat)
+        TRACE_ARG(attribindex) TRACE_ARG(size) TRACE_ARG(type) TRACE_ARG(normalized) TRACE_ARG(relativeoffset)
+    TRACE_END()
+}
+
+void hookVertexAttribBinding(GLuint attribindex, GLuint bindingindex) {
+    glVertexAttribBinding(attribindex, bindingindex);
+    STATS()
+    TRACE_BEGIN(VertexAttribBinding) TRACE_ARG(attribindex) TRACE_ARG(bindingindex) TRACE_END()
+}
+
+// Textures and framebuffers
+
+void hookGenTextures(GLsizei n, GLuint* textures) {
+    glGenTextures(n, textures);
+    STATS()
+    traceNames(GLTraceOp::GenTextures, n, textures);
+}
+
+void hookDeleteTextures(GLsizei n, const GLuint* textures) {
+    glDeleteTextures(n, textures);
+    STATS()
+    traceNames(GLTraceOp::DeleteTextures, n, textures);
+}
+
+void hookBindTexture(GLenum target, GLuint texture) {
+    glBindTexture(target, texture);
+    STATS(++glStats.current.textureBinds)
+    TRACE_BEGIN(BindTexture) TRACE_ARG(target) TRACE_ARG(texture) TRACE_END()
+}
+
+void hookTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height) {
+    glTexStorage2D(target, levels, internalformat, width, height);
+    STATS()
+    TRACE_BEGIN(TexStorage2D)
+        TRACE_ARG(target) TRACE_ARG(levels) TRACE_ARG(internalformat) TRACE_ARG(width) TRACE_ARG(height)
+    TRACE_END()
+}
+
+void hookTexParameteri(GLenum target, GLenum pname, GLint param) {
+    glTexParameteri(target, pname, param);
+    STATS()
+    TRACE_BEGIN(TexParameteri) TRACE_ARG(target) TRACE_ARG(pname) TRACE_ARG(param) TRACE_END()
+}
+
+void hookGenFramebuffers(GLsizei n, GLuint* framebuffers) {
+    glGenFramebuffers(n, framebuffers);
+    STATS()
+    traceNames(GLTraceOp::GenFramebuffers, n, framebuffers);
+}
+
+void hookDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
+    glDeleteFramebuffers(n, framebuffers);
+    STATS()
+    traceNames(GLTraceOp::DeleteFramebuffers, n, framebuffers);
+}
+
+void hookBindFramebuffer(GLenum target, GLuint framebuffer) {
+    glBindFramebuffer(target, framebuffer);
+    STATS(++glStats.current.framebufferBinds)
+    TRACE_BEGIN(BindFramebuffer) TRACE_ARG(target) TRACE_ARG(framebuffer) TRACE_END()
+}
+
+void hookFramebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level) {
+    glFramebufferTexture(target, attachment, texture, level);
+    STATS()
+    TRACE_BEGIN(FramebufferTexture)
+        TRACE_ARG(target) TRACE_ARG(attachment) TRACE_ARG(texture) TRACE_ARG(level)
+    TRACE_END()
+}
+
+void hookDrawBuffers(GLsizei n, const GLenum* bufs) {
+    glDrawBuffers(n, bufs);
+    STATS()
+    TRACE_BEGIN(DrawBuffers)
+        TRACE_ARG(n)
+        glTraceWriter.write(bufs, sizeof(GLenum) * n);
+    TRACE_END()
+}
+
+void hookBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1,
+                         GLint dstY1, GLbitfield mask, GLenum filter) {
+    glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+    STATS()
+    TRACE_BEGIN(BlitFramebuffer)
+        TRACE_ARG(srcX0) TRACE_ARG(srcY0) TRACE_ARG(srcX1) TRACE_ARG(srcY1)
+        TRACE_ARG(dstX0) TRACE_ARG(dstY0) TRACE_ARG(dstX1) TRACE_ARG(dstY1) TRACE_ARG(mask) TRACE_ARG(filter)
+    TRACE_END()
+}
+
+// Fixed-function state
+
+void hookEnable(GLenum cap) {
+    glEnable(cap);
+    STATS(++glStats.current.stateChanges)
+    TRACE_BEGIN(Enable) TRACE_ARG(cap) TRACE_END()
+}
+
+void hookDisable(GLenum cap) {
+    glDisable(cap);
+    STATS(++glStats.current.stateChanges)
+    TRACE_BEGIN(Disable) TRACE_ARG(cap) TRACE_END()
+}
+
+void hookDepthFunc(GLenum func) {
+    glDepthFunc(func);
+    STATS(++glStats.current.stateChanges)
+    TRACE_BEGIN(DepthFunc) TRACE_ARG(func) TRACE_END()
+}
+
+void hookBlendFunc(GLenum sfactor, GLenum dfactor) {
+    glBlendFunc(sfactor, dfactor);
+    STATS(++glStats.current.stateChanges)
+    TRACE_BEGIN(BlendFunc) TRACE_ARG(sfactor) TRACE_ARG(dfactor) TRACE_END()
+}
+
+void hookClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    glClearColor(red, green, blue, alpha);
+    STATS(++glStats.current.stateChanges)
+    TRACE_BEGIN(ClearColor) TRACE_ARG(red) TRACE_ARG(green) TRACE_ARG(blue) TRACE_ARG(alpha) TRACE_END()
+}
+
+void hookClearDepth(GLdouble depth) {
+    glClearDepth(depth);
+    STATS(++glStats.current.stateChanges)
+    TRACE_BEGIN(ClearDepth) TRACE_ARG(depth) TRACE_END()
+}
+
+void hookClear(GLbitfield mask) {
+    glClear(mask);
+    STATS()
+    TRACE_BEGIN(Clear) TRACE_ARG(mask) TRACE_END()
+}
+
+void hookViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    glViewport(x, y, width, height);
+    STATS(++glStats.current.stateChanges)
+    TRACE_BEGIN(Viewport) TRACE_ARG(x) TRACE_ARG(y) TRACE_ARG(width) TRACE_ARG(height) TRACE_END()
+}
+
+void hookScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+    glScissor(x, y, width, height);
+    STATS(++glStats.current.stateChanges)
+    TRACE_BEGIN(Scissor) TRACE_ARG(x) TRACE_ARG(y) TRACE_ARG(width) TRACE_ARG(height) TRACE_END()
+}
+
+// Draws and dispatch
+
+void hookDrawArrays(GLenum mode, GLint first, GLsizei count) {
+    glDrawArrays(mode, first, count);
+    STATS(++glStats.current.drawCalls; ++glStats.current.instances;
+          glStats.current.triangles += primitiveCount(mode, count))
+    TRACE_BEGIN(DrawArrays) TRACE_ARG(mode) TRACE_ARG(first) TRACE_ARG(count) TRACE_END()
+}
+
+void hookDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    glDrawElements(mode, count, type, indices);
+    STATS(++glStats.current.drawCalls; ++glStats.current.instances;
+          glStats.current.triangles += primitiveCount(mode, count))
+    TRACE_BEGIN(DrawElements)
+        uint64_t offset = reinterpret_cast<uintptr_t>(indices);
+        TRACE_ARG(mode) TRACE_ARG(count) TRACE_ARG(type) TRACE_ARG(offset)
+    TRACE_END()
+}
+
+void hookDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount) {
+    glDrawArraysInstanced(mode, first, count, instancecount);
+    STATS(++glStats.current.drawCalls; glStats.current.instances += instancecount;
+          glStats.current.triangles += primitiveCount(mode, count) * instancecount)
+    TRACE_BEGIN(DrawArraysInstanced)
+        TRACE_ARG(mode) TRACE_ARG(first) TRACE_ARG(count) TRACE_ARG(instancecount)
+    TRACE_END()
+}
+
+void hookDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount) {
+    glDrawElementsInstanced(mode, count, type, indices, instancecount);
+    STATS(++glStats.current.drawCalls; glStats.current.instances += instancecount;
+          glStats.current.triangles += primitiveCount(mode, count) * instancecount)
+    TRACE_BEGIN(DrawElementsInstanced)
+        uint64_t offset = reinterpret_cast<uintptr_t>(indices);
+        TRACE_ARG(mode) TRACE_ARG(count) TRACE_ARG(type) TRACE_ARG(offset) TRACE_ARG(instancecount)
+    TRACE_END()
+}
+
+void hookDispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z) {
+    glDispatchCompute(num_groups_x, num_groups_y, num_groups_z);
+    STATS(++glStats.current.dispatches)
+    TRACE_BEGIN(DispatchCompute) TRACE_ARG(num_groups_x) TRACE_ARG(num_groups_y) TRACE_ARG(num_groups_z) TRACE_END()
+}
+
+void hookMemoryBarrier(GLbitfield barriers) {
+    glMemoryBarrier(barriers);
+    STATS(++glStats.current.barriers)
+    TRACE_BEGIN(MemoryBarrier) TRACE_ARG(barriers) TRACE_END()
+}
+
+// Uniforms. Locations are recorded as the application used them: engine
+// uniforms all have an explicit layout(location), so they survive the relink
+// in the replay.
+
+void hookUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    glUniformMatrix4fv(location, count, transpose, value);
+    STATS(++glStats.current.uniformUpdates)
+    TRACE_BEGIN(UniformMatrix4fv)
+        TRACE_ARG(location) TRACE_ARG(count) TRACE_ARG(transpose)
+        glTraceWriter.write(value, sizeof(GLfloat) * 16 * count);
+    TRACE_END()
+}
+
+void hookUniform4fv(GLint location, GLsizei count, const GLfloat* value) {
+    glUniform4fv(location, count, value);
+    STATS(++glStats.current.uniformUpdates)
+    TRACE_BEGIN(Uniform4fv)
+        TRACE_ARG(location) TRACE_ARG(count)
+        glTraceWriter.write(value, sizeof(GLfloat) * 4 * count);
+    TRACE_END()
+}
+
+void hookUniform1i(GLint location, GLint v0) {
+    glUniform1i(location, v0);
+    STATS(++glStats.current.uniformUpdates)
+    TRACE_BEGIN(Uniform1i) TRACE_ARG(location) TRACE_ARG(v0) TRACE_END()
+}
+
+void hookUniform1ui(GLint location, GLuint v0) {
+    glUniform1ui(location, v0);
+    STATS(++glStats.current.uniformUpdates)
+    TRACE_BEGIN(Uniform1ui) TRACE_ARG(location) TRACE_ARG(v0) TRACE_END()
+}
+
+// Texture uploads, image units and vertex buffer bindings
+
+void hookPixelStorei(GLenum pname, GLint param) {
+    glPixelStorei(pname, param);
+    STATS(++glStats.current.stateChanges)
+    if (pname == GL_UNPACK_ALIGNMENT) {
+        unpackAlignment = param;
+    }
+    TRACE_BEGIN(PixelStorei) TRACE_ARG(pname) TRACE_ARG(param) TRACE_END()
+}
+
+void hookTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+                       GLenum format, GLenum type, const void* pixels) {
+    glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+    STATS(++glStats.current.textureUploads;
+          glStats.current.textureUploadBytes += pixelBytes(format, type, width, height, 1))
+    TRACE_BEGIN(TexSubImage2D)
+        // Client memory only: the engine never uploads from a pixel unpack buffer
+        TRACE_ARG(target) TRACE_ARG(level) TRACE_ARG(xoffset) TRACE_ARG(yoffset) TRACE_ARG(width) TRACE_ARG(height)
+        TRACE_ARG(format) TRACE_ARG(type)
+        traceBlob(static_cast<GLsizeiptr>(pixelBytes(format, type, width, height, unpackAlignment)), pixels);
+    TRACE_END()
+}
+
+void hookActiveTexture(GLenum texture) {
+    glActiveTexture(texture);
+    STATS(++glStats.current.stateChanges)
+    TRACE_BEGIN(ActiveTexture) TRACE_ARG(texture) TRACE_END()
+}
+
+void hookBindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access,
+                          GLenum format) {
+    glBindImageTexture(unit, texture, level, layered, layer, access, format);
+    STATS(++glStats.current.textureBinds)
+    TRACE_BEGIN(BindImageTexture)
+        TRACE_ARG(unit) TRACE_ARG(texture) TRACE_ARG(level) TRACE_ARG(layered) TRACE_ARG(layer) TRACE_ARG(access)
+        TRACE_ARG(format)
+    TRACE_END()
+}
+
+void hookBindVertexBuffer(GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride) {
+    glBindVertexBuffer(bindingindex, buffer, offset, stride);
+    STATS(++glStats.current.bufferBinds)
+    TRACE_BEGIN(BindVertexBuffer)
+        int64_t offset64 = offset;
+        TRACE_ARG(bindingindex) TRACE_ARG(buffer) TRACE_ARG(offset64) TRACE_ARG(stride)
+    TRACE_END()
+}
+
+// Indirect draws and dispatch; the commands live in buffers the trace already has
+
+void hookMultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride) {
+    glMultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+    STATS(++glStats.current.drawCalls; ++glStats.current.indirectDraws)
+    TRACE_BEGIN(MultiDrawElementsIndirect)
+        uint64_t offset = reinterpret_cast<uintptr_t>(indirect);
+        TRACE_ARG(mode) TRACE_ARG(type) TRACE_ARG(offset) TRACE_ARG(drawcount) TRACE_ARG(stride)
+    TRACE_END()
+}
+
+// The ARB and core (4.6) entry points share one record; the replay picks
+// whichever the replaying context has
+static void traceMultiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount,
+                                                GLsizei maxdrawcount, GLsizei stride) {
+    TRACE_BEGIN(MultiDrawElementsIndirectCount)
+        uint64_t offset = reinterpret_cast<uintptr_t>(indirect);
+        int64_t drawCountOffset = drawcount;
+        TRACE_ARG(mode) TRACE_ARG(type) TRACE_ARG(offset) TRACE_ARG(drawCountOffset) TRACE_ARG(maxdrawcount)
+        TRACE_ARG(stride)
+    TRACE_END()
+}
+
+void hookMultiDrawElementsIndirectCountARB(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount,
+                                           GLsizei maxdrawcount, GLsizei stride) {
+    glMultiDrawElementsIndirectCountARB(mode, type, indirect, drawcount, maxdrawcount, stride);
+    STATS(++glStats.current.drawCalls; ++glStats.current.indirectDraws)
+    traceMultiDrawElementsIndirectCount(mode, type, indirect, drawcount, maxdrawcount, stride);
+}
+
+void hookMultiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount,
+                                        GLsizei maxdrawcount, GLsizei stride) {
+    glMultiDrawElementsIndirectCount(mode, type, indirect, drawcount, maxdrawcount, stride);
+    STATS(++glStats.current.drawCalls; ++glStats.current.indirectDraws)
+    traceMultiDrawElementsIndirectCount(mode, type, indirect, drawcount, maxdrawcount, stride);
+}
+
+void hookDispatchComputeIndirect(GLintptr indirect) {
+    glDispatchComputeIndirect(indirect);
+    STATS(++glStats.current.dispatches)
+    TRACE_BEGIN(DispatchComputeIndirect)
+        int64_t offset = indirect;
+        TRACE_ARG(offset)
+    TRACE_END()
+}
+
+#endif // XWGL_GL_HOOKS
@@ -0,0 +1,246 @@
+#ifndef GL_HOOKS_H
+#define GL_HOOKS_H
+
+#include <GL/glew.h>
+
+// Build-time GL interception layer. When a hook consumer is enabled
+// (XWGL_GL_CAPTURE, XWGL_GL_STATS), every engine translation unit that includes this header
+// after its GL headers has the GL entry points below redirected to hook*
+// functions that forward to the driver and report the call. When no consumer
+// is enabled the header does nothing and engine code calls GL directly.
+//
+// Only GLHooks.cpp defines GL_HOOKS_IMPLEMENTATION so it can reach the real
+// entry points.
+
+#if defined(XWGL_GL_CAPTURE) || defined(XWGL_GL_STATS)
+#define XWGL_GL_HOOKS 1
+#endif
+
+#ifdef XWGL_GL_HOOKS
+
+// Reads the consumers' runtime settings (XWGL_CAPTURE=<file>, XWGL_CAPTURE_FRAMES=<n>,
+// XWGL_GL_STATS_FILE=<file>, ...); call before the first GL call that should be seen
+void hookInitialize();
+// Marks the end of a frame for the hook consumers (call right before the swap)
+void hookEndFrame();
+void hookShutdown();
+
+GLuint hookCreateShader(GLenum type);
+void hookShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+void hookCompileShader(GLuint shader);
+void hookDeleteShader(GLuint shader);
+GLuint hookCreateProgram(void);
+void hookAttachShader(GLuint program, GLuint shader);
+void hookDetachShader(GLuint program, GLuint shader);
+void hookLinkProgram(GLuint program);
+void hookUseProgram(GLuint program);
+void hookDeleteProgram(GLuint program);
+void hookGenBuffers(GLsizei n, GLuint* buffers);
+void hookDeleteBuffers(GLsizei n, const GLuint* buffers);
+void hookBindBuffer(GLenum target, GLuint buffer);
+void hookBindBufferBase(GLenum target, GLuint index, GLuint buffer);
+void hookBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+void hookBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+void hookBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+void hookClearBufferData(GLenum target, GLenum internalformat, GLenum format, GLenum type, const void* data);
+void hookBufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+void* hookMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+GLboolean hookUnmapBuffer(GLenum target);
+// Not a GL entry point: owners of persistently mapped buffers report the bytes
+// they wrote this frame before hookEndFrame(), since those writes bypass GL
+void hookMappedBufferWrite(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+void hookGenVertexArrays(GLsizei n, GLuint* arrays);
+void hookDeleteVertexArrays(GLsizei n, const GLuint* arrays);
+void hookBindVertexArray(GLuint array);
+void hookVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+void hookEnableVertexAttribArray(GLuint index);
+void hookDisableVertexAttribArray(GLuint index);
+void hookVertexAttribFormat(GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+void hookVertexAttribBinding(GLuint attribindex, GLuint bindingindex);
+void hookGenTextures(GLsizei n, GLuint* textures);
+void hookDeleteTextures(GLsizei n, const GLuint* textures);
+void hookBindTexture(GLenum target, GLuint texture);
+void hookTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+void hookTexParameteri(GLenum target, GLenum pname, GLint param);
+void hookGenFramebuffers(GLsizei n, GLuint* framebuffers);
+void hookDeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+void hookBindFramebuffer(GLenum target, GLuint framebuffer);
+void hookFramebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level);
+void hookDrawBuffers(GLsizei n, const GLenum* bufs);
+void hookBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1,
+                         GLint dstY1, GLbitfield mask, GLenum filter);
+void hookEnable(GLenum cap);
+void hookDisable(GLenum cap);
+void hookDepthFunc(GLenum func);
+void hookBlendFunc(GLenum sfactor, GLenum dfactor);
+void hookClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void hookClearDepth(GLdouble depth);
+void hookClear(GLbitfield mask);
+void hookViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+void hookScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+void hookDrawArrays(GLenum mode, GLint first, GLsizei count);
+void hookDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+void hookDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+void hookDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount);
+void hookDispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+void hookMemoryBarrier(GLbitfield barriers);
+void hookUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void hookUniform4fv(GLint location, GLsizei count, const GLfloat* value);
+void hookUniform1i(GLint location, GLint v0);
+void hookUniform1ui(GLint location, GLuint v0);
+void hookPixelStorei(GLenum pname, GLint param);
+void hookTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+                       GLenum format, GLenum type, const void* pixels);
+void hookBindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access,
+                          GLenum format);
+void hookActiveTexture(GLenum texture);
+void hookBindVertexBuffer(GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+void hookMultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+void hookMultiDrawElementsIndirectCountARB(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount,
+                                           GLsizei maxdrawcount, GLsizei stride);
+void hookMultiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount,
+                                        GLsizei maxdrawcount, GLsizei stride);
+void hookDispatchComputeIndirect(GLintptr indirect);
+
+#ifndef GL_HOOKS_IMPLEMENTATION
+#undef glCreateShader
+#define glCreateShader hookCreateShader
+#undef glShaderSource
+#define glShaderSource hookShaderSource
+#undef glCompileShader
+#define glCompileShader hookCompileShader
+#undef glDeleteShader
+#define glDeleteShader hookDeleteShader
+#undef glCreateProgram
+#define glCreateProgram hookCreateProgram
+#undef glAttachShader
+#define glAttachShader hookAttachShader
+#undef glDetachShader
+#define glDetachShader hookDetachShader
+#undef glLinkProgram
+#define glLinkProgram hookLinkProgram
+#undef glUseProgram
+#define glUseProgram hookUseProgram
+#undef glDeleteProgram
+#define glDeleteProgram hookDeleteProgram
+#undef glGenBuffers
+#define glGenBuffers hookGenBuffers
+#undef glDeleteBuffers
+#define glDeleteBuffers hookDeleteBuffers
+#undef glBindBuffer
+#define glBindBuffer hookBindBuffer
+#undef glBindBufferBase
+#define glBindBufferBase hookBindBufferBase
+#undef glBindBufferRange
+#define glBindBufferRange hookBindBufferRange
+#undef glBufferData
+#define glBufferData hookBufferData
+#undef glBufferSubData
+#define glBufferSubData hookBufferSubData
+#undef glClearBufferData
+#define glClearBufferData hookClearBufferData
+#undef glBufferStorage
+#define glBufferStorage hookBufferStorage
+#undef glMapBufferRange
+#define glMapBufferRange hookMapBufferRange
+#undef glUnmapBuffer
+#define glUnmapBuffer hookUnmapBuffer
+#undef glGenVertexArrays
+#define glGenVertexArrays hookGenVertexArrays
+#undef glDeleteVertexArrays
+#define glDeleteVertexArrays hookDeleteVertexArrays
+#undef glBindVertexArray
+#define glBindVertexArray hookBindVertexArray
+#undef glVertexAttribPointer
+#define glVertexAttribPointer hookVertexAttribPointer
+#undef glEnableVertexAttribArray
+#define glEnableVertexAttribArray hookEnableVertexAttribArray
+#undef glDisableVertexAttribArray
+#define glDisableVertexAttribArray hookDisableVertexAttribArray
+#undef glVertexAttribFormat
+#define glVertexAttribFormat hookVertexAttribFormat
+#undef glVertexAttribBinding
+#define glVertexAttribBinding hookVertexAttribBinding
+#undef glGenTextures
+#define glGenTextures hookGenTextures
+#undef glDeleteTextures
+#define glDeleteTextures hookDeleteTextures
+#undef glBindTexture
+#define glBindTexture hookBindTexture
+#undef glTexStorage2D
+#define glTexStorage2D hookTexStorage2D
+#undef glTexParameteri
+#define glTexParameteri hookTexParameteri
+#undef glGenFramebuffers
+#define glGenFramebuffers hookGenFramebuffers
+#undef glDeleteFramebuffers
+#define glDeleteFramebuffers hookDeleteFramebuffers
+#undef glBindFramebuffer
+#define glBindFramebuffer hookBindFramebuffer
+#undef glFramebufferTexture
+#define glFramebufferTexture hookFramebufferTexture
+#undef glDrawBuffers
+#define glDrawBuffers hookDrawBuffers
+#undef glBlitFramebuffer
+#define glBlitFramebuffer hookBlitFramebuffer
+#undef glEnable
+#define glEnable hookEnable
+#undef glDisable
+#define glDisable hookDisable
+#undef glDepthFunc
+#define glDepthFunc hookDepthFunc
+#undef glBlendFunc
+#define glBlendFunc hookBlendFunc
+#undef glClearColor
+#define glClearColor hookClearColor
+#undef glClearDepth
+#define glClearDepth hookClearDepth
+#undef glClear
+#define glClear hookClear
+#undef glViewport
+#define glViewport hookViewport
+#undef glScissor
+#define glScissor hookScissor
+#undef glDrawArrays
+#define glDrawArrays hookDrawArrays
+#undef glDrawElements
+#define glDrawElements hookDrawElements
+#undef glDrawArraysInstanced
+#define glDrawArraysInstanced hookDrawArraysInstanced
+#undef glDrawElementsInstanced
+#define glDrawElementsInstanced hookDrawElementsInstanced
+#undef glDispatchCompute
+#define glDispatchCompute hookDispatchCompute
+#undef glMemoryBarrier
+#define glMemoryBarrier hookMemoryBarrier
+#undef glBindVertexBuffer
+#define glBindVertexBuffer hookBindVertexBuffer
+#undef glTexSubImage2D
+#define glTexSubImage2D hookTexSubImage2D
+#undef glBindImageTexture
+#define glBindImageTexture hookBindImageTexture
+#undef glActiveTexture
+#define glActiveTexture hookActiveTexture
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv hookUniformMatrix4fv
+#undef glUniform4fv
+#define glUniform4fv hookUniform4fv
+#undef glUniform1i
+#define glUniform1i hookUniform1i
+#undef glUniform1ui
+#define glUniform1ui hookUniform1ui
+#undef glMultiDrawElementsIndirect
+#define glMultiDrawElementsIndirect hookMultiDrawElementsIndirect
+#undef glMultiDrawElementsIndirectCountARB
+#define glMultiDrawElementsIndirectCountARB hookMultiDrawElementsIndirectCountARB
+#undef glMultiDrawElementsIndirectCount
+#define glMultiDrawElementsIndirectCount hookMultiDrawElementsIndirectCount
+#undef glDispatchComputeIndirect
+#define glDispatchComputeIndirect hookDispatchComputeIndirect
+#undef glPixelStorei
+#define glPixelStorei hookPixelStorei
+#endif // GL_HOOKS_IMPLEMENTATION
+
+#endif // XWGL_GL_HOOKS
+
+#endif // GL_HOOKS_H
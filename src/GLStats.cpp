@@ -0,0 +1,113 @@
+#include "GLStats.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// Definition of the global GL statistics instance
+GLStats glStats;
+
+namespace {
+
+// Applies op to every counter so sums, maxima and the JSON writer stay in
+// sync with the struct
+#define GL_FRAME_STATS_FIELDS(op) \
+    op(calls) op(drawCalls) op(triangles) op(instances) op(indirectDraws) op(dispatches) op(programBinds) \
+    op(redundantProgramBinds) op(vertexArrayBinds) op(redundantVertexArrayBinds) op(bufferBinds) \
+    op(textureBinds) op(framebufferBinds) op(uniformUpdates) op(stateChanges) op(barriers) op(bufferUploads) \
+    op(bufferUploadBytes) op(textureUploads) op(textureUploadBytes)
+
+void accumulate(GLFrameStats& sum, const GLFrameStats& frame) {
+#define GL_STATS_ADD(field) sum.field += frame.field;
+    GL_FRAME_STATS_FIELDS(GL_STATS_ADD)
+#undef GL_STATS_ADD
+}
+
+void keepMaximum(GLFrameStats& peak, const GLFrameStats& frame) {
+#define GL_STATS_MAX(field) peak.field = std::max(peak.field, frame.field);
+    GL_FRAME_STATS_FIELDS(GL_STATS_MAX)
+#undef GL_STATS_MAX
+}
+
+}
+
+GLStats::GLStats() : boundProgram(0), boundVertexArray(0), numFrames(0), logInterval(600), file(nullptr) {
+    memset(&current, 0, sizeof(current));
+    memset(&lastFrame, 0, sizeof(lastFrame));
+    memset(&intervalTotal, 0, sizeof(intervalTotal));
+    memset(&total, 0, sizeof(total));
+    memset(&peak, 0, sizeof(peak));
+}
+
+GLStats::~GLStats() {
+    if (file) {
+        fclose(file);
+    }
+}
+
+void GLStats::initialize() {
+    const char* interval = getenv("XWGL_GL_STATS_INTERVAL");
+    if (interval != nullptr) {
+        logInterval = static_cast<unsigned long>(std::max(0, atoi(interval)));
+    }
+
+    const char* path = getenv("XWGL_GL_STATS_FILE");
+    if (path != nullptr) {
+        file = fopen(path, "w");
+        if (!file) {
+            logger.Error("GLStats: cannot open %s", path);
+        }
+    }
+}
+
+void GLStats::endFrame() {
+    if (file) {
+        fprintf(file, "{\"frame\":%lu", numFrames);
+#define GL_STATS_JSON(field) fprintf(file, ",\"" #field "\":%llu", static_cast<unsigned long long>(current.field));
+        GL_FRAME_STATS_FIELDS(GL_STATS_JSON)
+#undef GL_STATS_JSON
+        fputs("}\n", file);
+    }
+
+    accumulate(intervalTotal, current);
+    accumulate(total, current);
+    keepMaximum(peak, current);
+    lastFrame = current;
+    memset(&current, 0, sizeof(current));
+    ++numFrames;
+
+    if (logInterval > 0 && numFrames % logInterval == 0) {
+        logAverages("GL per frame", intervalTotal, logInterval);
+        memset(&intervalTotal, 0, sizeof(intervalTotal));
+    }
+}
+
+void GLStats::shutdown() {
+    if (numFrames > 0) {
+        logAverages("GL per frame over the run", total, numFrames);
+        logger.Info("GL peak frame: %u calls, %u draws, %llu triangles, %u program binds, %llu upload bytes",
+                    peak.calls, peak.drawCalls, static_cast<unsigned long long>(peak.triangles), peak.programBinds,
+                    static_cast<unsigned long long>(peak.bufferUploadBytes + peak.textureUploadBytes));
+    }
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+void GLStats::logAverages(const char* label, const GLFrameStats& sum, unsigned long frames) const {
+    const double n = static_cast<double>(frames);
+    logger.Info("%s (%lu frames): %.1f calls, %.1f draws (%.1f indirect), %.0f triangles, %.1f dispatches",
+                label, frames, sum.calls / n, sum.drawCalls / n, sum.indirectDraws / n, sum.triangles / n,
+                sum.dispatches / n);
+    logger.Info("  binds: %.1f program (%.1f redundant), %.1f VAO (%.1f redundant), %.1f buffer, %.1f texture, "
+                "%.1f framebuffer",
+                sum.programBinds / n, sum.redundantProgramBinds / n, sum.vertexArrayBinds / n,
+                sum.redundantVertexArrayBinds / n, sum.bufferBinds / n, sum.textureBinds / n,
+                sum.framebufferBinds / n);
+    logger.Info("  %.1f uniform updates, %.1f state changes, %.1f barriers, uploads %.1f buffer (%.0f bytes), "
+                "%.1f texture (%.0f bytes)",
+                sum.uniformUpdates / n, sum.stateChanges / n, sum.barriers / n, sum.bufferUploads / n,
+                sum.bufferUploadBytes / n, sum.textureUploads / n, sum.textureUploadBytes / n);
+}
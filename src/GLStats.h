@@ -0,0 +1,77 @@
+#ifndef GL_STATS_H
+#define GL_STATS_H
+
+#include <cstdio>
+#include <stdint.h>
+
+// Per-frame GL submission counters, fed by the GL hooks when the build
+// enables XWGL_GL_STATS (CMake option of the same name). Without it nothing
+// calls into this and the engine's GL calls are not wrapped at all.
+//
+// Uploads count bytes passed through glBufferData/glBufferSubData/
+// glTexSubImage2D. Writes into persistently mapped memory (GpuRingBuffer) are
+// plain memcpys, not GL calls: their owner reports each frame's bytes
+// (hookMappedBufferWrite), which go into bufferUploadBytes but not into
+// bufferUploads or calls.
+struct GLFrameStats {
+    uint32_t calls;               // every hooked GL call
+    uint32_t drawCalls;           // glDraw*/glMultiDraw* (a multi-draw counts once)
+    uint64_t triangles;           // from direct draws; indirect draw counts live on the GPU
+    uint64_t instances;
+    uint32_t indirectDraws;       // glMultiDraw*Indirect* submissions
+    uint32_t dispatches;
+    uint32_t programBinds;        // glUseProgram
+    uint32_t redundantProgramBinds;
+    uint32_t vertexArrayBinds;
+    uint32_t redundantVertexArrayBinds;
+    uint32_t bufferBinds;         // glBindBuffer/Base/Range/glBindVertexBuffer
+    uint32_t textureBinds;        // glBindTexture/glBindImageTexture
+    uint32_t framebufferBinds;
+    uint32_t uniformUpdates;      // glUniform*
+    uint32_t stateChanges;        // enable/disable, depth/blend func, viewport, scissor, clear color, active texture
+    uint32_t barriers;
+    uint32_t bufferUploads;
+    uint64_t bufferUploadBytes;
+    uint32_t textureUploads;
+    uint64_t textureUploadBytes;
+};
+
+// Collects GLFrameStats for the frame in progress; endFrame() (from
+// hookEndFrame) closes the frame. Runtime settings:
+//   XWGL_GL_STATS_FILE=<path>     one JSON object per frame (JSON Lines), for CI
+//   XWGL_GL_STATS_INTERVAL=<n>    log averages every n frames (default 600, 0 = off)
+// A summary with per-frame averages and maxima is logged at shutdown.
+class GLStats {
+public:
+    GLStats();
+    ~GLStats();
+
+    void initialize();
+    void endFrame();
+    void shutdown();
+
+    // Counters of the frame in progress, written by the hooks
+    GLFrameStats current;
+    // Last bound objects, to flag redundant binds
+    uint32_t boundProgram;
+    uint32_t boundVertexArray;
+
+    const GLFrameStats& getLastFrame() const { return lastFrame; }
+    unsigned long getNumFrames() const { return numFrames; }
+
+private:
+    GLFrameStats lastFrame;
+    GLFrameStats intervalTotal;
+    GLFrameStats total;
+    GLFrameStats peak;
+    unsigned long numFrames;
+    unsigned long logInterval;
+    FILE* file;
+
+    void logAverages(const char* label, const GLFrameStats& sum, unsigned long frames) const;
+};
+
+// Global instance of GLStats
+extern GLStats glStats;
+
+#endif // GL_STATS_H
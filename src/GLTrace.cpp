@@ -0,0 +1,91 @@
+#include "GLTrace.h"
+#include "Logger.h"
+
+#include <cstring>
+
+// Definition of the global trace writer instance
+GLTraceWriter glTraceWriter;
+
+GLTraceWriter::GLTraceWriter()
+    : file(nullptr), recordOp(GLTraceOp::FrameEnd), framesWritten(0), maxFrames(0), bytesWritten(0) {
+}
+
+GLTraceWriter::~GLTraceWriter() {
+    close();
+}
+
+bool GLTraceWriter::open(const char* filePath, int maxFrames) {
+    close();
+
+    file = fopen(filePath, "wb");
+    if (!file) {
+        logger.Error("GLTrace: failed to open %s for writing", filePath);
+        return false;
+    }
+    setvbuf(file, nullptr, _IOFBF, 1 << 20);
+
+    GLTraceHeader header;
+    memcpy(header.magic, GLTraceMagic, sizeof(header.magic));
+    header.version = GLTraceVersion;
+    fwrite(&header, sizeof(header), 1, file);
+
+    this->maxFrames = maxFrames;
+    framesWritten = 0;
+    bytesWritten = sizeof(header);
+    record.reserve(4096);
+
+    if (maxFrames > 0) {
+        logger.Info("GLTrace: capturing %d frames to %s", maxFrames, filePath);
+    } else {
+        logger.Info("GLTrace: capturing until exit to %s", filePath);
+    }
+    return true;
+}
+
+void GLTraceWriter::close() {
+    if (!file) {
+        return;
+    }
+    fclose(file);
+    file = nullptr;
+    logger.Info("GLTrace: wrote %d frames, %zu bytes", framesWritten, bytesWritten);
+}
+
+void GLTraceWriter::beginRecord(GLTraceOp op) {
+    recordOp = op;
+    record.clear();
+}
+
+void GLTraceWriter::write(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    record.insert(record.end(), bytes, bytes + size);
+}
+
+void GLTraceWriter::endRecord() {
+    if (!file) {
+        return;
+    }
+
+    uint16_t op = static_cast<uint16_t>(recordOp);
+    uint32_t payloadSize = static_cast<uint32_t>(record.size());
+    fwrite(&op, sizeof(op), 1, file);
+    fwrite(&payloadSize, sizeof(payloadSize), 1, file);
+    if (payloadSize > 0) {
+        fwrite(record.data(), 1, payloadSize, file);
+    }
+    bytesWritten += sizeof(op) + sizeof(payloadSize) + payloadSize;
+}
+
+void GLTraceWriter::endFrame() {
+    if (!file) {
+        return;
+    }
+
+    beginRecord(GLTraceOp::FrameEnd);
+    endRecord();
+
+    ++framesWritten;
+    if (maxFrames > 0 && framesWritten >= maxFrames) {
+        close();
+    }
+}
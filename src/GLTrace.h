@@ -0,0 +1,148 @@
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdio>
+#include <stdint.h>
+#include <vector>
+
+// Binary GL command trace written by the capture hooks (GLHooks.h) and
+// re-executed by the replay tool.
+//
+// Layout: GLTraceHeader, then records of
+//   uint16_t op, uint32_t payloadSize, payload[payloadSize]
+// Payloads are the call arguments in declaration order, native endianness.
+// Object names are the ones the application saw; the replayer remaps them.
+// Buffer uploads and shader sources are stored inline. Writes through
+// persistently mapped buffers don't pass through GL, so their owner reports
+// them once per frame (MappedBufferWrite) and the replayer uploads them before
+// the frame's other records, or right after the buffer's creation and storage
+// when those are recorded in the same frame.
+
+const char GLTraceMagic[4] = {'X', 'W', 'G', 'T'};
+const uint32_t GLTraceVersion = 4;
+
+struct GLTraceHeader {
+    char magic[4];
+    uint32_t version;
+};
+
+enum class GLTraceOp : uint16_t {
+    FrameEnd = 0,
+
+    // Shaders and programs
+    CreateShader,
+    ShaderSource,
+    CompileShader,
+    DeleteShader,
+    CreateProgram,
+    AttachShader,
+    DetachShader,
+    LinkProgram,
+    UseProgram,
+    DeleteProgram,
+    Uniform1i,
+    Uniform1ui,
+    Uniform4fv,
+    UniformMatrix4fv,
+
+    // Buffers
+    GenBuffers,
+    DeleteBuffers,
+    BindBuffer,
+    BindBufferBase,
+    BindBufferRange,
+    BufferData,
+    BufferSubData,
+    ClearBufferData,
+    BufferStorage,
+    MapBufferRange,
+    UnmapBuffer,
+    MappedBufferWrite,
+
+    // Vertex arrays
+    GenVertexArrays,
+    DeleteVertexArrays,
+    BindVertexArray,
+    VertexAttribPointer,
+    EnableVertexAttribArray,
+    DisableVertexAttribArray,
+    VertexAttribFormat,
+    VertexAttribBinding,
+    BindVertexBuffer,
+
+    // Textures and framebuffers
+    GenTextures,
+    DeleteTextures,
+    BindTexture,
+    TexStorage2D,
+    TexParameteri,
+    PixelStorei,
+    TexSubImage2D,
+    ActiveTexture,
+    BindImageTexture,
+    GenFramebuffers,
+    DeleteFramebuffers,
+    BindFramebuffer,
+    FramebufferTexture,
+    DrawBuffers,
+    BlitFramebuffer,
+
+    // Fixed-function state
+    Enable,
+    Disable,
+    DepthFunc,
+    BlendFunc,
+    ClearColor,
+    ClearDepth,
+    Clear,
+    Viewport,
+    Scissor,
+
+    // Draws and dispatch
+    DrawArrays,
+    DrawElements,
+    DrawArraysInstanced,
+    DrawElementsInstanced,
+    MultiDrawElementsIndirect,
+    MultiDrawElementsIndirectCount,
+    DispatchCompute,
+    DispatchComputeIndirect,
+    MemoryBarrier,
+
+    NumOps
+};
+
+// Serializes records into a buffered file. Not thread-safe: GL calls happen on
+// the thread owning the context.
+class GLTraceWriter {
+public:
+    GLTraceWriter();
+    ~GLTraceWriter();
+
+    bool open(const char* filePath, int maxFrames);
+    void close();
+    bool isActive() const { return file != nullptr; }
+
+    void beginRecord(GLTraceOp op);
+    void write(const void* data, size_t size);
+    template <typename T>
+    void write(const T& value) { write(&value, sizeof(T)); }
+    void endRecord();
+
+    void endFrame();
+
+private:
+    FILE* file;
+    std::vector<unsigned char> record;
+    GLTraceOp recordOp;
+    int framesWritten;
+    int maxFrames;
+    size_t bytesWritten;
+};
+
+// Global instance of GLTraceWriter
+extern GLTraceWriter glTraceWriter;
+
+#endif // GL_TRACE_H
@@ -0,0 +1,739 @@
+#include "GLTraceReplay.h"
+#include "Logger.h"
+
+#include <cstring>
+
+namespace {
+
+// Sequential reader over a record payload
+class PayloadReader {
+public:
+    PayloadReader(const unsigned char* payload, uint32_t size) : cursor(payload), end(payload + size), failed(false) {
+    }
+
+    template <typename T>
+    T read() {
+        T value;
+        memset(&value, 0, sizeof(value));
+        if (cursor + sizeof(T) > end) {
+            failed = true;
+            return value;
+        }
+        memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return value;
+    }
+
+    const unsigned char* readBytes(size_t size) {
+        if (cursor + size > end) {
+            failed = true;
+            return nullptr;
+        }
+        const unsigned char* bytes = cursor;
+        cursor += size;
+        return bytes;
+    }
+
+    // Blob written by traceBlob(): flag followed by the bytes
+    const void* readBlob(size_t size) {
+        uint8_t hasData = read<uint8_t>();
+        return hasData ? readBytes(size) : nullptr;
+    }
+
+    size_t remaining() const { return static_cast<size_t>(end - cursor); }
+
+    bool ok() const { return !failed; }
+
+private:
+    const unsigned char* cursor;
+    const unsigned char* end;
+    bool failed;
+};
+
+} // namespace
+
+GLTraceReplayer::GLTraceReplayer() {
+}
+
+GLTraceReplayer::~GLTraceReplayer() {
+}
+
+bool GLTraceReplayer::load(const char* filePath) {
+    FILE* file = fopen(filePath, "rb");
+    if (!file) {
+        logger.Error("GLTraceReplay: failed to open %s", filePath);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    rewind(file);
+
+    data.resize(fileSize > 0 ? fileSize : 0);
+    size_t bytesRead = fread(data.data(), 1, data.size(), file);
+    fclose(file);
+
+    GLTraceHeader header;
+    if (bytesRead != data.size() || bytesRead < sizeof(header)) {
+        logger.Error("GLTraceReplay: short read on %s", filePath);
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (memcmp(header.magic, GLTraceMagic, sizeof(header.magic)) != 0 || header.version != GLTraceVersion) {
+        logger.Error("GLTraceReplay: %s is not a version %u trace", filePath, GLTraceVersion);
+        return false;
+    }
+
+    // Index frame starts; a trailing partial frame is dropped
+    frameOffsets.clear();
+    size_t offset = sizeof(header);
+    size_t frameStart = offset;
+    const size_t recordHeaderSize = sizeof(uint16_t) + sizeof(uint32_t);
+    while (offset + recordHeaderSize <= data.size()) {
+        uint16_t op;
+        uint32_t payloadSize;
+        memcpy(&op, &data[offset], sizeof(op));
+        memcpy(&payloadSize, &data[offset + sizeof(op)], sizeof(payloadSize));
+        offset += recordHeaderSize + payloadSize;
+
+        if (static_cast<GLTraceOp>(op) == GLTraceOp::FrameEnd && offset <= data.size()) {
+            frameOffsets.push_back(frameStart);
+            frameStart = offset;
+        }
+    }
+
+    logger.Info("GLTraceReplay: loaded %s (%zu bytes, %zu frames)", filePath, data.size(), frameOffsets.size());
+    return !frameOffsets.empty();
+}
+
+GLuint GLTraceReplayer::mapName(ObjectKind kind, GLuint captured) const {
+    if (captured == 0) {
+        return 0;
+    }
+    std::map<GLuint, GLuint>::const_iterator it = names[kind].find(captured);
+    return it == names[kind].end() ? 0 : it->second;
+}
+
+void GLTraceReplayer::getRecordOffsets(int frame, std::vector<size_t>& offsets) const {
+    offsets.clear();
+    size_t offset = frameOffsets[frame];
+    for (;;) {
+        uint16_t op;
+        uint32_t payloadSize;
+        memcpy(&op, &data[offset], sizeof(op));
+        memcpy(&payloadSize, &data[offset + sizeof(op)], sizeof(payloadSize));
+        if (static_cast<GLTraceOp>(op) == GLTraceOp::FrameEnd) {
+            break;
+        }
+        offsets.push_back(offset);
+        offset += sizeof(op) + sizeof(payloadSize) + payloadSize;
+    }
+}
+
+void GLTraceReplayer::getReplayOrder(int frame, std::vector<size_t>& records) const {
+    const size_t recordHeaderSize = sizeof(uint16_t) + sizeof(uint32_t);
+    std::vector<size_t> offsets;
+    getRecordOffsets(frame, offsets);
+
+    // Per buffer, the last record of the frame that created it or allocated
+    // its store (a buffer made in an earlier frame has none)
+    std::map<GLenum, GLuint> boundBuffers;
+    std::map<GLuint, size_t> lastSetup;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        uint16_t op;
+        uint32_t payloadSize;
+        memcpy(&op, &data[offsets[i]], sizeof(op));
+        memcpy(&payloadSize, &data[offsets[i] + sizeof(op)], sizeof(payloadSize));
+        PayloadReader in(&data[offsets[i] + recordHeaderSize], payloadSize);
+        switch (static_cast<GLTraceOp>(op)) {
+            case GLTraceOp::GenBuffers: {
+                GLsizei n = in.read<GLsizei>();
+                for (GLsizei j = 0; j < n && in.ok(); ++j) {
+                    lastSetup[in.read<GLuint>()] = i;
+                }
+                break;
+            }
+            case GLTraceOp::BindBuffer: {
+                GLenum target = in.read<GLenum>();
+                boundBuffers[target] = in.read<GLuint>();
+                break;
+            }
+            case GLTraceOp::BindBufferBase:
+            case GLTraceOp::BindBufferRange: {
+                GLenum target = in.read<GLenum>();
+                in.read<GLuint>();
+                boundBuffers[target] = in.read<GLuint>();
+                break;
+            }
+            case GLTraceOp::BufferData:
+            case GLTraceOp::BufferStorage: {
+                GLuint buffer = boundBuffers[in.read<GLenum>()];
+                if (buffer != 0) {
+                    lastSetup[buffer] = i;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Mapped writes are recorded at the end of the frame but were visible to
+    // every draw in it, so they go first, or right after their buffer's
+    // creation and storage when those happen in this frame (frame 0 creates
+    // the ring buffers after the capture started)
+    std::vector<size_t> writes;
+    std::vector<std::vector<size_t> > writesAfter(offsets.size());
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        uint16_t op;
+        uint32_t payloadSize;
+        memcpy(&op, &data[offsets[i]], sizeof(op));
+        memcpy(&payloadSize, &data[offsets[i] + sizeof(op)], sizeof(payloadSize));
+        if (static_cast<GLTraceOp>(op) != GLTraceOp::MappedBufferWrite) {
+            continue;
+        }
+        PayloadReader in(&data[offsets[i] + recordHeaderSize], payloadSize);
+        GLuint buffer = in.read<GLuint>();
+        std::map<GLuint, size_t>::const_iterator setup = lastSetup.find(buffer);
+        if (setup != lastSetup.end() && setup->second < i) {
+            writesAfter[setup->second].push_back(i);
+        } else {
+            writes.push_back(i);
+        }
+    }
+
+    records.swap(writes);
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        uint16_t op;
+        memcpy(&op, &data[offsets[i]], sizeof(op));
+        if (static_cast<GLTraceOp>(op) != GLTraceOp::MappedBufferWrite) {
+            records.push_back(i);
+        }
+        records.insert(records.end(), writesAfter[i].begin(), writesAfter[i].end());
+    }
+}
+
+bool GLTraceReplayer::replayFrame(int frame) {
+    const size_t recordHeaderSize = sizeof(uint16_t) + sizeof(uint32_t);
+    std::vector<size_t> offsets;
+    getRecordOffsets(frame, offsets);
+
+    std::vector<size_t> records;
+    getReplayOrder(frame, records);
+    for (size_t i = 0; i < records.size(); ++i) {
+        size_t recordOffset = offsets[records[i]];
+        uint16_t op;
+        uint32_t payloadSize;
+        memcpy(&op, &data[recordOffset], sizeof(op));
+        memcpy(&payloadSize, &data[recordOffset + sizeof(op)], sizeof(payloadSize));
+        if (!replayRecord(static_cast<GLTraceOp>(op), &data[recordOffset + recordHeaderSize], payloadSize)) {
+            logger.Error("GLTraceReplay: malformed record (op %u) in frame %d", op, frame);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GLTraceReplayer::replayRecord(GLTraceOp op, const unsigned char* payload, uint32_t payloadSize) {
+    PayloadReader in(payload, payloadSize);
+
+    switch (op) {
+        // Shaders and programs
+        case GLTraceOp::CreateShader: {
+            GLenum type = in.read<GLenum>();
+            GLuint captured = in.read<GLuint>();
+            names[ShaderObject][captured] = glCreateShader(type);
+            break;
+        }
+        case GLTraceOp::ShaderSource: {
+            GLuint shader = in.read<GLuint>();
+            uint32_t length = in.read<uint32_t>();
+            const GLchar* source = reinterpret_cast<const GLchar*>(in.readBytes(length));
+            GLint sourceLength = static_cast<GLint>(length);
+            if (source) {
+                glShaderSource(mapName(ShaderObject, shader), 1, &source, &sourceLength);
+            }
+            break;
+        }
+        case GLTraceOp::CompileShader:
+            glCompileShader(mapName(ShaderObject, in.read<GLuint>()));
+            break;
+        case GLTraceOp::DeleteShader: {
+            GLuint captured = in.read<GLuint>();
+            glDeleteShader(mapName(ShaderObject, captured));
+            names[ShaderObject].erase(captured);
+            break;
+        }
+        case GLTraceOp::CreateProgram: {
+            GLuint captured = in.read<GLuint>();
+            names[ProgramObject][captured] = glCreateProgram();
+            break;
+        }
+        case GLTraceOp::AttachShader: {
+            GLuint program = in.read<GLuint>();
+            GLuint shader = in.read<GLuint>();
+            glAttachShader(mapName(ProgramObject, program), mapName(ShaderObject, shader));
+            break;
+        }
+        case GLTraceOp::DetachShader: {
+            GLuint program = in.read<GLuint>();
+            GLuint shader = in.read<GLuint>();
+            glDetachShader(mapName(ProgramObject, program), mapName(ShaderObject, shader));
+            break;
+        }
+        case GLTraceOp::LinkProgram:
+            glLinkProgram(mapName(ProgramObject, in.read<GLuint>()));
+            break;
+        case GLTraceOp::UseProgram:
+            glUseProgram(mapName(ProgramObject, in.read<GLuint>()));
+            break;
+        case GLTraceOp::DeleteProgram: {
+            GLuint captured = in.read<GLuint>();
+            glDeleteProgram(mapName(ProgramObject, captured));
+            names[ProgramObject].erase(captured);
+            break;
+        }
+        case GLTraceOp::Uniform1i: {
+            GLint location = in.read<GLint>();
+            glUniform1i(location, in.read<GLint>());
+            break;
+        }
+        case GLTraceOp::Uniform1ui: {
+            GLint location = in.read<GLint>();
+            glUniform1ui(location, in.read<GLuint>());
+            break;
+        }
+        case GLTraceOp::Uniform4fv: {
+            GLint location = in.read<GLint>();
+            GLsizei count = in.read<GLsizei>();
+            const GLfloat* values = reinterpret_cast<const GLfloat*>(in.readBytes(sizeof(GLfloat) * 4 * count));
+            if (values) {
+                glUniform4fv(location, count, values);
+            }
+            break;
+        }
+        case GLTraceOp::UniformMatrix4fv: {
+            GLint location = in.read<GLint>();
+            GLsizei count = in.read<GLsizei>();
+            GLboolean transpose = in.read<GLboolean>();
+            const GLfloat* values = reinterpret_cast<const GLfloat*>(in.readBytes(sizeof(GLfloat) * 16 * count));
+            if (values) {
+                glUniformMatrix4fv(location, count, transpose, values);
+            }
+            break;
+        }
+
+        // Buffers
+        case GLTraceOp::GenBuffers:
+        case GLTraceOp::GenVertexArrays:
+        case GLTraceOp::GenTextures:
+        case GLTraceOp::GenFramebuffers: {
+            GLsizei n = in.read<GLsizei>();
+            for (GLsizei i = 0; i < n && in.ok(); ++i) {
+                GLuint captured = in.read<GLuint>();
+                GLuint name = 0;
+                if (op == GLTraceOp::GenBuffers) {
+                    glGenBuffers(1, &name);
+                    names[BufferObject][captured] = name;
+                } else if (op == GLTraceOp::GenVertexArrays) {
+                    glGenVertexArrays(1, &name);
+                    names[VertexArrayObject][captured] = name;
+                } else if (op == GLTraceOp::GenTextures) {
+                    glGenTextures(1, &name);
+                    names[TextureObject][captured] = name;
+                } else {
+                    glGenFramebuffers(1, &name);
+                    names[FramebufferObject][captured] = name;
+                }
+            }
+            break;
+        }
+        case GLTraceOp::DeleteBuffers:
+        case GLTraceOp::DeleteVertexArrays:
+        case GLTraceOp::DeleteTextures:
+        case GLTraceOp::DeleteFramebuffers: {
+            ObjectKind kind = op == GLTraceOp::DeleteBuffers        ? BufferObject
+                              : op == GLTraceOp::DeleteVertexArrays ? VertexArrayObject
+                              : op == GLTraceOp::DeleteTextures     ? TextureObject
+                                                                    : FramebufferObject;
+            GLsizei n = in.read<GLsizei>();
+            for (GLsizei i = 0; i < n && in.ok(); ++i) {
+                GLuint captured = in.read<GLuint>();
+                GLuint name = mapName(kind, captured);
+                if (kind == BufferObject) {
+                    glDeleteBuffers(1, &name);
+                } else if (kind == VertexArrayObject) {
+                    glDeleteVertexArrays(1, &name);
+                } else if (kind == TextureObject) {
+                    glDeleteTextures(1, &name);
+                } else {
+                    glDeleteFramebuffers(1, &name);
+                }
+                names[kind].erase(captured);
+            }
+            break;
+        }
+        case GLTraceOp::BindBuffer: {
+            GLenum target = in.read<GLenum>();
+            glBindBuffer(target, mapName(BufferObject, in.read<GLuint>()));
+            break;
+        }
+        case GLTraceOp::BindBufferBase: {
+            GLenum target = in.read<GLenum>();
+            GLuint index = in.read<GLuint>();
+            glBindBufferBase(target, index, mapName(BufferObject, in.read<GLuint>()));
+            break;
+        }
+        case GLTraceOp::BindBufferRange: {
+            GLenum target = in.read<GLenum>();
+            GLuint index = in.read<GLuint>();
+            GLuint buffer = in.read<GLuint>();
+            int64_t offset = in.read<int64_t>();
+            int64_t size = in.read<int64_t>();
+            glBindBufferRange(target, index, mapName(BufferObject, buffer), offset, size);
+            break;
+        }
+        case GLTraceOp::BufferData: {
+            GLenum target = in.read<GLenum>();
+            int64_t size = in.read<int64_t>();
+            GLenum usage = in.read<GLenum>();
+            const void* bytes = in.readBlob(static_cast<size_t>(size));
+            glBufferData(target, size, bytes, usage);
+            break;
+        }
+        case GLTraceOp::BufferSubData: {
+            GLenum target = in.read<GLenum>();
+            int64_t offset = in.read<int64_t>();
+            int64_t size = in.read<int64_t>();
+            const void* bytes = in.readBlob(static_cast<size_t>(size));
+            if (bytes) {
+                glBufferSubData(target, offset, size, bytes);
+            }
+            break;
+        }
+        case GLTraceOp::ClearBufferData: {
+            GLenum target = in.read<GLenum>();
+            GLenum internalFormat = in.read<GLenum>();
+            GLenum format = in.read<GLenum>();
+            GLenum type = in.read<GLenum>();
+            uint32_t elementSize = in.read<uint32_t>();
+            const void* value = in.readBlob(elementSize);
+            glClearBufferData(target, internalFormat, format, type, value);
+            break;
+        }
+        case GLTraceOp::BufferStorage: {
+            GLenum target = in.read<GLenum>();
+            int64_t size = in.read<int64_t>();
+            GLbitfield flags = in.read<GLbitfield>();
+            const void* bytes = in.readBlob(static_cast<size_t>(size));
+            // Mapped writes come back as glBufferSubData, which immutable
+            // storage only accepts with the dynamic bit
+            glBufferStorage(target, size, bytes, flags | GL_DYNAMIC_STORAGE_BIT);
+            break;
+        }
+        case GLTraceOp::MapBufferRange: {
+            GLenum target = in.read<GLenum>();
+            int64_t offset = in.read<int64_t>();
+            int64_t length = in.read<int64_t>();
+            glMapBufferRange(target, offset, length, in.read<GLbitfield>());
+            break;
+        }
+        case GLTraceOp::UnmapBuffer:
+            glUnmapBuffer(in.read<GLenum>());
+            break;
+        case GLTraceOp::MappedBufferWrite: {
+            GLuint buffer = in.read<GLuint>();
+            int64_t offset = in.read<int64_t>();
+            int64_t size = in.read<int64_t>();
+            const void* bytes = in.readBytes(static_cast<size_t>(size));
+            if (bytes) {
+                GLint boundBuffer = 0;
+                glGetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &boundBuffer);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, mapName(BufferObject, buffer));
+                glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, bytes);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, static_cast<GLuint>(boundBuffer));
+            }
+            break;
+        }
+
+        // Vertex arrays
+        case GLTraceOp::BindVertexArray:
+            glBindVertexArray(mapName(VertexArrayObject, in.read<GLuint>()));
+            break;
+        case GLTraceOp::VertexAttribPointer: {
+            GLuint index = in.read<GLuint>();
+            GLint size = in.read<GLint>();
+            GLenum type = in.read<GLenum>();
+            GLboolean normalized = in.read<GLboolean>();
+            GLsizei stride = in.read<GLsizei>();
+            uint64_t offset = in.read<uint64_t>();
+            glVertexAttribPointer(index, size, type, normalized, stride,
+                                  reinterpret_cast<const void*>(static_cast<uintptr_t>(offset)));
+            break;
+        }
+        case GLTraceOp::EnableVertexAttribArray:
+            glEnableVertexAttribArray(in.read<GLuint>());
+            break;
+        case GLTraceOp::DisableVertexAttribArray:
+            glDisableVertexAttribArray(in.read<GLuint>());
+            break;
+        case GLTraceOp::VertexAttribFormat: {
+            GLuint index = in.read<GLuint>();
+            GLint size = in.read<GLint>();
+            GLenum type = in.read<GLenum>();
+            GLboolean normalized = in.read<GLboolean>();
+            glVertexAttribFormat(index, size, type, normalized, in.read<GLuint>());
+            break;
+        }
+        case GLTraceOp::VertexAttribBinding: {
+            GLuint index = in.read<GLuint>();
+            glVertexAttribBinding(index, in.read<GLuint>());
+            break;
+        }
+        case GLTraceOp::BindVertexBuffer: {
+            GLuint bindingIndex = in.read<GLuint>();
+            GLuint buffer = in.read<GLuint>();
+            int64_t offset = in.read<int64_t>();
+            glBindVertexBuffer(bindingIndex, mapName(BufferObject, buffer), offset, in.read<GLsizei>());
+            break;
+        }
+
+        // Textures and framebuffers
+        case GLTraceOp::BindTexture: {
+            GLenum target = in.read<GLenum>();
+            glBindTexture(target, mapName(TextureObject, in.read<GLuint>()));
+            break;
+        }
+        case GLTraceOp::TexStorage2D: {
+            GLenum target = in.read<GLenum>();
+            GLsizei levels = in.read<GLsizei>();
+            GLenum format = in.read<GLenum>();
+            GLsizei width = in.read<GLsizei>();
+            GLsizei height = in.read<GLsizei>();
+            glTexStorage2D(target, levels, format, width, height);
+            break;
+        }
+        case GLTraceOp::TexParameteri: {
+            GLenum target = in.read<GLenum>();
+            GLenum pname = in.read<GLenum>();
+            glTexParameteri(target, pname, in.read<GLint>());
+            break;
+        }
+        case GLTraceOp::PixelStorei: {
+            GLenum pname = in.read<GLenum>();
+            glPixelStorei(pname, in.read<GLint>());
+            break;
+        }
+        case GLTraceOp::TexSubImage2D: {
+            GLenum target = in.read<GLenum>();
+            GLint level = in.read<GLint>();
+            GLint x = in.read<GLint>();
+            GLint y = in.read<GLint>();
+            GLsizei width = in.read<GLsizei>();
+            GLsizei height = in.read<GLsizei>();
+            GLenum format = in.read<GLenum>();
+            GLenum type = in.read<GLenum>();
+            // The blob's size is whatever is left of the payload
+            uint8_t hasPixels = in.read<uint8_t>();
+            const void* pixels = hasPixels ? in.readBytes(in.remaining()) : nullptr;
+            glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+            break;
+        }
+        case GLTraceOp::ActiveTexture:
+            glActiveTexture(in.read<GLenum>());
+            break;
+        case GLTraceOp::BindImageTexture: {
+            GLuint unit = in.read<GLuint>();
+            GLuint texture = in.read<GLuint>();
+            GLint level = in.read<GLint>();
+            GLboolean layered = in.read<GLboolean>();
+            GLint layer = in.read<GLint>();
+            GLenum access = in.read<GLenum>();
+            glBindImageTexture(unit, mapName(TextureObject, texture), level, layered, layer, access,
+                               in.read<GLenum>());
+            break;
+        }
+        case GLTraceOp::BindFramebuffer: {
+            GLenum target = in.read<GLenum>();
+            glBindFramebuffer(target, mapName(FramebufferObject, in.read<GLuint>()));
+            break;
+        }
+        case GLTraceOp::FramebufferTexture: {
+            GLenum target = in.read<GLenum>();
+            GLenum attachment = in.read<GLenum>();
+            GLuint texture = in.read<GLuint>();
+            glFramebufferTexture(target, attachment, mapName(TextureObject, texture), in.read<GLint>());
+            break;
+        }
+        case GLTraceOp::DrawBuffers: {
+            GLsizei n = in.read<GLsizei>();
+            const GLenum* bufs = reinterpret_cast<const GLenum*>(in.readBytes(sizeof(GLenum) * n));
+            if (bufs) {
+                glDrawBuffers(n, bufs);
+            }
+            break;
+        }
+        case GLTraceOp::BlitFramebuffer: {
+            GLint coordinates[8];
+            for (int i = 0; i < 8; ++i) {
+                coordinates[i] = in.read<GLint>();
+            }
+            GLbitfield mask = in.read<GLbitfield>();
+            glBlitFramebuffer(coordinates[0], coordinates[1], coordinates[2], coordinates[3], coordinates[4],
+                              coordinates[5], coordinates[6], coordinates[7], mask, in.read<GLenum>());
+            break;
+        }
+
+        // Fixed-function state
+        case GLTraceOp::Enable:
+            glEnable(in.read<GLenum>());
+            break;
+        case GLTraceOp::Disable:
+            glDisable(in.read<GLenum>());
+            break;
+        case GLTraceOp::DepthFunc:
+            glDepthFunc(in.read<GLenum>());
+            break;
+        case GLTraceOp::BlendFunc: {
+            GLenum sfactor = in.read<GLenum>();
+            glBlendFunc(sfactor, in.read<GLenum>());
+            break;
+        }
+        case GLTraceOp::ClearColor: {
+            GLfloat red = in.read<GLfloat>();
+            GLfloat green = in.read<GLfloat>();
+            GLfloat blue = in.read<GLfloat>();
+            glClearColor(red, green, blue, in.read<GLfloat>());
+            break;
+        }
+        case GLTraceOp::ClearDepth:
+            glClearDepth(in.read<GLdouble>());
+            break;
+        case GLTraceOp::Clear:
+            glClear(in.read<GLbitfield>());
+            break;
+        case GLTraceOp::Viewport: {
+            GLint x = in.read<GLint>();
+            GLint y = in.read<GLint>();
+            GLsizei width = in.read<GLsizei>();
+            glViewport(x, y, width, in.read<GLsizei>());
+            break;
+        }
+        case GLTraceOp::Scissor: {
+            GLint x = in.read<GLint>();
+            GLint y = in.read<GLint>();
+            GLsizei width = in.read<GLsizei>();
+            glScissor(x, y, width, in.read<GLsizei>());
+            break;
+        }
+
+        // Draws and dispatch
+        case GLTraceOp::DrawArrays: {
+            GLenum mode = in.read<GLenum>();
+            GLint first = in.read<GLint>();
+            glDrawArrays(mode, first, in.read<GLsizei>());
+            break;
+        }
+        case GLTraceOp::DrawElements: {
+            GLenum mode = in.read<GLenum>();
+            GLsizei count = in.read<GLsizei>();
+            GLenum type = in.read<GLenum>();
+            uint64_t offset = in.read<uint64_t>();
+            glDrawElements(mode, count, type, reinterpret_cast<const void*>(static_cast<uintptr_t>(offset)));
+            break;
+        }
+        case GLTraceOp::DrawArraysInstanced: {
+            GLenum mode = in.read<GLenum>();
+            GLint first = in.read<GLint>();
+            GLsizei count = in.read<GLsizei>();
+            glDrawArraysInstanced(mode, first, count, in.read<GLsizei>());
+            break;
+        }
+        case GLTraceOp::DrawElementsInstanced: {
+            GLenum mode = in.read<GLenum>();
+            GLsizei count = in.read<GLsizei>();
+            GLenum type = in.read<GLenum>();
+            uint64_t offset = in.read<uint64_t>();
+            GLsizei instanceCount = in.read<GLsizei>();
+            glDrawElementsInstanced(mode, count, type, reinterpret_cast<const void*>(static_cast<uintptr_t>(offset)),
+                                    instanceCount);
+            break;
+        }
+        case GLTraceOp::MultiDrawElementsIndirect: {
+            GLenum mode = in.read<GLenum>();
+            GLenum type = in.read<GLenum>();
+            uint64_t offset = in.read<uint64_t>();
+            GLsizei drawCount = in.read<GLsizei>();
+            glMultiDrawElementsIndirect(mode, type, reinterpret_cast<const void*>(static_cast<uintptr_t>(offset)),
+                                        drawCount, in.read<GLsizei>());
+            break;
+        }
+        case GLTraceOp::MultiDrawElementsIndirectCount: {
+            GLenum mode = in.read<GLenum>();
+            GLenum type = in.read<GLenum>();
+            const void* indirect = reinterpret_cast<const void*>(static_cast<uintptr_t>(in.read<uint64_t>()));
+            int64_t drawCountOffset = in.read<int64_t>();
+            GLsizei maxDrawCount = in.read<GLsizei>();
+            GLsizei stride = in.read<GLsizei>();
+            // Captured through either entry point; use whichever this context has
+            if (GLEW_VERSION_4_6) {
+                glMultiDrawElementsIndirectCount(mode, type, indirect, drawCountOffset, maxDrawCount, stride);
+            } else if (GLEW_ARB_indirect_parameters) {
+                glMultiDrawElementsIndirectCountARB(mode, type, indirect, drawCountOffset, maxDrawCount, stride);
+            } else {
+                logger.Error("GLTraceReplay: trace needs GL 4.6 or ARB_indirect_parameters");
+                return false;
+            }
+            break;
+        }
+        case GLTraceOp::DispatchCompute: {
+            GLuint x = in.read<GLuint>();
+            GLuint y = in.read<GLuint>();
+            glDispatchCompute(x, y, in.read<GLuint>());
+            break;
+        }
+        case GLTraceOp::DispatchComputeIndirect:
+            glDispatchComputeIndirect(static_cast<GLintptr>(in.read<int64_t>()));
+            break;
+        case GLTraceOp::MemoryBarrier:
+            glMemoryBarrier(in.read<GLbitfield>());
+            break;
+
+        default:
+            // Unknown op from a newer writer: skip it, the payload size is known
+            logger.Debug("GLTraceReplay: skipping unknown op %u", static_cast<unsigned int>(op));
+            break;
+    }
+
+    return in.ok();
+}
+
+void GLTraceReplayer::reset() {
+    for (std::map<GLuint, GLuint>::iterator it = names[ShaderObject].begin(); it != names[ShaderObject].end(); ++it) {
+        glDeleteShader(it->second);
+    }
+    for (std::map<GLuint, GLuint>::iterator it = names[ProgramObject].begin(); it != names[ProgramObject].end(); ++it) {
+        glDeleteProgram(it->second);
+    }
+    for (std::map<GLuint, GLuint>::iterator it = names[BufferObject].begin(); it != names[BufferObject].end(); ++it) {
+        glDeleteBuffers(1, &it->second);
+    }
+    for (std::map<GLuint, GLuint>::iterator it = names[VertexArrayObject].begin();
+         it != names[VertexArrayObject].end(); ++it) {
+        glDeleteVertexArrays(1, &it->second);
+    }
+    for (std::map<GLuint, GLuint>::iterator it = names[TextureObject].begin(); it != names[TextureObject].end(); ++it) {
+        glDeleteTextures(1, &it->second);
+    }
+    for (std::map<GLuint, GLuint>::iterator it = names[FramebufferObject].begin();
+         it != names[FramebufferObject].end(); ++it) {
+        glDeleteFramebuffers(1, &it->second);
+    }
+    for (int kind = 0; kind < NumObjectKinds; ++kind) {
+        names[kind].clear();
+    }
+
+    glUseProgram(0);
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,53 @@
+#ifndef GL_TRACE_REPLAY_H
+#define GL_TRACE_REPLAY_H
+
+#include "GLTrace.h"
+
+#include <map>
+#include <vector>
+
+// Loads a GLTrace file and re-executes it frame by frame on the current
+// context, remapping captured object names to freshly created ones.
+class GLTraceReplayer {
+public:
+    GLTraceReplayer();
+    ~GLTraceReplayer();
+
+    bool load(const char* filePath);
+
+    int getNumFrames() const { return static_cast<int>(frameOffsets.size()); }
+
+    // Issues every record of the frame; returns false on a malformed record
+    bool replayFrame(int frame);
+
+    // Indices of the frame's records (FrameEnd excluded) in the order
+    // replayFrame() issues them: recording order, except that mapped buffer
+    // writes move up to the start of the frame or to just after the record
+    // that created or allocated their buffer
+    void getReplayOrder(int frame, std::vector<size_t>& records) const;
+
+    // Deletes every object the replay created, so the trace can run again
+    void reset();
+
+private:
+    enum ObjectKind {
+        ShaderObject,
+        ProgramObject,
+        BufferObject,
+        VertexArrayObject,
+        TextureObject,
+        FramebufferObject,
+        NumObjectKinds
+    };
+
+    std::vector<unsigned char> data;
+    std::vector<size_t> frameOffsets;
+    std::map<GLuint, GLuint> names[NumObjectKinds];
+
+    // Where each record of the frame starts, FrameEnd excluded
+    void getRecordOffsets(int frame, std::vector<size_t>& offsets) const;
+    GLuint mapName(ObjectKind kind, GLuint captured) const;
+    bool replayRecord(GLTraceOp op, const unsigned char* payload, uint32_t payloadSize);
+};
+
+#endif // GL_TRACE_REPLAY_H
@@ -0,0 +1,426 @@
+#include "MeshLoader.h"
+#include "Json.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace {
+
+// Vertices per parallelFor range when converting accessors
+const size_t MinConvertRange = 65536;
+
+const uint32_t GlbMagic = 0x46546C67;     // "glTF"
+const uint32_t GlbChunkJson = 0x4E4F534A; // "JSON"
+const uint32_t GlbChunkBin = 0x004E4942;  // "BIN\0"
+
+enum ComponentType {
+    ComponentByte = 5120,
+    ComponentUnsignedByte = 5121,
+    ComponentShort = 5122,
+    ComponentUnsignedShort = 5123,
+    ComponentUnsignedInt = 5125,
+    ComponentFloat = 5126
+};
+
+const int PrimitiveTriangles = 4;
+
+struct GltfBuffer {
+    const char* data;
+    size_t size;
+};
+
+// Resolved view of one accessor's elements inside a mapped buffer
+struct GltfAccessor {
+    const char* data;
+    size_t count;
+    size_t stride;
+    int componentType;
+    int numComponents;
+    bool normalized;
+};
+
+inline uint32_t readUint32(const char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+size_t componentSize(int componentType) {
+    switch (componentType) {
+        case ComponentByte:
+        case ComponentUnsignedByte:
+            return 1;
+        case ComponentShort:
+        case ComponentUnsignedShort:
+            return 2;
+        case ComponentUnsignedInt:
+        case ComponentFloat:
+            return 4;
+    }
+    return 0;
+}
+
+int componentCount(const std::string& type) {
+    if (type == "SCALAR") {
+        return 1;
+    }
+    if (type == "VEC2") {
+        return 2;
+    }
+    if (type == "VEC3") {
+        return 3;
+    }
+    if (type == "VEC4") {
+        return 4;
+    }
+    return 0;
+}
+
+// Component as float, applying the glTF normalization rules for integer types
+inline float readComponent(const char* p, int componentType, bool normalized) {
+    switch (componentType) {
+        case ComponentFloat: {
+            float value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+        case ComponentUnsignedByte: {
+            uint8_t value = static_cast<uint8_t>(*p);
+            return normalized ? value / 255.0f : value;
+        }
+        case ComponentByte: {
+            int8_t value = static_cast<int8_t>(*p);
+            return normalized ? std::fmax(value / 127.0f, -1.0f) : value;
+        }
+        case ComponentUnsignedShort: {
+            uint16_t value;
+            memcpy(&value, p, sizeof(value));
+            return normalized ? value / 65535.0f : value;
+        }
+        case ComponentShort: {
+            int16_t value;
+            memcpy(&value, p, sizeof(value));
+            return normalized ? std::fmax(value / 32767.0f, -1.0f) : value;
+        }
+        case ComponentUnsignedInt: {
+            uint32_t value;
+            memcpy(&value, p, sizeof(value));
+            return static_cast<float>(value);
+        }
+    }
+    return 0.0f;
+}
+
+inline uint32_t readIndex(const char* p, int componentType) {
+    switch (componentType) {
+        case ComponentUnsignedByte:
+            return static_cast<uint8_t>(*p);
+        case ComponentUnsignedShort: {
+            uint16_t value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+        default:
+            return readUint32(p);
+    }
+}
+
+class GltfDocument {
+public:
+    bool load(const char* filePath) {
+        this->filePath = filePath;
+        if (!file.open(filePath)) {
+            return false;
+        }
+
+        const char* json = file.data();
+        size_t jsonLength = file.size();
+        GltfBuffer embedded = {nullptr, 0};
+
+        if (file.size() >= 12 && readUint32(file.data()) == GlbMagic) {
+            if (!readGlb(json, jsonLength, embedded)) {
+                return false;
+            }
+        }
+
+        std::string error;
+        if (!JsonValue::parse(json, jsonLength, document, error)) {
+            logger.Error("Invalid glTF JSON in %s: %s", filePath, error.c_str());
+            return false;
+        }
+
+        return loadBuffers(embedded);
+    }
+
+    const JsonValue& getDocument() const { return document; }
+
+    bool getAccessor(int index, GltfAccessor& accessor) const {
+        const JsonValue& accessorJson = document["accessors"][static_cast<size_t>(index)];
+        const JsonValue& viewJson = document["bufferViews"][static_cast<size_t>(accessorJson["bufferView"].asInt(-1))];
+        if (!accessorJson.isObject() || !viewJson.isObject()) {
+            // Sparse-only or view-less accessors are not supported
+            logger.Error("Unsupported accessor %d in %s", index, filePath.c_str());
+            return false;
+        }
+
+        int bufferIndex = viewJson["buffer"].asInt(-1);
+        if (bufferIndex < 0 || bufferIndex >= static_cast<int>(buffers.size())) {
+            logger.Error("Accessor %d references a missing buffer in %s", index, filePath.c_str());
+            return false;
+        }
+        const GltfBuffer& buffer = buffers[bufferIndex];
+
+        accessor.componentType = accessorJson["componentType"].asInt();
+        accessor.numComponents = componentCount(accessorJson["type"].asString());
+        accessor.count = static_cast<size_t>(accessorJson["count"].asNumber());
+        accessor.normalized = accessorJson["normalized"].asBool();
+
+        size_t elementSize = componentSize(accessor.componentType) * accessor.numComponents;
+        size_t viewOffset = static_cast<size_t>(viewJson["byteOffset"].asNumber());
+        size_t viewLength = static_cast<size_t>(viewJson["byteLength"].asNumber());
+        size_t accessorOffset = static_cast<size_t>(accessorJson["byteOffset"].asNumber());
+        accessor.stride = static_cast<size_t>(viewJson["byteStride"].asNumber());
+        if (accessor.stride == 0) {
+            accessor.stride = elementSize;
+        }
+
+        // Every element must lie inside the view and the view inside the buffer
+        if (elementSize == 0 || viewOffset + viewLength > buffer.size ||
+            (accessor.count > 0 && accessorOffset + accessor.stride * (accessor.count - 1) + elementSize > viewLength)) {
+            logger.Error("Accessor %d is out of bounds in %s", index, filePath.c_str());
+            return false;
+        }
+
+        accessor.data = buffer.data + viewOffset + accessorOffset;
+        return true;
+    }
+
+private:
+    std::string filePath;
+    MappedFile file;
+    JsonValue document;
+    std::vector<std::unique_ptr<MappedFile>> externalFiles;
+    std::vector<GltfBuffer> buffers;
+
+    bool readGlb(const char*& json, size_t& jsonLength, GltfBuffer& embedded) {
+        const char* data = file.data();
+        size_t size = file.size();
+        size_t totalLength = readUint32(data + 8);
+        if (totalLength > size) {
+            logger.Error("Truncated GLB file: %s", filePath.c_str());
+            return false;
+        }
+
+        json = nullptr;
+        size_t offset = 12;
+        while (offset + 8 <= totalLength) {
+            uint32_t chunkLength = readUint32(data + offset);
+            uint32_t chunkType = readUint32(data + offset + 4);
+            if (offset + 8 + chunkLength > totalLength) {
+                break;
+            }
+            if (chunkType == GlbChunkJson && json == nullptr) {
+                json = data + offset + 8;
+                jsonLength = chunkLength;
+            } else if (chunkType == GlbChunkBin && embedded.data == nullptr) {
+                embedded.data = data + offset + 8;
+                embedded.size = chunkLength;
+            }
+            offset += 8 + ((chunkLength + 3) & ~3u);
+        }
+
+        if (json == nullptr) {
+            logger.Error("GLB file without a JSON chunk: %s", filePath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool loadBuffers(const GltfBuffer& embedded) {
+        std::string directory(filePath);
+        size_t slash = directory.find_last_of('/');
+        directory = (slash == std::string::npos) ? std::string() : directory.substr(0, slash + 1);
+
+        const JsonValue& buffersJson = document["buffers"];
+        for (size_t i = 0; i < buffersJson.size(); ++i) {
+            const JsonValue& bufferJson = buffersJson[i];
+            GltfBuffer buffer = {nullptr, 0};
+
+            if (!bufferJson.has("uri")) {
+                buffer = embedded;
+            } else if (bufferJson["uri"].asString().compare(0, 5, "data:") == 0) {
+                logger.Error("Embedded data URIs are not supported (%s)", filePath.c_str());
+                return false;
+            } else {
+                std::unique_ptr<MappedFile> external(new MappedFile());
+                std::string path = directory + bufferJson["uri"].asString();
+                if (!external->open(path.c_str())) {
+                    return false;
+                }
+                buffer.data = external->data();
+                buffer.size = external->size();
+                externalFiles.push_back(std::move(external));
+            }
+
+            size_t declaredLength = static_cast<size_t>(bufferJson["byteLength"].asNumber());
+            if (buffer.data == nullptr || declaredLength > buffer.size) {
+                logger.Error("Buffer %zu is missing or shorter than declared in %s", i, filePath.c_str());
+                return false;
+            }
+            buffers.push_back(buffer);
+        }
+        return true;
+    }
+};
+
+bool readVec(const GltfAccessor& accessor, int expectedComponents, size_t expectedCount) {
+    return accessor.numComponents == expectedComponents && accessor.count == expectedCount &&
+           (accessor.componentType == ComponentFloat || accessor.normalized);
+}
+
+}
+
+bool loadGltf(const char* filePath, MeshData& mesh, ThreadPool& threadPool) {
+    mesh.clear();
+
+    GltfDocument gltf;
+    if (!gltf.load(filePath)) {
+        return false;
+    }
+
+    const JsonValue& meshesJson = gltf.getDocument()["meshes"];
+    for (size_t meshIndex = 0; meshIndex < meshesJson.size(); ++meshIndex) {
+        const JsonValue& primitivesJson = meshesJson[meshIndex]["primitives"];
+        for (size_t primitiveIndex = 0; primitiveIndex < primitivesJson.size(); ++primitiveIndex) {
+            const JsonValue& primitive = primitivesJson[primitiveIndex];
+            if (primitive["mode"].asInt(PrimitiveTriangles) != PrimitiveTriangles) {
+                logger.Debug("Skipping non-triangle primitive in %s", filePath);
+                continue;
+            }
+
+            const JsonValue& attributes = primitive["attributes"];
+            GltfAccessor positions;
+            if (!attributes.has("POSITION") || !gltf.getAccessor(attributes["POSITION"].asInt(), positions) ||
+                positions.numComponents != 3 || positions.componentType != ComponentFloat) {
+                logger.Error("Primitive without float3 POSITION in %s", filePath);
+                return false;
+            }
+
+            const size_t count = positions.count;
+            GltfAccessor normals, texCoords, colors;
+            bool hasNormals = attributes.has("NORMAL") && gltf.getAccessor(attributes["NORMAL"].asInt(), normals) &&
+                              readVec(normals, 3, count);
+            bool hasTexCoords = attributes.has("TEXCOORD_0") &&
+                                gltf.getAccessor(attributes["TEXCOORD_0"].asInt(), texCoords) &&
+                                readVec(texCoords, 2, count);
+            bool hasColors = attributes.has("COLOR_0") && gltf.getAccessor(attributes["COLOR_0"].asInt(), colors) &&
+                             (readVec(colors, 3, count) || readVec(colors, 4, count));
+
+            const size_t vertexBase = mesh.vertices.size();
+            mesh.vertices.resize(vertexBase + count);
+            MeshVertex* vertices = &mesh.vertices[vertexBase];
+
+            // Straight out of the mapped buffers, in parallel ranges
+            threadPool.parallelFor(count, MinConvertRange, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    MeshVertex& vertex = vertices[i];
+                    const char* position = positions.data + positions.stride * i;
+                    for (int c = 0; c < 3; ++c) {
+                        vertex.position[c] = readComponent(position + c * 4, ComponentFloat, false);
+                    }
+
+                    if (hasNormals) {
+                        const char* normal = normals.data + normals.stride * i;
+                        size_t size = componentSize(normals.componentType);
+                        for (int c = 0; c < 3; ++c) {
+                            vertex.normal[c] = readComponent(normal + c * size, normals.componentType, normals.normalized);
+                        }
+                    } else {
+                        vertex.normal[0] = vertex.normal[1] = 0.0f;
+                        vertex.normal[2] = 1.0f;
+                    }
+
+                    if (hasTexCoords) {
+                        const char* texCoord = texCoords.data + texCoords.stride * i;
+                        size_t size = componentSize(texCoords.componentType);
+                        for (int c = 0; c < 2; ++c) {
+                            vertex.texCoord[c] =
+                                readComponent(texCoord + c * size, texCoords.componentType, texCoords.normalized);
+                        }
+                    } else {
+                        vertex.texCoord[0] = vertex.texCoord[1] = 0.0f;
+                    }
+
+                    vertex.color[0] = vertex.color[1] = vertex.color[2] = vertex.color[3] = 1.0f;
+                    if (hasColors) {
+                        const char* color = colors.data + colors.stride * i;
+                        size_t size = componentSize(colors.componentType);
+                        for (int c = 0; c < colors.numComponents; ++c) {
+                            vertex.color[c] = readComponent(color + c * size, colors.componentType, colors.normalized);
+                        }
+                    }
+                }
+            });
+
+            const size_t indexBase = mesh.indices.size();
+            if (primitive.has("indices")) {
+                GltfAccessor indices;
+                if (!gltf.getAccessor(primitive["indices"].asInt(), indices) || indices.numComponents != 1 ||
+                    (indices.componentType != ComponentUnsignedByte &&
+                     indices.componentType != ComponentUnsignedShort &&
+                     indices.componentType != ComponentUnsignedInt)) {
+                    logger.Error("Invalid index accessor in %s", filePath);
+                    return false;
+                }
+                if (indices.count % 3 != 0) {
+                    logger.Error("Triangle primitive with %zu indices (not a multiple of 3) in %s", indices.count,
+                                 filePath);
+                    return false;
+                }
+
+                mesh.indices.resize(indexBase + indices.count);
+                uint32_t* output = &mesh.indices[indexBase];
+                std::atomic<bool> outOfRange(false);
+                threadPool.parallelFor(indices.count, MinConvertRange, [&](size_t begin, size_t end) {
+                    bool rangeOutOfRange = false;
+                    for (size_t i = begin; i < end; ++i) {
+                        uint32_t index = readIndex(indices.data + indices.stride * i, indices.componentType);
+                        rangeOutOfRange |= index >= count;
+                        output[i] = static_cast<uint32_t>(vertexBase) + index;
+                    }
+                    if (rangeOutOfRange) {
+                        outOfRange = true;
+                    }
+                });
+                if (outOfRange) {
+                    logger.Error("Index out of range in %s", filePath);
+                    return false;
+                }
+            } else {
+                if (count % 3 != 0) {
+                    logger.Error("Triangle primitive with %zu vertices (not a multiple of 3) in %s", count, filePath);
+                    return false;
+                }
+                mesh.indices.resize(indexBase + count);
+                for (size_t i = 0; i < count; ++i) {
+                    mesh.indices[indexBase + i] = static_cast<uint32_t>(vertexBase + i);
+                }
+            }
+        }
+    }
+
+    if (mesh.indices.empty()) {
+        logger.Error("No triangle primitives in %s", filePath);
+        return false;
+    }
+
+    mesh.computeBounds();
+    logger.Debug("Loaded %s: %zu vertices, %zu triangles", filePath, mesh.vertices.size(), mesh.indices.size() / 3);
+    return true;
+}
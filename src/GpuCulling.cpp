@@ -0,0 +1,187 @@
+#include "GpuCulling.h"
+#include "FrustumCulling.h"
+#include "GLHooks.h"
+#include "Logger.h"
+#include "MemoryBudget.h"
+#include "ShaderLibrary.h"
+
+static_assert(sizeof(GpuInstance) == 96, "GpuInstance must match the std430 Instance struct");
+static_assert(sizeof(GpuMesh) == 16, "GpuMesh must match the std430 Mesh struct");
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand must be tightly packed");
+
+namespace {
+
+// Slots of cullUniforms
+enum CullUniform {
+    CullUniformFrustumPlanes,
+    CullUniformInstanceCount,
+    CullUniformCompact
+};
+
+constexpr ShaderUniform cullUniforms[] = {
+    {"uFrustumPlanes", 0, GL_FLOAT_VEC4}, // locations 0-5
+    {"uInstanceCount", 6, GL_UNSIGNED_INT},
+    {"uCompact", 7, GL_BOOL},
+};
+
+// Indexed by GpuCullBinding, so the slot of each block is its binding
+constexpr ShaderBlock cullStorageBlocks[] = {
+    {"Instances", GpuCullBindingInstances, sizeof(GpuInstance)},
+    {"Meshes", GpuCullBindingMeshes, sizeof(GpuMesh)},
+    {"Commands", GpuCullBindingCommands, sizeof(DrawElementsIndirectCommand)},
+    {"DrawCount", GpuCullBindingDrawCount, sizeof(GLuint)},
+};
+
+static_assert(blockBindingsUnique(cullStorageBlocks, countOf(cullStorageBlocks)), "duplicate SSBO binding");
+
+const ShaderInterface cullInterface = {
+    nullptr, 0, cullUniforms, countOf(cullUniforms), nullptr, 0, cullStorageBlocks, countOf(cullStorageBlocks)};
+
+}
+
+GpuCuller::GpuCuller()
+    : cullShader(nullptr), instanceBuffer(0), meshBuffer(0), commandBuffer(0), countBuffer(0), numInstances(0), indirectCount(false),
+      coreIndirectCount(false), meshesDirty(false) {
+}
+
+GpuCuller::~GpuCuller() {
+    cleanup();
+}
+
+bool GpuCuller::initialize() {
+    cullShader = shaderLibrary.get("frustumCull", cullInterface);
+    if (cullShader == nullptr || !cullShader->isCompute()) {
+        logger.Error("GPU culling disabled: shaders/cull/frustumCull.comp failed to build");
+        return false;
+    }
+
+    // A 4.6 driver need not advertise ARB_indirect_parameters, and GLEW only
+    // loads the ARB entry point when it does
+    coreIndirectCount = GLEW_VERSION_4_6;
+    indirectCount = coreIndirectCount || GLEW_ARB_indirect_parameters;
+
+    GLuint buffers[4];
+    glGenBuffers(4, buffers);
+    instanceBuffer = buffers[0];
+    meshBuffer = buffers[1];
+    commandBuffer = buffers[2];
+    countBuffer = buffers[3];
+
+    GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), &zero, GL_DYNAMIC_DRAW);
+    memoryBudget.trackBuffer(MemoryCategory::Storage, countBuffer, sizeof(GLuint));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    logger.Info("GPU culling: %s", coreIndirectCount ? "glMultiDrawElementsIndirectCount"
+                                   : indirectCount   ? "glMultiDrawElementsIndirectCountARB"
+                                                     : "glMultiDrawElementsIndirect");
+    return true;
+}
+
+void GpuCuller::cleanup() {
+    if (instanceBuffer != 0) {
+        GLuint buffers[4] = {instanceBuffer, meshBuffer, commandBuffer, countBuffer};
+        for (int i = 0; i < 4; ++i) {
+            memoryBudget.untrackBuffer(buffers[i]);
+        }
+        glDeleteBuffers(4, buffers);
+        instanceBuffer = meshBuffer = commandBuffer = countBuffer = 0;
+    }
+    cullShader = nullptr;
+    meshes.clear();
+    numInstances = 0;
+}
+
+uint32_t GpuCuller::addMesh(GLuint indexCount, GLuint firstIndex, GLint baseVertex) {
+    GpuMesh mesh;
+    mesh.indexCount = indexCount;
+    mesh.firstIndex = firstIndex;
+    mesh.baseVertex = baseVertex;
+    mesh.padding = 0;
+    meshes.push_back(mesh);
+    meshesDirty = true;
+    return static_cast<uint32_t>(meshes.size() - 1);
+}
+
+void GpuCuller::setInstances(const GpuInstance* instances, size_t count) {
+    numInstances = count;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, count * sizeof(GpuInstance), instances, GL_STATIC_DRAW);
+    memoryBudget.trackBuffer(MemoryCategory::Storage, instanceBuffer,
+                             static_cast<int64_t>(count * sizeof(GpuInstance)));
+
+    // Worst case every instance survives
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, count * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+    memoryBudget.trackBuffer(MemoryCategory::Storage, commandBuffer,
+                             static_cast<int64_t>(count * sizeof(DrawElementsIndirectCommand)));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuCuller::cull(const mat4& viewProjection) {
+    if (numInstances == 0) {
+        return;
+    }
+
+    if (meshesDirty) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, meshBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, meshes.size() * sizeof(GpuMesh), meshes.data(), GL_STATIC_DRAW);
+        memoryBudget.trackBuffer(MemoryCategory::Storage, meshBuffer,
+                                 static_cast<int64_t>(meshes.size() * sizeof(GpuMesh)));
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        meshesDirty = false;
+    }
+
+    // Reset the append counter; ordered before the dispatch by the GL
+    if (indirectCount) {
+        GLuint zero = 0;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    Frustum frustum = Frustum::fromMatrix(viewProjection.data());
+
+    cullShader->use();
+    cullShader->setUniformVector4(CullUniformFrustumPlanes, &frustum.planes[0][0], 6);
+    cullShader->setUniformUint(CullUniformInstanceCount, static_cast<GLuint>(numInstances));
+    cullShader->setUniformInt(CullUniformCompact, indirectCount ? 1 : 0);
+
+    cullShader->bindStorageBuffer(GpuCullBindingInstances, instanceBuffer);
+    cullShader->bindStorageBuffer(GpuCullBindingMeshes, meshBuffer);
+    cullShader->bindStorageBuffer(GpuCullBindingCommands, commandBuffer);
+    cullShader->bindStorageBuffer(GpuCullBindingDrawCount, countBuffer);
+    cullShader->dispatchThreads(static_cast<GLuint>(numInstances));
+
+    glUseProgram(0);
+}
+
+void GpuCuller::draw(GLenum mode) {
+    if (numInstances == 0) {
+        return;
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GpuCullBindingInstances, instanceBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+
+    if (indirectCount) {
+        // GL_PARAMETER_BUFFER has the value of GL_PARAMETER_BUFFER_ARB
+        glBindBuffer(GL_PARAMETER_BUFFER, countBuffer);
+        if (coreIndirectCount) {
+            glMultiDrawElementsIndirectCount(mode, GL_UNSIGNED_INT, nullptr, 0, static_cast<GLsizei>(numInstances),
+                                             sizeof(DrawElementsIndirectCommand));
+        } else {
+            glMultiDrawElementsIndirectCountARB(mode, GL_UNSIGNED_INT, nullptr, 0,
+                                                static_cast<GLsizei>(numInstances),
+                                                sizeof(DrawElementsIndirectCommand));
+        }
+        glBindBuffer(GL_PARAMETER_BUFFER, 0);
+    } else {
+        glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(numInstances),
+                                    sizeof(DrawElementsIndirectCommand));
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
@@ -0,0 +1,92 @@
+#ifndef GPU_CULLING_H
+#define GPU_CULLING_H
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+#include <vector>
+
+#include "Shader.h"
+#include "VectorMath.h"
+
+// std430 mirrors of the structs in shaders/common/gpuInstance.glsl
+struct GpuInstance {
+    mat4 world;
+    float boundingSphere[4]; // world-space center, radius
+    GLuint mesh;
+    GLuint padding[3];
+};
+
+struct GpuMesh {
+    GLuint indexCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint padding;
+};
+
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// SSBO bindings declared by shaders/cull/frustumCull.comp; the instanced
+// vertex shader reads Instances at the same binding
+enum GpuCullBinding {
+    GpuCullBindingInstances = 0,
+    GpuCullBindingMeshes = 1,
+    GpuCullBindingCommands = 2,
+    GpuCullBindingDrawCount = 3
+};
+
+// GPU-driven frustum culling for large instance sets. cull() runs
+// shaders/cull/frustumCull.comp, which tests each instance's bounding sphere
+// and writes a DrawElementsIndirectCommand for the survivors; draw() then
+// consumes the command buffer without any CPU readback.
+//
+// With ARB_indirect_parameters (core in 4.6) survivors are appended and
+// counted atomically and drawn with glMultiDrawElementsIndirectCount. Without
+// it every instance keeps its own command slot and culled ones are emitted
+// with instanceCount 0 for a plain glMultiDrawElementsIndirect.
+//
+// cull() writes the command and count buffers through SSBOs: the caller must
+// issue glMemoryBarrier(GL_COMMAND_BARRIER_BIT) before draw(), which the
+// render graph does when a pass reads them as RenderGraphAccess::IndirectBuffer.
+class GpuCuller {
+public:
+    GpuCuller();
+    ~GpuCuller();
+
+    bool initialize();
+    void cleanup();
+
+    // Meshes index into the element buffer bound to the VAO used in draw()
+    uint32_t addMesh(GLuint indexCount, GLuint firstIndex, GLint baseVertex);
+    // Replaces the instance set; instance.mesh must come from addMesh()
+    void setInstances(const GpuInstance* instances, size_t count);
+
+    void cull(const mat4& viewProjection);
+    // Instance transforms are bound at GpuCullBindingInstances for the vertex shader
+    void draw(GLenum mode);
+
+    GLuint getCommandBuffer() const { return commandBuffer; }
+    GLuint getCountBuffer() const { return countBuffer; }
+    size_t getNumInstances() const { return numInstances; }
+    bool usesIndirectCount() const { return indirectCount; }
+
+private:
+    Shader* cullShader; // owned by shaderLibrary
+    GLuint instanceBuffer;
+    GLuint meshBuffer;
+    GLuint commandBuffer;
+    GLuint countBuffer;
+    std::vector<GpuMesh> meshes;
+    size_t numInstances;
+    bool indirectCount;
+    bool coreIndirectCount; // 4.6 entry point rather than the ARB one
+    bool meshesDirty;
+};
+
+#endif // GPU_CULLING_H
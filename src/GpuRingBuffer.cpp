@@ -0,0 +1,148 @@
+#include "GpuRingBuffer.h"
+#include "GLDebug.h"
+#include "GLHooks.h"
+#include "Logger.h"
+#include "MemoryBudget.h"
+
+#include <algorithm>
+
+const unsigned int GpuRingBuffer::FramesInFlight;
+
+GpuRingBuffer::GpuRingBuffer()
+    : buffer(0), mapped(nullptr), bytesPerFrame(0), uniformAlignment(256), storageAlignment(256), frameIndex(0),
+      regionStart(0), head(0), overflowReported(false), numStalls(0) {
+    for (unsigned int i = 0; i < FramesInFlight; ++i) {
+        fences[i] = 0;
+    }
+}
+
+GpuRingBuffer::~GpuRingBuffer() {
+    cleanup();
+}
+
+bool GpuRingBuffer::initialize(GLsizeiptr bytesPerFrame) {
+    cleanup();
+
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    uniformAlignment = std::max<GLsizeiptr>(alignment, 16);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    storageAlignment = std::max<GLsizeiptr>(alignment, 16);
+
+    // Regions start on an alignment boundary for either use
+    GLsizeiptr regionAlignment = std::max(uniformAlignment, storageAlignment);
+    this->bytesPerFrame = (bytesPerFrame + regionAlignment - 1) / regionAlignment * regionAlignment;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, this->bytesPerFrame * FramesInFlight, nullptr, flags);
+    memoryBudget.trackBuffer(MemoryCategory::Uniform, buffer, this->bytesPerFrame * FramesInFlight);
+    glDebug.label(GL_BUFFER, buffer, "GpuRingBuffer");
+    mapped = static_cast<unsigned char*>(
+        glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, this->bytesPerFrame * FramesInFlight, flags));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (mapped == nullptr) {
+        logger.Error("Failed to map the %ld byte GPU ring buffer",
+                     static_cast<long>(this->bytesPerFrame * FramesInFlight));
+        cleanup();
+        return false;
+    }
+
+    frameIndex = 0;
+    regionStart = head = 0;
+    logger.Debug("GPU ring buffer: %ld bytes x %u frames, uniform alignment %ld, storage alignment %ld",
+                 static_cast<long>(this->bytesPerFrame), FramesInFlight, static_cast<long>(uniformAlignment),
+                 static_cast<long>(storageAlignment));
+    return true;
+}
+
+void GpuRingBuffer::cleanup() {
+    for (unsigned int i = 0; i < FramesInFlight; ++i) {
+        if (fences[i] != 0) {
+            glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+    }
+    if (buffer != 0) {
+        if (mapped != nullptr) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        memoryBudget.untrackBuffer(buffer);
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+    mapped = nullptr;
+    bytesPerFrame = 0;
+    regionStart = head = 0;
+}
+
+void GpuRingBuffer::beginFrame() {
+    if (buffer == 0) {
+        return;
+    }
+
+    GLsync& fence = fences[frameIndex];
+    if (fence != 0) {
+        GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            // The GPU is FramesInFlight frames behind: block until it catches up
+            ++numStalls;
+            do {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+            } while (status == GL_TIMEOUT_EXPIRED);
+        }
+        glDeleteSync(fence);
+        fence = 0;
+    }
+
+    regionStart = head = frameIndex * bytesPerFrame;
+    overflowReported = false;
+}
+
+void GpuRingBuffer::endFrame() {
+    if (buffer == 0) {
+        return;
+    }
+#ifdef XWGL_GL_HOOKS
+    // The memcpys into the map bypass GL; hand a capture the frame's slice
+    if (head > regionStart) {
+        hookMappedBufferWrite(buffer, regionStart, head - regionStart, mapped + regionStart);
+    }
+#endif
+    fences[frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frameIndex = (frameIndex + 1) % FramesInFlight;
+}
+
+GpuAllocation GpuRingBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment) {
+    GpuAllocation allocation = {nullptr, buffer, 0, size};
+
+    GLsizeiptr offset = (head + alignment - 1) / alignment * alignment;
+    if (buffer == 0 || offset + size > regionStart + bytesPerFrame) {
+        if (!overflowReported) {
+            logger.Error("GPU ring buffer exhausted: %ld of %ld bytes used this frame, %ld more requested",
+                         static_cast<long>(head - regionStart), static_cast<long>(bytesPerFrame),
+                         static_cast<long>(size));
+            overflowReported = true;
+        }
+        return allocation;
+    }
+
+    allocation.data = mapped + offset;
+    allocation.offset = offset;
+    head = offset + size;
+    return allocation;
+}
+
+void GpuRingBuffer::bindUniform(GLuint binding, const GpuAllocation& allocation, GLintptr offset, GLsizeiptr size) {
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, allocation.buffer, allocation.offset + offset,
+                      size != 0 ? size : allocation.size - offset);
+}
+
+void GpuRingBuffer::bindStorage(GLuint binding, const GpuAllocation& allocation, GLintptr offset, GLsizeiptr size) {
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, allocation.buffer, allocation.offset + offset,
+                      size != 0 ? size : allocation.size - offset);
+}
@@ -0,0 +1,73 @@
+#ifndef GPU_RING_BUFFER_H
+#define GPU_RING_BUFFER_H
+
+#include <GL/glew.h>
+
+// Slice of a GpuRingBuffer, valid until the end of the frame it was
+// allocated in. data is write-only mapped memory (nullptr if the frame's
+// region ran out).
+struct GpuAllocation {
+    void* data;
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+};
+
+// Per-frame sub-allocator for uniform and storage data. One persistently
+// mapped buffer is split into FramesInFlight regions; a frame bumps through
+// its own region, and a region is reused only once the fence placed at the
+// end of its last frame has signalled, so the CPU never overwrites data the
+// GPU may still be reading. Writing per-draw constants is then a memcpy and
+// a glBindBufferRange, with no glBufferSubData or glUniform* traffic.
+class GpuRingBuffer {
+public:
+    static const unsigned int FramesInFlight = 3;
+
+    GpuRingBuffer();
+    ~GpuRingBuffer();
+
+    bool initialize(GLsizeiptr bytesPerFrame);
+    void cleanup();
+
+    // Waits (rarely) for the GPU to release the region this frame reuses
+    void beginFrame();
+    // Fences the frame's region
+    void endFrame();
+
+    // Offsets honour GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT /
+    // GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+    GpuAllocation allocateUniform(GLsizeiptr size) { return allocate(size, uniformAlignment); }
+    GpuAllocation allocateStorage(GLsizeiptr size) { return allocate(size, storageAlignment); }
+    GpuAllocation allocate(GLsizeiptr size, GLsizeiptr alignment);
+
+    // Element stride for arrays of per-draw uniform blocks bound one element at a time
+    GLsizeiptr alignUniform(GLsizeiptr size) const {
+        return (size + uniformAlignment - 1) / uniformAlignment * uniformAlignment;
+    }
+
+    static void bindUniform(GLuint binding, const GpuAllocation& allocation, GLintptr offset = 0,
+                            GLsizeiptr size = 0);
+    static void bindStorage(GLuint binding, const GpuAllocation& allocation, GLintptr offset = 0,
+                            GLsizeiptr size = 0);
+
+    bool isInitialized() const { return buffer != 0; }
+    GLsizeiptr getBytesPerFrame() const { return bytesPerFrame; }
+    GLsizeiptr getBytesUsed() const { return head - regionStart; }
+    // Frames whose beginFrame() had to block on the GPU
+    unsigned int getNumStalls() const { return numStalls; }
+
+private:
+    GLuint buffer;
+    unsigned char* mapped;
+    GLsizeiptr bytesPerFrame;
+    GLsizeiptr uniformAlignment;
+    GLsizeiptr storageAlignment;
+    GLsync fences[FramesInFlight];
+    unsigned int frameIndex;
+    GLsizeiptr regionStart;
+    GLsizeiptr head;
+    bool overflowReported;
+    unsigned int numStalls;
+};
+
+#endif // GPU_RING_BUFFER_H
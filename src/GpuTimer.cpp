@@ -0,0 +1,79 @@
+#include "GpuTimer.h"
+#include "GLHooks.h"
+
+GpuTimer::GpuTimer(int latency) : current(0), created(false) {
+    QueryPair pair = {0, 0, false};
+    queries.assign(latency > 1 ? latency : 2, pair);
+}
+
+GpuTimer::~GpuTimer() {
+    cleanup();
+}
+
+void GpuTimer::create() {
+    for (size_t i = 0; i < queries.size(); ++i) {
+        glGenQueries(1, &queries[i].start);
+        glGenQueries(1, &queries[i].end);
+    }
+    created = true;
+}
+
+void GpuTimer::begin() {
+    if (!created) {
+        create();
+    }
+
+    // Still unread after a full ring: the driver is far behind, reuse the slot anyway
+    QueryPair& pair = queries[current];
+    pair.pending = false;
+    glQueryCounter(pair.start, GL_TIMESTAMP);
+}
+
+void GpuTimer::end() {
+    QueryPair& pair = queries[current];
+    glQueryCounter(pair.end, GL_TIMESTAMP);
+    pair.pending = true;
+    current = (current + 1) % static_cast<int>(queries.size());
+}
+
+bool GpuTimer::getLatestMs(double& milliseconds) {
+    if (!created) {
+        return false;
+    }
+
+    // Walk from newest to oldest, take the newest finished pair and retire older ones
+    bool found = false;
+    for (size_t i = 1; i <= queries.size(); ++i) {
+        QueryPair& pair = queries[(current + queries.size() - i) % queries.size()];
+        if (!pair.pending) {
+            continue;
+        }
+
+        if (!found) {
+            GLint available = 0;
+            glGetQueryObjectiv(pair.end, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                continue;
+            }
+
+            GLuint64 start = 0, end = 0;
+            glGetQueryObjectui64v(pair.start, GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(pair.end, GL_QUERY_RESULT, &end);
+            milliseconds = (end - start) / 1.0e6;
+            found = true;
+        }
+        pair.pending = false;
+    }
+    return found;
+}
+
+void GpuTimer::cleanup() {
+    if (!created) {
+        return;
+    }
+    for (size_t i = 0; i < queries.size(); ++i) {
+        glDeleteQueries(1, &queries[i].start);
+        glDeleteQueries(1, &queries[i].end);
+    }
+    created = false;
+}
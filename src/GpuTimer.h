@@ -0,0 +1,38 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+// Measures GPU time between begin() and end() with GL_TIMESTAMP queries.
+// Results are read back a few frames later from a ring of query pairs, so
+// reading never stalls; getLatestMs() returns the newest finished sample.
+class GpuTimer {
+public:
+    explicit GpuTimer(int latency = 4);
+    ~GpuTimer();
+
+    void begin();
+    void end();
+
+    // True when a new sample became available since the last call
+    bool getLatestMs(double& milliseconds);
+
+    void cleanup();
+
+private:
+    struct QueryPair {
+        GLuint start;
+        GLuint end;
+        bool pending;
+    };
+
+    std::vector<QueryPair> queries;
+    int current;
+    bool created;
+
+    void create();
+};
+
+#endif // GPU_TIMER_H
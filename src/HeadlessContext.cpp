@@ -0,0 +1,125 @@
+#include "HeadlessContext.h"
+#include "Logger.h"
+
+#include <X11/Xlib.h>
+
+typedef GLXContext (*glXCreateContextAttribsARBProc)(Display *, GLXFBConfig, GLXContext, Bool, const int *);
+
+HeadlessContext::HeadlessContext()
+    : display(nullptr), pbuffer(0), glxContext(nullptr), width(0), height(0)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    destroy();
+}
+
+bool HeadlessContext::create(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+    display = XOpenDisplay(nullptr);
+    if (!display)
+    {
+        logger.Error("HeadlessContext: failed to open X display.");
+        return false;
+    }
+
+    int attribs[] = {
+        GLX_DRAWABLE_TYPE, GLX_PBUFFER_BIT,
+        GLX_RENDER_TYPE, GLX_RGBA_BIT,
+        GLX_RED_SIZE, 8,
+        GLX_GREEN_SIZE, 8,
+        GLX_BLUE_SIZE, 8,
+        GLX_ALPHA_SIZE, 8,
+        GLX_DEPTH_SIZE, 24,
+        GLX_STENCIL_SIZE, 8,
+        None};
+
+    int numFBConfigs = 0;
+    GLXFBConfig *glxFBConfigs = glXChooseFBConfig(display, XDefaultScreen(display), attribs, &numFBConfigs);
+    if (!glxFBConfigs || numFBConfigs == 0)
+    {
+        logger.Error("HeadlessContext: no pbuffer capable FBConfig.");
+        return false;
+    }
+    GLXFBConfig glxFBConfig = glxFBConfigs[0];
+    XFree(glxFBConfigs);
+
+    int pbufferAttribs[] = {
+        GLX_PBUFFER_WIDTH, width,
+        GLX_PBUFFER_HEIGHT, height,
+        None};
+    pbuffer = glXCreatePbuffer(display, glxFBConfig, pbufferAttribs);
+
+    glXCreateContextAttribsARBProc glXCreateContextAttribsARB = (glXCreateContextAttribsARBProc)glXGetProcAddress(
+        (const GLubyte *)"glXCreateContextAttribsARB");
+    if (!glXCreateContextAttribsARB)
+    {
+        logger.Error("HeadlessContext: glXCreateContextAttribsARB unavailable.");
+        return false;
+    }
+
+    // 4.6 first, then 4.5 for older Mesa releases
+    const int versions[][2] = {{4, 6}, {4, 5}};
+    for (int i = 0; i < 2 && !glxContext; i++)
+    {
+        int contextAttribs[] = {
+            GLX_CONTEXT_MAJOR_VERSION_ARB, versions[i][0],
+            GLX_CONTEXT_MINOR_VERSION_ARB, versions[i][1],
+            GLX_CONTEXT_PROFILE_MASK_ARB, GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+            None};
+        glxContext = glXCreateContextAttribsARB(display, glxFBConfig, 0, True, contextAttribs);
+    }
+    if (!glxContext)
+    {
+        logger.Error("HeadlessContext: core profile context cannot be obtained.");
+        return false;
+    }
+
+    if (!glXMakeContextCurrent(display, pbuffer, pbuffer, glxContext))
+    {
+        logger.Error("HeadlessContext: failed to make context current.");
+        return false;
+    }
+
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK)
+    {
+        logger.Error("HeadlessContext: glewInit() failed.");
+        return false;
+    }
+
+    logger.Info("HeadlessContext: %s / %s", reinterpret_cast<const char *>(glGetString(GL_RENDERER)),
+                reinterpret_cast<const char *>(glGetString(GL_VERSION)));
+
+    glViewport(0, 0, width, height);
+    return true;
+}
+
+void HeadlessContext::destroy()
+{
+    if (glxContext)
+    {
+        glXMakeContextCurrent(display, None, None, NULL);
+        glXDestroyContext(display, glxContext);
+        glxContext = nullptr;
+    }
+    if (pbuffer)
+    {
+        glXDestroyPbuffer(display, pbuffer);
+        pbuffer = 0;
+    }
+    if (display)
+    {
+        XCloseDisplay(display);
+        display = nullptr;
+    }
+}
+
+void HeadlessContext::swapBuffers()
+{
+    glXSwapBuffers(display, pbuffer);
+}
@@ -0,0 +1,32 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+// OpenGL Header Files
+#include <GL/glew.h>
+#include <GL/gl.h>
+#include <GL/glx.h>
+
+// Core profile GL context on a GLX pbuffer, for tools that render without a
+// window (trace replay, benchmarks). Still needs an X server, e.g. Xvfb with
+// Mesa llvmpipe on machines without a GPU.
+class HeadlessContext {
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    bool create(int width, int height);
+    void destroy();
+
+    void swapBuffers();
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+private:
+    Display *display;
+    GLXPbuffer pbuffer;
+    GLXContext glxContext;
+    int width, height;
+};
+
+#endif // HEADLESS_CONTEXT_H
@@ -0,0 +1,94 @@
+#include "HeapTracking.h"
+
+#ifdef XWGL_TRACK_HEAP
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Constant-initialized, so they are usable before any static constructor runs
+std::atomic<size_t> heapAllocations(0);
+std::atomic<size_t> heapFrees(0);
+std::atomic<size_t> heapBytes(0);
+
+void* trackedAllocate(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    heapBytes.fetch_add(size, std::memory_order_relaxed);
+    return malloc(size != 0 ? size : 1);
+}
+
+void trackedFree(void* pointer) {
+    if (pointer) {
+        heapFrees.fetch_add(1, std::memory_order_relaxed);
+        free(pointer);
+    }
+}
+
+}
+
+void* operator new(size_t size) {
+    void* pointer = trackedAllocate(size);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](size_t size) {
+    void* pointer = trackedAllocate(size);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    trackedFree(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    trackedFree(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    trackedFree(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    trackedFree(pointer);
+}
+
+bool isHeapTrackingEnabled() {
+    return true;
+}
+
+HeapCounters getHeapCounters() {
+    HeapCounters counters;
+    counters.allocations = heapAllocations.load(std::memory_order_relaxed);
+    counters.frees = heapFrees.load(std::memory_order_relaxed);
+    counters.bytesAllocated = heapBytes.load(std::memory_order_relaxed);
+    return counters;
+}
+
+#else
+
+bool isHeapTrackingEnabled() {
+    return false;
+}
+
+HeapCounters getHeapCounters() {
+    HeapCounters counters = {0, 0, 0};
+    return counters;
+}
+
+#endif
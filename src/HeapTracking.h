@@ -0,0 +1,18 @@
+#ifndef HEAP_TRACKING_H
+#define HEAP_TRACKING_H
+
+#include <cstddef>
+
+// Process-wide operator new/delete counters. They are only fed when the build
+// defines XWGL_TRACK_HEAP (CMake option of the same name), which replaces the
+// global allocation operators; otherwise every count reads zero.
+struct HeapCounters {
+    size_t allocations;
+    size_t frees;
+    size_t bytesAllocated;
+};
+
+bool isHeapTrackingEnabled();
+HeapCounters getHeapCounters();
+
+#endif // HEAP_TRACKING_H
@@ -0,0 +1,328 @@
+#include "Json.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const JsonValue nullValue;
+const std::string emptyString;
+
+// Nesting beyond this is treated as malformed instead of recursing further
+const int MaxDepth = 128;
+
+}
+
+class JsonParser {
+public:
+    JsonParser(const char* text, size_t length) : cursor(text), begin(text), end(text + length) {}
+
+    bool parseDocument(JsonValue& value, std::string& error) {
+        if (!parseValue(value, 0)) {
+            error = message;
+            return false;
+        }
+        skipWhitespace();
+        if (cursor != end) {
+            fail("trailing characters");
+            error = message;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    const char* cursor;
+    const char* begin;
+    const char* end;
+    std::string message;
+
+    bool fail(const char* what) {
+        char buffer[128];
+        snprintf(buffer, sizeof(buffer), "%s at offset %ld", what, static_cast<long>(cursor - begin));
+        message = buffer;
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) {
+            ++cursor;
+        }
+    }
+
+    bool match(const char* literal) {
+        size_t length = strlen(literal);
+        if (static_cast<size_t>(end - cursor) < length || memcmp(cursor, literal, length) != 0) {
+            return false;
+        }
+        cursor += length;
+        return true;
+    }
+
+    bool parseValue(JsonValue& value, int depth) {
+        if (depth > MaxDepth) {
+            return fail("nesting too deep");
+        }
+
+        skipWhitespace();
+        if (cursor >= end) {
+            return fail("unexpected end of input");
+        }
+
+        switch (*cursor) {
+            case '{':
+                return parseObject(value, depth);
+            case '[':
+                return parseArray(value, depth);
+            case '"':
+                value.type = JsonValue::String;
+                return parseString(value.string);
+            case 't':
+                value.type = JsonValue::Bool;
+                value.boolean = true;
+                return match("true") || fail("invalid literal");
+            case 'f':
+                value.type = JsonValue::Bool;
+                value.boolean = false;
+                return match("false") || fail("invalid literal");
+            case 'n':
+                value.type = JsonValue::Null;
+                return match("null") || fail("invalid literal");
+            default:
+                return parseNumber(value);
+        }
+    }
+
+    bool parseNumber(JsonValue& value) {
+        // strtod needs a terminated string; numbers are short, copy them out
+        char buffer[64];
+        size_t length = 0;
+        while (cursor + length < end && length < sizeof(buffer) - 1 &&
+               strchr("+-0123456789.eE", cursor[length]) != nullptr) {
+            buffer[length] = cursor[length];
+            ++length;
+        }
+        buffer[length] = '\0';
+
+        char* numberEnd = nullptr;
+        double number = strtod(buffer, &numberEnd);
+        if (length == 0 || numberEnd != buffer + length) {
+            return fail("invalid number");
+        }
+        cursor += length;
+        value.type = JsonValue::Number;
+        value.number = number;
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, unsigned int codepoint) {
+        if (codepoint < 0x80) {
+            out += static_cast<char>(codepoint);
+        } else if (codepoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codepoint >> 6));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else if (codepoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codepoint >> 12));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codepoint >> 18));
+            out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    bool parseHex4(unsigned int& codepoint) {
+        if (end - cursor < 4) {
+            return fail("truncated escape");
+        }
+        codepoint = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = *cursor++;
+            codepoint <<= 4;
+            if (c >= '0' && c <= '9') {
+                codepoint |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                codepoint |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                codepoint |= c - 'A' + 10;
+            } else {
+                return fail("invalid escape");
+            }
+        }
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        ++cursor; // opening quote
+        while (cursor < end) {
+            char c = *cursor++;
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (cursor >= end) {
+                break;
+            }
+            char escape = *cursor++;
+            switch (escape) {
+                case '"':
+                case '\\':
+                case '/':
+                    out += escape;
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u': {
+                    unsigned int codepoint;
+                    if (!parseHex4(codepoint)) {
+                        return false;
+                    }
+                    // Surrogate pair
+                    if (codepoint >= 0xD800 && codepoint < 0xDC00 && end - cursor >= 6 && cursor[0] == '\\' &&
+                        cursor[1] == 'u') {
+                        cursor += 2;
+                        unsigned int low;
+                        if (!parseHex4(low)) {
+                            return false;
+                        }
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, codepoint);
+                    break;
+                }
+                default:
+                    return fail("invalid escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    bool parseArray(JsonValue& value, int depth) {
+        value.type = JsonValue::Array;
+        ++cursor;
+        skipWhitespace();
+        if (cursor < end && *cursor == ']') {
+            ++cursor;
+            return true;
+        }
+        while (true) {
+            value.elements.push_back(JsonValue());
+            if (!parseValue(value.elements.back(), depth + 1)) {
+                return false;
+            }
+            skipWhitespace();
+            if (cursor < end && *cursor == ',') {
+                ++cursor;
+            } else if (cursor < end && *cursor == ']') {
+                ++cursor;
+                return true;
+            } else {
+                return fail("expected ',' or ']'");
+            }
+        }
+    }
+
+    bool parseObject(JsonValue& value, int depth) {
+        value.type = JsonValue::Object;
+        ++cursor;
+        skipWhitespace();
+        if (cursor < end && *cursor == '}') {
+            ++cursor;
+            return true;
+        }
+        while (true) {
+            skipWhitespace();
+            if (cursor >= end || *cursor != '"') {
+                return fail("expected member name");
+            }
+            value.members.push_back(std::make_pair(std::string(), JsonValue()));
+            if (!parseString(value.members.back().first)) {
+                return false;
+            }
+            skipWhitespace();
+            if (cursor >= end || *cursor != ':') {
+                return fail("expected ':'");
+            }
+            ++cursor;
+            if (!parseValue(value.members.back().second, depth + 1)) {
+                return false;
+            }
+            skipWhitespace();
+            if (cursor < end && *cursor == ',') {
+                ++cursor;
+            } else if (cursor < end && *cursor == '}') {
+                ++cursor;
+                return true;
+            } else {
+                return fail("expected ',' or '}'");
+            }
+        }
+    }
+};
+
+size_t JsonValue::size() const {
+    if (type == Array) {
+        return elements.size();
+    }
+    if (type == Object) {
+        return members.size();
+    }
+    return 0;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+    if (type == Array && index < elements.size()) {
+        return elements[index];
+    }
+    if (type == Object && index < members.size()) {
+        return members[index].second;
+    }
+    return nullValue;
+}
+
+const JsonValue& JsonValue::operator[](const char* key) const {
+    if (type == Object) {
+        for (size_t i = 0; i < members.size(); ++i) {
+            if (members[i].first == key) {
+                return members[i].second;
+            }
+        }
+    }
+    return nullValue;
+}
+
+bool JsonValue::has(const char* key) const {
+    return !(*this)[key].isNull();
+}
+
+const std::string& JsonValue::getKey(size_t index) const {
+    if (type == Object && index < members.size()) {
+        return members[index].first;
+    }
+    return emptyString;
+}
+
+bool JsonValue::parse(const char* text, size_t length, JsonValue& value, std::string& error) {
+    value = JsonValue();
+    JsonParser parser(text, length);
+    return parser.parseDocument(value, error);
+}
@@ -0,0 +1,59 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Small DOM for configuration-sized JSON documents (glTF headers, manifests).
+// Lookups on missing keys or wrong types return a shared null value, so
+// chained access like doc["asset"]["version"].asString() never needs checks in
+// between.
+class JsonValue {
+public:
+    enum Type {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    JsonValue() : type(Null), boolean(false), number(0.0) {}
+
+    Type getType() const { return type; }
+    bool isNull() const { return type == Null; }
+    bool isNumber() const { return type == Number; }
+    bool isString() const { return type == String; }
+    bool isArray() const { return type == Array; }
+    bool isObject() const { return type == Object; }
+
+    bool asBool(bool fallback = false) const { return type == Bool ? boolean : fallback; }
+    double asNumber(double fallback = 0.0) const { return type == Number ? number : fallback; }
+    int asInt(int fallback = 0) const { return type == Number ? static_cast<int>(number) : fallback; }
+    const std::string& asString() const { return string; }
+
+    // Array elements / object members; 0 for other types
+    size_t size() const;
+    const JsonValue& operator[](size_t index) const;
+    const JsonValue& operator[](const char* key) const;
+    bool has(const char* key) const;
+    const std::string& getKey(size_t index) const;
+
+    // Parses a complete document; error describes the first problem with its offset
+    static bool parse(const char* text, size_t length, JsonValue& value, std::string& error);
+
+private:
+    friend class JsonParser;
+
+    Type type;
+    bool boolean;
+    double number;
+    std::string string;
+    std::vector<JsonValue> elements;
+    std::vector<std::pair<std::string, JsonValue>> members;
+};
+
+#endif // JSON_H
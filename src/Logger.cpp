@@ -6,23 +6,12 @@
 Logger logger;
 
 Logger::Logger()
+    : debugFile(nullptr), errorFile(nullptr), shaderFile(nullptr), infoFile(nullptr)
 {
-    if (debugFile == nullptr)
-    {
-        debugFile = openLogFile("logs/debug.log");
-    }
-    if (errorFile == nullptr)
-    {
-        errorFile = openLogFile("logs/error.log");
-    }
-    if (shaderFile == nullptr)
-    {
-        shaderFile = openLogFile("logs/shader.log");
-    }
-    if (infoFile == nullptr)
-    {
-        infoFile = openLogFile("logs/info.log");
-    }
+    debugFile = openLogFile("logs/debug.log");
+    errorFile = openLogFile("logs/error.log");
+    shaderFile = openLogFile("logs/shader.log");
+    infoFile = openLogFile("logs/info.log");
 }
 
 Logger::~Logger()
@@ -59,57 +48,55 @@ FILE *Logger::openLogFile(const char *filename)
     return file;
 }
 
-char *Logger::getCurrentDateTime()
+void Logger::getCurrentDateTime(char *buffer, size_t size)
 {
-    char toReturn[64];
     time_t now;
-    struct tm *timeinfo;
+    struct tm timeinfo;
     time(&now);
-    timeinfo = localtime(&now);
-    strftime(toReturn, sizeof(toReturn), "%Y-%m-%d %H:%M:%S", timeinfo);
-    return toReturn;
+    localtime_r(&now, &timeinfo);
+    strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &timeinfo);
+}
+
+void Logger::write(FILE *file, const char *tag, const char *format, va_list args)
+{
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    char dateTime[64];
+    getCurrentDateTime(dateTime, sizeof(dateTime));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    fprintf(file, "[%s] [%s] ", dateTime, tag);
+    vfprintf(file, format, args);
+    fprintf(file, "\n");
 }
 
 void Logger::Debug(const char* format, ...) {
     va_list args;
     va_start(args, format);
-    
-    fprintf(debugFile, "[%s] [DEBUG] ", getCurrentDateTime());
-    vfprintf(debugFile, format, args);
-    fprintf(debugFile, "\n");
-    
+    write(debugFile, "DEBUG", format, args);
     va_end(args);
 }
 
 void Logger::Error(const char* format, ...) {
     va_list args;
     va_start(args, format);
-    
-    fprintf(errorFile, "[%s] [ERROR] ", getCurrentDateTime());
-    vfprintf(errorFile, format, args);
-    fprintf(errorFile, "\n");
-    
+    write(errorFile, "ERROR", format, args);
     va_end(args);
 }
 
 void Logger::Shader(const char* format, ...) {
     va_list args;
     va_start(args, format);
-    
-    fprintf(shaderFile, "[%s] [SHADER] ", getCurrentDateTime());
-    vfprintf(shaderFile, format, args);
-    fprintf(shaderFile, "\n");
-    
+    write(shaderFile, "SHADER", format, args);
     va_end(args);
 }
 
 void Logger::Info(const char* format, ...) {
     va_list args;
     va_start(args, format);
-    
-    fprintf(infoFile, "[%s] [INFO] ", getCurrentDateTime());
-    vfprintf(infoFile, format, args);
-    fprintf(infoFile, "\n");
-    
+    write(infoFile, "INFO", format, args);
     va_end(args);
-}
\ No newline at end of file
+}
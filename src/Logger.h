@@ -3,6 +3,8 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <mutex>
 
 class Logger {
 public:
@@ -20,8 +22,12 @@ private:
     FILE *shaderFile;
     FILE *infoFile;
 
+    // Serializes the timestamp/message/newline writes so lines from worker threads don't interleave
+    std::mutex mutex;
+
     FILE* openLogFile(const char* filename);
-    char* getCurrentDateTime();
+    void getCurrentDateTime(char* buffer, size_t size);
+    void write(FILE* file, const char* tag, const char* format, va_list args);
 };
 
 // Global instance of Logger
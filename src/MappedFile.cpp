@@ -0,0 +1,57 @@
+#include "MappedFile.h"
+#include "Logger.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() : mapping(nullptr), length(0), modifiedTime(0) {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const char* filePath) {
+    close();
+
+    int fd = ::open(filePath, O_RDONLY);
+    if (fd < 0) {
+        logger.Error("Failed to open file: %s", filePath);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        logger.Error("Failed to stat file or file is empty: %s", filePath);
+        ::close(fd);
+        return false;
+    }
+
+    void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        logger.Error("Failed to map file: %s", filePath);
+        return false;
+    }
+
+    // Parsers and the upload read front to back
+    madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    madvise(address, static_cast<size_t>(info.st_size), MADV_WILLNEED);
+
+    mapping = address;
+    length = static_cast<size_t>(info.st_size);
+    modifiedTime = static_cast<int64_t>(info.st_mtime);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapping) {
+        munmap(mapping, length);
+        mapping = nullptr;
+        length = 0;
+        modifiedTime = 0;
+    }
+}
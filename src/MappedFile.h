@@ -0,0 +1,32 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <stdint.h>
+
+// Read-only mmap of a whole file. The mapping lives until close() or
+// destruction; pointers into data() must not outlive it.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const char* filePath);
+    void close();
+
+    bool isOpen() const { return mapping != nullptr; }
+    const char* data() const { return static_cast<const char*>(mapping); }
+    size_t size() const { return length; }
+    // Source identity used to invalidate derived caches
+    int64_t getModifiedTime() const { return modifiedTime; }
+
+private:
+    void* mapping;
+    size_t length;
+    int64_t modifiedTime;
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+#endif // MAPPED_FILE_H
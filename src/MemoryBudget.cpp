@@ -0,0 +1,277 @@
+#include "MemoryBudget.h"
+#include "Logger.h"
+#include "GLHooks.h"
+
+#include <algorithm>
+#include <cstring>
+
+// GL_NVX_gpu_memory_info / GL_ATI_meminfo tokens, in case glew.h predates them
+#ifndef GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX 0x9047
+#define GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#define GL_GPU_MEMORY_INFO_EVICTION_COUNT_NVX 0x904A
+#define GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX 0x904B
+#endif
+#ifndef GL_TEXTURE_FREE_MEMORY_ATI
+#define GL_VBO_FREE_MEMORY_ATI 0x87FB
+#define GL_TEXTURE_FREE_MEMORY_ATI 0x87FC
+#define GL_RENDERBUFFER_FREE_MEMORY_ATI 0x87FD
+#endif
+
+// Definition of the global memory budget instance
+MemoryBudget memoryBudget;
+
+namespace {
+
+const double BytesPerMB = 1024.0 * 1024.0;
+
+}
+
+MemoryBudget::MemoryBudget()
+    : driverQueryInterval(60), gpuBytes(0), peakGpuBytes(0), budgetBytes(0), driverReserveBytes(0),
+      nextCallbackId(1), frameIndex(0), overBudget(false), unevictableBytes(0) {
+    memset(bytes, 0, sizeof(bytes));
+    memset(peakBytes, 0, sizeof(peakBytes));
+    memset(&driverInfo, 0, sizeof(driverInfo));
+}
+
+const char* MemoryBudget::getCategoryName(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::RenderTarget:
+            return "render targets";
+        case MemoryCategory::Texture:
+            return "textures";
+        case MemoryCategory::Geometry:
+            return "geometry";
+        case MemoryCategory::Uniform:
+            return "uniform buffers";
+        case MemoryCategory::Storage:
+            return "storage buffers";
+        case MemoryCategory::Readback:
+            return "readback buffers";
+        case MemoryCategory::HostFrame:
+            return "host frame arena";
+        case MemoryCategory::HostScratch:
+            return "host scratch";
+        case MemoryCategory::Count:
+            break;
+    }
+    return "unknown";
+}
+
+void MemoryBudget::add(MemoryCategory category, int64_t delta) {
+    int index = static_cast<int>(category);
+    bytes[index] += delta;
+    peakBytes[index] = std::max(peakBytes[index], bytes[index]);
+    if (isGpuCategory(category)) {
+        gpuBytes += delta;
+        peakGpuBytes = std::max(peakGpuBytes, gpuBytes);
+    }
+}
+
+void MemoryBudget::track(std::map<GLuint, Allocation>& objects, MemoryCategory category, GLuint object,
+                         int64_t size) {
+    if (object == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<GLuint, Allocation>::iterator it = objects.find(object);
+    if (it != objects.end()) {
+        add(it->second.category, -it->second.bytes);
+        objects.erase(it);
+    }
+    Allocation allocation = {category, size};
+    objects[object] = allocation;
+    add(category, size);
+}
+
+void MemoryBudget::untrack(std::map<GLuint, Allocation>& objects, GLuint object) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<GLuint, Allocation>::iterator it = objects.find(object);
+    if (it != objects.end()) {
+        add(it->second.category, -it->second.bytes);
+        objects.erase(it);
+    }
+}
+
+void MemoryBudget::trackBuffer(MemoryCategory category, GLuint buffer, int64_t size) {
+    track(buffers, category, buffer, size);
+}
+
+void MemoryBudget::untrackBuffer(GLuint buffer) {
+    untrack(buffers, buffer);
+}
+
+void MemoryBudget::trackTexture(MemoryCategory category, GLuint texture, int64_t size) {
+    track(textures, category, texture, size);
+}
+
+void MemoryBudget::untrackTexture(GLuint texture) {
+    untrack(textures, texture);
+}
+
+void MemoryBudget::addHostBytes(MemoryCategory category, int64_t delta) {
+    std::lock_guard<std::mutex> lock(mutex);
+    add(category, delta);
+}
+
+int MemoryBudget::addEvictionCallback(const EvictionCallback& callback) {
+    std::lock_guard<std::mutex> lock(callbackMutex);
+    Callback entry = {nextCallbackId++, callback};
+    callbacks.push_back(entry);
+    return entry.id;
+}
+
+void MemoryBudget::removeEvictionCallback(int id) {
+    std::lock_guard<std::mutex> lock(callbackMutex);
+    for (size_t i = 0; i < callbacks.size(); ++i) {
+        if (callbacks[i].id == id) {
+            callbacks.erase(callbacks.begin() + i);
+            return;
+        }
+    }
+}
+
+bool MemoryBudget::queryDriver(DriverMemoryInfo& info) const {
+    memset(&info, 0, sizeof(info));
+
+    if (GLEW_NVX_gpu_memory_info) {
+        GLint dedicated = 0, available = 0, evictionCount = 0, evicted = 0;
+        glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &dedicated);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTION_COUNT_NVX, &evictionCount);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX, &evicted);
+        // Reported in KiB
+        info.available = true;
+        info.source = "NVX_gpu_memory_info";
+        info.totalBytes = static_cast<int64_t>(dedicated) * 1024;
+        info.freeBytes = static_cast<int64_t>(available) * 1024;
+        info.evictedBytes = static_cast<int64_t>(evicted) * 1024;
+        info.evictionCount = evictionCount;
+        return true;
+    }
+
+    if (GLEW_ATI_meminfo) {
+        // [0] total free KiB in the pool, [1] largest free block, [2..3] auxiliary memory
+        GLint texture[4] = {0, 0, 0, 0};
+        glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, texture);
+        info.available = true;
+        info.source = "ATI_meminfo";
+        info.freeBytes = static_cast<int64_t>(texture[0]) * 1024;
+        return true;
+    }
+
+    return false;
+}
+
+void MemoryBudget::update() {
+    if (driverQueryInterval > 0 && frameIndex++ % static_cast<unsigned long>(driverQueryInterval) == 0) {
+        DriverMemoryInfo info;
+        queryDriver(info);
+        std::lock_guard<std::mutex> lock(mutex);
+        driverInfo = info;
+    }
+
+    int64_t bytesToFree = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (budgetBytes > 0 && gpuBytes > budgetBytes) {
+            bytesToFree = gpuBytes - budgetBytes;
+        }
+        if (driverReserveBytes > 0 && driverInfo.available && driverInfo.freeBytes < driverReserveBytes) {
+            bytesToFree = std::max(bytesToFree, driverReserveBytes - driverInfo.freeBytes);
+        }
+    }
+
+    if (bytesToFree <= 0) {
+        if (overBudget) {
+            logger.Info("MemoryBudget: back within budget (%.1f MB tracked)", getGpuBytes() / BytesPerMB);
+        }
+        overBudget = false;
+        unevictableBytes = 0;
+        return;
+    }
+
+    if (!overBudget) {
+        logger.Info("MemoryBudget: %.1f MB over budget (%.1f MB tracked, budget %.1f MB, driver free %.1f MB)",
+                    bytesToFree / BytesPerMB, getGpuBytes() / BytesPerMB, budgetBytes / BytesPerMB,
+                    getDriverInfo().freeBytes / BytesPerMB);
+    }
+    overBudget = true;
+
+    // Nothing changed since the callbacks last fell short
+    if (bytesToFree == unevictableBytes) {
+        return;
+    }
+
+    // Callbacks run without the accounting lock, they untrack what they free
+    int64_t freed = 0;
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        for (size_t i = 0; i < callbacks.size() && freed < bytesToFree; ++i) {
+            freed += callbacks[i].callback(bytesToFree - freed);
+        }
+    }
+    if (freed > 0) {
+        logger.Debug("MemoryBudget: eviction freed %.1f MB of %.1f MB", freed / BytesPerMB,
+                     bytesToFree / BytesPerMB);
+    }
+    unevictableBytes = freed < bytesToFree ? bytesToFree - freed : 0;
+    if (unevictableBytes > 0) {
+        logger.Info("MemoryBudget: %.1f MB over budget with nothing left to evict; retrying when usage changes",
+                    unevictableBytes / BytesPerMB);
+    }
+}
+
+int64_t MemoryBudget::getBytes(MemoryCategory category) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bytes[static_cast<int>(category)];
+}
+
+int64_t MemoryBudget::getPeakBytes(MemoryCategory category) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return peakBytes[static_cast<int>(category)];
+}
+
+int64_t MemoryBudget::getGpuBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return gpuBytes;
+}
+
+int64_t MemoryBudget::getPeakGpuBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return peakGpuBytes;
+}
+
+int64_t MemoryBudget::getHostBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    int64_t total = 0;
+    for (int i = static_cast<int>(MemoryCategory::HostFrame); i < static_cast<int>(MemoryCategory::Count); ++i) {
+        total += bytes[i];
+    }
+    return total;
+}
+
+DriverMemoryInfo MemoryBudget::getDriverInfo() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return driverInfo;
+}
+
+void MemoryBudget::logSummary() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    logger.Info("Memory: GPU %.1f MB (peak %.1f MB, budget %s%.1f MB)", gpuBytes / BytesPerMB,
+                peakGpuBytes / BytesPerMB, budgetBytes > 0 ? "" : "none, ", budgetBytes / BytesPerMB);
+    for (int i = 0; i < static_cast<int>(MemoryCategory::Count); ++i) {
+        if (peakBytes[i] == 0) {
+            continue;
+        }
+        logger.Info("  %-18s %9.2f MB (peak %.2f MB)", getCategoryName(static_cast<MemoryCategory>(i)),
+                    bytes[i] / BytesPerMB, peakBytes[i] / BytesPerMB);
+    }
+    if (driverInfo.available) {
+        logger.Info("  driver (%s): %.1f MB free of %.1f MB, %d evictions (%.1f MB)", driverInfo.source,
+                    driverInfo.freeBytes / BytesPerMB, driverInfo.totalBytes / BytesPerMB, driverInfo.evictionCount,
+                    driverInfo.evictedBytes / BytesPerMB);
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// What an allocation is for. GPU categories count towards the budget; host
+// categories are reported alongside so engine-side CPU memory is visible too.
+enum class MemoryCategory {
+    RenderTarget,   // RenderTargetPool attachments
+    Texture,        // sampled asset textures
+    Geometry,       // vertex and index buffers
+    Uniform,        // uniform buffers, GpuRingBuffer
+    Storage,        // shader storage / indirect buffers
+    Readback,       // pixel pack buffers
+    HostFrame,      // FrameArena blocks
+    HostScratch,    // ScratchAllocator blocks (all threads)
+    Count
+};
+
+// Free memory as reported by GL_NVX_gpu_memory_info or GL_ATI_meminfo. The
+// driver's view includes other processes on the same GPU, which the
+// engine's own accounting cannot see.
+struct DriverMemoryInfo {
+    bool available;
+    const char* source;      // "NVX_gpu_memory_info" / "ATI_meminfo"
+    int64_t totalBytes;      // dedicated video memory, 0 if unknown (ATI)
+    int64_t freeBytes;       // currently available
+    int64_t evictedBytes;    // NVX only: bytes the driver has evicted so far
+    int evictionCount;       // NVX only
+};
+
+// Byte accounting for every buffer, texture and render target the engine
+// creates, per category with high-water marks. GL objects are tracked by name
+// (re-tracking a name replaces its size, e.g. after glBufferData
+// re-specification), host memory by deltas. Thread-safe; GL queries and
+// eviction only run from update() on the GL thread.
+//
+// With a budget set (XWGL_GPU_BUDGET_MB) or a driver reserve
+// (XWGL_GPU_RESERVE_MB, free memory the driver must keep reporting), update()
+// calls the registered eviction callbacks in registration order with the
+// number of bytes to free until they have freed enough. When they cannot, it
+// does not ask again until the overage changes. Callbacks run under their own
+// lock, so they must not add or remove callbacks.
+class MemoryBudget {
+public:
+    // Returns the bytes actually freed
+    typedef std::function<int64_t(int64_t bytesToFree)> EvictionCallback;
+
+    MemoryBudget();
+
+    void trackBuffer(MemoryCategory category, GLuint buffer, int64_t bytes);
+    void untrackBuffer(GLuint buffer);
+    void trackTexture(MemoryCategory category, GLuint texture, int64_t bytes);
+    void untrackTexture(GLuint texture);
+    void addHostBytes(MemoryCategory category, int64_t delta);
+
+    void setBudget(int64_t gpuBytes) { budgetBytes = gpuBytes; }
+    void setDriverReserve(int64_t freeBytes) { driverReserveBytes = freeBytes; }
+    int64_t getBudget() const { return budgetBytes; }
+
+    int addEvictionCallback(const EvictionCallback& callback);
+    void removeEvictionCallback(int id);
+
+    // Once per frame on the GL thread: refreshes the driver's view every
+    // driverQueryInterval frames and evicts when over budget
+    void update();
+
+    int64_t getBytes(MemoryCategory category) const;
+    int64_t getPeakBytes(MemoryCategory category) const;
+    int64_t getGpuBytes() const;
+    int64_t getPeakGpuBytes() const;
+    int64_t getHostBytes() const;
+    DriverMemoryInfo getDriverInfo() const;
+    bool queryDriver(DriverMemoryInfo& info) const;
+
+    // Per-category current/peak and the driver's view at info level
+    void logSummary() const;
+
+    static const char* getCategoryName(MemoryCategory category);
+    static bool isGpuCategory(MemoryCategory category) { return category < MemoryCategory::HostFrame; }
+
+    int driverQueryInterval;
+
+private:
+    struct Allocation {
+        MemoryCategory category;
+        int64_t bytes;
+    };
+
+    struct Callback {
+        int id;
+        EvictionCallback callback;
+    };
+
+    mutable std::mutex mutex;
+    // Guards callbacks; held while they run so update() needs no copy of them
+    std::mutex callbackMutex;
+    std::map<GLuint, Allocation> buffers;
+    std::map<GLuint, Allocation> textures;
+    int64_t bytes[static_cast<int>(MemoryCategory::Count)];
+    int64_t peakBytes[static_cast<int>(MemoryCategory::Count)];
+    int64_t gpuBytes;
+    int64_t peakGpuBytes;
+    int64_t budgetBytes;
+    int64_t driverReserveBytes;
+    DriverMemoryInfo driverInfo;
+    std::vector<Callback> callbacks;
+    int nextCallbackId;
+    unsigned long frameIndex;
+    bool overBudget;
+    // Overage left after the last eviction that fell short, 0 if none
+    int64_t unevictableBytes;
+
+    void add(MemoryCategory category, int64_t delta);
+    void track(std::map<GLuint, Allocation>& objects, MemoryCategory category, GLuint object, int64_t bytes);
+    void untrack(std::map<GLuint, Allocation>& objects, GLuint object);
+};
+
+// Global instance of MemoryBudget
+extern MemoryBudget memoryBudget;
+
+#endif // MEMORY_BUDGET_H
@@ -0,0 +1,180 @@
+#include "MeshCache.h"
+#include "Logger.h"
+#include "MeshLoader.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <vector>
+
+const uint32_t MeshCache::Version;
+const char* MeshCache::cacheDirectory = "cache/meshes";
+
+namespace {
+
+const char CacheMagic[4] = {'X', 'W', 'M', 'C'};
+
+inline uint64_t alignTo16(uint64_t offset) {
+    return (offset + 15) & ~static_cast<uint64_t>(15);
+}
+
+bool writePadding(FILE* file, uint64_t from, uint64_t to) {
+    static const char zeros[16] = {0};
+    return to <= from || fwrite(zeros, 1, static_cast<size_t>(to - from), file) == to - from;
+}
+
+}
+
+bool MappedMesh::open(const char* cachePath) {
+    if (!file.open(cachePath)) {
+        return false;
+    }
+
+    // Reject anything that would make the accessors read out of bounds
+    const MeshCacheHeader& header = getHeader();
+    bool valid = file.size() >= sizeof(MeshCacheHeader) && memcmp(header.magic, CacheMagic, 4) == 0 &&
+                 header.version == MeshCache::Version && header.vertexFormat == MeshVertexFormatQuantized &&
+                 header.vertexStride == sizeof(QuantizedVertex) &&
+                 (header.indexSize == 2 || header.indexSize == 4) &&
+                 header.vertexOffset + header.vertexCount * header.vertexStride <= file.size() &&
+                 header.indexOffset + header.indexCount * header.indexSize <= file.size() &&
+                 header.lodCount >= 1 && header.lodCount <= MaxMeshLods;
+    for (uint32_t i = 0; valid && i < header.lodCount; ++i) {
+        valid = static_cast<uint64_t>(header.lods[i].firstIndex) + header.lods[i].indexCount <= header.indexCount;
+    }
+    if (!valid) {
+        logger.Debug("Mesh cache %s is invalid or from another version", cachePath);
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+void MappedMesh::close() {
+    file.close();
+}
+
+std::string MeshCache::getCachePath(const char* sourcePath) {
+    // FNV-1a of the full path keeps same-named assets in different directories apart
+    uint64_t hash = 14695981039346656037ull;
+    for (const char* c = sourcePath; *c; ++c) {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ull;
+    }
+
+    const char* name = strrchr(sourcePath, '/');
+    name = name ? name + 1 : sourcePath;
+
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "-%016llx.mesh", static_cast<unsigned long long>(hash));
+    return std::string(cacheDirectory) + "/" + name + suffix;
+}
+
+bool MeshCache::write(const char* cachePath, const QuantizedMesh& mesh, uint64_t sourceSize,
+                      int64_t sourceModifiedTime) {
+    MeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CacheMagic, 4);
+    header.version = Version;
+    header.vertexFormat = MeshVertexFormatQuantized;
+    header.vertexStride = sizeof(QuantizedVertex);
+    // 16-bit indices halve index bandwidth whenever they can address every vertex
+    header.indexSize = mesh.vertices.size() <= 65536 ? 2 : 4;
+    header.vertexCount = mesh.vertices.size();
+    header.indexCount = mesh.indices.size();
+    header.vertexOffset = alignTo16(sizeof(MeshCacheHeader));
+    header.indexOffset = alignTo16(header.vertexOffset + header.vertexCount * header.vertexStride);
+    header.sourceSize = sourceSize;
+    header.sourceModifiedTime = sourceModifiedTime;
+    memcpy(header.boundsMin, mesh.boundsMin, sizeof(header.boundsMin));
+    memcpy(header.boundsMax, mesh.boundsMax, sizeof(header.boundsMax));
+    memcpy(header.dequantize, mesh.dequantize, sizeof(header.dequantize));
+    if (mesh.lods.empty()) {
+        MeshLod fullDetail = {0, static_cast<uint32_t>(mesh.indices.size()), 0.0f};
+        header.lodCount = 1;
+        header.lods[0] = fullDetail;
+    } else {
+        header.lodCount = static_cast<uint32_t>(std::min<size_t>(mesh.lods.size(), MaxMeshLods));
+        memcpy(header.lods, mesh.lods.data(), header.lodCount * sizeof(MeshLod));
+    }
+
+    // Only the default location needs creating; the meshopt tool writes wherever it is told
+    if (strncmp(cachePath, cacheDirectory, strlen(cacheDirectory)) == 0) {
+        mkdir("cache", 0755);
+        mkdir(cacheDirectory, 0755);
+    }
+
+    // Write next to the target and rename, so readers never map a partial file
+    std::string temporaryPath = std::string(cachePath) + ".tmp";
+    FILE* file = fopen(temporaryPath.c_str(), "wb");
+    if (!file) {
+        logger.Error("Failed to create mesh cache: %s", temporaryPath.c_str());
+        return false;
+    }
+
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   writePadding(file, sizeof(header), header.vertexOffset) &&
+                   fwrite(mesh.vertices.data(), sizeof(QuantizedVertex), mesh.vertices.size(), file) ==
+                       mesh.vertices.size() &&
+                   writePadding(file, header.vertexOffset + header.vertexCount * header.vertexStride, header.indexOffset);
+
+    if (success && header.indexSize == 2) {
+        std::vector<uint16_t> shortIndices(mesh.indices.begin(), mesh.indices.end());
+        success = fwrite(shortIndices.data(), sizeof(uint16_t), shortIndices.size(), file) == shortIndices.size();
+    } else if (success) {
+        success = fwrite(mesh.indices.data(), sizeof(uint32_t), mesh.indices.size(), file) == mesh.indices.size();
+    }
+
+    success = (fclose(file) == 0) && success;
+    if (!success || rename(temporaryPath.c_str(), cachePath) != 0) {
+        logger.Error("Failed to write mesh cache: %s", cachePath);
+        remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::load(const char* sourcePath, MappedMesh& mesh, ThreadPool& threadPool) {
+    // Already built offline (meshopt)
+    size_t pathLength = strlen(sourcePath);
+    if (pathLength > 5 && strcmp(sourcePath + pathLength - 5, ".mesh") == 0) {
+        return mesh.open(sourcePath);
+    }
+
+    std::string cachePath = getCachePath(sourcePath);
+
+    struct stat sourceInfo;
+    bool haveSource = stat(sourcePath, &sourceInfo) == 0;
+
+    if (mesh.open(cachePath.c_str())) {
+        const MeshCacheHeader& header = mesh.getHeader();
+        if (!haveSource || (header.sourceSize == static_cast<uint64_t>(sourceInfo.st_size) &&
+                            header.sourceModifiedTime == static_cast<int64_t>(sourceInfo.st_mtime))) {
+            return true;
+        }
+        logger.Debug("Mesh cache %s is stale, rebuilding", cachePath.c_str());
+        mesh.close();
+    }
+
+    if (!haveSource) {
+        logger.Error("Mesh not found: %s", sourcePath);
+        return false;
+    }
+
+    MeshData data;
+    if (!loadMesh(sourcePath, data, threadPool)) {
+        return false;
+    }
+    optimizeMesh(data);
+
+    QuantizedMesh quantized;
+    quantizeMesh(data, quantized);
+    if (!write(cachePath.c_str(), quantized, static_cast<uint64_t>(sourceInfo.st_size),
+               static_cast<int64_t>(sourceInfo.st_mtime))) {
+        return false;
+    }
+
+    logger.Info("Built mesh cache %s", cachePath.c_str());
+    return mesh.open(cachePath.c_str());
+}
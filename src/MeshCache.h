@@ -0,0 +1,79 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <stdint.h>
+#include <string>
+
+#include "MappedFile.h"
+#include "MeshLoader.h"
+
+struct QuantizedMesh;
+class ThreadPool;
+
+enum MeshVertexFormat {
+    MeshVertexFormatFloat = 0,    // MeshVertex (version 1 caches only)
+    MeshVertexFormatQuantized = 1 // QuantizedVertex, positions undone by MeshCacheHeader::dequantize
+};
+
+// On-disk layout of a cache file: this header, then the vertex blob at
+// vertexOffset and the index blob at indexOffset, both 16-byte aligned and
+// in exactly the form glBufferData expects.
+struct MeshCacheHeader {
+    char magic[4]; // "XWMC"
+    uint32_t version;
+    uint32_t vertexFormat;
+    uint32_t vertexStride;
+    uint32_t indexSize; // 2 or 4 bytes
+    uint32_t lodCount;
+    uint64_t vertexCount;
+    uint64_t indexCount;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    // Identity of the source asset the cache was built from
+    uint64_t sourceSize;
+    int64_t sourceModifiedTime;
+    float boundsMin[3];
+    float boundsMax[3];
+    float dequantize[16]; // column-major, see QuantizedMesh
+    MeshLod lods[MaxMeshLods]; // index ranges, finest first
+};
+
+// A validated cache file mapped in memory
+class MappedMesh {
+public:
+    bool open(const char* cachePath);
+    void close();
+
+    bool isOpen() const { return file.isOpen(); }
+    const MeshCacheHeader& getHeader() const { return *reinterpret_cast<const MeshCacheHeader*>(file.data()); }
+    const void* getVertices() const { return file.data() + getHeader().vertexOffset; }
+    const void* getIndices() const { return file.data() + getHeader().indexOffset; }
+    size_t getVertexBytes() const { return getHeader().vertexCount * getHeader().vertexStride; }
+    size_t getIndexBytes() const { return getHeader().indexCount * getHeader().indexSize; }
+
+private:
+    MappedFile file;
+};
+
+// Binary, GPU-ready mesh cache under cache/meshes/. Parsing a text asset once
+// and then mapping the cache on later runs turns load time into a page-in
+// plus one buffer upload. Cached meshes are optimized and quantized (see
+// MeshOptimizer.h), the same as the meshopt tool's build-time output.
+class MeshCache {
+public:
+    static const uint32_t Version = 3;
+
+    // Maps the cache for sourcePath, (re)building it first when it is missing
+    // or the source's size/modification time changed. A cache whose source has
+    // been removed is still used. A ".mesh" path is mapped as is.
+    static bool load(const char* sourcePath, MappedMesh& mesh, ThreadPool& threadPool);
+
+    static bool write(const char* cachePath, const QuantizedMesh& mesh, uint64_t sourceSize,
+                      int64_t sourceModifiedTime);
+    static std::string getCachePath(const char* sourcePath);
+
+private:
+    static const char* cacheDirectory;
+};
+
+#endif // MESH_CACHE_H
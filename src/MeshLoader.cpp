@@ -0,0 +1,42 @@
+#include "MeshLoader.h"
+#include "Logger.h"
+
+#include <cfloat>
+#include <cstring>
+#include <strings.h>
+
+void MeshData::clear() {
+    vertices.clear();
+    indices.clear();
+    lods.clear();
+    for (int axis = 0; axis < 3; ++axis) {
+        boundsMin[axis] = 0.0f;
+        boundsMax[axis] = 0.0f;
+    }
+}
+
+void MeshData::computeBounds() {
+    for (int axis = 0; axis < 3; ++axis) {
+        boundsMin[axis] = vertices.empty() ? 0.0f : FLT_MAX;
+        boundsMax[axis] = vertices.empty() ? 0.0f : -FLT_MAX;
+    }
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            float value = vertices[i].position[axis];
+            boundsMin[axis] = value < boundsMin[axis] ? value : boundsMin[axis];
+            boundsMax[axis] = value > boundsMax[axis] ? value : boundsMax[axis];
+        }
+    }
+}
+
+bool loadMesh(const char* filePath, MeshData& mesh, ThreadPool& threadPool) {
+    const char* extension = strrchr(filePath, '.');
+    if (extension && strcasecmp(extension, ".obj") == 0) {
+        return loadObj(filePath, mesh, threadPool);
+    }
+    if (extension && (strcasecmp(extension, ".gltf") == 0 || strcasecmp(extension, ".glb") == 0)) {
+        return loadGltf(filePath, mesh, threadPool);
+    }
+    logger.Error("Unsupported mesh format: %s", filePath);
+    return false;
+}
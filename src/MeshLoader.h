@@ -0,0 +1,69 @@
+#ifndef MESH_LOADER_H
+#define MESH_LOADER_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+class ThreadPool;
+
+// Full-precision vertex produced by the loaders; MeshOptimizer quantizes it
+// for the GPU
+struct MeshVertex {
+    float position[3];
+    float normal[3];
+    float texCoord[2];
+    float color[4];
+};
+
+// Vertex attribute locations used by StaticMesh and shaders/mesh/
+enum MeshAttribute {
+    MeshAttributePosition = 0,
+    MeshAttributeNormal = 1,
+    MeshAttributeTexCoord = 2,
+    MeshAttributeColor = 3
+};
+
+// Upper bound on the level-of-detail chain of one mesh
+const unsigned int MaxMeshLods = 8;
+
+// Index range of one level of detail. error is how far (in object-space
+// units) the simplified surface may deviate from the full-detail one.
+struct MeshLod {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;
+};
+
+// Indexed triangle list. Once LODs are generated (see MeshOptimizer.h) the
+// indices hold every level back to back, finest first, all referencing the
+// same vertices; with no lods the whole index list is the only level.
+struct MeshData {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;
+    float boundsMin[3];
+    float boundsMax[3];
+
+    void clear();
+    void computeBounds();
+};
+
+// Wavefront OBJ: v (with optional r g b)/vt/vn/f (polygons are
+// fan-triangulated, negative indices supported). The file is mmapped and
+// split into line-aligned chunks parsed on the thread pool; vertices are
+// deduplicated across the whole file, so the result does not depend on the
+// chunking. Groups, materials and smoothing groups are ignored. chunkBytes
+// overrides the chunk size (0: 1 MiB, SIZE_MAX: a single chunk).
+bool loadObj(const char* filePath, MeshData& mesh, ThreadPool& threadPool, size_t chunkBytes = 0);
+
+// glTF 2.0 (.gltf with external .bin buffers, or .glb): POSITION, NORMAL,
+// TEXCOORD_0 and COLOR_0 of every triangle primitive, merged into one mesh
+// in object space (node transforms are not applied). Accessors are
+// converted in parallel ranges straight out of the mapped buffers.
+bool loadGltf(const char* filePath, MeshData& mesh, ThreadPool& threadPool);
+
+// Picks the loader by file extension
+bool loadMesh(const char* filePath, MeshData& mesh, ThreadPool& threadPool);
+
+#endif // MESH_LOADER_H
@@ -0,0 +1,491 @@
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+const unsigned int MaxCacheSize = 64;
+
+// Levels below this many triangles are not worth a draw of their own
+const size_t MinLodTriangles = 32;
+
+// Cache size used to find cluster boundaries for overdraw ordering; small
+// enough that a boundary really means the strip of reuse was broken
+const unsigned int ClusterCacheSize = 16;
+
+// Forsyth's vertex score: recently used vertices score high (the last
+// triangle's three slightly lower, so strips keep turning), and vertices with
+// few remaining triangles get a boost so they are finished off.
+float vertexScore(int cachePosition, unsigned int activeTriangles, unsigned int cacheSize) {
+    if (activeTriangles == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = 0.75f;
+        } else {
+            float scale = 1.0f / (cacheSize - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scale, 1.5f);
+        }
+    }
+    return score + 2.0f / std::sqrt(static_cast<float>(activeTriangles));
+}
+
+struct VertexHasher {
+    const std::vector<MeshVertex>* vertices;
+
+    size_t operator()(uint32_t index) const {
+        // FNV-1a over the raw bytes; equality below is bitwise too
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&(*vertices)[index]);
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < sizeof(MeshVertex); ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+struct VertexEqual {
+    const std::vector<MeshVertex>* vertices;
+
+    bool operator()(uint32_t a, uint32_t b) const {
+        return memcmp(&(*vertices)[a], &(*vertices)[b], sizeof(MeshVertex)) == 0;
+    }
+};
+
+struct Cluster {
+    uint32_t firstTriangle;
+    uint32_t numTriangles;
+    float sortKey;
+};
+
+bool clusterKeyGreater(const Cluster& a, const Cluster& b) {
+    return a.sortKey > b.sortKey;
+}
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t biasedExponent = static_cast<int32_t>((bits >> 23) & 0xFF);
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (biasedExponent == 0xFF) {
+        return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0)); // inf / NaN
+    }
+
+    int32_t exponent = biasedExponent - 127 + 15;
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7C00); // overflow to infinity
+    }
+    if (exponent <= 0) {
+        // Subnormal half (or zero)
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // Round to nearest; a carry out of the mantissa correctly bumps the exponent
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000) {
+        ++half;
+    }
+    return static_cast<uint16_t>(half);
+}
+
+inline int16_t toSnorm16(float value) {
+    value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+    return static_cast<int16_t>(std::floor(value * 32767.0f + 0.5f));
+}
+
+inline uint8_t toUnorm8(float value) {
+    value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    return static_cast<uint8_t>(std::floor(value * 255.0f + 0.5f));
+}
+
+// Octahedral mapping: project onto |x|+|y|+|z| = 1 and fold the lower
+// hemisphere over the diagonals into the unit square
+void encodeOctahedral(const float normal[3], int16_t encoded[2]) {
+    float x = normal[0], y = normal[1], z = normal[2];
+    float sum = std::fabs(x) + std::fabs(y) + std::fabs(z);
+    if (sum == 0.0f) {
+        encoded[0] = encoded[1] = 0;
+        return;
+    }
+    x /= sum;
+    y /= sum;
+    if (z < 0.0f) {
+        float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+        y = foldedY;
+    }
+    encoded[0] = toSnorm16(x);
+    encoded[1] = toSnorm16(y);
+}
+
+}
+
+void deduplicateVertices(MeshData& mesh) {
+    const uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+    VertexHasher hasher = {&mesh.vertices};
+    VertexEqual equal = {&mesh.vertices};
+    std::unordered_map<uint32_t, uint32_t, VertexHasher, VertexEqual> unique(vertexCount, hasher, equal);
+
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<MeshVertex> vertices;
+    vertices.reserve(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; ++i) {
+        std::pair<std::unordered_map<uint32_t, uint32_t, VertexHasher, VertexEqual>::iterator, bool> inserted =
+            unique.insert(std::make_pair(i, static_cast<uint32_t>(vertices.size())));
+        if (inserted.second) {
+            vertices.push_back(mesh.vertices[i]);
+        }
+        remap[i] = inserted.first->second;
+    }
+
+    for (size_t i = 0; i < mesh.indices.size(); ++i) {
+        mesh.indices[i] = remap[mesh.indices[i]];
+    }
+    mesh.vertices.swap(vertices);
+}
+
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize) {
+    cacheSize = std::max(4u, std::min(cacheSize, MaxCacheSize));
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // Vertex -> triangle adjacency; each vertex's list shrinks as triangles are emitted
+    std::vector<uint32_t> activeCount(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        ++activeCount[indices[i]];
+    }
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        offsets[v + 1] = offsets[v] + activeCount[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i) {
+            adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        scores[v] = vertexScore(-1, activeCount[v], cacheSize);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+
+    uint32_t cache[MaxCacheSize + 3];
+    uint32_t newCache[MaxCacheSize + 3];
+    unsigned int cacheCount = 0;
+    size_t scanCursor = 0;
+    long best = -1;
+
+    while (output.size() < triangleCount * 3) {
+        if (best < 0) {
+            // Nothing adjacent to the cache left: continue with the next unemitted triangle
+            while (emitted[scanCursor]) {
+                ++scanCursor;
+            }
+            best = static_cast<long>(scanCursor);
+        }
+
+        const uint32_t* triangle = &indices[best * 3];
+        emitted[best] = 1;
+        output.insert(output.end(), triangle, triangle + 3);
+
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t v = triangle[corner];
+            uint32_t* list = &adjacency[offsets[v]];
+            for (uint32_t i = 0; i < activeCount[v]; ++i) {
+                if (list[i] == static_cast<uint32_t>(best)) {
+                    list[i] = list[activeCount[v] - 1];
+                    --activeCount[v];
+                    break;
+                }
+            }
+        }
+
+        // Emitted vertices move to the front; anything past cacheSize falls out
+        unsigned int newCount = 0;
+        for (int corner = 0; corner < 3; ++corner) {
+            newCache[newCount++] = triangle[corner];
+        }
+        for (unsigned int i = 0; i < cacheCount; ++i) {
+            uint32_t v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                newCache[newCount++] = v;
+            }
+        }
+
+        for (unsigned int i = 0; i < newCount; ++i) {
+            uint32_t v = newCache[i];
+            cachePosition[v] = i < cacheSize ? static_cast<int>(i) : -1;
+            float score = vertexScore(cachePosition[v], activeCount[v], cacheSize);
+            float delta = score - scores[v];
+            scores[v] = score;
+            for (uint32_t j = 0; j < activeCount[v]; ++j) {
+                triangleScores[adjacency[offsets[v] + j]] += delta;
+            }
+        }
+
+        cacheCount = std::min(newCount, cacheSize);
+        memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+
+        // Next triangle: best score among those touching the cache
+        best = -1;
+        float bestScore = -1.0f;
+        for (unsigned int i = 0; i < cacheCount; ++i) {
+            uint32_t v = cache[i];
+            for (uint32_t j = 0; j < activeCount[v]; ++j) {
+                uint32_t t = adjacency[offsets[v] + j];
+                if (triangleScores[t] > bestScore) {
+                    bestScore = triangleScores[t];
+                    best = static_cast<long>(t);
+                }
+            }
+        }
+    }
+
+    indices.swap(output);
+}
+
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // Cluster boundaries: triangles that miss all three vertices in a FIFO cache
+    std::vector<Cluster> clusters;
+    std::vector<uint32_t> cacheTime(vertices.size(), 0);
+    uint32_t time = ClusterCacheSize + 1;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        int misses = 0;
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t v = indices[t * 3 + corner];
+            if (time - cacheTime[v] > ClusterCacheSize) {
+                cacheTime[v] = time++;
+                ++misses;
+            }
+        }
+        if (t == 0 || misses == 3) {
+            Cluster cluster = {static_cast<uint32_t>(t), 0, 0.0f};
+            clusters.push_back(cluster);
+        }
+        ++clusters.back().numTriangles;
+    }
+
+    if (clusters.size() < 2) {
+        return;
+    }
+
+    // Area-weighted centroid of the whole mesh
+    std::vector<float> clusterData(clusters.size() * 7, 0.0f); // centroid * area (3), area, normal (3)
+    float meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        float* data = &clusterData[c * 7];
+        for (uint32_t t = clusters[c].firstTriangle; t < clusters[c].firstTriangle + clusters[c].numTriangles; ++t) {
+            const float* p0 = vertices[indices[t * 3]].position;
+            const float* p1 = vertices[indices[t * 3 + 1]].position;
+            const float* p2 = vertices[indices[t * 3 + 2]].position;
+            float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float normal[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                               e1[0] * e2[1] - e1[1] * e2[0]};
+            float area = 0.5f * std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (int axis = 0; axis < 3; ++axis) {
+                data[axis] += area * (p0[axis] + p1[axis] + p2[axis]) / 3.0f;
+                data[4 + axis] += normal[axis];
+            }
+            data[3] += area;
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            meshCentroid[axis] += data[axis];
+        }
+        meshArea += data[3];
+    }
+    if (meshArea <= 0.0f) {
+        return;
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        meshCentroid[axis] /= meshArea;
+    }
+
+    // Clusters whose outward side faces away from the center tend to be
+    // occluders when seen from outside, so they go first
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        const float* data = &clusterData[c * 7];
+        float area = data[3] > 0.0f ? data[3] : 1.0f;
+        float normalLength = std::sqrt(data[4] * data[4] + data[5] * data[5] + data[6] * data[6]);
+        float key = 0.0f;
+        if (normalLength > 0.0f) {
+            for (int axis = 0; axis < 3; ++axis) {
+                key += (data[axis] / area - meshCentroid[axis]) * data[4 + axis] / normalLength;
+            }
+        }
+        clusters[c].sortKey = key;
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), clusterKeyGreater);
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        const uint32_t* first = &indices[clusters[c].firstTriangle * 3];
+        output.insert(output.end(), first, first + clusters[c].numTriangles * 3);
+    }
+    indices.swap(output);
+}
+
+void optimizeVertexFetch(MeshData& mesh) {
+    const uint32_t Unassigned = 0xFFFFFFFFu;
+    std::vector<uint32_t> remap(mesh.vertices.size(), Unassigned);
+    std::vector<MeshVertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+
+    // Unreferenced vertices are dropped on the way
+    for (size_t i = 0; i < mesh.indices.size(); ++i) {
+        uint32_t& index = mesh.indices[i];
+        if (remap[index] == Unassigned) {
+            remap[index] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices.swap(vertices);
+}
+
+float computeAcmr(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return 0.0f;
+    }
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        uint32_t v = indices[i];
+        if (time - cacheTime[v] > cacheSize) {
+            cacheTime[v] = time++;
+            ++misses;
+        }
+    }
+    return static_cast<float>(misses) / triangleCount;
+}
+
+void generateLods(MeshData& mesh, const MeshOptimizeOptions& options) {
+    MeshLod fullDetail = {0, static_cast<uint32_t>(mesh.indices.size()), 0.0f};
+    mesh.lods.assign(1, fullDetail);
+
+    float diagonal = 0.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        float extent = mesh.boundsMax[axis] - mesh.boundsMin[axis];
+        diagonal += extent * extent;
+    }
+    const float maxError = options.lodMaxError * std::sqrt(diagonal);
+    const unsigned int maxLods = std::min(options.maxLods, MaxMeshLods);
+
+    // Each level is simplified from the previous one, so errors add up
+    std::vector<uint32_t> previous(mesh.indices);
+    std::vector<uint32_t> simplified;
+    float error = 0.0f;
+    while (mesh.lods.size() < maxLods && previous.size() / 3 > MinLodTriangles) {
+        size_t target = static_cast<size_t>(previous.size() / 3 * options.lodReduction) * 3;
+        float levelError = simplifyMesh(simplified, previous.data(), previous.size(), mesh.vertices, target,
+                                        maxError - error);
+        if (simplified.size() > previous.size() * 9 / 10 || simplified.size() / 3 < MinLodTriangles) {
+            break;
+        }
+        error += levelError;
+
+        optimizeVertexCache(simplified, mesh.vertices.size(), options.cacheSize);
+        MeshLod lod = {static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(simplified.size()), error};
+        mesh.lods.push_back(lod);
+        mesh.indices.insert(mesh.indices.end(), simplified.begin(), simplified.end());
+        previous.swap(simplified);
+    }
+}
+
+void optimizeMesh(MeshData& mesh, const MeshOptimizeOptions& options) {
+    deduplicateVertices(mesh);
+    optimizeVertexCache(mesh.indices, mesh.vertices.size(), options.cacheSize);
+    if (options.optimizeOverdraw) {
+        optimizeOverdraw(mesh.indices, mesh.vertices);
+    }
+    mesh.computeBounds();
+    generateLods(mesh, options);
+    // Full detail comes first in the index list, so it decides the vertex order
+    optimizeVertexFetch(mesh);
+    mesh.computeBounds();
+}
+
+void quantizeMesh(const MeshData& mesh, QuantizedMesh& quantized) {
+    float extent[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        quantized.boundsMin[axis] = mesh.boundsMin[axis];
+        quantized.boundsMax[axis] = mesh.boundsMax[axis];
+        extent[axis] = mesh.boundsMax[axis] - mesh.boundsMin[axis];
+        // Flat axis: any non-zero scale reproduces it exactly
+        if (extent[axis] <= 0.0f) {
+            extent[axis] = 1.0f;
+        }
+    }
+
+    const float dequantize[16] = {extent[0], 0.0f, 0.0f, 0.0f,
+                                  0.0f, extent[1], 0.0f, 0.0f,
+                                  0.0f, 0.0f, extent[2], 0.0f,
+                                  mesh.boundsMin[0], mesh.boundsMin[1], mesh.boundsMin[2], 1.0f};
+    memcpy(quantized.dequantize, dequantize, sizeof(dequantize));
+
+    quantized.vertices.resize(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+        const MeshVertex& source = mesh.vertices[i];
+        QuantizedVertex& target = quantized.vertices[i];
+
+        for (int axis = 0; axis < 3; ++axis) {
+            float normalized = (source.position[axis] - mesh.boundsMin[axis]) / extent[axis];
+            normalized = normalized < 0.0f ? 0.0f : (normalized > 1.0f ? 1.0f : normalized);
+            target.position[axis] = static_cast<uint16_t>(std::floor(normalized * 65535.0f + 0.5f));
+        }
+        target.padding = 0;
+        encodeOctahedral(source.normal, target.normal);
+        target.texCoord[0] = floatToHalf(source.texCoord[0]);
+        target.texCoord[1] = floatToHalf(source.texCoord[1]);
+        for (int c = 0; c < 4; ++c) {
+            target.color[c] = toUnorm8(source.color[c]);
+        }
+    }
+
+    quantized.indices = mesh.indices;
+    quantized.lods = mesh.lods;
+}
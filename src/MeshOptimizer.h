@@ -0,0 +1,78 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "MeshLoader.h"
+
+// 20-byte GPU vertex: positions are unorm16 inside the mesh AABB (undone by
+// QuantizedMesh::dequantize), normals are octahedral snorm16, texture
+// coordinates half floats and colors unorm8. The padding keeps every
+// attribute 4-byte aligned.
+struct QuantizedVertex {
+    uint16_t position[3];
+    uint16_t padding;
+    int16_t normal[2];
+    uint16_t texCoord[2];
+    uint8_t color[4];
+};
+
+struct QuantizedMesh {
+    std::vector<QuantizedVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;
+    // Column-major matrix taking unorm16 positions (as [0, 1]) back to object space
+    float dequantize[16];
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct MeshOptimizeOptions {
+    bool optimizeOverdraw;
+    // Vertex cache size assumed by the reordering
+    unsigned int cacheSize;
+    // Longest LOD chain to generate, full detail included (1 disables LODs)
+    unsigned int maxLods;
+    // Each level aims for this fraction of the previous level's triangles
+    float lodReduction;
+    // Simplification stops at this error, relative to the bounding box diagonal
+    float lodMaxError;
+
+    MeshOptimizeOptions()
+        : optimizeOverdraw(true), cacheSize(32), maxLods(6), lodReduction(0.5f), lodMaxError(0.05f) {}
+};
+
+// Merges bit-identical vertices and remaps the indices
+void deduplicateVertices(MeshData& mesh);
+
+// Forsyth's linear-speed triangle ordering for post-transform vertex cache reuse
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize = 32);
+
+// Sander et al. style overdraw ordering: splits the cache-optimized order into
+// clusters at cache-miss boundaries and draws clusters facing away from the
+// mesh center first, which tends to put occluders in front of what they hide.
+// Keeps most of the vertex cache efficiency since clusters stay intact.
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices);
+
+// Renumbers vertices in first-use order so vertex fetch walks memory linearly
+void optimizeVertexFetch(MeshData& mesh);
+
+// Average cache misses per triangle (ACMR) for a FIFO cache of cacheSize
+// entries: 3.0 without any reuse, ~0.5-0.7 for a well ordered regular mesh
+float computeAcmr(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize);
+
+// Appends simplified levels (see MeshSimplifier.h) after the full-detail
+// indices and fills mesh.lods; each level is vertex cache optimized on its
+// own. Stops early once a level no longer shrinks meaningfully or would
+// exceed the error limit. Expects a mesh without LODs.
+void generateLods(MeshData& mesh, const MeshOptimizeOptions& options = MeshOptimizeOptions());
+
+// deduplicate -> vertex cache -> overdraw -> LODs -> vertex fetch. Expects a
+// freshly loaded mesh (no LODs yet).
+void optimizeMesh(MeshData& mesh, const MeshOptimizeOptions& options = MeshOptimizeOptions());
+
+void quantizeMesh(const MeshData& mesh, QuantizedMesh& quantized);
+
+#endif // MESH_OPTIMIZER_H
@@ -0,0 +1,288 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+// Symmetric 4x4 error quadric: v^T A v + 2 b.v + c, summed over planes
+// weighted by triangle area; weight is the total so the error can be
+// reported as a mean squared distance rather than growing with every merge
+struct Quadric {
+    double a00, a01, a02, a11, a12, a22;
+    double b0, b1, b2;
+    double c;
+    double weight;
+};
+
+void addQuadric(Quadric& target, const Quadric& source) {
+    target.a00 += source.a00;
+    target.a01 += source.a01;
+    target.a02 += source.a02;
+    target.a11 += source.a11;
+    target.a12 += source.a12;
+    target.a22 += source.a22;
+    target.b0 += source.b0;
+    target.b1 += source.b1;
+    target.b2 += source.b2;
+    target.c += source.c;
+    target.weight += source.weight;
+}
+
+// Squared distance to the plane n.v + d = 0 (n normalized), times weight
+Quadric planeQuadric(double nx, double ny, double nz, double d, double weight) {
+    Quadric q;
+    q.a00 = weight * nx * nx;
+    q.a01 = weight * nx * ny;
+    q.a02 = weight * nx * nz;
+    q.a11 = weight * ny * ny;
+    q.a12 = weight * ny * nz;
+    q.a22 = weight * nz * nz;
+    q.b0 = weight * nx * d;
+    q.b1 = weight * ny * d;
+    q.b2 = weight * nz * d;
+    q.c = weight * d * d;
+    q.weight = weight;
+    return q;
+}
+
+// Area-weighted mean squared distance of p to the quadric's planes
+double evaluateQuadric(const Quadric& q, const float* p) {
+    if (q.weight <= 0.0) {
+        return 0.0;
+    }
+    double x = p[0], y = p[1], z = p[2];
+    double result = q.a00 * x * x + 2.0 * q.a01 * x * y + 2.0 * q.a02 * x * z + q.a11 * y * y + 2.0 * q.a12 * y * z +
+                    q.a22 * z * z + 2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+    // Rounding can push the minimum slightly below zero
+    return result > 0.0 ? result / q.weight : 0.0;
+}
+
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    double cost;
+};
+
+bool collapseLess(const Collapse& a, const Collapse& b) {
+    return a.cost < b.cost;
+}
+
+struct PositionHasher {
+    const std::vector<MeshVertex>* vertices;
+
+    size_t operator()(uint32_t index) const {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>((*vertices)[index].position);
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < sizeof(float) * 3; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+struct PositionEqual {
+    const std::vector<MeshVertex>* vertices;
+
+    bool operator()(uint32_t a, uint32_t b) const {
+        return memcmp((*vertices)[a].position, (*vertices)[b].position, sizeof(float) * 3) == 0;
+    }
+};
+
+inline uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+void triangleNormal(const float* p0, const float* p1, const float* p2, float normal[3]) {
+    float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+// Would moving corner `from` of triangle (from, b, c) to `to` turn it over?
+bool collapseFlips(const float* from, const float* b, const float* c, const float* to) {
+    float before[3], after[3];
+    triangleNormal(from, b, c, before);
+    triangleNormal(to, b, c, after);
+    return before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0f;
+}
+
+}
+
+float simplifyMesh(std::vector<uint32_t>& destination, const uint32_t* indices, size_t indexCount,
+                   const std::vector<MeshVertex>& vertices, size_t targetIndexCount, float maxError) {
+    destination.assign(indices, indices + (indexCount - indexCount % 3));
+    const size_t vertexCount = vertices.size();
+
+    // Vertices sharing a position form a seam; they are locked and share one quadric
+    std::vector<uint32_t> positionRemap(vertexCount);
+    std::vector<uint8_t> locked(vertexCount, 0);
+    {
+        PositionHasher hasher = {&vertices};
+        PositionEqual equal = {&vertices};
+        std::unordered_map<uint32_t, uint32_t, PositionHasher, PositionEqual> unique(vertexCount, hasher, equal);
+        for (uint32_t i = 0; i < vertexCount; ++i) {
+            std::pair<std::unordered_map<uint32_t, uint32_t, PositionHasher, PositionEqual>::iterator, bool> inserted =
+                unique.insert(std::make_pair(i, i));
+            positionRemap[i] = inserted.first->second;
+            if (!inserted.second) {
+                locked[i] = 1;
+                locked[inserted.first->second] = 1;
+            }
+        }
+    }
+
+    // Open border: a half-edge whose twin (by position) does not exist
+    {
+        std::unordered_set<uint64_t> halfEdges;
+        halfEdges.reserve(destination.size());
+        for (size_t i = 0; i < destination.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                uint32_t a = destination[i + e], b = destination[i + (e + 1) % 3];
+                halfEdges.insert(edgeKey(positionRemap[a], positionRemap[b]));
+            }
+        }
+        for (size_t i = 0; i < destination.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                uint32_t a = destination[i + e], b = destination[i + (e + 1) % 3];
+                if (halfEdges.find(edgeKey(positionRemap[b], positionRemap[a])) == halfEdges.end()) {
+                    locked[a] = 1;
+                    locked[b] = 1;
+                }
+            }
+        }
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    memset(quadrics.data(), 0, quadrics.size() * sizeof(Quadric));
+    for (size_t i = 0; i < destination.size(); i += 3) {
+        const float* p0 = vertices[destination[i]].position;
+        float normal[3];
+        triangleNormal(p0, vertices[destination[i + 1]].position, vertices[destination[i + 2]].position, normal);
+        double length = std::sqrt(double(normal[0]) * normal[0] + double(normal[1]) * normal[1] +
+                                  double(normal[2]) * normal[2]);
+        if (length == 0.0) {
+            continue;
+        }
+        double nx = normal[0] / length, ny = normal[1] / length, nz = normal[2] / length;
+        Quadric plane = planeQuadric(nx, ny, nz, -(nx * p0[0] + ny * p0[1] + nz * p0[2]), 0.5 * length);
+        for (int corner = 0; corner < 3; ++corner) {
+            addQuadric(quadrics[positionRemap[destination[i + corner]]], plane);
+        }
+    }
+
+    const double maxCost = double(maxError) * maxError;
+    double worstCost = 0.0;
+
+    std::vector<uint32_t> remap(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; ++i) {
+        remap[i] = i;
+    }
+    std::vector<uint8_t> touched(vertexCount);
+    std::vector<uint32_t> offsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+
+    // Each pass performs the cheapest independent collapses, then compacts
+    while (destination.size() > targetIndexCount) {
+        const size_t triangleCount = destination.size() / 3;
+
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (size_t i = 0; i < destination.size(); ++i) {
+            ++offsets[destination[i] + 1];
+        }
+        for (size_t v = 0; v < vertexCount; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        adjacency.resize(destination.size());
+        {
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < destination.size(); ++i) {
+                adjacency[cursor[destination[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        collapses.clear();
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (int e = 0; e < 3; ++e) {
+                uint32_t a = destination[t * 3 + e], b = destination[t * 3 + (e + 1) % 3];
+                for (int direction = 0; direction < 2; ++direction) {
+                    uint32_t from = direction == 0 ? a : b;
+                    uint32_t to = direction == 0 ? b : a;
+                    if (locked[from]) {
+                        continue;
+                    }
+                    Quadric combined = quadrics[positionRemap[from]];
+                    addQuadric(combined, quadrics[positionRemap[to]]);
+                    Collapse collapse = {from, to, evaluateQuadric(combined, vertices[to].position)};
+                    collapses.push_back(collapse);
+                }
+            }
+        }
+        if (collapses.empty()) {
+            break;
+        }
+        std::sort(collapses.begin(), collapses.end(), collapseLess);
+
+        // A collapse removes about two triangles
+        const size_t collapseLimit = (destination.size() - targetIndexCount) / 6 + 1;
+        std::fill(touched.begin(), touched.end(), 0);
+        size_t performed = 0;
+        for (size_t i = 0; i < collapses.size() && performed < collapseLimit; ++i) {
+            const Collapse& collapse = collapses[i];
+            if (collapse.cost > maxCost) {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to]) {
+                continue;
+            }
+
+            bool flips = false;
+            for (uint32_t j = offsets[collapse.from]; j < offsets[collapse.from + 1] && !flips; ++j) {
+                const uint32_t* triangle = &destination[adjacency[j] * 3];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+                    continue; // becomes degenerate and disappears
+                }
+                int corner = triangle[0] == collapse.from ? 0 : (triangle[1] == collapse.from ? 1 : 2);
+                flips = collapseFlips(vertices[collapse.from].position, vertices[triangle[(corner + 1) % 3]].position,
+                                      vertices[triangle[(corner + 2) % 3]].position, vertices[collapse.to].position);
+            }
+            if (flips) {
+                continue;
+            }
+
+            // The one-ring now changes shape, so later collapses this pass stay clear of it
+            for (uint32_t j = offsets[collapse.from]; j < offsets[collapse.from + 1]; ++j) {
+                const uint32_t* triangle = &destination[adjacency[j] * 3];
+                touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+            }
+            touched[collapse.to] = 1;
+
+            remap[collapse.from] = collapse.to;
+            addQuadric(quadrics[positionRemap[collapse.to]], quadrics[positionRemap[collapse.from]]);
+            worstCost = std::max(worstCost, collapse.cost);
+            ++performed;
+        }
+        if (performed == 0) {
+            break;
+        }
+
+        size_t write = 0;
+        for (size_t i = 0; i < destination.size(); i += 3) {
+            uint32_t a = remap[destination[i]], b = remap[destination[i + 1]], c = remap[destination[i + 2]];
+            if (a != b && b != c && a != c) {
+                destination[write++] = a;
+                destination[write++] = b;
+                destination[write++] = c;
+            }
+        }
+        destination.resize(write);
+    }
+
+    return static_cast<float>(std::sqrt(worstCost));
+}
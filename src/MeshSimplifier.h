@@ -0,0 +1,24 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "MeshLoader.h"
+
+// Quadric error metric edge collapse (Garland & Heckbert) that only ever
+// collapses a vertex onto one of its neighbours, so the result indexes the
+// same vertex buffer as the input and LODs can share it. Vertices on open
+// borders or attribute seams (several vertices at one position) never move,
+// which keeps the silhouette of open meshes and avoids texture cracks.
+//
+// Collapses run until at most targetIndexCount indices are left or the next
+// collapse would exceed maxError. Errors are object-space distances (RMS over
+// the area of the planes a vertex has absorbed). Writes the simplified
+// triangles to destination and returns the largest error of the collapses
+// performed.
+float simplifyMesh(std::vector<uint32_t>& destination, const uint32_t* indices, size_t indexCount,
+                   const std::vector<MeshVertex>& vertices, size_t targetIndexCount, float maxError);
+
+#endif // MESH_SIMPLIFIER_H
@@ -0,0 +1,535 @@
+#include "MeshLoader.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+// Chunks smaller than this are not worth a task
+const size_t DefaultChunkBytes = 1 << 20;
+
+// Face corner index that was left out ("f 1//2")
+const int32_t AbsentIndex = INT32_MIN;
+
+enum {
+    RelativePosition = 1,
+    RelativeTexCoord = 2,
+    RelativeNormal = 4
+};
+
+// Positive OBJ indices are global (stored 0-based); negative ones are
+// relative to the elements seen so far, which a chunk only knows locally, so
+// they are stored chunk-local and flagged until the chunk's base is known.
+struct ObjCorner {
+    int32_t position;
+    int32_t texCoord;
+    int32_t normal;
+    uint32_t relativeMask;
+};
+
+struct ObjCornerKey {
+    int32_t position;
+    int32_t texCoord;
+    int32_t normal;
+
+    bool operator==(const ObjCornerKey& other) const {
+        return position == other.position && texCoord == other.texCoord && normal == other.normal;
+    }
+};
+
+struct ObjCornerKeyHash {
+    size_t operator()(const ObjCornerKey& key) const {
+        uint64_t hash = static_cast<uint32_t>(key.position) * 0x9E3779B97F4A7C15ull;
+        hash ^= static_cast<uint32_t>(key.texCoord) * 0xC2B2AE3D27D4EB4Full + (hash << 6) + (hash >> 2);
+        hash ^= static_cast<uint32_t>(key.normal) * 0x165667B19E3779F9ull + (hash << 6) + (hash >> 2);
+        return static_cast<size_t>(hash);
+    }
+};
+
+struct ObjChunk {
+    const char* begin;
+    const char* end;
+
+    std::vector<float> positions;
+    std::vector<float> colors; // parallel to positions, white unless "v x y z r g b"
+    std::vector<float> texCoords;
+    std::vector<float> normals;
+    std::vector<ObjCorner> corners; // three per triangle
+
+    size_t positionBase;
+    size_t texCoordBase;
+    size_t normalBase;
+
+    std::vector<MeshVertex> vertices;
+    std::vector<ObjCornerKey> vertexKeys; // parallel to vertices
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> vertexRemap; // chunk vertex -> mesh vertex
+
+    bool failed;
+};
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && isSpace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// strtof needs a terminated string and honours the locale; the mapping is neither
+bool parseFloat(const char*& p, const char* end, float& value) {
+    static const double powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                                         1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20};
+
+    p = skipSpaces(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    double mantissa = 0.0;
+    int exponent = 0;
+    int digits = 0;
+    while (p < end && isDigit(*p)) {
+        mantissa = mantissa * 10.0 + (*p - '0');
+        ++p;
+        ++digits;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && isDigit(*p)) {
+            mantissa = mantissa * 10.0 + (*p - '0');
+            --exponent;
+            ++p;
+            ++digits;
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            ++p;
+        }
+        int explicitExponent = 0;
+        while (p < end && isDigit(*p)) {
+            explicitExponent = explicitExponent * 10 + (*p - '0');
+            ++p;
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+
+    int magnitude = exponent < 0 ? -exponent : exponent;
+    double scale = magnitude <= 20 ? powersOfTen[magnitude] : std::pow(10.0, magnitude);
+    double result = exponent < 0 ? mantissa / scale : mantissa * scale;
+    value = static_cast<float>(negative ? -result : result);
+    return true;
+}
+
+bool parseInt(const char*& p, const char* end, int32_t& value) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p >= end || !isDigit(*p)) {
+        return false;
+    }
+    int64_t result = 0;
+    while (p < end && isDigit(*p)) {
+        result = result * 10 + (*p - '0');
+        ++p;
+    }
+    value = static_cast<int32_t>(negative ? -result : result);
+    return true;
+}
+
+// Converts a raw OBJ index to the ObjCorner encoding; localCount is the number
+// of elements of that kind this chunk has seen so far
+inline int32_t encodeIndex(int32_t raw, size_t localCount, uint32_t relativeBit, uint32_t& relativeMask) {
+    if (raw < 0) {
+        relativeMask |= relativeBit;
+        return static_cast<int32_t>(localCount) + raw;
+    }
+    return raw - 1;
+}
+
+bool parseFace(const char* p, const char* end, ObjChunk& chunk, std::vector<ObjCorner>& polygon) {
+    polygon.clear();
+    size_t numPositions = chunk.positions.size() / 3;
+    size_t numTexCoords = chunk.texCoords.size() / 2;
+    size_t numNormals = chunk.normals.size() / 3;
+
+    while (true) {
+        p = skipSpaces(p, end);
+        if (p >= end) {
+            break;
+        }
+
+        ObjCorner corner;
+        corner.relativeMask = 0;
+        corner.texCoord = AbsentIndex;
+        corner.normal = AbsentIndex;
+
+        int32_t raw;
+        if (!parseInt(p, end, raw) || raw == 0) {
+            return false;
+        }
+        corner.position = encodeIndex(raw, numPositions, RelativePosition, corner.relativeMask);
+
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p != '/') {
+                if (!parseInt(p, end, raw) || raw == 0) {
+                    return false;
+                }
+                corner.texCoord = encodeIndex(raw, numTexCoords, RelativeTexCoord, corner.relativeMask);
+            }
+            if (p < end && *p == '/') {
+                ++p;
+                if (!parseInt(p, end, raw) || raw == 0) {
+                    return false;
+                }
+                corner.normal = encodeIndex(raw, numNormals, RelativeNormal, corner.relativeMask);
+            }
+        }
+        polygon.push_back(corner);
+    }
+
+    if (polygon.size() < 3) {
+        return false;
+    }
+
+    // Fan triangulation; fine for the convex polygons exporters write
+    for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+        chunk.corners.push_back(polygon[0]);
+        chunk.corners.push_back(polygon[i]);
+        chunk.corners.push_back(polygon[i + 1]);
+    }
+    return true;
+}
+
+void parseChunk(ObjChunk& chunk) {
+    std::vector<ObjCorner> polygon;
+    const char* p = chunk.begin;
+    while (p < chunk.end) {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', chunk.end - p));
+        if (!lineEnd) {
+            lineEnd = chunk.end;
+        }
+
+        p = skipSpaces(p, lineEnd);
+        if (lineEnd - p >= 2 && isSpace(p[1]) && p[0] == 'v') {
+            const char* cursor = p + 1;
+            float x, y, z;
+            if (parseFloat(cursor, lineEnd, x) && parseFloat(cursor, lineEnd, y) && parseFloat(cursor, lineEnd, z)) {
+                chunk.positions.push_back(x);
+                chunk.positions.push_back(y);
+                chunk.positions.push_back(z);
+
+                float r, g, b;
+                if (parseFloat(cursor, lineEnd, r) && parseFloat(cursor, lineEnd, g) && parseFloat(cursor, lineEnd, b)) {
+                    chunk.colors.push_back(r);
+                    chunk.colors.push_back(g);
+                    chunk.colors.push_back(b);
+                } else {
+                    chunk.colors.push_back(1.0f);
+                    chunk.colors.push_back(1.0f);
+                    chunk.colors.push_back(1.0f);
+                }
+            } else {
+                chunk.failed = true;
+            }
+        } else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && isSpace(p[2])) {
+            const char* cursor = p + 2;
+            float u, v = 0.0f;
+            if (parseFloat(cursor, lineEnd, u)) {
+                parseFloat(cursor, lineEnd, v);
+                chunk.texCoords.push_back(u);
+                chunk.texCoords.push_back(v);
+            } else {
+                chunk.failed = true;
+            }
+        } else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && isSpace(p[2])) {
+            const char* cursor = p + 2;
+            float x, y, z;
+            if (parseFloat(cursor, lineEnd, x) && parseFloat(cursor, lineEnd, y) && parseFloat(cursor, lineEnd, z)) {
+                chunk.normals.push_back(x);
+                chunk.normals.push_back(y);
+                chunk.normals.push_back(z);
+            } else {
+                chunk.failed = true;
+            }
+        } else if (lineEnd - p >= 2 && p[0] == 'f' && isSpace(p[1])) {
+            if (!parseFace(p + 1, lineEnd, chunk, polygon)) {
+                chunk.failed = true;
+            }
+        }
+        // Everything else (comments, o/g/s/usemtl/mtllib, l, p) is skipped
+
+        p = lineEnd + 1;
+    }
+}
+
+inline bool resolveIndex(int32_t index, bool relative, size_t base, size_t count, int32_t& resolved) {
+    if (index == AbsentIndex) {
+        resolved = AbsentIndex;
+        return true;
+    }
+    int64_t global = relative ? static_cast<int64_t>(base) + index : index;
+    if (global < 0 || global >= static_cast<int64_t>(count)) {
+        return false;
+    }
+    resolved = static_cast<int32_t>(global);
+    return true;
+}
+
+void buildChunkVertices(ObjChunk& chunk, const std::vector<float>& positions, const std::vector<float>& colors,
+                        const std::vector<float>& texCoords, const std::vector<float>& normals) {
+    std::unordered_map<ObjCornerKey, uint32_t, ObjCornerKeyHash> vertexMap;
+    vertexMap.reserve(chunk.corners.size() / 2);
+    chunk.indices.reserve(chunk.corners.size());
+
+    const size_t numPositions = positions.size() / 3;
+    const size_t numTexCoords = texCoords.size() / 2;
+    const size_t numNormals = normals.size() / 3;
+
+    for (size_t i = 0; i < chunk.corners.size(); ++i) {
+        const ObjCorner& corner = chunk.corners[i];
+        ObjCornerKey key;
+        if (!resolveIndex(corner.position, (corner.relativeMask & RelativePosition) != 0, chunk.positionBase,
+                          numPositions, key.position) ||
+            key.position == AbsentIndex ||
+            !resolveIndex(corner.texCoord, (corner.relativeMask & RelativeTexCoord) != 0, chunk.texCoordBase,
+                          numTexCoords, key.texCoord) ||
+            !resolveIndex(corner.normal, (corner.relativeMask & RelativeNormal) != 0, chunk.normalBase, numNormals,
+                          key.normal)) {
+            chunk.failed = true;
+            return;
+        }
+
+        std::pair<std::unordered_map<ObjCornerKey, uint32_t, ObjCornerKeyHash>::iterator, bool> inserted =
+            vertexMap.insert(std::make_pair(key, static_cast<uint32_t>(chunk.vertices.size())));
+        if (inserted.second) {
+            MeshVertex vertex;
+            memcpy(vertex.position, &positions[key.position * 3], sizeof(vertex.position));
+            memcpy(vertex.color, &colors[key.position * 3], 3 * sizeof(float));
+            vertex.color[3] = 1.0f;
+            if (key.normal != AbsentIndex) {
+                memcpy(vertex.normal, &normals[key.normal * 3], sizeof(vertex.normal));
+            } else {
+                vertex.normal[0] = vertex.normal[1] = vertex.normal[2] = 0.0f;
+            }
+            if (key.texCoord != AbsentIndex) {
+                memcpy(vertex.texCoord, &texCoords[key.texCoord * 2], sizeof(vertex.texCoord));
+            } else {
+                vertex.texCoord[0] = vertex.texCoord[1] = 0.0f;
+            }
+            chunk.vertices.push_back(vertex);
+            chunk.vertexKeys.push_back(key);
+        }
+        chunk.indices.push_back(inserted.first->second);
+    }
+
+    std::vector<ObjCorner>().swap(chunk.corners);
+}
+
+// Area-weighted smooth normals for files without vn records
+void generateNormals(MeshData& mesh) {
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+        MeshVertex& vertex = mesh.vertices[i];
+        vertex.normal[0] = vertex.normal[1] = vertex.normal[2] = 0.0f;
+    }
+
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        MeshVertex* corners[3] = {&mesh.vertices[mesh.indices[i]], &mesh.vertices[mesh.indices[i + 1]],
+                                  &mesh.vertices[mesh.indices[i + 2]]};
+        float edge1[3], edge2[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            edge1[axis] = corners[1]->position[axis] - corners[0]->position[axis];
+            edge2[axis] = corners[2]->position[axis] - corners[0]->position[axis];
+        }
+        float normal[3] = {edge1[1] * edge2[2] - edge1[2] * edge2[1], edge1[2] * edge2[0] - edge1[0] * edge2[2],
+                           edge1[0] * edge2[1] - edge1[1] * edge2[0]};
+        for (int corner = 0; corner < 3; ++corner) {
+            for (int axis = 0; axis < 3; ++axis) {
+                corners[corner]->normal[axis] += normal[axis];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+        float* normal = mesh.vertices[i].normal;
+        float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (length > 0.0f) {
+            normal[0] /= length;
+            normal[1] /= length;
+            normal[2] /= length;
+        }
+    }
+}
+
+}
+
+bool loadObj(const char* filePath, MeshData& mesh, ThreadPool& threadPool, size_t chunkBytes) {
+    mesh.clear();
+
+    MappedFile file;
+    if (!file.open(filePath)) {
+        return false;
+    }
+
+    // Line-aligned chunks, a few per thread so uneven chunks balance out
+    const char* data = file.data();
+    const size_t size = file.size();
+    size_t numChunks = size / (chunkBytes > 0 ? chunkBytes : DefaultChunkBytes);
+    size_t maxChunks = threadPool.getNumThreads() * 4 + 4;
+    numChunks = numChunks < 1 ? 1 : (numChunks > maxChunks ? maxChunks : numChunks);
+
+    std::vector<ObjChunk> chunks(numChunks);
+    const char* chunkBegin = data;
+    for (size_t i = 0; i < numChunks; ++i) {
+        const char* chunkEnd = data + size;
+        if (i + 1 < numChunks) {
+            chunkEnd = data + size * (i + 1) / numChunks;
+            if (chunkEnd < chunkBegin) {
+                chunkEnd = chunkBegin;
+            }
+            const char* newline = static_cast<const char*>(memchr(chunkEnd, '\n', data + size - chunkEnd));
+            chunkEnd = newline ? newline + 1 : data + size;
+        }
+        chunks[i].begin = chunkBegin;
+        chunks[i].end = chunkEnd;
+        chunks[i].failed = false;
+        chunkBegin = chunkEnd;
+    }
+
+    // Pass 1: tokenize every chunk independently
+    threadPool.parallelFor(numChunks, 1, [&chunks](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            parseChunk(chunks[i]);
+        }
+    });
+
+    // Element bases so chunk-relative indices become global
+    size_t numPositions = 0, numTexCoords = 0, numNormals = 0;
+    for (size_t i = 0; i < numChunks; ++i) {
+        if (chunks[i].failed) {
+            logger.Error("Malformed OBJ data in %s", filePath);
+            return false;
+        }
+        chunks[i].positionBase = numPositions;
+        chunks[i].texCoordBase = numTexCoords;
+        chunks[i].normalBase = numNormals;
+        numPositions += chunks[i].positions.size() / 3;
+        numTexCoords += chunks[i].texCoords.size() / 2;
+        numNormals += chunks[i].normals.size() / 3;
+    }
+
+    std::vector<float> positions(numPositions * 3);
+    std::vector<float> colors(numPositions * 3);
+    std::vector<float> texCoords(numTexCoords * 2);
+    std::vector<float> normals(numNormals * 3);
+    threadPool.parallelFor(numChunks, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            ObjChunk& chunk = chunks[i];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionBase * 3);
+            std::copy(chunk.colors.begin(), chunk.colors.end(), colors.begin() + chunk.positionBase * 3);
+            std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + chunk.texCoordBase * 2);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalBase * 3);
+            std::vector<float>().swap(chunk.positions);
+            std::vector<float>().swap(chunk.colors);
+            std::vector<float>().swap(chunk.texCoords);
+            std::vector<float>().swap(chunk.normals);
+        }
+    });
+
+    // Pass 2: resolve indices and build deduplicated vertices per chunk
+    threadPool.parallelFor(numChunks, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            buildChunkVertices(chunks[i], positions, colors, texCoords, normals);
+        }
+    });
+
+    size_t numChunkVertices = 0, numIndices = 0;
+    std::vector<size_t> indexBases(numChunks);
+    for (size_t i = 0; i < numChunks; ++i) {
+        if (chunks[i].failed) {
+            logger.Error("Face index out of range in %s", filePath);
+            return false;
+        }
+        indexBases[i] = numIndices;
+        numChunkVertices += chunks[i].vertices.size();
+        numIndices += chunks[i].indices.size();
+    }
+
+    if (numIndices == 0) {
+        logger.Error("No faces in %s", filePath);
+        return false;
+    }
+
+    // Pass 3: merge the vertices chunks share. Chunks are walked in file
+    // order, so the vertices come out in first-use order exactly as from a
+    // single-chunk parse, and generated normals don't seam at chunk borders.
+    // Only each chunk's unique vertices go through the map.
+    std::unordered_map<ObjCornerKey, uint32_t, ObjCornerKeyHash> vertexMap;
+    vertexMap.reserve(numChunks > 1 ? numChunkVertices : 0);
+    mesh.vertices.reserve(numChunkVertices);
+    for (size_t i = 0; i < numChunks; ++i) {
+        ObjChunk& chunk = chunks[i];
+        chunk.vertexRemap.resize(chunk.vertices.size());
+        for (size_t j = 0; j < chunk.vertices.size(); ++j) {
+            uint32_t vertex = static_cast<uint32_t>(mesh.vertices.size());
+            if (numChunks > 1) {
+                std::pair<std::unordered_map<ObjCornerKey, uint32_t, ObjCornerKeyHash>::iterator, bool> inserted =
+                    vertexMap.insert(std::make_pair(chunk.vertexKeys[j], vertex));
+                vertex = inserted.first->second;
+                if (!inserted.second) {
+                    chunk.vertexRemap[j] = vertex;
+                    continue;
+                }
+            }
+            mesh.vertices.push_back(chunk.vertices[j]);
+            chunk.vertexRemap[j] = vertex;
+        }
+        std::vector<MeshVertex>().swap(chunk.vertices);
+        std::vector<ObjCornerKey>().swap(chunk.vertexKeys);
+    }
+
+    mesh.indices.resize(numIndices);
+    threadPool.parallelFor(numChunks, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const ObjChunk& chunk = chunks[i];
+            for (size_t j = 0; j < chunk.indices.size(); ++j) {
+                mesh.indices[indexBases[i] + j] = chunk.vertexRemap[chunk.indices[j]];
+            }
+        }
+    });
+
+    if (numNormals == 0) {
+        generateNormals(mesh);
+    }
+    mesh.computeBounds();
+
+    logger.Debug("Loaded %s: %zu vertices, %zu triangles, %zu chunks", filePath, mesh.vertices.size(),
+                 mesh.indices.size() / 3, numChunks);
+    return true;
+}
@@ -0,0 +1,105 @@
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "AllocatorStats.h"
+
+// Fixed-size slot allocator for long-lived objects of one type (GL handle
+// wrappers such as StaticMesh). Slots come from blocks of SlotsPerBlock and
+// are recycled through a free list, so creating and destroying objects at
+// runtime does not fragment the heap and, once a block exists, does not touch
+// it at all. Objects never move; pointers stay valid until destroy().
+template <typename T, size_t SlotsPerBlock = 32>
+class ObjectPool {
+public:
+    ObjectPool() : freeList(nullptr), numLive(0) {}
+
+    // Objects still alive are destroyed with the pool
+    ~ObjectPool() {
+        clear();
+    }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        if (!freeList) {
+            grow();
+        }
+        Slot* slot = freeList;
+        freeList = slot->next;
+        slot->live = true;
+        ++numLive;
+        ++stats.allocations;
+        stats.bytesInUse += sizeof(T);
+        if (stats.bytesInUse > stats.peakBytes) {
+            stats.peakBytes = stats.bytesInUse;
+        }
+        return new (&slot->storage) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T* object) {
+        if (!object) {
+            return;
+        }
+        object->~T();
+        // storage is the slot's first member
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->live = false;
+        slot->next = freeList;
+        freeList = slot;
+        --numLive;
+        stats.bytesInUse -= sizeof(T);
+    }
+
+    // Destroys every live object and releases the blocks
+    void clear() {
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            for (size_t i = 0; i < SlotsPerBlock; ++i) {
+                if (blocks[b][i].live) {
+                    reinterpret_cast<T*>(&blocks[b][i].storage)->~T();
+                }
+            }
+            delete[] blocks[b];
+        }
+        blocks.clear();
+        freeList = nullptr;
+        numLive = 0;
+        stats.bytesInUse = 0;
+    }
+
+    size_t size() const { return numLive; }
+    size_t getCapacity() const { return blocks.size() * SlotsPerBlock; }
+    const AllocatorStats& getStats() const { return stats; }
+
+private:
+    struct Slot {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        Slot* next;
+        bool live;
+    };
+
+    std::vector<Slot*> blocks;
+    Slot* freeList;
+    size_t numLive;
+    AllocatorStats stats;
+
+    void grow() {
+        Slot* block = new Slot[SlotsPerBlock];
+        ++stats.heapAllocations;
+        for (size_t i = 0; i < SlotsPerBlock; ++i) {
+            block[i].live = false;
+            block[i].next = i + 1 < SlotsPerBlock ? &block[i + 1] : freeList;
+        }
+        freeList = block;
+        blocks.push_back(block);
+    }
+
+    ObjectPool(const ObjectPool&);
+    ObjectPool& operator=(const ObjectPool&);
+};
+
+#endif // OBJECT_POOL_H
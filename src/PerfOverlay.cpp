@@ -0,0 +1,364 @@
+#include "PerfOverlay.h"
+#include "GLDebug.h"
+#include "GLHooks.h"
+#include "HeapTracking.h"
+#include "Logger.h"
+#include "MemoryBudget.h"
+#include "OverlayFont.h"
+#include "ShaderLibrary.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const uint32_t PanelColor = 0x000000B0;
+const uint32_t TextColor = 0xE0E0E0FF;
+const uint32_t LabelColor = 0x80C0FFFF;
+const uint32_t GoodColor = 0x40D040FF;
+const uint32_t SlowColor = 0xE0C040FF;
+const uint32_t BadColor = 0xE04040FF;
+const uint32_t TargetLineColor = 0xFFFFFF60;
+
+// Graph full height and the target line
+const float GraphMaxMs = 33.3f;
+const float TargetMs = 16.7f;
+
+const int NumTextLines = 5;
+
+}
+
+namespace {
+
+// Vertex inputs of shaders/overlay/ as the VAO lays out Vertex
+enum OverlayAttribute {
+    OverlayAttributePosition = 0,
+    OverlayAttributeTexel = 1,
+    OverlayAttributeColor = 2,
+    NumOverlayAttributes
+};
+
+constexpr ShaderAttribute overlayAttributes[] = {
+    {"aPosition", OverlayAttributePosition, GL_FLOAT_VEC2},
+    {"aTexel", OverlayAttributeTexel, GL_FLOAT_VEC2},
+    {"aColor", OverlayAttributeColor, GL_FLOAT_VEC4},
+};
+
+static_assert(countOf(overlayAttributes) == NumOverlayAttributes, "every overlay attribute needs a table entry");
+static_assert(attributeLocationsUnique(overlayAttributes, countOf(overlayAttributes)),
+              "duplicate overlay attribute location");
+
+// Slots of overlayUniforms
+enum OverlayUniform {
+    OverlayUniformViewport,
+    OverlayUniformAtlas
+};
+
+constexpr ShaderUniform overlayUniforms[] = {
+    {"uViewport", 0, GL_FLOAT_VEC4},
+    {"uAtlas", 1, GL_SAMPLER_2D}, // layout(binding = 0), texture unit 0 in draw()
+};
+
+const ShaderInterface overlayInterface = {overlayAttributes, countOf(overlayAttributes), overlayUniforms,
+                                          countOf(overlayUniforms), nullptr, 0, nullptr, 0};
+
+}
+
+PerfOverlay::PerfOverlay()
+    : shader(nullptr), vao(0), indexBuffer(0), atlasTexture(0), scale(2), numQuads(0), historyHead(0), accumulatedFrames(0),
+      gpuSamples(0), cpuMs(0.0) {
+    solidTexel[0] = solidTexel[1] = 0;
+    memset(frameHistory, 0, sizeof(frameHistory));
+    memset(&accumulated, 0, sizeof(accumulated));
+    memset(&shown, 0, sizeof(shown));
+    shown.gpuMs = -1.0;
+}
+
+PerfOverlay::~PerfOverlay() {
+    cleanup();
+}
+
+bool PerfOverlay::initialize(int scale) {
+    this->scale = std::max(scale, 1);
+
+    shader = shaderLibrary.get("overlay", overlayInterface);
+    if (shader == nullptr) {
+        logger.Error("Performance overlay disabled: the overlay program did not build");
+        return false;
+    }
+
+    buildAtlas();
+
+    // Every quad is two triangles of its four vertices; the index buffer never changes
+    std::vector<uint16_t> indices(MaxQuads * 6);
+    for (int quad = 0; quad < MaxQuads; ++quad) {
+        uint16_t first = static_cast<uint16_t>(quad * 4);
+        uint16_t* index = &indices[quad * 6];
+        index[0] = first;
+        index[1] = first + 1;
+        index[2] = first + 2;
+        index[3] = first;
+        index[4] = first + 2;
+        index[5] = first + 3;
+    }
+
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glDebug.label(GL_VERTEX_ARRAY, vao, "PerfOverlay");
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+    memoryBudget.trackBuffer(MemoryCategory::Geometry, indexBuffer,
+                             static_cast<int64_t>(indices.size() * sizeof(uint16_t)));
+    glDebug.label(GL_BUFFER, indexBuffer, "PerfOverlay indices");
+
+    // Vertex data comes from the ring buffer at a different offset each frame
+    glVertexAttribFormat(OverlayAttributePosition, 2, GL_SHORT, GL_FALSE, offsetof(Vertex, position));
+    glVertexAttribFormat(OverlayAttributeTexel, 2, GL_UNSIGNED_SHORT, GL_FALSE, offsetof(Vertex, texel));
+    glVertexAttribFormat(OverlayAttributeColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Vertex, color));
+    for (GLuint attribute = 0; attribute < NumOverlayAttributes; ++attribute) {
+        glVertexAttribBinding(attribute, 0);
+        glEnableVertexAttribArray(attribute);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    vertices.resize(MaxQuads * 4);
+    return true;
+}
+
+void PerfOverlay::buildAtlas() {
+    // Glyphs in 8x8 cells, 16 per row; the cell after '~' is solid for rectangles
+    const int numCells = OverlayFontNumChars + 1;
+    const int atlasWidth = AtlasColumns * AtlasCellSize;
+    const int atlasHeight = (numCells + AtlasColumns - 1) / AtlasColumns * AtlasCellSize;
+    std::vector<uint8_t> pixels(atlasWidth * atlasHeight, 0);
+
+    for (int glyph = 0; glyph < numCells; ++glyph) {
+        int cellX = glyph % AtlasColumns * AtlasCellSize;
+        int cellY = glyph / AtlasColumns * AtlasCellSize;
+        for (int row = 0; row < AtlasCellSize; ++row) {
+            for (int column = 0; column < AtlasCellSize; ++column) {
+                bool set = glyph == OverlayFontNumChars ||
+                           (row < OverlayFontGlyphHeight && column < OverlayFontGlyphWidth &&
+                            (overlayFontGlyphs[glyph][row] >> (OverlayFontGlyphWidth - 1 - column)) & 1);
+                pixels[(cellY + row) * atlasWidth + cellX + column] = set ? 255 : 0;
+            }
+        }
+    }
+    solidTexel[0] = static_cast<uint16_t>(OverlayFontNumChars % AtlasColumns * AtlasCellSize + AtlasCellSize / 2);
+    solidTexel[1] = static_cast<uint16_t>(OverlayFontNumChars / AtlasColumns * AtlasCellSize + AtlasCellSize / 2);
+
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, atlasWidth, atlasHeight);
+    glDebug.label(GL_TEXTURE, atlasTexture, "PerfOverlay font atlas");
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, atlasWidth, atlasHeight, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    memoryBudget.trackTexture(MemoryCategory::Texture, atlasTexture, static_cast<int64_t>(pixels.size()));
+}
+
+void PerfOverlay::cleanup() {
+    if (vao != 0) {
+        glDeleteVertexArrays(1, &vao);
+        vao = 0;
+    }
+    if (indexBuffer != 0) {
+        memoryBudget.untrackBuffer(indexBuffer);
+        glDeleteBuffers(1, &indexBuffer);
+        indexBuffer = 0;
+    }
+    if (atlasTexture != 0) {
+        memoryBudget.untrackTexture(atlasTexture);
+        glDeleteTextures(1, &atlasTexture);
+        atlasTexture = 0;
+    }
+    shader = nullptr;
+}
+
+void PerfOverlay::addFrame(const PerfOverlayStats& stats) {
+    frameHistory[historyHead] = static_cast<float>(stats.frameMs);
+    historyHead = (historyHead + 1) % HistorySize;
+
+    accumulated.frameMs += stats.frameMs;
+    accumulated.cpuMs += stats.cpuMs;
+    if (stats.gpuMs >= 0.0) {
+        accumulated.gpuMs += stats.gpuMs;
+        ++gpuSamples;
+    }
+    accumulated.heapAllocations += stats.heapAllocations;
+    if (++accumulatedFrames < RefreshFrames) {
+        return;
+    }
+
+    // Counts and memory as of the newest frame, timings averaged
+    shown = stats;
+    shown.frameMs = accumulated.frameMs / accumulatedFrames;
+    shown.cpuMs = accumulated.cpuMs / accumulatedFrames;
+    shown.gpuMs = gpuSamples > 0 ? accumulated.gpuMs / gpuSamples : -1.0;
+    shown.heapAllocations = accumulated.heapAllocations / accumulatedFrames;
+    memset(&accumulated, 0, sizeof(accumulated));
+    accumulatedFrames = 0;
+    gpuSamples = 0;
+}
+
+void PerfOverlay::addQuad(int x0, int y0, int x1, int y1, int u0, int v0, int u1, int v1, uint32_t color) {
+    if (numQuads == MaxQuads) {
+        return;
+    }
+    Vertex* quad = &vertices[numQuads++ * 4];
+    const int corners[4][4] = {{x0, y0, u0, v0}, {x1, y0, u1, v0}, {x1, y1, u1, v1}, {x0, y1, u0, v1}};
+    for (int i = 0; i < 4; ++i) {
+        quad[i].position[0] = static_cast<int16_t>(corners[i][0]);
+        quad[i].position[1] = static_cast<int16_t>(corners[i][1]);
+        quad[i].texel[0] = static_cast<uint16_t>(corners[i][2]);
+        quad[i].texel[1] = static_cast<uint16_t>(corners[i][3]);
+        quad[i].color[0] = static_cast<uint8_t>(color >> 24);
+        quad[i].color[1] = static_cast<uint8_t>(color >> 16);
+        quad[i].color[2] = static_cast<uint8_t>(color >> 8);
+        quad[i].color[3] = static_cast<uint8_t>(color);
+    }
+}
+
+void PerfOverlay::addRect(int x, int y, int width, int height, uint32_t color) {
+    if (width > 0 && height > 0) {
+        addQuad(x, y, x + width, y + height, solidTexel[0], solidTexel[1], solidTexel[0], solidTexel[1], color);
+    }
+}
+
+int PerfOverlay::addText(int x, int y, const char* text, uint32_t color) {
+    const int advance = (OverlayFontGlyphWidth + 1) * scale;
+    for (const char* c = text; *c; ++c, x += advance) {
+        int glyph = static_cast<unsigned char>(*c) - OverlayFontFirstChar;
+        if (glyph <= 0 || glyph >= OverlayFontNumChars) {
+            continue; // space or unprintable
+        }
+        int u = glyph % AtlasColumns * AtlasCellSize;
+        int v = glyph / AtlasColumns * AtlasCellSize;
+        addQuad(x, y, x + OverlayFontGlyphWidth * scale, y + OverlayFontGlyphHeight * scale, u, v,
+                u + OverlayFontGlyphWidth, v + OverlayFontGlyphHeight, color);
+    }
+    return x;
+}
+
+void PerfOverlay::render(int width, int height, GpuRingBuffer& ring) {
+    if (!isInitialized() || width <= 0 || height <= 0) {
+        return;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    const int padding = 4 * scale;
+    const int lineHeight = (OverlayFontGlyphHeight + 2) * scale;
+    const int graphWidth = HistorySize * scale;
+    const int graphHeight = 24 * scale;
+    const int panelWidth = std::max(graphWidth, 30 * (OverlayFontGlyphWidth + 1) * scale) + 2 * padding;
+    const int panelHeight = padding + NumTextLines * lineHeight + graphHeight + padding;
+    const int left = 8, top = 8;
+
+    numQuads = 0;
+    addRect(left, top, panelWidth, panelHeight, PanelColor);
+
+    char text[64];
+    int x = left + padding;
+    int y = top + padding;
+    double fps = shown.frameMs > 0.0 ? 1000.0 / shown.frameMs : 0.0;
+    x = addText(x, y, "frame ", LabelColor);
+    snprintf(text, sizeof(text), "%6.2f ms  %5.0f fps", shown.frameMs, fps);
+    addText(x, y, text, TextColor);
+
+    x = left + padding;
+    y += lineHeight;
+    x = addText(x, y, "cpu   ", LabelColor);
+    snprintf(text, sizeof(text), "%6.2f ms  ", shown.cpuMs);
+    x = addText(x, y, text, TextColor);
+    x = addText(x, y, "gpu ", LabelColor);
+    if (shown.gpuMs >= 0.0) {
+        snprintf(text, sizeof(text), "%6.2f ms", shown.gpuMs);
+    } else {
+        snprintf(text, sizeof(text), "  n/a");
+    }
+    addText(x, y, text, TextColor);
+
+    x = left + padding;
+    y += lineHeight;
+    x = addText(x, y, "draws ", LabelColor);
+    snprintf(text, sizeof(text), "%6u     ", shown.drawCalls);
+    x = addText(x, y, text, TextColor);
+    x = addText(x, y, "tris ", LabelColor);
+    snprintf(text, sizeof(text), "%.1fk", shown.triangles / 1000.0);
+    addText(x, y, text, TextColor);
+
+    x = left + padding;
+    y += lineHeight;
+    x = addText(x, y, "vram  ", LabelColor);
+    snprintf(text, sizeof(text), "%6.1f MB  ", shown.gpuMemoryBytes / (1024.0 * 1024.0));
+    x = addText(x, y, text, TextColor);
+    x = addText(x, y, "host ", LabelColor);
+    snprintf(text, sizeof(text), "%.1f MB", shown.hostMemoryBytes / (1024.0 * 1024.0));
+    addText(x, y, text, TextColor);
+
+    x = left + padding;
+    y += lineHeight;
+    x = addText(x, y, "heap  ", LabelColor);
+    if (isHeapTrackingEnabled()) {
+        snprintf(text, sizeof(text), "%6zu/fr   ", shown.heapAllocations);
+    } else {
+        snprintf(text, sizeof(text), "   n/a     ");
+    }
+    x = addText(x, y, text, TextColor);
+    x = addText(x, y, "self ", LabelColor);
+    snprintf(text, sizeof(text), "%.3f ms", cpuMs);
+    addText(x, y, text, TextColor);
+
+    // Frame time graph, oldest sample on the left
+    const int graphLeft = left + padding;
+    const int graphTop = y + lineHeight;
+    for (int i = 0; i < HistorySize; ++i) {
+        float ms = frameHistory[(historyHead + i) % HistorySize];
+        int barHeight = static_cast<int>(std::min(ms / GraphMaxMs, 1.0f) * graphHeight);
+        uint32_t color = ms <= TargetMs ? GoodColor : (ms <= GraphMaxMs ? SlowColor : BadColor);
+        addRect(graphLeft + i * scale, graphTop + graphHeight - barHeight, scale, barHeight, color);
+    }
+    addRect(graphLeft, graphTop + graphHeight - static_cast<int>(TargetMs / GraphMaxMs * graphHeight), graphWidth,
+            1, TargetLineColor);
+
+    const GLsizeiptr bytes = numQuads * 4 * sizeof(Vertex);
+    GpuAllocation allocation = ring.allocate(bytes, sizeof(uint32_t));
+    if (allocation.data == nullptr) {
+        return;
+    }
+    memcpy(allocation.data, vertices.data(), bytes);
+
+    const GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    const GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    shader->use();
+    const float viewport[4] = {2.0f / width, 2.0f / height, 0.0f, 0.0f};
+    shader->setUniformVector4(OverlayUniformViewport, viewport);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glBindVertexArray(vao);
+    glBindVertexBuffer(0, allocation.buffer, allocation.offset, sizeof(Vertex));
+    glDrawElements(GL_TRIANGLES, numQuads * 6, GL_UNSIGNED_SHORT, nullptr);
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    if (depthTest) {
+        glEnable(GL_DEPTH_TEST);
+    }
+    if (!blend) {
+        glDisable(GL_BLEND);
+    }
+
+    cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,89 @@
+#ifndef PERF_OVERLAY_H
+#define PERF_OVERLAY_H
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+#include "GpuRingBuffer.h"
+#include "Shader.h"
+
+// One frame's numbers as the overlay shows them
+struct PerfOverlayStats {
+    double frameMs;          // wall time since the previous frame
+    double cpuMs;            // render() up to the buffer swap
+    double gpuMs;            // GPU time of the frame's passes; < 0 while no sample is ready
+    unsigned int drawCalls;
+    uint64_t triangles;
+    int64_t gpuMemoryBytes;  // MemoryBudget tracked totals
+    int64_t hostMemoryBytes;
+    size_t heapAllocations;  // operator new calls (XWGL_TRACK_HEAP builds)
+};
+
+// In-window diagnostics: frame time graph plus CPU/GPU timings, draw counts
+// and memory. Text comes from a glyph atlas built once from the embedded 5x7
+// font (OverlayFont.h); text, panel and graph bars are all quads of one vertex
+// format written to the frame's GpuRingBuffer region, so the whole overlay is
+// a single glDrawElements with no buffer uploads or per-glyph state changes.
+// Numbers are averaged and the text refreshed every RefreshFrames frames to
+// keep it readable; the graph updates every frame. The overlay reports its
+// own CPU cost in its last line.
+class PerfOverlay {
+public:
+    static const int HistorySize = 120;
+    static const int RefreshFrames = 15;
+
+    PerfOverlay();
+    ~PerfOverlay();
+
+    // Needs a current GL context; scale is the integer glyph magnification
+    bool initialize(int scale = 2);
+    void cleanup();
+    bool isInitialized() const { return vao != 0; }
+
+    void addFrame(const PerfOverlayStats& stats);
+
+    // Draws into the bound framebuffer over the whole viewport
+    void render(int width, int height, GpuRingBuffer& ring);
+
+    // CPU time of the last render() call
+    double getCpuMs() const { return cpuMs; }
+
+private:
+    static const int MaxQuads = 2048;
+    static const int AtlasColumns = 16;
+    static const int AtlasCellSize = 8;
+
+    struct Vertex {
+        int16_t position[2];  // pixels
+        uint16_t texel[2];    // atlas texels
+        uint8_t color[4];
+    };
+
+    Shader* shader; // owned by shaderLibrary
+    GLuint vao;
+    GLuint indexBuffer;
+    GLuint atlasTexture;
+    int scale;
+    uint16_t solidTexel[2];
+
+    std::vector<Vertex> vertices;
+    int numQuads;
+
+    float frameHistory[HistorySize];
+    int historyHead;
+    PerfOverlayStats accumulated;
+    int accumulatedFrames;
+    int gpuSamples;
+    PerfOverlayStats shown;
+    double cpuMs;
+
+    void buildAtlas();
+    void addQuad(int x0, int y0, int x1, int y1, int u0, int v0, int u1, int v1, uint32_t color);
+    void addRect(int x, int y, int width, int height, uint32_t color);
+    // Returns the x after the last glyph
+    int addText(int x, int y, const char* text, uint32_t color);
+};
+
+#endif // PERF_OVERLAY_H
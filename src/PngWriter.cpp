@@ -0,0 +1,133 @@
+#include "PngWriter.h"
+#include "Logger.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef XWGL_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+static void appendBigEndian(std::vector<unsigned char>& out, unsigned int value) {
+    out.push_back(static_cast<unsigned char>(value >> 24));
+    out.push_back(static_cast<unsigned char>(value >> 16));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+struct CrcTable {
+    unsigned int entries[256];
+
+    CrcTable() {
+        for (unsigned int n = 0; n < 256; ++n) {
+            unsigned int c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[n] = c;
+        }
+    }
+};
+
+unsigned int PngWriter::crc32(unsigned int crc, const unsigned char* data, size_t size) {
+    static const CrcTable table;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void PngWriter::appendChunk(std::vector<unsigned char>& png, const char* type, const unsigned char* data,
+                            size_t size) {
+    appendBigEndian(png, static_cast<unsigned int>(size));
+    size_t typeOffset = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data, data + size);
+    appendBigEndian(png, crc32(0, &png[typeOffset], size + 4));
+}
+
+void PngWriter::deflate(const std::vector<unsigned char>& raw, std::vector<unsigned char>& compressed) {
+#ifdef XWGL_HAVE_ZLIB
+    uLongf compressedSize = compressBound(raw.size());
+    compressed.resize(compressedSize);
+    // Level 1: the writer thread has to keep up with the frame rate
+    if (compress2(compressed.data(), &compressedSize, raw.data(), raw.size(), 1) == Z_OK) {
+        compressed.resize(compressedSize);
+        return;
+    }
+    compressed.clear();
+#endif
+
+    // zlib stream of stored blocks (max 65535 bytes each)
+    compressed.push_back(0x78);
+    compressed.push_back(0x01);
+
+    size_t offset = 0;
+    do {
+        size_t blockSize = raw.size() - offset;
+        if (blockSize > 65535) {
+            blockSize = 65535;
+        }
+        bool last = offset + blockSize == raw.size();
+        compressed.push_back(last ? 1 : 0);
+        compressed.push_back(static_cast<unsigned char>(blockSize));
+        compressed.push_back(static_cast<unsigned char>(blockSize >> 8));
+        compressed.push_back(static_cast<unsigned char>(~blockSize));
+        compressed.push_back(static_cast<unsigned char>(~blockSize >> 8));
+        compressed.insert(compressed.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+        offset += blockSize;
+    } while (offset < raw.size());
+
+    unsigned int a = 1, b = 0;
+    for (size_t i = 0; i < raw.size(); ++i) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    appendBigEndian(compressed, (b << 16) | a);
+}
+
+void PngWriter::encode(const unsigned char* rgba, int width, int height, bool flipVertically,
+                       std::vector<unsigned char>& png) {
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    png.assign(signature, signature + 8);
+
+    std::vector<unsigned char> header;
+    appendBigEndian(header, static_cast<unsigned int>(width));
+    appendBigEndian(header, static_cast<unsigned int>(height));
+    header.push_back(8); // bit depth
+    header.push_back(6); // color type RGBA
+    header.push_back(0); // compression
+    header.push_back(0); // filter
+    header.push_back(0); // interlace
+    appendChunk(png, "IHDR", header.data(), header.size());
+
+    // Filter type 0 (none) per scanline
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    std::vector<unsigned char> raw((rowBytes + 1) * height);
+    for (int y = 0; y < height; ++y) {
+        int sourceRow = flipVertically ? height - 1 - y : y;
+        raw[y * (rowBytes + 1)] = 0;
+        memcpy(&raw[y * (rowBytes + 1) + 1], rgba + sourceRow * rowBytes, rowBytes);
+    }
+
+    std::vector<unsigned char> compressed;
+    deflate(raw, compressed);
+    appendChunk(png, "IDAT", compressed.data(), compressed.size());
+    appendChunk(png, "IEND", nullptr, 0);
+}
+
+bool PngWriter::write(const char* filePath, const unsigned char* rgba, int width, int height, bool flipVertically) {
+    std::vector<unsigned char> png;
+    encode(rgba, width, height, flipVertically, png);
+
+    FILE* file = fopen(filePath, "wb");
+    if (!file) {
+        logger.Error("PngWriter: failed to open %s", filePath);
+        return false;
+    }
+    bool success = fwrite(png.data(), 1, png.size(), file) == png.size();
+    fclose(file);
+    return success;
+}
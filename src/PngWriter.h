@@ -0,0 +1,23 @@
+#ifndef PNG_WRITER_H
+#define PNG_WRITER_H
+
+#include <cstddef>
+#include <vector>
+
+// Minimal RGBA8 PNG encoder. Uses zlib when the build found it
+// (XWGL_HAVE_ZLIB), otherwise emits uncompressed deflate blocks, which any
+// PNG reader accepts.
+class PngWriter {
+public:
+    // rows are stored top to bottom; flipVertically for GL readback data
+    static bool write(const char* filePath, const unsigned char* rgba, int width, int height, bool flipVertically);
+
+private:
+    static void encode(const unsigned char* rgba, int width, int height, bool flipVertically,
+                       std::vector<unsigned char>& png);
+    static void deflate(const std::vector<unsigned char>& raw, std::vector<unsigned char>& compressed);
+    static void appendChunk(std::vector<unsigned char>& png, const char* type, const unsigned char* data, size_t size);
+    static unsigned int crc32(unsigned int crc, const unsigned char* data, size_t size);
+};
+
+#endif // PNG_WRITER_H
@@ -0,0 +1,443 @@
+#include "RenderBenchmark.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+const char* const VertexSource =
+    "#version 450 core\n"
+    "layout(location = 0) in vec2 aPosition;\n"
+    "uniform vec4 uOffsetScale;\n"
+    "void main() {\n"
+    "    gl_Position = vec4(aPosition * uOffsetScale.zw + uOffsetScale.xy, 0.0, 1.0);\n"
+    "}\n";
+
+const char* const ColorFragmentSource =
+    "#version 450 core\n"
+    "uniform vec4 uColor;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    fragColor = uColor;\n"
+    "}\n";
+
+const char* const TexturedFragmentSource =
+    "#version 450 core\n"
+    "layout(binding = 0) uniform sampler2D uTexture;\n"
+    "uniform vec4 uColor;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    fragColor = uColor * texture(uTexture, gl_FragCoord.xy / 64.0);\n"
+    "}\n";
+
+// Same LCG everywhere so geometry is identical across runs and machines
+struct Random {
+    uint32_t state;
+
+    explicit Random(uint32_t seed) : state(seed) {}
+
+    float next() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.0f;
+    }
+};
+
+GLuint compileStage(GLenum stage, const char* source) {
+    GLuint shader = glCreateShader(stage);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        logger.Error("RenderBenchmark: shader compilation failed:\n%s", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint linkProgram(const char* vertexSource, const char* fragmentSource) {
+    GLuint vertexShader = compileStage(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compileStage(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!vertexShader || !fragmentShader) {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDetachShader(program, vertexShader);
+    glDetachShader(program, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        logger.Error("RenderBenchmark: program link failed:\n%s", log);
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+// count small triangles scattered over the viewport, as vec2 positions
+void generateTriangles(std::vector<float>& positions, size_t count, float size, uint32_t seed) {
+    Random random(seed);
+    positions.resize(count * 6);
+    for (size_t i = 0; i < count; ++i) {
+        float x = random.next() * 2.0f - 1.0f;
+        float y = random.next() * 2.0f - 1.0f;
+        float* triangle = &positions[i * 6];
+        triangle[0] = x;
+        triangle[1] = y;
+        triangle[2] = x + size;
+        triangle[3] = y;
+        triangle[4] = x;
+        triangle[5] = y + size;
+    }
+}
+
+// Vertex array with one vec2 stream at location 0
+GLuint createVertexArray(GLuint buffer) {
+    GLuint vertexArray = 0;
+    glGenVertexArrays(1, &vertexArray);
+    glBindVertexArray(vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    return vertexArray;
+}
+
+GLuint createStaticBuffer(const std::vector<float>& data) {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
+    return buffer;
+}
+
+void setIdentityTransform(GLuint program) {
+    glUniform4f(glGetUniformLocation(program, "uOffsetScale"), 0.0f, 0.0f, 1.0f, 1.0f);
+}
+
+size_t scaled(double scale, size_t base) {
+    return std::max<size_t>(1, static_cast<size_t>(base * scale + 0.5));
+}
+
+// Vertex and fill throughput: one draw of many small triangles
+class TriangleScene : public BenchmarkScene {
+public:
+    explicit TriangleScene(size_t triangleCount)
+        : triangleCount(triangleCount), program(0), buffer(0), vertexArray(0) {}
+
+    const char* getName() const { return "triangles"; }
+    const char* getWorkUnit() const { return "triangles"; }
+    uint64_t getWorkPerFrame() const { return triangleCount; }
+
+    bool setup(int, int) {
+        program = linkProgram(VertexSource, ColorFragmentSource);
+        std::vector<float> positions;
+        generateTriangles(positions, triangleCount, 0.01f, 1);
+        buffer = createStaticBuffer(positions);
+        vertexArray = createVertexArray(buffer);
+        return program != 0;
+    }
+
+    void renderFrame(unsigned int) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        glUseProgram(program);
+        setIdentityTransform(program);
+        glUniform4f(glGetUniformLocation(program, "uColor"), 0.2f, 0.6f, 1.0f, 1.0f);
+        glBindVertexArray(vertexArray);
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(triangleCount * 3));
+    }
+
+    void cleanup() {
+        glDeleteVertexArrays(1, &vertexArray);
+        glDeleteBuffers(1, &buffer);
+        glDeleteProgram(program);
+    }
+
+private:
+    size_t triangleCount;
+    GLuint program;
+    GLuint buffer;
+    GLuint vertexArray;
+};
+
+// Per-draw driver overhead: one triangle per draw call, no state in between
+class DrawCallScene : public BenchmarkScene {
+public:
+    explicit DrawCallScene(size_t drawCount) : drawCount(drawCount), program(0), buffer(0), vertexArray(0) {}
+
+    const char* getName() const { return "draws"; }
+    const char* getWorkUnit() const { return "draws"; }
+    uint64_t getWorkPerFrame() const { return drawCount; }
+
+    bool setup(int, int) {
+        program = linkProgram(VertexSource, ColorFragmentSource);
+        std::vector<float> positions;
+        generateTriangles(positions, drawCount, 0.02f, 2);
+        buffer = createStaticBuffer(positions);
+        vertexArray = createVertexArray(buffer);
+        return program != 0;
+    }
+
+    void renderFrame(unsigned int) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        glUseProgram(program);
+        setIdentityTransform(program);
+        glUniform4f(glGetUniformLocation(program, "uColor"), 1.0f, 0.5f, 0.2f, 1.0f);
+        glBindVertexArray(vertexArray);
+        for (size_t i = 0; i < drawCount; ++i) {
+            glDrawArrays(GL_TRIANGLES, static_cast<GLint>(i * 3), 3);
+        }
+    }
+
+    void cleanup() {
+        glDeleteVertexArrays(1, &vertexArray);
+        glDeleteBuffers(1, &buffer);
+        glDeleteProgram(program);
+    }
+
+private:
+    size_t drawCount;
+    GLuint program;
+    GLuint buffer;
+    GLuint vertexArray;
+};
+
+// Validation cost: every draw switches program, texture, blend state and a
+// uniform, the pattern material sorting is meant to avoid
+class StateChangeScene : public BenchmarkScene {
+public:
+    static const int ChangesPerDraw = 4;
+
+    explicit StateChangeScene(size_t drawCount) : drawCount(drawCount), buffer(0), vertexArray(0) {
+        programs[0] = programs[1] = 0;
+        textures[0] = textures[1] = 0;
+    }
+
+    const char* getName() const { return "state"; }
+    const char* getWorkUnit() const { return "state changes"; }
+    uint64_t getWorkPerFrame() const { return drawCount * ChangesPerDraw; }
+
+    bool setup(int, int) {
+        programs[0] = linkProgram(VertexSource, ColorFragmentSource);
+        programs[1] = linkProgram(VertexSource, TexturedFragmentSource);
+        for (int i = 0; i < 2; ++i) {
+            colorLocations[i] = glGetUniformLocation(programs[i], "uColor");
+        }
+
+        std::vector<float> positions;
+        generateTriangles(positions, drawCount, 0.05f, 3);
+        buffer = createStaticBuffer(positions);
+        vertexArray = createVertexArray(buffer);
+
+        // Two 64x64 checkerboards with different periods
+        std::vector<uint32_t> pixels(64 * 64);
+        glGenTextures(2, textures);
+        for (int t = 0; t < 2; ++t) {
+            for (int y = 0; y < 64; ++y) {
+                for (int x = 0; x < 64; ++x) {
+                    pixels[y * 64 + x] = (((x >> (t + 2)) ^ (y >> (t + 2))) & 1) ? 0xffffffffu : 0xff404040u;
+                }
+            }
+            glBindTexture(GL_TEXTURE_2D, textures[t]);
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 64, 64);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 64, 64, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        for (int i = 0; i < 2; ++i) {
+            if (programs[i]) {
+                glUseProgram(programs[i]);
+                setIdentityTransform(programs[i]);
+            }
+        }
+        return programs[0] != 0 && programs[1] != 0;
+    }
+
+    void renderFrame(unsigned int) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        glBindVertexArray(vertexArray);
+        glActiveTexture(GL_TEXTURE0);
+        for (size_t i = 0; i < drawCount; ++i) {
+            int variant = static_cast<int>(i & 1);
+            glUseProgram(programs[variant]);
+            glBindTexture(GL_TEXTURE_2D, textures[(i >> 1) & 1]);
+            if (variant) {
+                glEnable(GL_BLEND);
+            } else {
+                glDisable(GL_BLEND);
+            }
+            glUniform4f(colorLocations[variant], (i % 7) / 7.0f, (i % 5) / 5.0f, (i % 3) / 3.0f, 0.75f);
+            glDrawArrays(GL_TRIANGLES, static_cast<GLint>(i * 3), 3);
+        }
+        glDisable(GL_BLEND);
+    }
+
+    void cleanup() {
+        glDeleteTextures(2, textures);
+        glDeleteVertexArrays(1, &vertexArray);
+        glDeleteBuffers(1, &buffer);
+        glDeleteProgram(programs[0]);
+        glDeleteProgram(programs[1]);
+    }
+
+private:
+    size_t drawCount;
+    GLuint programs[2];
+    GLint colorLocations[2];
+    GLuint textures[2];
+    GLuint buffer;
+    GLuint vertexArray;
+};
+
+// Streaming: the whole vertex buffer is orphaned and refilled every frame in
+// fixed-size glBufferSubData chunks, then drawn so the upload is consumed
+class UploadScene : public BenchmarkScene {
+public:
+    static const size_t ChunkBytes = 64 * 1024;
+
+    explicit UploadScene(size_t bytesPerFrame)
+        : bytesPerFrame((bytesPerFrame + ChunkBytes - 1) / ChunkBytes * ChunkBytes), program(0), buffer(0),
+          vertexArray(0) {}
+
+    const char* getName() const { return "upload"; }
+    const char* getWorkUnit() const { return "bytes"; }
+    uint64_t getWorkPerFrame() const { return bytesPerFrame; }
+
+    bool setup(int, int) {
+        program = linkProgram(VertexSource, ColorFragmentSource);
+        // Two frames of source data so consecutive frames upload different bytes
+        generateTriangles(source, 2 * bytesPerFrame / (6 * sizeof(float)), 0.002f, 4);
+        source.resize(2 * bytesPerFrame / sizeof(float));
+
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, bytesPerFrame, nullptr, GL_STREAM_DRAW);
+        vertexArray = createVertexArray(buffer);
+        return program != 0;
+    }
+
+    void renderFrame(unsigned int frame) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        const unsigned char* data =
+            reinterpret_cast<const unsigned char*>(source.data()) + (frame & 1) * bytesPerFrame;
+
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, bytesPerFrame, nullptr, GL_STREAM_DRAW);
+        for (size_t offset = 0; offset < bytesPerFrame; offset += ChunkBytes) {
+            glBufferSubData(GL_ARRAY_BUFFER, offset, ChunkBytes, data + offset);
+        }
+
+        glUseProgram(program);
+        setIdentityTransform(program);
+        glUniform4f(glGetUniformLocation(program, "uColor"), 0.4f, 1.0f, 0.4f, 1.0f);
+        glBindVertexArray(vertexArray);
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(bytesPerFrame / (6 * sizeof(float)) * 3));
+    }
+
+    void cleanup() {
+        glDeleteVertexArrays(1, &vertexArray);
+        glDeleteBuffers(1, &buffer);
+        glDeleteProgram(program);
+        std::vector<float>().swap(source);
+    }
+
+private:
+    size_t bytesPerFrame;
+    std::vector<float> source;
+    GLuint program;
+    GLuint buffer;
+    GLuint vertexArray;
+};
+
+// Shader compile storm: fresh programs every frame, each with a unique
+// constant. Within a run that defeats any in-memory cache; across runs the
+// sources would repeat and an on-disk cache (Mesa's, the NVIDIA/AMD ones)
+// would serve them, so every run also stamps its sources with a nonce. The
+// `bench` target additionally sets MESA_SHADER_CACHE_DISABLE, which keeps the
+// shared vertex shader from being a cache hit too.
+class CompileScene : public BenchmarkScene {
+public:
+    explicit CompileScene(size_t programsPerFrame) : programsPerFrame(programsPerFrame), failures(0), runNonce(0) {}
+
+    const char* getName() const { return "compile"; }
+    const char* getWorkUnit() const { return "programs"; }
+    uint64_t getWorkPerFrame() const { return programsPerFrame; }
+
+    bool setup(int, int) {
+        failures = 0;
+        runNonce = static_cast<unsigned int>(std::chrono::system_clock::now().time_since_epoch().count());
+        return true;
+    }
+
+    void renderFrame(unsigned int frame) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        for (size_t i = 0; i < programsPerFrame; ++i) {
+            // Same source shape every run (the nonce is a comment), so
+            // run-to-run work is identical
+            char fragmentSource[512];
+            snprintf(fragmentSource, sizeof(fragmentSource),
+                     "#version 450 core\n"
+                     "// run %08x\n"
+                     "uniform vec4 uColor;\n"
+                     "out vec4 fragColor;\n"
+                     "const float variant = %u.0;\n"
+                     "void main() {\n"
+                     "    vec4 color = uColor;\n"
+                     "    for (int i = 0; i < 4; ++i) {\n"
+                     "        color = fract(color * 1.618 + variant * 0.001 + float(i));\n"
+                     "    }\n"
+                     "    fragColor = color;\n"
+                     "}\n",
+                     runNonce, static_cast<unsigned int>(frame * programsPerFrame + i));
+            GLuint program = linkProgram(VertexSource, fragmentSource);
+            if (!program) {
+                ++failures;
+            }
+            glDeleteProgram(program);
+        }
+    }
+
+    void cleanup() {
+        if (failures > 0) {
+            logger.Error("RenderBenchmark: %zu programs of the compile scene failed to build", failures);
+        }
+    }
+
+    uint64_t getFailures() const { return failures; }
+
+private:
+    size_t programsPerFrame;
+    size_t failures;
+    unsigned int runNonce;
+};
+
+}
+
+std::vector<std::unique_ptr<BenchmarkScene>> createBenchmarkScenes(double scale) {
+    std::vector<std::unique_ptr<BenchmarkScene>> scenes;
+    scenes.push_back(std::unique_ptr<BenchmarkScene>(new TriangleScene(scaled(scale, 200000))));
+    scenes.push_back(std::unique_ptr<BenchmarkScene>(new DrawCallScene(scaled(scale, 10000))));
+    scenes.push_back(std::unique_ptr<BenchmarkScene>(new StateChangeScene(scaled(scale, 2000))));
+    scenes.push_back(std::unique_ptr<BenchmarkScene>(new UploadScene(scaled(scale, 16 * 1024 * 1024))));
+    scenes.push_back(std::unique_ptr<BenchmarkScene>(new CompileScene(scaled(scale, 8))));
+    return scenes;
+}
@@ -0,0 +1,35 @@
+#ifndef RENDER_BENCHMARK_H
+#define RENDER_BENCHMARK_H
+
+#include <GL/glew.h>
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+// One reproducible render workload for the renderbench tool. Scenes build all
+// their data from fixed seeds in setup(), so two runs on the same driver issue
+// exactly the same GL stream; renderFrame() is what gets timed.
+class BenchmarkScene {
+public:
+    virtual ~BenchmarkScene() {}
+
+    virtual const char* getName() const = 0;
+    // Unit of getWorkPerFrame(), e.g. "triangles" or "bytes"
+    virtual const char* getWorkUnit() const = 0;
+    virtual uint64_t getWorkPerFrame() const = 0;
+
+    virtual bool setup(int width, int height) = 0;
+    virtual void renderFrame(unsigned int frame) = 0;
+    virtual void cleanup() = 0;
+    // Work that failed since setup(), e.g. programs that did not build; the
+    // run fails when this is non-zero
+    virtual uint64_t getFailures() const { return 0; }
+};
+
+// The standard scenes: triangle throughput, draw call overhead, state
+// changes, streaming uploads and shader compile storms. scale multiplies
+// every per-frame workload (1.0 suits llvmpipe at 800x600).
+std::vector<std::unique_ptr<BenchmarkScene>> createBenchmarkScenes(double scale);
+
+#endif // RENDER_BENCHMARK_H
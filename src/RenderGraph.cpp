@@ -0,0 +1,428 @@
+#include "RenderGraph.h"
+#include "Logger.h"
+#include "GLDebug.h"
+#include "GLHooks.h"
+
+RenderGraphPass& RenderGraphPass::read(RenderGraphResource resource, RenderGraphAccess access) {
+    Use use = {resource, access, false};
+    uses.push_back(use);
+    return *this;
+}
+
+RenderGraphPass& RenderGraphPass::write(RenderGraphResource resource, RenderGraphAccess access) {
+    Use use = {resource, access, true};
+    uses.push_back(use);
+    return *this;
+}
+
+RenderGraphPass& RenderGraphPass::sideEffect() {
+    hasSideEffects = true;
+    return *this;
+}
+
+RenderGraph::RenderGraph(RenderTargetPool& renderTargetPool, FrameArena& frameArena)
+    : renderTargetPool(renderTargetPool), frameArena(frameArena), numPasses(0), numCulledPasses(0),
+      compiled(false) {
+}
+
+RenderGraph::~RenderGraph() {
+    reset();
+}
+
+void RenderGraph::reset() {
+    for (int p = 0; p < numPasses; ++p) {
+        passes[p].destroy(passes[p].callable);
+        passes[p].callable = nullptr;
+    }
+    resources.clear();
+    numPasses = 0;
+    numCulledPasses = 0;
+    compiled = false;
+}
+
+RenderGraphResource RenderGraph::createTexture(const char* name, const RenderTargetDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.kind = ResourceKind::Texture;
+    resource.desc = desc;
+    resource.imported = false;
+    resource.output = false;
+    resource.object = 0;
+    resources.push_back(resource);
+    return static_cast<RenderGraphResource>(resources.size()) - 1;
+}
+
+RenderGraphResource RenderGraph::importTexture(const char* name, GLuint texture) {
+    Resource resource;
+    resource.name = name;
+    resource.kind = ResourceKind::Texture;
+    resource.imported = true;
+    resource.output = false;
+    resource.object = texture;
+
+    const RenderTargetDesc* desc = renderTargetPool.getDesc(texture);
+    if (desc) {
+        resource.desc = *desc;
+    }
+
+    resources.push_back(resource);
+    return static_cast<RenderGraphResource>(resources.size()) - 1;
+}
+
+RenderGraphResource RenderGraph::importBuffer(const char* name, GLuint buffer) {
+    Resource resource;
+    resource.name = name;
+    resource.kind = ResourceKind::Buffer;
+    resource.imported = true;
+    resource.output = false;
+    resource.object = buffer;
+    resources.push_back(resource);
+    return static_cast<RenderGraphResource>(resources.size()) - 1;
+}
+
+RenderGraphResource RenderGraph::importBackbuffer(int width, int height) {
+    Resource resource;
+    resource.name = "backbuffer";
+    resource.kind = ResourceKind::Backbuffer;
+    resource.desc = RenderTargetDesc(GL_RGBA8, width, height);
+    resource.imported = true;
+    resource.output = true;
+    resource.object = 0;
+    resources.push_back(resource);
+    return static_cast<RenderGraphResource>(resources.size()) - 1;
+}
+
+void RenderGraph::markOutput(RenderGraphResource resource) {
+    resources[resource].output = true;
+}
+
+RenderGraphPass& RenderGraph::addPass(const char* name, void* callable, RenderGraphPass::InvokeFunction invoke,
+                                      RenderGraphPass::DestroyFunction destroy) {
+    if (numPasses == static_cast<int>(passes.size())) {
+        passes.push_back(RenderGraphPass());
+    }
+
+    // Reuse the slot, keeping the capacity of its vectors
+    RenderGraphPass& pass = passes[numPasses++];
+    pass.name = name;
+    pass.callable = callable;
+    pass.invoke = invoke;
+    pass.destroy = destroy;
+    pass.uses.clear();
+    pass.hasSideEffects = false;
+    pass.culled = false;
+    pass.barrierBits = 0;
+    pass.acquireBefore.clear();
+    pass.releaseAfter.clear();
+    return pass;
+}
+
+GLbitfield RenderGraph::barrierFor(RenderGraphAccess access) {
+    switch (access) {
+        case RenderGraphAccess::ColorAttachment:
+        case RenderGraphAccess::DepthAttachment:
+            return GL_FRAMEBUFFER_BARRIER_BIT;
+        case RenderGraphAccess::Sampled:
+            return GL_TEXTURE_FETCH_BARRIER_BIT;
+        case RenderGraphAccess::StorageImage:
+            return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+        case RenderGraphAccess::StorageBuffer:
+            return GL_SHADER_STORAGE_BARRIER_BIT;
+        case RenderGraphAccess::UniformBuffer:
+            return GL_UNIFORM_BARRIER_BIT;
+        case RenderGraphAccess::VertexBuffer:
+            return GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+        case RenderGraphAccess::IndexBuffer:
+            return GL_ELEMENT_ARRAY_BARRIER_BIT;
+        case RenderGraphAccess::IndirectBuffer:
+            return GL_COMMAND_BARRIER_BIT;
+        case RenderGraphAccess::Transfer:
+            return GL_PIXEL_BUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT;
+    }
+    return 0;
+}
+
+bool RenderGraph::isIncoherentWrite(RenderGraphAccess access) {
+    // Everything else is ordered by the GL pipeline itself
+    return access == RenderGraphAccess::StorageImage || access == RenderGraphAccess::StorageBuffer;
+}
+
+bool RenderGraph::readsResource(const RenderGraphPass& pass, RenderGraphResource resource) {
+    for (size_t u = 0; u < pass.uses.size(); ++u) {
+        if (!pass.uses[u].write && pass.uses[u].resource == resource) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RenderGraph::writesResource(const RenderGraphPass& pass, RenderGraphResource resource) {
+    for (size_t u = 0; u < pass.uses.size(); ++u) {
+        if (pass.uses[u].write && pass.uses[u].resource == resource) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RenderGraph::sortPasses() {
+    const int numResources = static_cast<int>(resources.size());
+
+    // Dependency edges, collected in one sweep in declaration order
+    edges.clear();
+    firstWriter.assign(numResources, -1);
+    lastWriter.assign(numResources, -1);
+    for (int p = 0; p < numPasses; ++p) {
+        const RenderGraphPass& pass = passes[p];
+        for (size_t u = 0; u < pass.uses.size(); ++u) {
+            RenderGraphResource r = pass.uses[u].resource;
+            int writer = lastWriter[r];
+            if (writer >= 0 && writer != p) {
+                edges.push_back(std::make_pair(writer, p));
+            }
+            if (!pass.uses[u].write || writer == p) {
+                continue;
+            }
+
+            // Reads of the contents this write replaces run before it; for a
+            // transient, reads declared before any write are handled below
+            if (writer >= 0 || resources[r].imported) {
+                for (int q = writer + 1; q < p; ++q) {
+                    if (readsResource(passes[q], r)) {
+                        edges.push_back(std::make_pair(q, p));
+                    }
+                }
+            }
+            if (firstWriter[r] < 0) {
+                firstWriter[r] = p;
+            }
+            lastWriter[r] = p;
+        }
+    }
+
+    // A transient read declared ahead of its producers sees the final contents
+    for (int p = 0; p < numPasses; ++p) {
+        const RenderGraphPass& pass = passes[p];
+        for (size_t u = 0; u < pass.uses.size(); ++u) {
+            RenderGraphResource r = pass.uses[u].resource;
+            if (!pass.uses[u].write && !resources[r].imported && lastWriter[r] >= 0 && p < firstWriter[r] &&
+                !writesResource(pass, r)) {
+                edges.push_back(std::make_pair(lastWriter[r], p));
+            }
+        }
+    }
+
+    // Kahn's algorithm, always taking the lowest declaration index that is
+    // ready so independent passes keep declaration order. Graphs hold a few
+    // dozen passes, so the quadratic scans are cheaper than adjacency lists.
+    inDegree.assign(numPasses, 0);
+    for (size_t e = 0; e < edges.size(); ++e) {
+        ++inDegree[edges[e].second];
+    }
+
+    order.clear();
+    for (int position = 0; position < numPasses; ++position) {
+        int ready = -1;
+        for (int p = 0; p < numPasses && ready < 0; ++p) {
+            if (inDegree[p] == 0) {
+                ready = p;
+            }
+        }
+
+        if (ready < 0) {
+            for (int p = 0; p < numPasses; ++p) {
+                if (inDegree[p] > 0) {
+                    logger.Error("RenderGraph: pass '%s' is part of or depends on a dependency cycle",
+                                 passes[p].name);
+                }
+            }
+            return false;
+        }
+
+        // Placed passes are parked at -1 so they are never picked again
+        inDegree[ready] = -1;
+        order.push_back(ready);
+        for (size_t e = 0; e < edges.size(); ++e) {
+            if (edges[e].first == ready) {
+                --inDegree[edges[e].second];
+            }
+        }
+    }
+    return true;
+}
+
+bool RenderGraph::compile() {
+    const int numResources = static_cast<int>(resources.size());
+
+    // 1. Order the passes by their dependencies
+    if (!sortPasses()) {
+        compiled = false;
+        return false;
+    }
+
+    // 2. Cull: walk backwards from the outputs, keeping passes that write
+    //    something still needed and marking what they read as needed.
+    needed.resize(numResources);
+    for (int r = 0; r < numResources; ++r) {
+        needed[r] = resources[r].output;
+    }
+
+    numCulledPasses = 0;
+    for (int position = numPasses - 1; position >= 0; --position) {
+        RenderGraphPass& pass = passes[order[position]];
+        bool keep = pass.hasSideEffects;
+        for (size_t u = 0; u < pass.uses.size() && !keep; ++u) {
+            if (pass.uses[u].write && needed[pass.uses[u].resource]) {
+                keep = true;
+            }
+        }
+
+        pass.culled = !keep;
+        if (pass.culled) {
+            ++numCulledPasses;
+            continue;
+        }
+
+        for (size_t u = 0; u < pass.uses.size(); ++u) {
+            if (!pass.uses[u].write) {
+                needed[pass.uses[u].resource] = 1;
+            }
+        }
+    }
+
+    // 3. Lifetimes of transient textures and barriers between surviving passes
+    firstUse.assign(numResources, -1);
+    lastUse.assign(numResources, -1);
+    written.assign(numResources, 0);
+    pendingIncoherentWrite.assign(numResources, 0);
+    bool success = true;
+
+    for (int position = 0; position < numPasses; ++position) {
+        int p = order[position];
+        RenderGraphPass& pass = passes[p];
+        pass.barrierBits = 0;
+        pass.acquireBefore.clear();
+        pass.releaseAfter.clear();
+        if (pass.culled) {
+            continue;
+        }
+
+        for (size_t u = 0; u < pass.uses.size(); ++u) {
+            const RenderGraphPass::Use& use = pass.uses[u];
+            const Resource& resource = resources[use.resource];
+
+            if (!use.write && !resource.imported && !written[use.resource]) {
+                logger.Error("RenderGraph: pass '%s' reads '%s' before any pass writes it", pass.name,
+                             resource.name);
+                success = false;
+            }
+
+            if (pendingIncoherentWrite[use.resource]) {
+                pass.barrierBits |= barrierFor(use.access);
+                pendingIncoherentWrite[use.resource] = 0;
+            }
+
+            if (use.write) {
+                written[use.resource] = 1;
+                if (isIncoherentWrite(use.access)) {
+                    pendingIncoherentWrite[use.resource] = 1;
+                }
+            }
+
+            if (firstUse[use.resource] < 0) {
+                firstUse[use.resource] = p;
+            }
+            lastUse[use.resource] = p;
+        }
+    }
+
+    for (int r = 0; r < numResources; ++r) {
+        if (resources[r].imported || firstUse[r] < 0) {
+            continue;
+        }
+        passes[firstUse[r]].acquireBefore.push_back(r);
+        passes[lastUse[r]].releaseAfter.push_back(r);
+    }
+
+    compiled = success;
+    return success;
+}
+
+void RenderGraph::execute() {
+    if (!compiled && !compile()) {
+        return;
+    }
+
+    for (int position = 0; position < numPasses; ++position) {
+        RenderGraphPass& pass = passes[order[position]];
+        if (pass.culled) {
+            continue;
+        }
+
+        // Capture tools and driver messages see the pass name
+        glDebug.pushGroup(pass.name);
+
+        for (size_t i = 0; i < pass.acquireBefore.size(); ++i) {
+            Resource& resource = resources[pass.acquireBefore[i]];
+            resource.object = renderTargetPool.acquire(resource.desc);
+            glDebug.label(GL_TEXTURE, resource.object, resource.name);
+        }
+
+        if (pass.barrierBits != 0) {
+            glMemoryBarrier(pass.barrierBits);
+        }
+
+        pass.invoke(pass.callable, *this);
+
+        for (size_t i = 0; i < pass.releaseAfter.size(); ++i) {
+            Resource& resource = resources[pass.releaseAfter[i]];
+            renderTargetPool.release(resource.object);
+            resource.object = 0;
+        }
+
+        glDebug.popGroup();
+    }
+}
+
+GLuint RenderGraph::getTexture(RenderGraphResource resource) const {
+    return resources[resource].object;
+}
+
+GLuint RenderGraph::getBuffer(RenderGraphResource resource) const {
+    return resources[resource].object;
+}
+
+const RenderTargetDesc& RenderGraph::getDesc(RenderGraphResource resource) const {
+    return resources[resource].desc;
+}
+
+GLuint RenderGraph::getFramebuffer(std::initializer_list<RenderGraphResource> colors, RenderGraphResource depth) {
+    GLuint colorTextures[8];
+    int numColorTextures = 0;
+
+    for (std::initializer_list<RenderGraphResource>::const_iterator it = colors.begin();
+         it != colors.end() && numColorTextures < 8; ++it) {
+        const Resource& resource = resources[*it];
+        if (resource.kind == ResourceKind::Backbuffer) {
+            return 0;
+        }
+        colorTextures[numColorTextures++] = resource.object;
+    }
+
+    GLuint depthTexture = depth != InvalidRenderGraphResource ? resources[depth].object : 0;
+    return renderTargetPool.getFramebuffer(colorTextures, numColorTextures, depthTexture);
+}
+
+void RenderGraph::bindFramebuffer(std::initializer_list<RenderGraphResource> colors, RenderGraphResource depth) {
+    glBindFramebuffer(GL_FRAMEBUFFER, getFramebuffer(colors, depth));
+
+    const RenderTargetDesc* viewport = nullptr;
+    if (colors.size() > 0) {
+        viewport = &resources[*colors.begin()].desc;
+    } else if (depth != InvalidRenderGraphResource) {
+        viewport = &resources[depth].desc;
+    }
+    if (viewport) {
+        glViewport(0, 0, viewport->width, viewport->height);
+    }
+}
@@ -0,0 +1,195 @@
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <GL/glew.h>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "FrameArena.h"
+#include "RenderTargetPool.h"
+
+class RenderGraph;
+
+typedef int RenderGraphResource;
+const RenderGraphResource InvalidRenderGraphResource = -1;
+
+// How a pass touches a resource; decides which glMemoryBarrier bits are needed
+// when the previous write went through an incoherent path (image store / SSBO).
+enum class RenderGraphAccess {
+    ColorAttachment,
+    DepthAttachment,
+    Sampled,
+    StorageImage,
+    StorageBuffer,
+    UniformBuffer,
+    VertexBuffer,
+    IndexBuffer,
+    IndirectBuffer,
+    Transfer // glReadPixels / glBlitFramebuffer / buffer copies
+};
+
+class RenderGraphPass {
+public:
+    RenderGraphPass& read(RenderGraphResource resource, RenderGraphAccess access);
+    RenderGraphPass& write(RenderGraphResource resource, RenderGraphAccess access);
+    // Keep the pass even if nothing reads its outputs (readback, timers, ...)
+    RenderGraphPass& sideEffect();
+
+private:
+    friend class RenderGraph;
+
+    struct Use {
+        RenderGraphResource resource;
+        RenderGraphAccess access;
+        bool write;
+    };
+
+    typedef void (*InvokeFunction)(void* callable, RenderGraph& graph);
+    typedef void (*DestroyFunction)(void* callable);
+
+    // Pass objects are reused frame to frame, so these vectors keep their
+    // capacity and the callable lives in the frame arena
+    const char* name;
+    void* callable;
+    InvokeFunction invoke;
+    DestroyFunction destroy;
+    std::vector<Use> uses;
+    bool hasSideEffects;
+    bool culled;
+    GLbitfield barrierBits;
+    std::vector<RenderGraphResource> acquireBefore;
+    std::vector<RenderGraphResource> releaseAfter;
+};
+
+// Declarative per-frame pass list. Passes declare what they read and write and
+// are executed after compile() has:
+//   - sorted them topologically over those declarations: writers of a resource
+//     run in declaration order, a read runs after the last write declared
+//     before it and before the next one, and a read declared before every
+//     write sees the final contents (transients) or the imported contents
+//     (imports); unrelated passes keep declaration order, a cycle is an error,
+//   - culled passes whose writes never reach an output or a side effect,
+//   - computed transient texture lifetimes so they are acquired from the
+//     RenderTargetPool right before first use and released after last use
+//     (letting non-overlapping transients alias the same texture),
+//   - inserted glMemoryBarrier() before passes consuming incoherent writes.
+// The graph is rebuilt every frame: reset(), declare, compile(), execute().
+// Pass callbacks are stored in the frame arena and the pass/resource arrays
+// keep their capacity across reset(), so a steady-state frame declares its
+// graph without heap allocations. Names must outlive the frame (literals).
+class RenderGraph {
+public:
+    RenderGraph(RenderTargetPool& renderTargetPool, FrameArena& frameArena);
+    ~RenderGraph();
+
+    // Destroys last frame's pass callbacks; call before resetting the arena
+    void reset();
+
+    RenderGraphResource createTexture(const char* name, const RenderTargetDesc& desc);
+    RenderGraphResource importTexture(const char* name, GLuint texture);
+    RenderGraphResource importBuffer(const char* name, GLuint buffer);
+    // The default framebuffer; always an output
+    RenderGraphResource importBackbuffer(int width, int height);
+
+    // Imported resources that must stay valid after the frame (e.g. history buffers)
+    void markOutput(RenderGraphResource resource);
+
+    // execute is any callable taking RenderGraph&
+    template <typename F>
+    RenderGraphPass& addPass(const char* name, F execute);
+
+    bool compile();
+    void execute();
+
+    // Valid inside a pass' execute callback
+    GLuint getTexture(RenderGraphResource resource) const;
+    GLuint getBuffer(RenderGraphResource resource) const;
+    const RenderTargetDesc& getDesc(RenderGraphResource resource) const;
+    // FBO for the attachments; 0 when the backbuffer is among the colors
+    GLuint getFramebuffer(std::initializer_list<RenderGraphResource> colors,
+                          RenderGraphResource depth = InvalidRenderGraphResource);
+    // Binds the FBO for the attachments (0 for the backbuffer) and sets the viewport
+    void bindFramebuffer(std::initializer_list<RenderGraphResource> colors,
+                         RenderGraphResource depth = InvalidRenderGraphResource);
+
+    int getNumPasses() const { return numPasses; }
+    // Declaration index of the pass executed at position; valid after compile()
+    int getExecutionOrder(int position) const { return order[position]; }
+    int getNumCulledPasses() const { return numCulledPasses; }
+    const char* getPassName(int pass) const { return passes[pass].name; }
+    bool isPassCulled(int pass) const { return passes[pass].culled; }
+
+private:
+    enum class ResourceKind {
+        Texture,
+        Buffer,
+        Backbuffer
+    };
+
+    struct Resource {
+        const char* name;
+        ResourceKind kind;
+        RenderTargetDesc desc;
+        bool imported;
+        bool output;
+        GLuint object;
+    };
+
+    RenderTargetPool& renderTargetPool;
+    FrameArena& frameArena;
+    std::vector<Resource> resources;
+    // Only the first numPasses entries belong to this frame
+    std::vector<RenderGraphPass> passes;
+    int numPasses;
+    int numCulledPasses;
+    bool compiled;
+    // Declaration indices in execution order
+    std::vector<int> order;
+    // compile() working arrays: dependency edges (before, after) and in-degrees
+    // indexed by pass, then arrays indexed by resource
+    std::vector<std::pair<int, int> > edges;
+    std::vector<int> inDegree;
+    std::vector<int> firstWriter;
+    std::vector<int> lastWriter;
+    std::vector<char> needed;
+    std::vector<int> firstUse;
+    std::vector<int> lastUse;
+    std::vector<char> written;
+    std::vector<char> pendingIncoherentWrite;
+
+    RenderGraphPass& addPass(const char* name, void* callable, RenderGraphPass::InvokeFunction invoke,
+                             RenderGraphPass::DestroyFunction destroy);
+
+    template <typename F>
+    static void invokeCallable(void* callable, RenderGraph& graph) {
+        (*static_cast<F*>(callable))(graph);
+    }
+
+    template <typename F>
+    static void destroyCallable(void* callable) {
+        static_cast<F*>(callable)->~F();
+    }
+
+    bool sortPasses();
+    static bool readsResource(const RenderGraphPass& pass, RenderGraphResource resource);
+    static bool writesResource(const RenderGraphPass& pass, RenderGraphResource resource);
+
+    static GLbitfield barrierFor(RenderGraphAccess access);
+    static bool isIncoherentWrite(RenderGraphAccess access);
+
+    RenderGraph(const RenderGraph&);
+    RenderGraph& operator=(const RenderGraph&);
+};
+
+template <typename F>
+RenderGraphPass& RenderGraph::addPass(const char* name, F execute) {
+    typedef typename std::decay<F>::type Callable;
+    void* storage = frameArena.allocate(sizeof(Callable), alignof(Callable));
+    Callable* callable = new (storage) Callable(std::move(execute));
+    return addPass(name, callable, &invokeCallable<Callable>, &destroyCallable<Callable>);
+}
+
+#endif // RENDER_GRAPH_H
@@ -0,0 +1,304 @@
+#include "RenderTargetPool.h"
+#include "Logger.h"
+#include "GLHooks.h"
+#include "MemoryBudget.h"
+
+#include <algorithm>
+#include <cstring>
+
+RenderTargetDesc::RenderTargetDesc() : format(GL_RGBA8), width(0), height(0), samples(0) {
+}
+
+RenderTargetDesc::RenderTargetDesc(GLenum format, int width, int height, int samples)
+    : format(format), width(width), height(height), samples(samples > 1 ? samples : 0) {
+}
+
+bool RenderTargetDesc::operator<(const RenderTargetDesc& other) const {
+    if (format != other.format) return format < other.format;
+    if (width != other.width) return width < other.width;
+    if (height != other.height) return height < other.height;
+    return samples < other.samples;
+}
+
+bool RenderTargetDesc::operator==(const RenderTargetDesc& other) const {
+    return format == other.format && width == other.width && height == other.height && samples == other.samples;
+}
+
+bool RenderTargetPool::FramebufferKey::operator<(const FramebufferKey& other) const {
+    return memcmp(attachments, other.attachments, sizeof(attachments)) < 0;
+}
+
+RenderTargetPool::RenderTargetPool()
+    : evictAfterFrames(120), frameIndex(0), allocatedBytes(0), frameBytesInUse(0), peakFrameBytes(0) {
+}
+
+RenderTargetPool::~RenderTargetPool() {
+    cleanup();
+}
+
+size_t RenderTargetPool::bytesPerPixel(GLenum format) {
+    switch (format) {
+        case GL_R8:
+            return 1;
+        case GL_RG8:
+        case GL_R16F:
+        case GL_DEPTH_COMPONENT16:
+            return 2;
+        case GL_RGB8:
+        case GL_DEPTH_COMPONENT24:
+            return 3;
+        case GL_RGBA8:
+        case GL_SRGB8_ALPHA8:
+        case GL_RGB10_A2:
+        case GL_R11F_G11F_B10F:
+        case GL_RG16F:
+        case GL_R32F:
+        case GL_DEPTH24_STENCIL8:
+        case GL_DEPTH_COMPONENT32F:
+            return 4;
+        case GL_DEPTH32F_STENCIL8:
+            return 5;
+        case GL_RGBA16F:
+        case GL_RG32F:
+            return 8;
+        case GL_RGBA32F:
+            return 16;
+        default:
+            return 4;
+    }
+}
+
+size_t RenderTargetPool::byteSize(const RenderTargetDesc& desc) {
+    return bytesPerPixel(desc.format) * desc.width * desc.height * std::max(desc.samples, 1);
+}
+
+bool RenderTargetPool::isDepthFormat(GLenum format) {
+    switch (format) {
+        case GL_DEPTH_COMPONENT16:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH_COMPONENT32F:
+        case GL_DEPTH24_STENCIL8:
+        case GL_DEPTH32F_STENCIL8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void RenderTargetPool::beginFrame() {
+    ++frameIndex;
+    frameBytesInUse = 0;
+    for (std::map<GLuint, TextureEntry>::const_iterator it = textures.begin(); it != textures.end(); ++it) {
+        if (it->second.inUse) {
+            frameBytesInUse += byteSize(it->second.desc);
+        }
+    }
+}
+
+void RenderTargetPool::endFrame() {
+    // Evict textures nobody asked for recently
+    std::vector<GLuint> stale;
+    for (std::map<GLuint, TextureEntry>::const_iterator it = textures.begin(); it != textures.end(); ++it) {
+        if (!it->second.inUse && frameIndex - it->second.lastUsedFrame > static_cast<unsigned long>(evictAfterFrames)) {
+            stale.push_back(it->first);
+        }
+    }
+    for (size_t i = 0; i < stale.size(); ++i) {
+        destroyTexture(stale[i]);
+    }
+}
+
+GLuint RenderTargetPool::acquire(const RenderTargetDesc& desc) {
+    GLuint texture = 0;
+
+    std::map<RenderTargetDesc, std::vector<GLuint>>::iterator freeList = freeLists.find(desc);
+    if (freeList != freeLists.end() && !freeList->second.empty()) {
+        texture = freeList->second.back();
+        freeList->second.pop_back();
+    } else {
+        texture = createTexture(desc);
+        if (texture == 0) {
+            return 0;
+        }
+    }
+
+    TextureEntry& entry = textures[texture];
+    entry.inUse = true;
+    entry.lastUsedFrame = frameIndex;
+
+    frameBytesInUse += byteSize(desc);
+    peakFrameBytes = std::max(peakFrameBytes, frameBytesInUse);
+
+    return texture;
+}
+
+void RenderTargetPool::release(GLuint texture) {
+    std::map<GLuint, TextureEntry>::iterator it = textures.find(texture);
+    if (it == textures.end() || !it->second.inUse) {
+        logger.Error("RenderTargetPool: release of unknown or free texture %u", texture);
+        return;
+    }
+
+    const RenderTargetDesc& desc = it->second.desc;
+    it->second.inUse = false;
+    it->second.lastUsedFrame = frameIndex;
+    frameBytesInUse -= byteSize(desc);
+
+    freeLists[desc].push_back(texture);
+}
+
+const RenderTargetDesc* RenderTargetPool::getDesc(GLuint texture) const {
+    std::map<GLuint, TextureEntry>::const_iterator it = textures.find(texture);
+    return it == textures.end() ? nullptr : &it->second.desc;
+}
+
+GLuint RenderTargetPool::getFramebuffer(const GLuint* colorTextures, int numColorTextures, GLuint depthTexture) {
+    FramebufferKey key;
+    memset(&key, 0, sizeof(key));
+    numColorTextures = std::min(numColorTextures, 8);
+    for (int i = 0; i < numColorTextures; ++i) {
+        key.attachments[i] = colorTextures[i];
+    }
+    key.attachments[8] = depthTexture;
+
+    std::map<FramebufferKey, GLuint>::iterator it = framebuffers.find(key);
+    if (it != framebuffers.end()) {
+        return it->second;
+    }
+
+    GLuint framebuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    GLenum drawBuffers[8];
+    for (int i = 0; i < numColorTextures; ++i) {
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, colorTextures[i], 0);
+        drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+    }
+    if (numColorTextures > 0) {
+        glDrawBuffers(numColorTextures, drawBuffers);
+    } else {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+
+    if (depthTexture != 0) {
+        const RenderTargetDesc* desc = getDesc(depthTexture);
+        bool hasStencil = desc && (desc->format == GL_DEPTH24_STENCIL8 || desc->format == GL_DEPTH32F_STENCIL8);
+        glFramebufferTexture(GL_FRAMEBUFFER, hasStencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                             depthTexture, 0);
+    }
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        logger.Error("RenderTargetPool: framebuffer incomplete (0x%x)", status);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    framebuffers[key] = framebuffer;
+    return framebuffer;
+}
+
+GLuint RenderTargetPool::createTexture(const RenderTargetDesc& desc) {
+    if (desc.width <= 0 || desc.height <= 0) {
+        logger.Error("RenderTargetPool: invalid size %dx%d", desc.width, desc.height);
+        return 0;
+    }
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+
+    if (desc.samples > 1) {
+        glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, texture);
+        glTexStorage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, desc.samples, desc.format, desc.width, desc.height,
+                                  GL_TRUE);
+        glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, desc.format, desc.width, desc.height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    TextureEntry entry;
+    entry.desc = desc;
+    entry.inUse = false;
+    entry.lastUsedFrame = frameIndex;
+    textures[texture] = entry;
+
+    allocatedBytes += byteSize(desc);
+    memoryBudget.trackTexture(MemoryCategory::RenderTarget, texture, static_cast<int64_t>(byteSize(desc)));
+
+    logger.Debug("RenderTargetPool: created %dx%d format 0x%x (%zu textures, %zu bytes)", desc.width, desc.height,
+                 desc.format, textures.size(), allocatedBytes);
+    return texture;
+}
+
+void RenderTargetPool::destroyTexture(GLuint texture) {
+    std::map<GLuint, TextureEntry>::iterator it = textures.find(texture);
+    if (it == textures.end()) {
+        return;
+    }
+
+    // Drop every framebuffer that references the texture
+    for (std::map<FramebufferKey, GLuint>::iterator fb = framebuffers.begin(); fb != framebuffers.end();) {
+        const GLuint* attachments = fb->first.attachments;
+        if (std::find(attachments, attachments + 9, texture) != attachments + 9) {
+            glDeleteFramebuffers(1, &fb->second);
+            framebuffers.erase(fb++);
+        } else {
+            ++fb;
+        }
+    }
+
+    const RenderTargetDesc desc = it->second.desc;
+    std::vector<GLuint>& freeList = freeLists[desc];
+    freeList.erase(std::remove(freeList.begin(), freeList.end(), texture), freeList.end());
+
+    allocatedBytes -= byteSize(desc);
+    textures.erase(it);
+    memoryBudget.untrackTexture(texture);
+    glDeleteTextures(1, &texture);
+}
+
+size_t RenderTargetPool::evictUnused(size_t bytesToFree) {
+    // Least recently used free textures first
+    std::vector<std::pair<unsigned long, GLuint>> candidates;
+    for (std::map<GLuint, TextureEntry>::const_iterator it = textures.begin(); it != textures.end(); ++it) {
+        if (!it->second.inUse) {
+            candidates.push_back(std::make_pair(it->second.lastUsedFrame, it->first));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    size_t freed = 0;
+    for (size_t i = 0; i < candidates.size() && freed < bytesToFree; ++i) {
+        freed += byteSize(textures[candidates[i].second].desc);
+        destroyTexture(candidates[i].second);
+    }
+    if (freed > 0) {
+        logger.Debug("RenderTargetPool: evicted %zu bytes of unused targets", freed);
+    }
+    return freed;
+}
+
+void RenderTargetPool::cleanup() {
+    for (std::map<FramebufferKey, GLuint>::iterator fb = framebuffers.begin(); fb != framebuffers.end(); ++fb) {
+        glDeleteFramebuffers(1, &fb->second);
+    }
+    framebuffers.clear();
+
+    for (std::map<GLuint, TextureEntry>::iterator it = textures.begin(); it != textures.end(); ++it) {
+        GLuint texture = it->first;
+        memoryBudget.untrackTexture(texture);
+        glDeleteTextures(1, &texture);
+    }
+    textures.clear();
+    freeLists.clear();
+    allocatedBytes = 0;
+    frameBytesInUse = 0;
+}
@@ -0,0 +1,91 @@
+#ifndef RENDER_TARGET_POOL_H
+#define RENDER_TARGET_POOL_H
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// Describes one color or depth attachment; the pool key
+struct RenderTargetDesc {
+    GLenum format;  // sized internal format, e.g. GL_RGBA8, GL_DEPTH24_STENCIL8
+    int width;
+    int height;
+    int samples;    // 0/1 = single sampled
+
+    RenderTargetDesc();
+    RenderTargetDesc(GLenum format, int width, int height, int samples = 0);
+
+    bool operator<(const RenderTargetDesc& other) const;
+    bool operator==(const RenderTargetDesc& other) const;
+};
+
+// Owns every offscreen texture and framebuffer object. Transient targets are
+// acquired and released within a frame; a released texture goes back on the
+// free list for its descriptor and is handed to the next acquire() with the
+// same descriptor, so passes whose lifetimes don't overlap share memory.
+// Textures left unused for evictAfterFrames frames are deleted, which also
+// drops old sizes after a resize.
+class RenderTargetPool {
+public:
+    RenderTargetPool();
+    ~RenderTargetPool();
+
+    void beginFrame();
+    void endFrame();
+
+    GLuint acquire(const RenderTargetDesc& desc);
+    void release(GLuint texture);
+
+    // Cached FBO for the attachment set; depthTexture may be 0. Depth formats
+    // with a stencil component are attached to GL_DEPTH_STENCIL_ATTACHMENT.
+    GLuint getFramebuffer(const GLuint* colorTextures, int numColorTextures, GLuint depthTexture);
+
+    const RenderTargetDesc* getDesc(GLuint texture) const;
+
+    // Deletes textures not acquired this frame, least recently used first,
+    // until bytesToFree are gone (memory budget eviction); returns bytes freed
+    size_t evictUnused(size_t bytesToFree);
+
+    void cleanup();
+
+    size_t getNumTextures() const { return textures.size(); }
+    size_t getAllocatedBytes() const { return allocatedBytes; }
+    size_t getPeakFrameBytes() const { return peakFrameBytes; }
+
+    static size_t bytesPerPixel(GLenum format);
+    static bool isDepthFormat(GLenum format);
+    static size_t byteSize(const RenderTargetDesc& desc);
+
+    int evictAfterFrames;
+
+private:
+    struct TextureEntry {
+        RenderTargetDesc desc;
+        bool inUse;
+        unsigned long lastUsedFrame;
+    };
+
+    struct FramebufferKey {
+        GLuint attachments[9];  // 8 color + depth
+
+        bool operator<(const FramebufferKey& other) const;
+    };
+
+    std::map<GLuint, TextureEntry> textures;
+    std::map<RenderTargetDesc, std::vector<GLuint>> freeLists;
+    std::map<FramebufferKey, GLuint> framebuffers;
+
+    unsigned long frameIndex;
+    size_t allocatedBytes;
+    size_t frameBytesInUse;
+    size_t peakFrameBytes;
+
+    GLuint createTexture(const RenderTargetDesc& desc);
+    void destroyTexture(GLuint texture);
+
+    RenderTargetPool(const RenderTargetPool&);
+    RenderTargetPool& operator=(const RenderTargetPool&);
+};
+
+#endif // RENDER_TARGET_POOL_H
@@ -0,0 +1,58 @@
+#ifndef SCENE_COMPONENTS_H
+#define SCENE_COMPONENTS_H
+
+#include <GL/glew.h>
+
+#include "MeshLoader.h"
+#include "TransformHierarchy.h"
+#include "VectorMath.h"
+
+class Shader;
+
+// Components stored in the EntityRegistry. Plain structs only: the pools
+// copy and move them around freely.
+
+// Node in the scene's TransformHierarchy
+struct TransformComponent {
+    TransformNode node;
+
+    TransformComponent() : node(InvalidTransformNode) {}
+    explicit TransformComponent(TransformNode node) : node(node) {}
+};
+
+// Draw of a vertex array, with a local-space bounding sphere. indexType 0
+// draws with glDrawArrays from `first`, otherwise glDrawElements from the
+// VAO's element buffer at `first` indices in. A null shader means the
+// renderer's default program.
+//
+// With lodCount > 0 the draw range comes from lods instead (errors in the
+// same local space as the bounds); DrawList picks a level every frame and
+// keeps it in currentLod for hysteresis.
+struct MeshComponent {
+    Shader* shader;
+    GLuint vao;
+    GLenum mode;
+    GLenum indexType;
+    GLint first;
+    GLsizei count;
+    vec3 boundsCenter;
+    float boundsRadius;
+    unsigned int lodCount;
+    unsigned int currentLod;
+    MeshLod lods[MaxMeshLods];
+
+    MeshComponent()
+        : shader(nullptr), vao(0), mode(GL_TRIANGLES), indexType(0), first(0), count(0), boundsRadius(0.0f),
+          lodCount(0), currentLod(0) {}
+};
+
+// Constant angular velocity about a local axis
+struct SpinComponent {
+    vec3 axis;
+    float radiansPerSecond;
+
+    SpinComponent() : axis(0.0f, 1.0f, 0.0f), radiansPerSecond(0.0f) {}
+    SpinComponent(const vec3& axis, float radiansPerSecond) : axis(axis), radiansPerSecond(radiansPerSecond) {}
+};
+
+#endif // SCENE_COMPONENTS_H
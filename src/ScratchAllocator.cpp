@@ -0,0 +1,80 @@
+#include "ScratchAllocator.h"
+#include "MemoryBudget.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+const size_t ScratchAllocator::MinBlockSize;
+
+ScratchAllocator& ScratchAllocator::forThread() {
+    static thread_local ScratchAllocator scratch;
+    return scratch;
+}
+
+ScratchAllocator::ScratchAllocator() : current(0), offset(0) {
+}
+
+ScratchAllocator::~ScratchAllocator() {
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        memoryBudget.addHostBytes(MemoryCategory::HostScratch, -static_cast<int64_t>(blocks[i].capacity));
+        free(blocks[i].data);
+    }
+}
+
+void* ScratchAllocator::allocate(size_t size, size_t alignment) {
+    ++stats.allocations;
+
+    size_t next = 0;
+    if (!blocks.empty()) {
+        size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+        if (aligned + size <= blocks[current].capacity) {
+            offset = aligned + size;
+            stats.peakBytes = std::max(stats.peakBytes, getStats().bytesInUse);
+            return blocks[current].data + aligned;
+        }
+        next = current + 1;
+    }
+
+    // Blocks past the current one are free; replace the next if it is too small
+    if (next < blocks.size() && blocks[next].capacity < size) {
+        memoryBudget.addHostBytes(MemoryCategory::HostScratch, -static_cast<int64_t>(blocks[next].capacity));
+        free(blocks[next].data);
+        blocks.erase(blocks.begin() + next);
+    }
+    if (next >= blocks.size() || blocks[next].capacity < size) {
+        Block block;
+        block.capacity = std::max(MinBlockSize, size);
+        block.data = static_cast<unsigned char*>(malloc(block.capacity));
+        if (!block.data) {
+            throw std::bad_alloc();
+        }
+        blocks.insert(blocks.begin() + next, block);
+        ++stats.heapAllocations;
+        memoryBudget.addHostBytes(MemoryCategory::HostScratch, static_cast<int64_t>(block.capacity));
+    }
+
+    current = next;
+    offset = size;
+    stats.peakBytes = std::max(stats.peakBytes, getStats().bytesInUse);
+    return blocks[current].data;
+}
+
+ScratchAllocator::Marker ScratchAllocator::mark() const {
+    Marker marker = {current, offset};
+    return marker;
+}
+
+void ScratchAllocator::release(const Marker& marker) {
+    current = marker.block;
+    offset = marker.offset;
+}
+
+AllocatorStats ScratchAllocator::getStats() const {
+    AllocatorStats result = stats;
+    result.bytesInUse = offset;
+    for (size_t i = 0; i < current && i < blocks.size(); ++i) {
+        result.bytesInUse += blocks[i].capacity;
+    }
+    return result;
+}
@@ -0,0 +1,68 @@
+#ifndef SCRATCH_ALLOCATOR_H
+#define SCRATCH_ALLOCATOR_H
+
+#include <cstddef>
+#include <vector>
+
+#include "AllocatorStats.h"
+
+// Per-thread stack allocator for temporary buffers while loading (file
+// contents, path strings). Callers take a mark() on entry and release() it on
+// exit, so nested loads (shader #includes) unwind in LIFO order. Blocks are
+// kept for the thread's next load and never move, so pointers stay valid
+// until their marker is released and repeated loads stop allocating once the
+// largest working set has been seen.
+class ScratchAllocator {
+public:
+    struct Marker {
+        size_t block;
+        size_t offset;
+    };
+
+    // The calling thread's instance (loader threads each get their own)
+    static ScratchAllocator& forThread();
+
+    ScratchAllocator();
+    ~ScratchAllocator();
+
+    // Alignment up to 16 bytes
+    void* allocate(size_t size, size_t alignment = 16);
+    char* allocateString(size_t length) { return static_cast<char*>(allocate(length + 1, 1)); }
+
+    Marker mark() const;
+    void release(const Marker& marker);
+
+    AllocatorStats getStats() const;
+
+private:
+    static const size_t MinBlockSize = 64 * 1024;
+
+    struct Block {
+        unsigned char* data;
+        size_t capacity;
+    };
+
+    std::vector<Block> blocks;
+    size_t current;
+    size_t offset;
+    AllocatorStats stats;
+
+    ScratchAllocator(const ScratchAllocator&);
+    ScratchAllocator& operator=(const ScratchAllocator&);
+};
+
+// Releases a ScratchAllocator back to where it was on construction
+class ScratchScope {
+public:
+    explicit ScratchScope(ScratchAllocator& scratch) : scratch(scratch), marker(scratch.mark()) {}
+    ~ScratchScope() { scratch.release(marker); }
+
+private:
+    ScratchAllocator& scratch;
+    ScratchAllocator::Marker marker;
+
+    ScratchScope(const ScratchScope&);
+    ScratchScope& operator=(const ScratchScope&);
+};
+
+#endif // SCRATCH_ALLOCATOR_H
@@ -1,35 +1,71 @@
 #include "Shader.h"
 #include "Logger.h"
+#include "ShaderSourceCache.h"
+#include "GLDebug.h"
+#include "GLHooks.h"
+#include "ScratchAllocator.h"
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 
-Shader::Shader() : programID(0) {
+Shader::Shader() : programID(0), linked(false), spirv(false) {
     // Initialize shaderIDs array
     for (int i = 0; i < static_cast<int>(ShaderType::NumShaderTypes); ++i) {
         shaderIDs[i] = 0;
     }
+    workgroupSize[0] = workgroupSize[1] = workgroupSize[2] = 0;
 }
 
 Shader::~Shader() {
     cleanup();
 }
 
-void Shader::addShaderFromSource(ShaderType type, const char* source) {
-    unsigned int shaderID = compileShader(type, source);
-    shaderIDs[static_cast<int>(type)] = shaderID;
+void Shader::addShaderFromSource(ShaderType type, const char* source, const char* name) {
+    if (name != nullptr && label.empty()) {
+        label = name;
+    }
+    stageNames[static_cast<int>(type)] = name != nullptr ? name : "<source>";
+    shaderIDs[static_cast<int>(type)] = compileShader(type, source, name);
 }
 
 void Shader::addShaderFromFile(ShaderType type, const char* filePath) {
-    char* source = readFile(filePath);
-    if (source) {
-        addShaderFromSource(type, source);
-        delete[] source; // Clean up allocated memory after use
+    // Served from the background preload when the file was queued at startup
+    std::string source;
+    if (shaderSourceCache.get(filePath, source)) {
+        addShaderFromSource(type, source.c_str(), filePath);
     } else {
         logger.Shader("Failed to read file: %s", filePath);
     }
 }
 
+void Shader::addShaderFromBinary(ShaderType type, const void* binary, size_t size, const char* name) {
+    if (label.empty()) {
+        label = name;
+    }
+    stageNames[static_cast<int>(type)] = name;
+    spirv = true;
+
+    GLuint shaderID = createShader(type);
+    if (shaderID == 0) {
+        return;
+    }
+    glShaderBinary(1, &shaderID, GL_SHADER_BINARY_FORMAT_SPIR_V, binary, static_cast<GLsizei>(size));
+    // Specialization is the compile step; its status is read in finishLink()
+    if (GLEW_VERSION_4_6) {
+        glSpecializeShader(shaderID, "main", 0, nullptr, nullptr);
+    } else {
+        glSpecializeShaderARB(shaderID, "main", 0, nullptr, nullptr);
+    }
+    glDebug.label(GL_SHADER, shaderID, name);
+    shaderIDs[static_cast<int>(type)] = shaderID;
+}
+
 void Shader::linkProgram() {
+    submitLink();
+    finishLink();
+}
+
+void Shader::submitLink() {
     programID = glCreateProgram();
 
     for (int i = 0; i < static_cast<int>(ShaderType::NumShaderTypes); ++i) {
@@ -39,14 +75,43 @@ void Shader::linkProgram() {
     }
 
     glLinkProgram(programID);
+}
+
+bool Shader::isLinkComplete() const {
+    if (programID == 0 || !(GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile)) {
+        return true;
+    }
+    GLint complete = GL_TRUE;
+    glGetProgramiv(programID, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+bool Shader::finishLink() {
+    // Stage logs first: a failed compile is the usual reason for a failed link
+    for (int i = 0; i < static_cast<int>(ShaderType::NumShaderTypes); ++i) {
+        if (shaderIDs[i] != 0) {
+            checkStage(i);
+        }
+    }
 
     // Check linking status
     int success;
     glGetProgramiv(programID, GL_LINK_STATUS, &success);
+    GLint logLength = 0;
+    glGetProgramiv(programID, GL_INFO_LOG_LENGTH, &logLength);
+    std::string infoLog(logLength > 1 ? logLength : 0, '\0');
+    if (logLength > 1) {
+        glGetProgramInfoLog(programID, logLength, nullptr, &infoLog[0]);
+    }
+    const char* name = label.empty() ? "<source>" : label.c_str();
     if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(programID, 512, nullptr, infoLog);
-        logger.Shader("Shader program linking failed: %s\n", infoLog);
+        logger.Shader("Shader program linking failed (%s):\n%s", name, infoLog.c_str());
+    } else {
+        if (!infoLog.empty()) {
+            logger.Shader("Shader program linked with messages (%s):\n%s", name, infoLog.c_str());
+        }
+        glDebug.label(GL_PROGRAM, programID, name);
+        reflectResources();
     }
 
     // Detach and delete shaders after linking
@@ -54,22 +119,439 @@ void Shader::linkProgram() {
         if (shaderIDs[i] != 0) {
             glDetachShader(programID, shaderIDs[i]);
             glDeleteShader(shaderIDs[i]);
+            shaderIDs[i] = 0;
         }
     }
+
+    linked = success != 0;
+    return linked;
 }
 
 void Shader::use() {
     glUseProgram(programID);
 }
 
+void Shader::setUniformMatrix4(const char* name, const float* value) {
+    GLint location = findBinding(uniforms, name);
+    if (location >= 0) {
+        glUniformMatrix4fv(location, 1, GL_FALSE, value);
+    }
+}
+
+void Shader::setUniformVector4(const char* name, const float* values, int count) {
+    GLint location = findBinding(uniforms, name);
+    if (location >= 0) {
+        glUniform4fv(location, count, values);
+    }
+}
+
+void Shader::setUniformInt(const char* name, int value) {
+    GLint location = findBinding(uniforms, name);
+    if (location >= 0) {
+        glUniform1i(location, value);
+    }
+}
+
+void Shader::setUniformUint(const char* name, unsigned int value) {
+    GLint location = findBinding(uniforms, name);
+    if (location >= 0) {
+        glUniform1ui(location, value);
+    }
+}
+
+void Shader::setUniformMatrix4(int slot, const float* value) {
+    GLint location = findSlot(uniformSlots, slot);
+    if (location >= 0) {
+        glUniformMatrix4fv(location, 1, GL_FALSE, value);
+    }
+}
+
+void Shader::setUniformVector4(int slot, const float* values, int count) {
+    GLint location = findSlot(uniformSlots, slot);
+    if (location >= 0) {
+        glUniform4fv(location, count, values);
+    }
+}
+
+void Shader::setUniformInt(int slot, int value) {
+    GLint location = findSlot(uniformSlots, slot);
+    if (location >= 0) {
+        glUniform1i(location, value);
+    }
+}
+
+void Shader::setUniformUint(int slot, unsigned int value) {
+    GLint location = findSlot(uniformSlots, slot);
+    if (location >= 0) {
+        glUniform1ui(location, value);
+    }
+}
+
+GLint Shader::getUniformBlockSize(const char* blockName) const {
+    for (size_t i = 0; i < uniformBlocks.size(); ++i) {
+        if (uniformBlocks[i].name == blockName) {
+            return uniformBlocks[i].size;
+        }
+    }
+    return -1;
+}
+
+bool Shader::bindUniformBuffer(const char* blockName, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    GLint binding = findBinding(uniformBlocks, blockName);
+    if (binding < 0) {
+        logger.Shader("Uniform block not found: %s", blockName);
+        return false;
+    }
+    if (size == 0) {
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+    } else {
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+    }
+    return true;
+}
+
+void Shader::getWorkgroupSize(GLuint size[3]) const {
+    size[0] = workgroupSize[0];
+    size[1] = workgroupSize[1];
+    size[2] = workgroupSize[2];
+}
+
+void Shader::dispatch(GLuint groupsX, GLuint groupsY, GLuint groupsZ) {
+    if (!isCompute()) {
+        logger.Shader("dispatch() on a program without a compute stage");
+        return;
+    }
+    glDispatchCompute(groupsX, groupsY, groupsZ);
+}
+
+void Shader::dispatchThreads(GLuint threadsX, GLuint threadsY, GLuint threadsZ) {
+    if (!isCompute()) {
+        logger.Shader("dispatchThreads() on a program without a compute stage");
+        return;
+    }
+    glDispatchCompute((threadsX + workgroupSize[0] - 1) / workgroupSize[0],
+                      (threadsY + workgroupSize[1] - 1) / workgroupSize[1],
+                      (threadsZ + workgroupSize[2] - 1) / workgroupSize[2]);
+}
+
+void Shader::dispatchIndirect(GLuint buffer, GLintptr offset) {
+    if (!isCompute()) {
+        logger.Shader("dispatchIndirect() on a program without a compute stage");
+        return;
+    }
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, buffer);
+    glDispatchComputeIndirect(offset);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+}
+
+bool Shader::bindStorageBuffer(const char* blockName, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    GLint binding = findBinding(storageBlocks, blockName);
+    if (binding < 0) {
+        logger.Shader("Storage block not found: %s", blockName);
+        return false;
+    }
+    if (size == 0) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+    } else {
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, buffer, offset, size);
+    }
+    return true;
+}
+
+bool Shader::bindStorageBuffer(int slot, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    GLint binding = findSlot(storageBlockSlots, slot);
+    if (binding < 0) {
+        return false;
+    }
+    if (size == 0) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+    } else {
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, buffer, offset, size);
+    }
+    return true;
+}
+
+bool Shader::bindImage(const char* name, GLuint texture, GLenum access, GLenum format, GLint level) {
+    GLint unit = findBinding(images, name);
+    if (unit < 0) {
+        logger.Shader("Image uniform not found: %s", name);
+        return false;
+    }
+    glBindImageTexture(unit, texture, level, GL_TRUE, 0, access, format);
+    return true;
+}
+
+void Shader::memoryBarrier(GLbitfield barriers) {
+    glMemoryBarrier(barriers);
+}
+
+void Shader::storageBarrier() {
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void Shader::imageBarrier() {
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
+
+void Shader::textureFetchBarrier() {
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void Shader::commandBarrier() {
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+}
+
+void Shader::vertexBarrier() {
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT);
+}
+
+void Shader::reflectResources() {
+    workgroupSize[0] = workgroupSize[1] = workgroupSize[2] = 0;
+    storageBlocks.clear();
+    uniformBlocks.clear();
+    uniforms.clear();
+    images.clear();
+    attributes.clear();
+    uniformSlots.clear();
+    uniformBlockSlots.clear();
+    storageBlockSlots.clear();
+
+    if (shaderIDs[static_cast<int>(ShaderType::Compute)] != 0) {
+        GLint size[3];
+        glGetProgramiv(programID, GL_COMPUTE_WORK_GROUP_SIZE, size);
+        workgroupSize[0] = static_cast<GLuint>(size[0]);
+        workgroupSize[1] = static_cast<GLuint>(size[1]);
+        workgroupSize[2] = static_cast<GLuint>(size[2]);
+    }
+
+    reflectBlocks(GL_SHADER_STORAGE_BLOCK, storageBlocks);
+    reflectBlocks(GL_UNIFORM_BLOCK, uniformBlocks);
+
+    char name[256];
+    GLint numUniforms = 0;
+    glGetProgramInterfaceiv(programID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &numUniforms);
+    for (GLint i = 0; i < numUniforms; ++i) {
+        const GLenum properties[2] = {GL_TYPE, GL_LOCATION};
+        GLint values[2];
+        glGetProgramResourceiv(programID, GL_UNIFORM, i, 2, properties, 2, nullptr, values);
+
+        // Block members have no location
+        if (values[1] < 0) {
+            continue;
+        }
+
+        GLsizei nameLength = 0;
+        glGetProgramResourceName(programID, GL_UNIFORM, i, sizeof(name), &nameLength, name);
+        // Arrays are reported as "name[0]"; setters look them up by the base name
+        if (nameLength > 3 && strcmp(name + nameLength - 3, "[0]") == 0) {
+            name[nameLength - 3] = '\0';
+        }
+
+        Binding uniform;
+        uniform.name = name;
+        uniform.binding = values[1];
+        uniform.size = 0;
+        uniform.type = static_cast<GLenum>(values[0]);
+        uniforms.push_back(uniform);
+
+        // GL_IMAGE_1D .. GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY are all the image types
+        if (values[0] >= GL_IMAGE_1D && values[0] <= GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY) {
+            Binding image = uniform;
+            glGetUniformiv(programID, values[1], &image.binding);
+            images.push_back(image);
+        }
+    }
+
+    // Vertex inputs; built-ins such as gl_VertexID have no location
+    GLint numInputs = 0;
+    glGetProgramInterfaceiv(programID, GL_PROGRAM_INPUT, GL_ACTIVE_RESOURCES, &numInputs);
+    for (GLint i = 0; i < numInputs && !isCompute(); ++i) {
+        const GLenum properties[2] = {GL_TYPE, GL_LOCATION};
+        GLint values[2];
+        glGetProgramResourceiv(programID, GL_PROGRAM_INPUT, i, 2, properties, 2, nullptr, values);
+        if (values[1] < 0) {
+            continue;
+        }
+        glGetProgramResourceName(programID, GL_PROGRAM_INPUT, i, sizeof(name), nullptr, name);
+
+        Binding attribute;
+        attribute.name = name;
+        attribute.binding = values[1];
+        attribute.size = 0;
+        attribute.type = static_cast<GLenum>(values[0]);
+        attributes.push_back(attribute);
+    }
+
+    if (isCompute()) {
+        logger.Debug("Compute program %u: workgroup %ux%ux%u, %d storage blocks, %d images", programID,
+                     workgroupSize[0], workgroupSize[1], workgroupSize[2], static_cast<int>(storageBlocks.size()),
+                     static_cast<int>(images.size()));
+    } else {
+        logger.Debug("Program %u: %d attributes, %d uniforms, %d uniform blocks, %d storage blocks", programID,
+                     static_cast<int>(attributes.size()), static_cast<int>(uniforms.size()),
+                     static_cast<int>(uniformBlocks.size()), static_cast<int>(storageBlocks.size()));
+    }
+}
+
+void Shader::reflectBlocks(GLenum interface, std::vector<Binding>& blocks) {
+    char name[256];
+    GLint numBlocks = 0;
+    glGetProgramInterfaceiv(programID, interface, GL_ACTIVE_RESOURCES, &numBlocks);
+    for (GLint i = 0; i < numBlocks; ++i) {
+        const GLenum properties[2] = {GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE};
+        GLint values[2];
+        glGetProgramResourceiv(programID, interface, i, 2, properties, 2, nullptr, values);
+        glGetProgramResourceName(programID, interface, i, sizeof(name), nullptr, name);
+
+        Binding block;
+        block.name = name;
+        block.binding = values[0];
+        block.size = values[1];
+        block.type = 0;
+        blocks.push_back(block);
+    }
+}
+
+GLint Shader::findBinding(const std::vector<Binding>& bindings, const char* name) {
+    const Binding* binding = findEntry(bindings, name);
+    return binding != nullptr ? binding->binding : -1;
+}
+
+const Shader::Binding* Shader::findEntry(const std::vector<Binding>& bindings, const char* name) {
+    for (size_t i = 0; i < bindings.size(); ++i) {
+        if (bindings[i].name == name) {
+            return &bindings[i];
+        }
+    }
+    return nullptr;
+}
+
+bool Shader::bindInterface(const ShaderInterface& shaderInterface) {
+    const char* program = label.empty() ? "<source>" : label.c_str();
+    bool valid = linked;
+
+    // SPIR-V programs report no names: entries are matched by location or
+    // binding, which the SPIR-V build requires every shader to declare
+    for (size_t i = 0; i < attributes.size(); ++i) {
+        const Binding& attribute = attributes[i];
+        const ShaderAttribute* declared = nullptr;
+        for (size_t j = 0; j < shaderInterface.numAttributes && declared == nullptr; ++j) {
+            const ShaderAttribute& candidate = shaderInterface.attributes[j];
+            if (spirv ? attribute.binding == candidate.location : attribute.name == candidate.name) {
+                declared = &candidate;
+            }
+        }
+        if (declared == nullptr) {
+            logger.Shader("%s: vertex input %s (location %d) is not fed by the vertex layout", program,
+                          attribute.name.c_str(), attribute.binding);
+            valid = false;
+        } else if (declared->location != attribute.binding) {
+            logger.Shader("%s: vertex input %s is at location %d, the vertex layout feeds %d", program,
+                          declared->name, attribute.binding, declared->location);
+            valid = false;
+        } else if (declared->type != attribute.type) {
+            logger.Shader("%s: vertex input %s has type 0x%04x, expected 0x%04x", program, declared->name,
+                          attribute.type, declared->type);
+            valid = false;
+        }
+    }
+
+    // Every active uniform must be set by someone, or it keeps its default
+    uniformSlots.assign(shaderInterface.numUniforms, -1);
+    for (size_t i = 0; i < uniforms.size(); ++i) {
+        const Binding& uniform = uniforms[i];
+        const ShaderUniform* declared = nullptr;
+        size_t slot = 0;
+        for (size_t j = 0; j < shaderInterface.numUniforms && declared == nullptr; ++j) {
+            const ShaderUniform& candidate = shaderInterface.uniforms[j];
+            if (spirv ? uniform.binding == candidate.location : uniform.name == candidate.name) {
+                declared = &candidate;
+                slot = j;
+            }
+        }
+        if (declared == nullptr) {
+            logger.Shader("%s: uniform %s (location %d) is never set", program, uniform.name.c_str(),
+                          uniform.binding);
+            valid = false;
+        } else if (declared->location >= 0 && declared->location != uniform.binding) {
+            logger.Shader("%s: uniform %s is at location %d, expected %d", program, declared->name,
+                          uniform.binding, declared->location);
+            valid = false;
+        } else if (declared->type != uniform.type) {
+            logger.Shader("%s: uniform %s has type 0x%04x, expected 0x%04x", program, declared->name, uniform.type,
+                          declared->type);
+            valid = false;
+        } else {
+            uniformSlots[slot] = uniform.binding;
+        }
+    }
+
+    valid = checkBlocks("uniform block", uniformBlocks, shaderInterface.uniformBlocks,
+                        shaderInterface.numUniformBlocks, uniformBlockSlots) && valid;
+    valid = checkBlocks("storage block", storageBlocks, shaderInterface.storageBlocks,
+                        shaderInterface.numStorageBlocks, storageBlockSlots) && valid;
+    return valid;
+}
+
+bool Shader::checkBlocks(const char* kind, const std::vector<Binding>& reflected, const ShaderBlock* declared,
+                         size_t count, std::vector<GLint>& slots) {
+    const char* program = label.empty() ? "<source>" : label.c_str();
+    bool valid = true;
+    slots.assign(count, -1);
+
+    for (size_t i = 0; i < reflected.size(); ++i) {
+        const ShaderBlock* block = nullptr;
+        for (size_t j = 0; j < count && block == nullptr; ++j) {
+            if (spirv ? reflected[i].binding == declared[j].binding : reflected[i].name == declared[j].name) {
+                block = &declared[j];
+                slots[j] = reflected[i].binding;
+            }
+        }
+        if (block == nullptr) {
+            logger.Shader("%s: %s %s (binding %d) is never bound", program, kind, reflected[i].name.c_str(),
+                          reflected[i].binding);
+            valid = false;
+        } else if (block->binding != reflected[i].binding) {
+            logger.Shader("%s: %s %s is at binding %d, the C++ side binds %d", program, kind, block->name,
+                          reflected[i].binding, block->binding);
+            valid = false;
+        } else if (block->size != 0 && reflected[i].size > block->size) {
+            logger.Shader("%s: %s %s needs %d bytes, the C++ struct has %d", program, kind, block->name,
+                          reflected[i].size, static_cast<int>(block->size));
+            valid = false;
+        }
+    }
+    return valid;
+}
+
 void Shader::cleanup() {
+    // Stages that were submitted but never linked
+    for (int i = 0; i < static_cast<int>(ShaderType::NumShaderTypes); ++i) {
+        if (shaderIDs[i] != 0) {
+            glDeleteShader(shaderIDs[i]);
+            shaderIDs[i] = 0;
+        }
+        stageNames[i].clear();
+    }
     if (programID != 0) {
         glDeleteProgram(programID);
         programID = 0;
     }
+    workgroupSize[0] = workgroupSize[1] = workgroupSize[2] = 0;
+    storageBlocks.clear();
+    uniformBlocks.clear();
+    uniforms.clear();
+    images.clear();
+    attributes.clear();
+    uniformSlots.clear();
+    uniformBlockSlots.clear();
+    storageBlockSlots.clear();
+    label.clear();
+    linked = false;
+    spirv = false;
 }
 
-char* Shader::readFile(const char* filePath) {
+char* Shader::readFile(const char* filePath, ScratchAllocator& scratch) {
     FILE* file = fopen(filePath, "rb");
     if (!file) {
         logger.Shader("Failed to open file: %s", filePath);
@@ -81,17 +563,16 @@ char* Shader::readFile(const char* filePath) {
     fseek(file, 0, SEEK_END);
     long fileSize = ftell(file);
     rewind(file);
-
-    // Allocate buffer for file contents
-    char* buffer = new char[fileSize + 1];
-    if (!buffer) {
-        char logBuffer[128];
-        logger.Shader("Failed to allocate memory for file: ", logBuffer);
+    if (fileSize < 0) {
+        logger.Shader("Failed to read file: %s", filePath);
 
         fclose(file);
         return nullptr;
     }
 
+    // Contents live in the thread's scratch memory until the caller releases it
+    char* buffer = scratch.allocateString(static_cast<size_t>(fileSize));
+
     // Read file contents into buffer
     size_t bytesRead = fread(buffer, 1, fileSize, file);
     buffer[bytesRead] = '\0'; // Null-terminate the string
@@ -101,45 +582,125 @@ char* Shader::readFile(const char* filePath) {
     return buffer;
 }
 
-unsigned int Shader::compileShader(ShaderType type, const char* source) {
-    unsigned int shaderID;
+bool Shader::loadSource(const char* filePath, std::string& source) {
+    source.clear();
+    return expandIncludes(filePath, source, 0);
+}
+
+bool Shader::expandIncludes(const char* filePath, std::string& source, int depth) {
+    if (depth > 16) {
+        logger.Shader("Include depth exceeded while loading: %s", filePath);
+        return false;
+    }
+
+    // File contents and include paths are released when this level returns
+    ScratchAllocator& scratch = ScratchAllocator::forThread();
+    ScratchScope scope(scratch);
+
+    char* buffer = readFile(filePath, scratch);
+    if (!buffer) {
+        return false;
+    }
+
+    // Includes are resolved relative to the directory of the including file
+    const char* slash = strrchr(filePath, '/');
+    size_t directoryLength = slash ? static_cast<size_t>(slash - filePath) + 1 : 0;
+
+    bool success = true;
+    const char* line = buffer;
+    while (*line) {
+        const char* lineEnd = strchr(line, '\n');
+        size_t lineLength = lineEnd ? static_cast<size_t>(lineEnd - line) + 1 : strlen(line);
+
+        const char* cursor = line;
+        while (*cursor == ' ' || *cursor == '\t') {
+            ++cursor;
+        }
+
+        const char* open = nullptr;
+        const char* close = nullptr;
+        if (strncmp(cursor, "#include", 8) == 0) {
+            open = strchr(cursor, '"');
+            close = open ? strchr(open + 1, '"') : nullptr;
+        }
+
+        if (open && close && close < line + lineLength) {
+            size_t nameLength = static_cast<size_t>(close - open - 1);
+            char* includePath = scratch.allocateString(directoryLength + nameLength);
+            memcpy(includePath, filePath, directoryLength);
+            memcpy(includePath + directoryLength, open + 1, nameLength);
+            includePath[directoryLength + nameLength] = '\0';
+
+            if (!expandIncludes(includePath, source, depth + 1)) {
+                logger.Shader("Failed to resolve include \"%s\" in %s", includePath, filePath);
+                success = false;
+                break;
+            }
+            if (source.empty() || source[source.size() - 1] != '\n') {
+                source += '\n';
+            }
+        } else {
+            source.append(line, lineLength);
+        }
+
+        line += lineLength;
+    }
+
+    return success;
+}
+
+GLuint Shader::createShader(ShaderType type) {
     switch (type) {
         case ShaderType::Vertex:
-            shaderID = glCreateShader(GL_VERTEX_SHADER);
-            break;
+            return glCreateShader(GL_VERTEX_SHADER);
         case ShaderType::Fragment:
-            shaderID = glCreateShader(GL_FRAGMENT_SHADER);
-            break;
+            return glCreateShader(GL_FRAGMENT_SHADER);
         case ShaderType::Geometry:
-            shaderID = glCreateShader(GL_GEOMETRY_SHADER);
-            break;
+            return glCreateShader(GL_GEOMETRY_SHADER);
         case ShaderType::TessControl:
-            shaderID = glCreateShader(GL_TESS_CONTROL_SHADER);
-            break;
+            return glCreateShader(GL_TESS_CONTROL_SHADER);
         case ShaderType::TessEvaluation:
-            shaderID = glCreateShader(GL_TESS_EVALUATION_SHADER);
-            break;
+            return glCreateShader(GL_TESS_EVALUATION_SHADER);
         case ShaderType::Compute:
-            shaderID = glCreateShader(GL_COMPUTE_SHADER);
-            break;
+            return glCreateShader(GL_COMPUTE_SHADER);
         default:
             logger.Shader("Unsupported shader type.");
             return 0;
     }
+}
+
+unsigned int Shader::compileShader(ShaderType type, const char* source, const char* name) {
+    unsigned int shaderID = createShader(type);
+    if (shaderID == 0) {
+        return 0;
+    }
 
     glShaderSource(shaderID, 1, &source, nullptr);
     glCompileShader(shaderID);
+    glDebug.label(GL_SHADER, shaderID, name != nullptr ? name : "<source>");
+
+    // Status is read in finishLink(), so this does not wait for the compiler
+    return shaderID;
+}
 
-    // Check compilation status
+bool Shader::checkStage(int stage) {
+    GLuint shaderID = shaderIDs[stage];
     int success;
     glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+    GLint logLength = 0;
+    glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &logLength);
+    std::string infoLog(logLength > 1 ? logLength : 0, '\0');
+    if (logLength > 1) {
+        glGetShaderInfoLog(shaderID, logLength, nullptr, &infoLog[0]);
+    }
+    const char* name = stageNames[stage].c_str();
     if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(shaderID, 512, nullptr, infoLog);
-        logger.Shader("Shader compilation failed:\n", infoLog);
-
-        return 0;
+        logger.Shader("Shader compilation failed (%s):\n%s", name, infoLog.c_str());
+        return false;
     }
-
-    return shaderID;
+    // Warnings, and on some drivers notes about slow paths
+    if (!infoLog.empty()) {
+        logger.Shader("Shader compiled with messages (%s):\n%s", name, infoLog.c_str());
+    }
+    return true;
 }
@@ -3,6 +3,11 @@
 
 #include <GL/glew.h>
 #include <string>
+#include <vector>
+
+#include "ShaderInterface.h"
+
+class ScratchAllocator;
 
 enum class ShaderType {
     Vertex,
@@ -19,18 +24,136 @@ public:
     Shader();
     ~Shader();
 
-    void addShaderFromSource(ShaderType type, const char* source);
+    // name (e.g. the file path) is used in logs and the debug label
+    void addShaderFromSource(ShaderType type, const char* source, const char* name = nullptr);
     void addShaderFromFile(ShaderType type, const char* filePath);
+    // Precompiled SPIR-V (GL_ARB_gl_spirv / GL 4.6), specialized at entry point
+    // main. SPIR-V programs carry no names the driver reports, so
+    // bindInterface() matches them by location and binding, and only the
+    // slot overloads below reach their uniforms and blocks.
+    void addShaderFromBinary(ShaderType type, const void* binary, size_t size, const char* name);
+    bool isSpirv() const { return spirv; }
     void linkProgram();
     void use();
     void cleanup();
 
+    // linkProgram() in two halves. Compiles are only submitted by the add*
+    // calls and statuses are not read until finishLink(), so with
+    // KHR_parallel_shader_compile several programs build concurrently on the
+    // driver's threads; isLinkComplete() polls without blocking.
+    void submitLink();
+    bool isLinkComplete() const;
+    bool finishLink();
+    bool isLinked() const { return linked; }
+    GLuint getProgramID() const { return programID; }
+
+    // Checks the linked program against the C++ side's table: every active
+    // attribute, uniform and block must be listed, at the same location or
+    // binding and with the same type. Entries the compiler removed are fine.
+    // Resolves the table's entries into the slots used by the slot
+    // overloads below. Logs each mismatch and returns false if there was any.
+    bool bindInterface(const ShaderInterface& shaderInterface);
+    // -1 when the program has no such active vertex input
+    GLint getAttributeLocation(const char* name) const { return findBinding(attributes, name); }
+
+    // Uniform setters; program must be in use. Locations come from the table
+    // reflected at link time, so no glGetUniformLocation per call.
+    void setUniformMatrix4(const char* name, const float* value); // column-major
+    void setUniformVector4(const char* name, const float* values, int count = 1);
+    void setUniformInt(const char* name, int value);
+    void setUniformUint(const char* name, unsigned int value);
+    // -1 when the program has no such active uniform (arrays by their base name)
+    GLint getUniformLocation(const char* name) const { return findBinding(uniforms, name); }
+
+    // Slot overloads for per-frame code: slot is the entry's index in the
+    // interface table given to bindInterface(), so these are array lookups
+    void setUniformMatrix4(int slot, const float* value);
+    void setUniformVector4(int slot, const float* values, int count = 1);
+    void setUniformInt(int slot, int value);
+    void setUniformUint(int slot, unsigned int value);
+    // -1 when the block was compiled out
+    GLint getUniformBlockBinding(int slot) const { return findSlot(uniformBlockSlots, slot); }
+    GLint getStorageBlockBinding(int slot) const { return findSlot(storageBlockSlots, slot); }
+    bool bindStorageBuffer(int slot, GLuint buffer, GLintptr offset = 0, GLsizeiptr size = 0);
+
+    // Uniform blocks: binding point and GL_BUFFER_DATA_SIZE as reflected at
+    // link time (-1 if absent). Blocks should declare layout(binding = N).
+    GLint getUniformBlockBinding(const char* blockName) const { return findBinding(uniformBlocks, blockName); }
+    GLint getUniformBlockSize(const char* blockName) const;
+    // Size 0 binds the whole buffer
+    bool bindUniformBuffer(const char* blockName, GLuint buffer, GLintptr offset = 0, GLsizeiptr size = 0);
+
+    // Compute programs (a ShaderType::Compute stage was linked); program must be in use
+    bool isCompute() const { return workgroupSize[0] != 0; }
+    // local_size_x/y/z reflected at link time; zeros for non-compute programs
+    void getWorkgroupSize(GLuint size[3]) const;
+    void dispatch(GLuint groupsX, GLuint groupsY = 1, GLuint groupsZ = 1);
+    // Enough workgroups to cover the given invocation counts
+    void dispatchThreads(GLuint threadsX, GLuint threadsY = 1, GLuint threadsZ = 1);
+    // Group counts read from a GL_DISPATCH_INDIRECT_BUFFER (three GLuints at offset)
+    void dispatchIndirect(GLuint buffer, GLintptr offset = 0);
+
+    // Bind by block/uniform name at the binding the shader declares
+    // (layout(binding = N)); size 0 binds the whole buffer
+    bool bindStorageBuffer(const char* blockName, GLuint buffer, GLintptr offset = 0, GLsizeiptr size = 0);
+    bool bindImage(const char* name, GLuint texture, GLenum access, GLenum format, GLint level = 0);
+
+    // Make writes from earlier dispatches visible to later reads
+    static void memoryBarrier(GLbitfield barriers);
+    static void storageBarrier();      // SSBO reads in later shaders
+    static void imageBarrier();        // imageLoad/imageStore in later shaders
+    static void textureFetchBarrier(); // sampling textures written with imageStore
+    static void commandBarrier();      // indirect draw/dispatch arguments
+    static void vertexBarrier();       // vertex/index buffers written through SSBOs
+
+    // Reads a shader file and expands #include "file" directives relative to it.
+    // Safe to call from worker threads (no GL calls).
+    static bool loadSource(const char* filePath, std::string& source);
+
 private:
     unsigned int programID;
     unsigned int shaderIDs[static_cast<int>(ShaderType::NumShaderTypes)];
+    // First shader file added; names the program in logs and debug labels
+    std::string label;
+    std::string stageNames[static_cast<int>(ShaderType::NumShaderTypes)];
+    bool linked;
+    bool spirv;
+
+    // Filled by reflectResources() after linking
+    struct Binding {
+        std::string name;
+        GLint binding; // binding point, image unit, uniform or attribute location
+        GLint size;    // blocks only: minimum buffer size
+        GLenum type;   // uniforms and attributes only
+    };
+    GLuint workgroupSize[3];
+    std::vector<Binding> storageBlocks;
+    std::vector<Binding> uniformBlocks;
+    std::vector<Binding> uniforms;
+    std::vector<Binding> images;
+    std::vector<Binding> attributes;
+
+    // Filled by bindInterface(): locations/bindings in table order, -1 if absent
+    std::vector<GLint> uniformSlots;
+    std::vector<GLint> uniformBlockSlots;
+    std::vector<GLint> storageBlockSlots;
+
+    void reflectResources();
+    void reflectBlocks(GLenum interface, std::vector<Binding>& blocks);
+    static GLint findBinding(const std::vector<Binding>& bindings, const char* name);
+    static const Binding* findEntry(const std::vector<Binding>& bindings, const char* name);
+    static GLint findSlot(const std::vector<GLint>& slots, int slot) {
+        return slot >= 0 && static_cast<size_t>(slot) < slots.size() ? slots[slot] : -1;
+    }
+    bool checkBlocks(const char* kind, const std::vector<Binding>& reflected, const ShaderBlock* declared,
+                     size_t count, std::vector<GLint>& slots);
 
-    char* readFile(const char* filePath);
-    unsigned int compileShader(ShaderType type, const char* source);
+    static char* readFile(const char* filePath, ScratchAllocator& scratch);
+    static bool expandIncludes(const char* filePath, std::string& source, int depth);
+    static GLuint createShader(ShaderType type);
+    unsigned int compileShader(ShaderType type, const char* source, const char* name);
+    // Logs the compile status and info log of a submitted stage
+    bool checkStage(int stage);
 };
 
 #endif // SHADER_H
@@ -0,0 +1,63 @@
+#ifndef SHADER_INTERFACE_H
+#define SHADER_INTERFACE_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+// What the C++ side feeds a program, declared as constexpr tables next to
+// the code that sets up the vertex layout or binds the buffers, using the
+// same constants. Shader::bindInterface() checks a linked program against it,
+// and the entries' indices become the slots of the Shader slot overloads.
+
+struct ShaderAttribute {
+    const char* name;
+    GLint location; // location the VAO feeds
+    GLenum type;    // type the shader must declare, e.g. GL_FLOAT_VEC4
+};
+
+// Uniforms set by the C++ side, samplers included
+struct ShaderUniform {
+    const char* name;
+    GLint location; // explicit layout(location = N); -1 leaves it to the linker (GLSL only)
+    GLenum type;
+};
+
+struct ShaderBlock {
+    const char* name;
+    GLint binding;
+    GLsizeiptr size; // size of the C++ struct; the shader's block may not be larger (0: unchecked)
+};
+
+struct ShaderInterface {
+    const ShaderAttribute* attributes;
+    size_t numAttributes;
+    const ShaderUniform* uniforms;
+    size_t numUniforms;
+    const ShaderBlock* uniformBlocks;
+    size_t numUniformBlocks;
+    const ShaderBlock* storageBlocks;
+    size_t numStorageBlocks;
+};
+
+template <typename T, size_t N>
+constexpr size_t countOf(const T (&)[N]) {
+    return N;
+}
+
+// For static_assert on the tables: no two attributes share a location, no
+// two blocks share a binding
+constexpr bool attributeLocationsUnique(const ShaderAttribute* attributes, size_t count, size_t i = 0, size_t j = 1) {
+    return i + 1 >= count ? true
+           : j >= count   ? attributeLocationsUnique(attributes, count, i + 1, i + 2)
+                          : attributes[i].location != attributes[j].location &&
+                              attributeLocationsUnique(attributes, count, i, j + 1);
+}
+
+constexpr bool blockBindingsUnique(const ShaderBlock* blocks, size_t count, size_t i = 0, size_t j = 1) {
+    return i + 1 >= count ? true
+           : j >= count   ? blockBindingsUnique(blocks, count, i + 1, i + 2)
+                          : blocks[i].binding != blocks[j].binding && blockBindingsUnique(blocks, count, i, j + 1);
+}
+
+#endif // SHADER_INTERFACE_H
@@ -0,0 +1,362 @@
+#include "ShaderLibrary.h"
+#include "GLDebug.h"
+#include "GLHooks.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "ShaderSourceCache.h"
+#include "Json.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+// Definition of the global shader library instance
+ShaderLibrary shaderLibrary;
+
+namespace {
+
+const char* const stageKeys[static_cast<int>(ShaderType::NumShaderTypes)] = {
+    "vertex", "fragment", "geometry", "tessControl", "tessEvaluation", "compute"};
+
+const char* const stageExtensions[static_cast<int>(ShaderType::NumShaderTypes)] = {
+    "vert", "frag", "geom", "tesc", "tese", "comp"};
+
+// Smallest GL_MAX_UNIFORM_BLOCK_SIZE an implementation may report
+const GLsizeiptr placeholderSize = 16384;
+
+void bindPlaceholder(GLuint program, GLenum interface, GLenum target, GLuint buffer) {
+    GLint count = 0;
+    glGetProgramInterfaceiv(program, interface, GL_ACTIVE_RESOURCES, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const GLenum property = GL_BUFFER_BINDING;
+        GLint binding = 0;
+        glGetProgramResourceiv(program, interface, i, 1, &property, 1, nullptr, &binding);
+        glBindBufferBase(target, binding, buffer);
+    }
+}
+
+void unbindPlaceholder(GLuint program, GLenum interface, GLenum target) {
+    GLint count = 0;
+    glGetProgramInterfaceiv(program, interface, GL_ACTIVE_RESOURCES, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const GLenum property = GL_BUFFER_BINDING;
+        GLint binding = 0;
+        glGetProgramResourceiv(program, interface, i, 1, &property, 1, nullptr, &binding);
+        glBindBufferBase(target, binding, 0);
+    }
+}
+
+}
+
+ShaderLibrary::ShaderLibrary() : submitted(false) {}
+
+ShaderLibrary::~ShaderLibrary() {
+    cleanup();
+}
+
+bool ShaderLibrary::loadManifest(const char* filePath) {
+    MappedFile file;
+    if (!file.open(filePath)) {
+        logger.Error("Failed to open shader manifest: %s", filePath);
+        return false;
+    }
+    JsonValue document;
+    std::string error;
+    if (!JsonValue::parse(file.data(), file.size(), document, error)) {
+        logger.Error("Invalid shader manifest %s: %s", filePath, error.c_str());
+        return false;
+    }
+
+    const JsonValue& entries = document["programs"];
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const JsonValue& entry = entries[i];
+        Program program;
+        program.name = entry["name"].asString();
+        program.spirv = false;
+        bool hasStage = false;
+        for (int stage = 0; stage < static_cast<int>(ShaderType::NumShaderTypes); ++stage) {
+            program.stages[stage] = entry[stageKeys[stage]].asString();
+            hasStage = hasStage || !program.stages[stage].empty();
+        }
+        if (program.name.empty() || !hasStage) {
+            logger.Error("Shader manifest %s: entry %zu needs a name and at least one stage", filePath, i);
+            continue;
+        }
+        bool duplicate = false;
+        for (size_t j = 0; j < programs.size(); ++j) {
+            duplicate = duplicate || programs[j].name == program.name;
+        }
+        if (duplicate) {
+            logger.Error("Shader manifest %s: program %s is declared twice", filePath, program.name.c_str());
+            continue;
+        }
+        const JsonValue& defines = entry["defines"];
+        for (size_t j = 0; j < defines.size(); ++j) {
+            program.defines.push_back(defines[j].asString());
+        }
+        programs.push_back(std::move(program));
+    }
+
+    logger.Info("Shader manifest %s: %zu programs", filePath, programs.size());
+    return true;
+}
+
+void ShaderLibrary::preloadSources() {
+    // Stages shared between programs are only read once
+    for (size_t i = 0; i < programs.size(); ++i) {
+        for (int stage = 0; stage < static_cast<int>(ShaderType::NumShaderTypes); ++stage) {
+            if (!programs[i].stages[stage].empty()) {
+                shaderSourceCache.preload(programs[i].stages[stage].c_str());
+            }
+        }
+    }
+}
+
+void ShaderLibrary::compileAll() {
+    if (submitted) {
+        return;
+    }
+    submitted = true;
+
+    // Let the driver use as many compiler threads as it likes; without the
+    // extension the submissions below still compile, one at a time
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+    } else if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+    }
+
+    // Prebuilt SPIR-V skips the driver's GLSL front end and optimizer. Not
+    // with capture builds: traces record GLSL sources for the replay tool.
+    spirvDirectory.clear();
+#ifndef XWGL_GL_CAPTURE
+    const char* spirvSetting = getenv("XWGL_SPIRV");
+    const char* spirvDirectorySetting = getenv("XWGL_SPIRV_DIR");
+#ifdef XWGL_SPIRV_DIR
+    if (spirvDirectorySetting == nullptr) {
+        spirvDirectorySetting = XWGL_SPIRV_DIR;
+    }
+#endif
+    if ((spirvSetting == nullptr || strcmp(spirvSetting, "0") != 0) && spirvDirectorySetting != nullptr &&
+        (GLEW_VERSION_4_6 || GLEW_ARB_gl_spirv)) {
+        spirvDirectory = spirvDirectorySetting;
+    }
+#endif
+
+    int spirvPrograms = 0;
+    for (size_t i = 0; i < programs.size(); ++i) {
+        Program& program = programs[i];
+        program.shader.reset(new Shader());
+        program.spirv = !spirvDirectory.empty() && submitSpirv(program);
+        if (program.spirv) {
+            ++spirvPrograms;
+        } else {
+            submitGlsl(i);
+        }
+    }
+    if (!spirvDirectory.empty()) {
+        logger.Info("ShaderLibrary: %d of %zu programs from SPIR-V in %s", spirvPrograms, programs.size(),
+                    spirvDirectory.c_str());
+    }
+}
+
+bool ShaderLibrary::submitSpirv(Program& program) {
+    MappedFile binaries[static_cast<int>(ShaderType::NumShaderTypes)];
+    for (int stage = 0; stage < static_cast<int>(ShaderType::NumShaderTypes); ++stage) {
+        if (program.stages[stage].empty()) {
+            continue;
+        }
+        std::string path = getSpirvPath(spirvDirectory, program.name, static_cast<ShaderType>(stage));
+        struct stat binaryInfo;
+        struct stat sourceInfo;
+        if (stat(path.c_str(), &binaryInfo) != 0) {
+            logger.Debug("ShaderLibrary: no %s, %s uses GLSL", path.c_str(), program.name.c_str());
+            return false;
+        }
+        // Only the top-level file is compared; the build tracks the includes
+        if (stat(program.stages[stage].c_str(), &sourceInfo) == 0 && sourceInfo.st_mtime > binaryInfo.st_mtime) {
+            logger.Info("ShaderLibrary: %s is newer than %s, %s uses GLSL", program.stages[stage].c_str(),
+                        path.c_str(), program.name.c_str());
+            return false;
+        }
+        if (!binaries[stage].open(path.c_str())) {
+            return false;
+        }
+    }
+
+    // glShaderBinary copies the module, so the mappings can go right after
+    for (int stage = 0; stage < static_cast<int>(ShaderType::NumShaderTypes); ++stage) {
+        if (binaries[stage].isOpen()) {
+            program.shader->addShaderFromBinary(static_cast<ShaderType>(stage), binaries[stage].data(),
+                                                binaries[stage].size(), program.stages[stage].c_str());
+        }
+    }
+    program.shader->submitLink();
+    return true;
+}
+
+void ShaderLibrary::submitGlsl(size_t index) {
+    Program& program = programs[index];
+    for (int stage = 0; stage < static_cast<int>(ShaderType::NumShaderTypes); ++stage) {
+        const std::string& path = program.stages[stage];
+        if (path.empty()) {
+            continue;
+        }
+        std::string source;
+        if (!getStageSource(index, static_cast<ShaderType>(stage), source)) {
+            logger.Shader("Failed to read file: %s", path.c_str());
+            continue;
+        }
+        program.shader->addShaderFromSource(static_cast<ShaderType>(stage), source.c_str(), path.c_str());
+    }
+    program.shader->submitLink();
+}
+
+bool ShaderLibrary::getStageSource(size_t program, ShaderType stage, std::string& source) {
+    const std::string& path = programs[program].stages[static_cast<int>(stage)];
+    if (path.empty() || !shaderSourceCache.get(path.c_str(), source)) {
+        return false;
+    }
+    injectDefines(source, programs[program].defines);
+    return true;
+}
+
+const char* ShaderLibrary::getStageExtension(ShaderType stage) {
+    return stageExtensions[static_cast<int>(stage)];
+}
+
+std::string ShaderLibrary::getSpirvPath(const std::string& directory, const std::string& program, ShaderType stage) {
+    return directory + "/" + program + "." + getStageExtension(stage) + ".spv";
+}
+
+int ShaderLibrary::finishAll() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int pending = 0;
+    int failed = 0;
+    for (size_t i = 0; i < programs.size(); ++i) {
+        Program& program = programs[i];
+        if (!program.shader) {
+            continue;
+        }
+        if (!program.shader->isLinkComplete()) {
+            ++pending;
+        }
+        bool built = program.shader->finishLink();
+        if (!built && program.spirv) {
+            // Drivers differ in the SPIR-V capabilities they accept
+            logger.Shader("Program %s failed to build from SPIR-V, falling back to GLSL", program.name.c_str());
+            program.shader.reset(new Shader());
+            program.spirv = false;
+            submitGlsl(i);
+            built = program.shader->finishLink();
+        }
+        if (!built) {
+            logger.Shader("Program %s failed to build", program.name.c_str());
+            ++failed;
+        }
+    }
+    double waitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    logger.Info("ShaderLibrary: %zu programs built, %d failed, waited %.2f ms for %d still compiling",
+                programs.size(), failed, waitMs, pending);
+    return failed;
+}
+
+void ShaderLibrary::warmUp() {
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    glDebug.label(GL_VERTEX_ARRAY, vao, "ShaderLibrary warm-up");
+    GLuint placeholder = 0;
+    glGenBuffers(1, &placeholder);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, placeholder);
+    glBufferData(GL_COPY_WRITE_BUFFER, placeholderSize, nullptr, GL_STATIC_DRAW);
+    glClearBufferData(GL_COPY_WRITE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDebug.label(GL_BUFFER, placeholder, "ShaderLibrary warm-up blocks");
+
+    glDebug.pushGroup("ShaderLibrary warm-up");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindVertexArray(vao);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(0, 0, 1, 1);
+
+    int warmed = 0;
+    for (size_t i = 0; i < programs.size(); ++i) {
+        Shader* shader = get(programs[i].name.c_str());
+        if (shader == nullptr) {
+            continue;
+        }
+        GLuint program = shader->getProgramID();
+        bindPlaceholder(program, GL_UNIFORM_BLOCK, GL_UNIFORM_BUFFER, placeholder);
+        bindPlaceholder(program, GL_SHADER_STORAGE_BLOCK, GL_SHADER_STORAGE_BUFFER, placeholder);
+        shader->use();
+        if (shader->isCompute()) {
+            shader->dispatch(1);
+        } else {
+            // Attributes read their defaults from the empty VAO; the backbuffer
+            // pixel is cleared by the first frame
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+        unbindPlaceholder(program, GL_UNIFORM_BLOCK, GL_UNIFORM_BUFFER);
+        unbindPlaceholder(program, GL_SHADER_STORAGE_BLOCK, GL_SHADER_STORAGE_BUFFER);
+        ++warmed;
+    }
+
+    glUseProgram(0);
+    glDisable(GL_SCISSOR_TEST);
+    glBindVertexArray(0);
+    glDebug.popGroup();
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &placeholder);
+    logger.Info("ShaderLibrary: warmed up %d programs", warmed);
+}
+
+Shader* ShaderLibrary::get(const char* name) {
+    for (size_t i = 0; i < programs.size(); ++i) {
+        if (programs[i].name == name) {
+            Shader* shader = programs[i].shader.get();
+            return shader != nullptr && shader->isLinked() ? shader : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+Shader* ShaderLibrary::get(const char* name, const ShaderInterface& shaderInterface) {
+    Shader* shader = get(name);
+    if (shader != nullptr && !shader->bindInterface(shaderInterface)) {
+        logger.Shader("Program %s does not match its C++ interface", name);
+        return nullptr;
+    }
+    return shader;
+}
+
+void ShaderLibrary::cleanup() {
+    programs.clear();
+    submitted = false;
+}
+
+void ShaderLibrary::injectDefines(std::string& source, const std::vector<std::string>& defines) {
+    if (defines.empty()) {
+        return;
+    }
+    std::string block;
+    for (size_t i = 0; i < defines.size(); ++i) {
+        // NAME=VALUE becomes #define NAME VALUE
+        std::string define = defines[i];
+        size_t equals = define.find('=');
+        if (equals != std::string::npos) {
+            define[equals] = ' ';
+        }
+        block += "#define " + define + "\n";
+    }
+
+    // After #version, which must stay the first directive
+    size_t insertAt = 0;
+    size_t version = source.find("#version");
+    if (version != std::string::npos) {
+        size_t lineEnd = source.find('\n', version);
+        insertAt = lineEnd == std::string::npos ? source.size() : lineEnd + 1;
+    }
+    source.insert(insertAt, block);
+}
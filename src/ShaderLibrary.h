@@ -0,0 +1,96 @@
+#ifndef SHADER_LIBRARY_H
+#define SHADER_LIBRARY_H
+
+#include "Shader.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Every program the engine uses, declared in shaders/manifest.json:
+//
+//   {"programs": [
+//     {"name": "triangle",
+//      "vertex": "shaders/triangle/vertexShader.glsl",
+//      "fragment": "shaders/triangle/fragmentShader.glsl"},
+//     {"name": "triangle.flat", ..., "defines": ["FLAT_SHADING", "LIGHTS=4"]}
+//   ]}
+//
+// Stage keys are vertex, fragment, geometry, tessControl, tessEvaluation and
+// compute. A permutation is its own entry; its defines are inserted after the
+// #version line.
+//
+// Startup goes loadManifest() + preloadSources() (file I/O on the thread pool)
+// before the context exists, then compileAll() submits every compile and link
+// at once so KHR_parallel_shader_compile can spread them over the driver's
+// threads, and finishAll() + warmUp() collect the results and draw each
+// program once, so no compile or first-use stall lands in the frame loop.
+//
+// With GL_ARB_gl_spirv (core in 4.6) programs are loaded from the SPIR-V the
+// build compiled with glslang and spirv-opt (tools/shaderbuild.cpp), found in
+// XWGL_SPIRV_DIR or the build's spirv/ directory; XWGL_SPIRV=0 turns it off.
+// A program falls back to its GLSL when a binary is missing, older than its
+// source, or fails to specialize or link.
+class ShaderLibrary {
+public:
+    ShaderLibrary();
+    ~ShaderLibrary();
+
+    bool loadManifest(const char* filePath);
+    void preloadSources();
+
+    // Needs a current context and GLEW
+    void compileAll();
+    // Waits for outstanding links and logs failures; returns the number that failed
+    int finishAll();
+    // One 1x1 scissored draw per graphics program, one dispatch per compute
+    // program, with placeholder buffers on every block binding
+    void warmUp();
+
+    // nullptr for unknown names and programs that failed to build
+    Shader* get(const char* name);
+    // Also nullptr when the program does not match what the C++ side feeds it
+    // (see Shader::bindInterface()); otherwise the interface's slots are bound
+    Shader* get(const char* name, const ShaderInterface& shaderInterface);
+
+    void cleanup();
+
+    // Manifest contents, for the SPIR-V build tool
+    size_t getProgramCount() const { return programs.size(); }
+    const std::string& getProgramName(size_t program) const { return programs[program].name; }
+    // Empty when the program has no such stage
+    const std::string& getStagePath(size_t program, ShaderType stage) const {
+        return programs[program].stages[static_cast<int>(stage)];
+    }
+    // With #includes expanded and the entry's defines inserted
+    bool getStageSource(size_t program, ShaderType stage, std::string& source);
+
+    // glslang's name for the stage: vert, frag, geom, tesc, tese or comp
+    static const char* getStageExtension(ShaderType stage);
+    // <directory>/<program>.<extension>.spv
+    static std::string getSpirvPath(const std::string& directory, const std::string& program, ShaderType stage);
+
+private:
+    struct Program {
+        std::string name;
+        std::string stages[static_cast<int>(ShaderType::NumShaderTypes)];
+        std::vector<std::string> defines;
+        std::unique_ptr<Shader> shader;
+        bool spirv;
+    };
+
+    std::vector<Program> programs;
+    bool submitted;
+    // Empty when SPIR-V is off or unsupported
+    std::string spirvDirectory;
+
+    bool submitSpirv(Program& program);
+    void submitGlsl(size_t program);
+
+    static void injectDefines(std::string& source, const std::vector<std::string>& defines);
+};
+
+// Global instance of ShaderLibrary
+extern ShaderLibrary shaderLibrary;
+
+#endif // SHADER_LIBRARY_H
@@ -0,0 +1,45 @@
+#include "ShaderSourceCache.h"
+#include "Shader.h"
+#include "ThreadPool.h"
+
+// Definition of the global shader source cache instance
+ShaderSourceCache shaderSourceCache;
+
+void ShaderSourceCache::preload(const char* filePath) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.count(filePath) != 0) {
+        return;
+    }
+
+    Entry entry;
+    entry.source = std::make_shared<std::string>();
+
+    std::string path(filePath);
+    std::shared_ptr<std::string> source = entry.source;
+    entry.ready = threadPool.submit([path, source]() { return Shader::loadSource(path.c_str(), *source); }).share();
+
+    entries[path] = entry;
+}
+
+bool ShaderSourceCache::get(const char* filePath, std::string& source) {
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<std::string, Entry>::iterator it = entries.find(filePath);
+        if (it == entries.end()) {
+            return Shader::loadSource(filePath, source);
+        }
+        entry = it->second;
+    }
+
+    if (!entry.ready.get()) {
+        return false;
+    }
+    source = *entry.source;
+    return true;
+}
+
+void ShaderSourceCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
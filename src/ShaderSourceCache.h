@@ -0,0 +1,35 @@
+#ifndef SHADER_SOURCE_CACHE_H
+#define SHADER_SOURCE_CACHE_H
+
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Reads and preprocesses shader files on the thread pool so the disk I/O and
+// #include expansion overlap with X11/GLX setup on the main thread.
+class ShaderSourceCache {
+public:
+    // Queue a file for background loading; repeated calls for the same path are ignored
+    void preload(const char* filePath);
+
+    // Returns the preprocessed source, waiting for a pending preload or loading
+    // synchronously if the file was never preloaded. Returns false on failure.
+    bool get(const char* filePath, std::string& source);
+
+    void clear();
+
+private:
+    struct Entry {
+        std::shared_future<bool> ready;
+        std::shared_ptr<std::string> source;
+    };
+
+    std::map<std::string, Entry> entries;
+    std::mutex mutex;
+};
+
+// Global instance of ShaderSourceCache
+extern ShaderSourceCache shaderSourceCache;
+
+#endif // SHADER_SOURCE_CACHE_H
@@ -0,0 +1,67 @@
+#include "StartupTracer.h"
+#include "Logger.h"
+
+// Definition of the global startup tracer instance
+StartupTracer startupTracer;
+
+StartupTracer::StartupTracer()
+    : origin(std::chrono::steady_clock::now()), mainThreadID(std::this_thread::get_id()), firstFrameMarked(false) {
+    phases.reserve(32);
+}
+
+double StartupTracer::elapsedMs() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+}
+
+int StartupTracer::beginPhase(const char* name) {
+    Phase phase;
+    phase.name = name;
+    phase.startMs = elapsedMs();
+    phase.durationMs = -1.0;
+    phase.mainThread = std::this_thread::get_id() == mainThreadID;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    phases.push_back(phase);
+    return static_cast<int>(phases.size()) - 1;
+}
+
+void StartupTracer::endPhase(int phase) {
+    double now = elapsedMs();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (phase >= 0 && phase < static_cast<int>(phases.size())) {
+        phases[phase].durationMs = now - phases[phase].startMs;
+    }
+}
+
+void StartupTracer::markFirstFrame() {
+    if (firstFrameMarked) {
+        return;
+    }
+    firstFrameMarked = true;
+    report(elapsedMs());
+}
+
+void StartupTracer::report(double firstFrameMs) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    logger.Info("Startup phases (ms since process start):");
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const Phase& phase = phases[i];
+        if (phase.durationMs < 0.0) {
+            logger.Info("  %-24s start %8.3f  (unfinished)  [%s]", phase.name, phase.startMs,
+                        phase.mainThread ? "main" : "worker");
+        } else {
+            logger.Info("  %-24s start %8.3f  took %8.3f  [%s]", phase.name, phase.startMs, phase.durationMs,
+                        phase.mainThread ? "main" : "worker");
+        }
+    }
+    logger.Info("Time to first frame: %.3f ms", firstFrameMs);
+}
+
+StartupPhase::StartupPhase(const char* name) : phase(startupTracer.beginPhase(name)) {
+}
+
+StartupPhase::~StartupPhase() {
+    startupTracer.endPhase(phase);
+}
@@ -0,0 +1,56 @@
+#ifndef STARTUP_TRACER_H
+#define STARTUP_TRACER_H
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Records named startup phases (on any thread) relative to process start and
+// reports them to the info log once the first frame has been presented.
+class StartupTracer {
+public:
+    StartupTracer();
+
+    // Returns the phase index to pass to endPhase()
+    int beginPhase(const char* name);
+    void endPhase(int phase);
+
+    void markFirstFrame();
+    bool isFirstFrameMarked() const { return firstFrameMarked; }
+
+private:
+    struct Phase {
+        const char* name;
+        double startMs;
+        double durationMs;
+        bool mainThread;
+    };
+
+    std::chrono::steady_clock::time_point origin;
+    std::thread::id mainThreadID;
+    std::vector<Phase> phases;
+    std::mutex mutex;
+    bool firstFrameMarked;
+
+    double elapsedMs() const;
+    void report(double firstFrameMs);
+};
+
+// Times the enclosing scope as one startup phase
+class StartupPhase {
+public:
+    explicit StartupPhase(const char* name);
+    ~StartupPhase();
+
+private:
+    int phase;
+
+    StartupPhase(const StartupPhase&);
+    StartupPhase& operator=(const StartupPhase&);
+};
+
+// Global instance of StartupTracer
+extern StartupTracer startupTracer;
+
+#endif // STARTUP_TRACER_H
@@ -0,0 +1,94 @@
+#include "StaticMesh.h"
+#include "GLDebug.h"
+#include "GLHooks.h"
+#include "MemoryBudget.h"
+#include "MeshCache.h"
+#include "MeshLoader.h"
+#include "MeshOptimizer.h"
+
+#include <cstddef>
+
+StaticMesh::StaticMesh()
+    : vao(0), vertexBuffer(0), indexBuffer(0), indexCount(0), indexType(GL_UNSIGNED_INT), lodCount(0),
+      boundsRadius(0.0f) {
+}
+
+StaticMesh::~StaticMesh() {
+    cleanup();
+}
+
+bool StaticMesh::upload(const MappedMesh& mesh) {
+    cleanup();
+
+    const MeshCacheHeader& header = mesh.getHeader();
+
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glDebug.label(GL_VERTEX_ARRAY, vao, "StaticMesh");
+
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, mesh.getVertexBytes(), mesh.getVertices(), GL_STATIC_DRAW);
+    memoryBudget.trackBuffer(MemoryCategory::Geometry, vertexBuffer, static_cast<int64_t>(mesh.getVertexBytes()));
+    glDebug.label(GL_BUFFER, vertexBuffer, "StaticMesh vertices");
+
+    const GLsizei stride = sizeof(QuantizedVertex);
+    glVertexAttribPointer(MeshAttributePosition, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+                          reinterpret_cast<const void*>(offsetof(QuantizedVertex, position)));
+    glEnableVertexAttribArray(MeshAttributePosition);
+    glVertexAttribPointer(MeshAttributeNormal, 2, GL_SHORT, GL_TRUE, stride,
+                          reinterpret_cast<const void*>(offsetof(QuantizedVertex, normal)));
+    glEnableVertexAttribArray(MeshAttributeNormal);
+    glVertexAttribPointer(MeshAttributeTexCoord, 2, GL_HALF_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<const void*>(offsetof(QuantizedVertex, texCoord)));
+    glEnableVertexAttribArray(MeshAttributeTexCoord);
+    glVertexAttribPointer(MeshAttributeColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                          reinterpret_cast<const void*>(offsetof(QuantizedVertex, color)));
+    glEnableVertexAttribArray(MeshAttributeColor);
+
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.getIndexBytes(), mesh.getIndices(), GL_STATIC_DRAW);
+    memoryBudget.trackBuffer(MemoryCategory::Geometry, indexBuffer, static_cast<int64_t>(mesh.getIndexBytes()));
+    glDebug.label(GL_BUFFER, indexBuffer, "StaticMesh indices");
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // Full detail; coarser levels follow it in the same element buffer
+    indexCount = static_cast<GLsizei>(header.lods[0].indexCount);
+    indexType = header.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    lodCount = header.lodCount;
+    for (unsigned int i = 0; i < lodCount; ++i) {
+        lods[i] = header.lods[i];
+    }
+
+    vec3 boundsMin(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    vec3 boundsMax(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    boundsCenter = (boundsMin + boundsMax) * 0.5f;
+    boundsRadius = length(boundsMax - boundsCenter);
+    const float* d = header.dequantize;
+    dequantize = mat4(vec4(d[0], d[1], d[2], d[3]), vec4(d[4], d[5], d[6], d[7]), vec4(d[8], d[9], d[10], d[11]),
+                      vec4(d[12], d[13], d[14], d[15]));
+    return true;
+}
+
+void StaticMesh::cleanup() {
+    if (vao != 0) {
+        glDeleteVertexArrays(1, &vao);
+        vao = 0;
+    }
+    if (vertexBuffer != 0) {
+        memoryBudget.untrackBuffer(vertexBuffer);
+        glDeleteBuffers(1, &vertexBuffer);
+        vertexBuffer = 0;
+    }
+    if (indexBuffer != 0) {
+        memoryBudget.untrackBuffer(indexBuffer);
+        glDeleteBuffers(1, &indexBuffer);
+        indexBuffer = 0;
+    }
+    indexCount = 0;
+    lodCount = 0;
+}
@@ -0,0 +1,59 @@
+#ifndef STATIC_MESH_H
+#define STATIC_MESH_H
+
+#include <GL/glew.h>
+
+#include "MeshLoader.h"
+#include "ShaderInterface.h"
+#include "VectorMath.h"
+
+class MappedMesh;
+
+// Immutable GPU copy of a cached mesh: one VAO with an interleaved vertex
+// buffer and an element buffer, uploaded straight from the cache mapping.
+// Attributes stay quantized; shaders/mesh/ decodes them, and positions come
+// out in [0, 1] until multiplied by getDequantizeMatrix().
+class StaticMesh {
+public:
+    StaticMesh();
+    ~StaticMesh();
+
+    bool upload(const MappedMesh& mesh);
+    void cleanup();
+
+    GLuint getVertexArray() const { return vao; }
+    GLsizei getIndexCount() const { return indexCount; }
+    // Level-of-detail index ranges from the cache, finest first
+    unsigned int getLodCount() const { return lodCount; }
+    const MeshLod& getLod(unsigned int lod) const { return lods[lod]; }
+    GLenum getIndexType() const { return indexType; }
+    // Bounding sphere around the cached AABB, in object space
+    const vec3& getBoundsCenter() const { return boundsCenter; }
+    float getBoundsRadius() const { return boundsRadius; }
+    const mat4& getDequantizeMatrix() const { return dequantize; }
+
+private:
+    GLuint vao;
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+    GLsizei indexCount;
+    GLenum indexType;
+    unsigned int lodCount;
+    MeshLod lods[MaxMeshLods];
+    vec3 boundsCenter;
+    float boundsRadius;
+    mat4 dequantize;
+};
+
+// Vertex inputs of shaders/mesh/ as upload() lays them out
+constexpr ShaderAttribute StaticMeshAttributes[] = {
+    {"aPosition", MeshAttributePosition, GL_FLOAT_VEC3},
+    {"aNormal", MeshAttributeNormal, GL_FLOAT_VEC2},
+    {"aTexCoord", MeshAttributeTexCoord, GL_FLOAT_VEC2},
+    {"aColor", MeshAttributeColor, GL_FLOAT_VEC4},
+};
+
+static_assert(attributeLocationsUnique(StaticMeshAttributes, countOf(StaticMeshAttributes)),
+              "duplicate StaticMesh attribute location");
+
+#endif // STATIC_MESH_H
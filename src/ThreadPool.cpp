@@ -0,0 +1,98 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+// Definition of the global thread pool instance
+ThreadPool threadPool;
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+    : numThreads(numThreads), started(false), stopping(false) {
+    if (this->numThreads == 0) {
+        // Leave one core for the main (X11/GL) thread
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        this->numThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!started) {
+            start();
+        }
+        tasks.push(std::move(task));
+    }
+    condition.notify_one();
+}
+
+void ThreadPool::start() {
+    started = true;
+    workers.reserve(numThreads);
+    for (unsigned int i = 0; i < numThreads; ++i) {
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+    }
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t minRangeSize, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (minRangeSize == 0) {
+        minRangeSize = 1;
+    }
+
+    size_t maxRanges = static_cast<size_t>(numThreads) + 1;
+    size_t numRanges = std::min(maxRanges, (count + minRangeSize - 1) / minRangeSize);
+    if (numRanges <= 1) {
+        body(0, count);
+        return;
+    }
+
+    size_t rangeSize = (count + numRanges - 1) / numRanges;
+    std::vector<std::future<void>> pending;
+    pending.reserve(numRanges - 1);
+
+    // Ranges 1..N go to the workers, range 0 runs on the caller
+    for (size_t range = 1; range < numRanges; ++range) {
+        size_t begin = range * rangeSize;
+        size_t end = std::min(count, begin + rangeSize);
+        if (begin >= end) {
+            break;
+        }
+        pending.push_back(submit([&body, begin, end]() { body(begin, end); }));
+    }
+
+    body(0, std::min(count, rangeSize));
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        pending[i].get();
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Small fixed-size worker pool for CPU-side work (file loading, parsing, culling).
+// Workers are started lazily on the first submit so tools that never use the
+// pool don't pay for the threads.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int numThreads = 0);
+    ~ThreadPool();
+
+    template <typename F>
+    std::future<typename std::result_of<F()>::type> submit(F task);
+
+    // Splits [0, count) into contiguous ranges and runs body(begin, end) on the
+    // workers and the calling thread, returning once every range has finished.
+    void parallelFor(size_t count, size_t minRangeSize, const std::function<void(size_t, size_t)>& body);
+
+    unsigned int getNumThreads() const { return numThreads; }
+
+private:
+    unsigned int numThreads;
+    bool started;
+    bool stopping;
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    void enqueue(std::function<void()> task);
+    void start();
+    void workerLoop();
+};
+
+template <typename F>
+std::future<typename std::result_of<F()>::type> ThreadPool::submit(F task) {
+    typedef typename std::result_of<F()>::type ResultType;
+
+    std::shared_ptr<std::packaged_task<ResultType()>> packagedTask =
+        std::make_shared<std::packaged_task<ResultType()>>(task);
+    std::future<ResultType> result = packagedTask->get_future();
+
+    enqueue([packagedTask]() { (*packagedTask)(); });
+    return result;
+}
+
+// Global instance of ThreadPool
+extern ThreadPool threadPool;
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,78 @@
+#include "TransformHierarchy.h"
+
+TransformHierarchy::TransformHierarchy() {
+}
+
+TransformNode TransformHierarchy::add(TransformNode parent, const vec3& translation, const quat& rotation,
+                                      const vec3& scale) {
+    TransformNode node = static_cast<TransformNode>(parents.size());
+
+    // Appending keeps parent-before-child order as long as the parent exists
+    if (parent != InvalidTransformNode && parent >= node) {
+        parent = InvalidTransformNode;
+    }
+
+    parents.push_back(parent);
+    translations.push_back(translation);
+    rotations.push_back(rotation);
+    scales.push_back(scale);
+    worldMatrices.push_back(mat4());
+    dirty.push_back(1);
+    return node;
+}
+
+void TransformHierarchy::clear() {
+    parents.clear();
+    translations.clear();
+    rotations.clear();
+    scales.clear();
+    worldMatrices.clear();
+    dirty.clear();
+}
+
+void TransformHierarchy::reserve(size_t count) {
+    parents.reserve(count);
+    translations.reserve(count);
+    rotations.reserve(count);
+    scales.reserve(count);
+    worldMatrices.reserve(count);
+    dirty.reserve(count);
+}
+
+void TransformHierarchy::setTranslation(TransformNode node, const vec3& translation) {
+    translations[node] = translation;
+    dirty[node] = 1;
+}
+
+void TransformHierarchy::setRotation(TransformNode node, const quat& rotation) {
+    rotations[node] = rotation;
+    dirty[node] = 1;
+}
+
+void TransformHierarchy::setScale(TransformNode node, const vec3& scale) {
+    scales[node] = scale;
+    dirty[node] = 1;
+}
+
+void TransformHierarchy::updateWorldMatrices() {
+    const size_t count = parents.size();
+    for (size_t i = 0; i < count; ++i) {
+        TransformNode parent = parents[i];
+
+        // A parent changed earlier in this pass: this node has to follow
+        if (parent != InvalidTransformNode && dirty[parent]) {
+            dirty[i] = 1;
+        }
+        if (!dirty[i]) {
+            continue;
+        }
+
+        mat4 local = composeTRS(translations[i], rotations[i], scales[i]);
+        worldMatrices[i] = parent == InvalidTransformNode ? local : worldMatrices[parent] * local;
+    }
+
+    // Clear after the pass so children could see their parent's flag
+    for (size_t i = 0; i < count; ++i) {
+        dirty[i] = 0;
+    }
+}
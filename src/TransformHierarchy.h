@@ -0,0 +1,53 @@
+#ifndef TRANSFORM_HIERARCHY_H
+#define TRANSFORM_HIERARCHY_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "AlignedAllocator.h"
+#include "VectorMath.h"
+
+typedef uint32_t TransformNode;
+const TransformNode InvalidTransformNode = 0xFFFFFFFFu;
+
+// Local transforms and world matrices of a node tree, stored as parallel
+// arrays in parent-before-child order. updateWorldMatrices() is then one
+// linear pass: every parent's world matrix is final before its children read
+// it, with no recursion or pointer chasing. Only dirty nodes and their
+// descendants are recomputed.
+class TransformHierarchy {
+public:
+    TransformHierarchy();
+
+    // parent must already exist (or be InvalidTransformNode for a root)
+    TransformNode add(TransformNode parent, const vec3& translation = vec3(0.0f), const quat& rotation = quat(),
+                      const vec3& scale = vec3(1.0f));
+    void clear();
+    void reserve(size_t count);
+
+    size_t size() const { return parents.size(); }
+
+    void setTranslation(TransformNode node, const vec3& translation);
+    void setRotation(TransformNode node, const quat& rotation);
+    void setScale(TransformNode node, const vec3& scale);
+
+    const vec3& getTranslation(TransformNode node) const { return translations[node]; }
+    const quat& getRotation(TransformNode node) const { return rotations[node]; }
+    const vec3& getScale(TransformNode node) const { return scales[node]; }
+    TransformNode getParent(TransformNode node) const { return parents[node]; }
+
+    void updateWorldMatrices();
+
+    const mat4& getWorldMatrix(TransformNode node) const { return worldMatrices[node]; }
+    const mat4* getWorldMatrices() const { return worldMatrices.data(); }
+
+private:
+    std::vector<TransformNode> parents;
+    std::vector<vec3, AlignedAllocator<vec3, 16>> translations;
+    std::vector<quat, AlignedAllocator<quat, 16>> rotations;
+    std::vector<vec3, AlignedAllocator<vec3, 16>> scales;
+    std::vector<mat4, AlignedAllocator<mat4, 32>> worldMatrices;
+    std::vector<uint8_t> dirty;
+};
+
+#endif // TRANSFORM_HIERARCHY_H
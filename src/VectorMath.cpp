@@ -0,0 +1,93 @@
+#include "VectorMath.h"
+
+mat4 inverse(const mat4& m) {
+    const float* a = m.data();
+    float inv[16];
+
+    inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] +
+             a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+    inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] -
+             a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+    inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] +
+             a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+    inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] -
+              a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+    inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] - a[9] * a[3] * a[14] -
+             a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+    inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] + a[8] * a[3] * a[14] +
+             a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+    inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] - a[8] * a[3] * a[13] -
+             a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+    inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] + a[8] * a[2] * a[13] +
+              a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+    inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] + a[5] * a[3] * a[14] +
+             a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+    inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] - a[4] * a[3] * a[14] -
+             a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+    inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] + a[4] * a[3] * a[13] +
+              a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+    inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] - a[4] * a[2] * a[13] -
+              a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+    inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] - a[5] * a[3] * a[10] -
+             a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+    inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] + a[4] * a[3] * a[10] +
+             a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+    inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] - a[4] * a[3] * a[9] -
+              a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+    inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] + a[4] * a[2] * a[9] +
+              a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+
+    float det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+    if (det == 0.0f) {
+        return mat4();
+    }
+
+    float invDet = 1.0f / det;
+    mat4 result;
+    float* r = result.data();
+    for (int i = 0; i < 16; ++i) {
+        r[i] = inv[i] * invDet;
+    }
+    return result;
+}
+
+mat4 inverseAffine(const mat4& m) {
+    // Upper 3x3 is R*S with orthogonal R, so its inverse is S^-1 * R^T: row i of the
+    // inverse is column i divided by its squared length. r0..r2 are the inverse's columns.
+    vec3 c0 = m[0].xyz(), c1 = m[1].xyz(), c2 = m[2].xyz();
+    float s0 = dot(c0, c0), s1 = dot(c1, c1), s2 = dot(c2, c2);
+    s0 = s0 > 0.0f ? 1.0f / s0 : 0.0f;
+    s1 = s1 > 0.0f ? 1.0f / s1 : 0.0f;
+    s2 = s2 > 0.0f ? 1.0f / s2 : 0.0f;
+
+    vec3 r0(c0.x * s0, c1.x * s1, c2.x * s2);
+    vec3 r1(c0.y * s0, c1.y * s1, c2.y * s2);
+    vec3 r2(c0.z * s0, c1.z * s1, c2.z * s2);
+    vec3 t = m[3].xyz();
+
+    return mat4(vec4(r0, 0.0f), vec4(r1, 0.0f), vec4(r2, 0.0f),
+                vec4(-(r0 * t.x + r1 * t.y + r2 * t.z), 1.0f));
+}
+
+quat slerp(const quat& a, const quat& b, float t) {
+    float cosTheta = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    quat end = b;
+    if (cosTheta < 0.0f) {
+        // Take the short way around
+        cosTheta = -cosTheta;
+        end = quat(-b.x, -b.y, -b.z, -b.w);
+    }
+
+    float wa, wb;
+    if (cosTheta > 0.9995f) {
+        wa = 1.0f - t;
+        wb = t;
+    } else {
+        float theta = std::acos(cosTheta);
+        float sinTheta = std::sin(theta);
+        wa = std::sin((1.0f - t) * theta) / sinTheta;
+        wb = std::sin(t * theta) / sinTheta;
+    }
+
+    return normalize(quat(a.x * wa + end.x * wb, a.y * wa + end.y * wb, a.z * wa + end.z * wb, a.w * wa + end.w * wb));
+}
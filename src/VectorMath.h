@@ -0,0 +1,245 @@
+#ifndef VECTOR_MATH_H
+#define VECTOR_MATH_H
+
+#include <cmath>
+
+#if defined(__SSE__) || defined(__x86_64__)
+#define XWGL_MATH_SSE 1
+#include <immintrin.h>
+#endif
+
+// Small vector/matrix/quaternion library for the renderer.
+// Conventions match GLSL/OpenGL: column vectors, column-major mat4 (columns
+// are contiguous, pass mat4::data() straight to glUniformMatrix4fv with
+// transpose = GL_FALSE), right-handed view space, clip z in [-1, 1].
+// vec4/mat4/quat are 16-byte aligned so the SSE path (x86-64 baseline) can
+// use aligned loads; mat4 * mat4 additionally has an AVX path, used when the
+// build enables it with the XWGL_AVX CMake option (-mavx). Both are checked
+// against a scalar reference by tests/VectorMathTest.cpp.
+
+struct alignas(16) vec3 {
+    float x, y, z;
+    float padding; // keeps vec3 arrays 16-byte strided for aligned loads
+
+    constexpr vec3() : x(0.0f), y(0.0f), z(0.0f), padding(0.0f) {}
+    constexpr explicit vec3(float s) : x(s), y(s), z(s), padding(0.0f) {}
+    constexpr vec3(float x, float y, float z) : x(x), y(y), z(z), padding(0.0f) {}
+
+    constexpr vec3 operator+(const vec3& v) const { return vec3(x + v.x, y + v.y, z + v.z); }
+    constexpr vec3 operator-(const vec3& v) const { return vec3(x - v.x, y - v.y, z - v.z); }
+    constexpr vec3 operator*(const vec3& v) const { return vec3(x * v.x, y * v.y, z * v.z); }
+    constexpr vec3 operator*(float s) const { return vec3(x * s, y * s, z * s); }
+    constexpr vec3 operator-() const { return vec3(-x, -y, -z); }
+};
+
+struct alignas(16) vec4 {
+    float x, y, z, w;
+
+    constexpr vec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+    constexpr explicit vec4(float s) : x(s), y(s), z(s), w(s) {}
+    constexpr vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    constexpr vec4(const vec3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+
+    constexpr vec3 xyz() const { return vec3(x, y, z); }
+
+    float* data() { return &x; }
+    const float* data() const { return &x; }
+};
+
+struct alignas(16) quat {
+    float x, y, z, w;
+
+    constexpr quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+    constexpr quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+};
+
+struct alignas(16) mat4 {
+    vec4 columns[4];
+
+    constexpr mat4()
+        : columns{vec4(1.0f, 0.0f, 0.0f, 0.0f), vec4(0.0f, 1.0f, 0.0f, 0.0f), vec4(0.0f, 0.0f, 1.0f, 0.0f),
+                  vec4(0.0f, 0.0f, 0.0f, 1.0f)} {}
+    constexpr mat4(const vec4& c0, const vec4& c1, const vec4& c2, const vec4& c3) : columns{c0, c1, c2, c3} {}
+
+    vec4& operator[](int column) { return columns[column]; }
+    const vec4& operator[](int column) const { return columns[column]; }
+
+    float* data() { return &columns[0].x; }
+    const float* data() const { return &columns[0].x; }
+};
+
+// vec3
+
+constexpr float dot(const vec3& a, const vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+constexpr vec3 cross(const vec3& a, const vec3& b) {
+    return vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+inline float length(const vec3& v) { return std::sqrt(dot(v, v)); }
+
+inline vec3 normalize(const vec3& v) {
+    float len = length(v);
+    return len > 0.0f ? v * (1.0f / len) : v;
+}
+
+// vec4
+
+inline vec4 operator+(const vec4& a, const vec4& b) {
+    vec4 r;
+#ifdef XWGL_MATH_SSE
+    _mm_store_ps(r.data(), _mm_add_ps(_mm_load_ps(a.data()), _mm_load_ps(b.data())));
+#else
+    r = vec4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w);
+#endif
+    return r;
+}
+
+inline vec4 operator-(const vec4& a, const vec4& b) {
+    vec4 r;
+#ifdef XWGL_MATH_SSE
+    _mm_store_ps(r.data(), _mm_sub_ps(_mm_load_ps(a.data()), _mm_load_ps(b.data())));
+#else
+    r = vec4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w);
+#endif
+    return r;
+}
+
+inline vec4 operator*(const vec4& a, float s) {
+    vec4 r;
+#ifdef XWGL_MATH_SSE
+    _mm_store_ps(r.data(), _mm_mul_ps(_mm_load_ps(a.data()), _mm_set1_ps(s)));
+#else
+    r = vec4(a.x * s, a.y * s, a.z * s, a.w * s);
+#endif
+    return r;
+}
+
+constexpr float dot(const vec4& a, const vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+// mat4
+
+inline vec4 operator*(const mat4& m, const vec4& v) {
+    vec4 r;
+#ifdef XWGL_MATH_SSE
+    __m128 result = _mm_mul_ps(_mm_load_ps(m[0].data()), _mm_set1_ps(v.x));
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(m[1].data()), _mm_set1_ps(v.y)));
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(m[2].data()), _mm_set1_ps(v.z)));
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(m[3].data()), _mm_set1_ps(v.w)));
+    _mm_store_ps(r.data(), result);
+#else
+    r = m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w;
+#endif
+    return r;
+}
+
+inline mat4 operator*(const mat4& a, const mat4& b) {
+    mat4 r;
+#if defined(__AVX__)
+    // Two result columns per iteration; mat4 is only 16-byte aligned, hence loadu/storeu
+    __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a[0].data()));
+    __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a[1].data()));
+    __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a[2].data()));
+    __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a[3].data()));
+    for (int c = 0; c < 4; c += 2) {
+        __m256 bc = _mm256_loadu_ps(b[c].data());
+        __m256 result = _mm256_mul_ps(a0, _mm256_permute_ps(bc, 0x00));
+        result = _mm256_add_ps(result, _mm256_mul_ps(a1, _mm256_permute_ps(bc, 0x55)));
+        result = _mm256_add_ps(result, _mm256_mul_ps(a2, _mm256_permute_ps(bc, 0xAA)));
+        result = _mm256_add_ps(result, _mm256_mul_ps(a3, _mm256_permute_ps(bc, 0xFF)));
+        _mm256_storeu_ps(r[c].data(), result);
+    }
+#else
+    for (int c = 0; c < 4; ++c) {
+        r[c] = a * b[c];
+    }
+#endif
+    return r;
+}
+
+inline mat4 transpose(const mat4& m) {
+    return mat4(vec4(m[0].x, m[1].x, m[2].x, m[3].x), vec4(m[0].y, m[1].y, m[2].y, m[3].y),
+                vec4(m[0].z, m[1].z, m[2].z, m[3].z), vec4(m[0].w, m[1].w, m[2].w, m[3].w));
+}
+
+inline mat4 translate(const vec3& t) {
+    return mat4(vec4(1.0f, 0.0f, 0.0f, 0.0f), vec4(0.0f, 1.0f, 0.0f, 0.0f), vec4(0.0f, 0.0f, 1.0f, 0.0f),
+                vec4(t, 1.0f));
+}
+
+inline mat4 scale(const vec3& s) {
+    return mat4(vec4(s.x, 0.0f, 0.0f, 0.0f), vec4(0.0f, s.y, 0.0f, 0.0f), vec4(0.0f, 0.0f, s.z, 0.0f),
+                vec4(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+// Translation * rotation * scale without the two matrix products
+inline mat4 composeTRS(const vec3& t, const quat& q, const vec3& s) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    return mat4(vec4((1.0f - 2.0f * (yy + zz)) * s.x, 2.0f * (xy + wz) * s.x, 2.0f * (xz - wy) * s.x, 0.0f),
+                vec4(2.0f * (xy - wz) * s.y, (1.0f - 2.0f * (xx + zz)) * s.y, 2.0f * (yz + wx) * s.y, 0.0f),
+                vec4(2.0f * (xz + wy) * s.z, 2.0f * (yz - wx) * s.z, (1.0f - 2.0f * (xx + yy)) * s.z, 0.0f),
+                vec4(t, 1.0f));
+}
+
+inline mat4 perspective(float fovYRadians, float aspect, float zNear, float zFar) {
+    float f = 1.0f / std::tan(fovYRadians * 0.5f);
+    return mat4(vec4(f / aspect, 0.0f, 0.0f, 0.0f), vec4(0.0f, f, 0.0f, 0.0f),
+                vec4(0.0f, 0.0f, (zFar + zNear) / (zNear - zFar), -1.0f),
+                vec4(0.0f, 0.0f, 2.0f * zFar * zNear / (zNear - zFar), 0.0f));
+}
+
+inline mat4 orthographic(float left, float right, float bottom, float top, float zNear, float zFar) {
+    return mat4(vec4(2.0f / (right - left), 0.0f, 0.0f, 0.0f), vec4(0.0f, 2.0f / (top - bottom), 0.0f, 0.0f),
+                vec4(0.0f, 0.0f, -2.0f / (zFar - zNear), 0.0f),
+                vec4(-(right + left) / (right - left), -(top + bottom) / (top - bottom),
+                     -(zFar + zNear) / (zFar - zNear), 1.0f));
+}
+
+inline mat4 lookAt(const vec3& eye, const vec3& center, const vec3& up) {
+    vec3 f = normalize(center - eye);
+    vec3 s = normalize(cross(f, up));
+    vec3 u = cross(s, f);
+    return mat4(vec4(s.x, u.x, -f.x, 0.0f), vec4(s.y, u.y, -f.y, 0.0f), vec4(s.z, u.z, -f.z, 0.0f),
+                vec4(-dot(s, eye), -dot(u, eye), dot(f, eye), 1.0f));
+}
+
+// General 4x4 inverse (cofactor expansion); returns identity for singular input
+mat4 inverse(const mat4& m);
+
+// Inverse of rotation/translation/positive-scale matrices, much cheaper than inverse()
+mat4 inverseAffine(const mat4& m);
+
+// quat
+
+inline quat operator*(const quat& a, const quat& b) {
+    return quat(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y, a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w, a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+}
+
+inline quat angleAxis(float angleRadians, const vec3& axis) {
+    vec3 n = normalize(axis);
+    float s = std::sin(angleRadians * 0.5f);
+    return quat(n.x * s, n.y * s, n.z * s, std::cos(angleRadians * 0.5f));
+}
+
+inline quat normalize(const quat& q) {
+    float len = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    return len > 0.0f ? quat(q.x / len, q.y / len, q.z / len, q.w / len) : quat();
+}
+
+inline vec3 rotate(const quat& q, const vec3& v) {
+    vec3 u(q.x, q.y, q.z);
+    vec3 t = cross(u, v) * 2.0f;
+    return v + t * q.w + cross(u, t);
+}
+
+quat slerp(const quat& a, const quat& b, float t);
+
+inline mat4 toMat4(const quat& q) {
+    return composeTRS(vec3(0.0f), q, vec3(1.0f));
+}
+
+#endif // VECTOR_MATH_H
@@ -0,0 +1,31 @@
+#include "WindowEvents.h"
+
+#include <X11/keysym.h>
+
+WindowAction translateEvent(const XEvent& event, KeySym keySym, char key) {
+    switch (event.type) {
+        case FocusIn:
+            return WindowAction::GainFocus;
+        case FocusOut:
+            return WindowAction::LoseFocus;
+        case ConfigureNotify:
+            return WindowAction::Resize;
+        case KeyPress:
+            if (keySym == XK_Escape) {
+                return WindowAction::Quit;
+            }
+            switch (key) {
+                case 'F':
+                case 'f':
+                    return WindowAction::ToggleFullscreen;
+                case 'O':
+                case 'o':
+                    return WindowAction::ToggleOverlay;
+                default:
+                    return WindowAction::Ignore;
+            }
+        default:
+            // MapNotify, mouse buttons and the WM protocol message need no handling
+            return WindowAction::Ignore;
+    }
+}
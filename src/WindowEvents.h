@@ -0,0 +1,23 @@
+#ifndef WINDOW_EVENTS_H
+#define WINDOW_EVENTS_H
+
+#include <X11/Xlib.h>
+
+// What the window loop does in response to one X event
+enum class WindowAction {
+    Ignore,
+    Quit,
+    ToggleFullscreen,
+    ToggleOverlay,
+    Resize,
+    GainFocus,
+    LoseFocus
+};
+
+// Maps an event to its action. The Xlib lookups that need a display
+// (XkbKeycodeToKeysym, XLookupString) are done by the caller and passed in as
+// keySym and key for KeyPress events, so the dispatch itself runs without a
+// display (see tools/microbench.cpp).
+WindowAction translateEvent(const XEvent& event, KeySym keySym, char key);
+
+#endif // WINDOW_EVENTS_H
@@ -1,12 +1,27 @@
 #include "WindowManager.h"
 #include "Logger.h"
 #include "Shader.h"
+#include "ShaderLibrary.h"
+#include "StartupTracer.h"
+#include "FBConfigCache.h"
+#include "GLDebug.h"
+#include "GLHooks.h"
+#include "GLStats.h"
+#include "HeapTracking.h"
+#include "MemoryBudget.h"
+#include "PerfOverlay.h"
+#include "MeshCache.h"
+#include "SceneComponents.h"
+#include "ThreadPool.h"
+#include "WindowEvents.h"
 
 // X11 Header Files
 #include <X11/Xlib.h>   // For all X11 XLib api
 #include <X11/Xutil.h>  // For all XVisuaInfo and related API's
 #include <X11/XKBlib.h> // For Keyboard relate functionality handling
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <cstdlib>
 
@@ -21,26 +36,99 @@ enum
 GLuint vao_triangle = 0;
 GLuint vbo_position_triange = 0;
 GLuint vbo_color_triangle = 0;
-Shader shaderProgram;
+GLuint ebo_triangle = 0;
+// What loadResources() feeds the triangle programs; shaders/triangle/ and
+// shaders/instanced/ declare the same locations
+constexpr ShaderAttribute triangleAttributes[] = {
+    {"aPosition", AMC_ATTRIBUTE_POSITION, GL_FLOAT_VEC4},
+    {"aColor", AMC_ATTRIBUTE_COLOR, GL_FLOAT_VEC4},
+};
+
+static_assert(attributeLocationsUnique(triangleAttributes, countOf(triangleAttributes)),
+              "duplicate triangle attribute location");
+
+// Slot 0 of the uniform blocks of every program drawn from the draw list
+const int ObjectConstantsSlot = 0;
+constexpr ShaderBlock drawListUniformBlocks[] = {
+    {"ObjectConstants", ObjectConstantsBinding, sizeof(ObjectConstants)},
+};
+
+const ShaderInterface triangleInterface = {triangleAttributes, countOf(triangleAttributes), nullptr, 0,
+                                           drawListUniformBlocks, countOf(drawListUniformBlocks), nullptr, 0};
+
+const ShaderInterface meshInterface = {StaticMeshAttributes, countOf(StaticMeshAttributes), nullptr, 0,
+                                       drawListUniformBlocks, countOf(drawListUniformBlocks), nullptr, 0};
+
+// GPU-culled instances: the triangle's vertex layout, transforms from the culler
+enum InstancedUniform
+{
+    InstancedUniformViewProjection
+};
+
+constexpr ShaderUniform instancedUniforms[] = {
+    {"uViewProjectionMatrix", 0, GL_FLOAT_MAT4},
+};
+
+constexpr ShaderBlock instancedStorageBlocks[] = {
+    {"Instances", GpuCullBindingInstances, sizeof(GpuInstance)},
+};
+
+const ShaderInterface instancedInterface = {triangleAttributes, countOf(triangleAttributes),
+                                            instancedUniforms, countOf(instancedUniforms),
+                                            nullptr, 0, instancedStorageBlocks, countOf(instancedStorageBlocks)};
+
+// Owned by shaderLibrary; nullptr if the program failed to build
+Shader *shaderProgram = nullptr;
+Shader *instancedShaderProgram = nullptr;
+Shader *meshShaderProgram = nullptr;
 
 // /////////////////////////////////////////////////////////////////////
 
-WindowManager::WindowManager(int width, int height, char *title)
-    : width(width), height(height), fullscreen(false),
+WindowManager::WindowManager(int width, int height, const char *title)
+    : width(width), height(height), title(title != nullptr ? title : "XWindow::OpenGL|Window"), fullscreen(false),
       running(true), focused(true), display(nullptr), window(0), colormap(0), visualInfo(nullptr),
-      glXCreateContextAttribsARB(nullptr), glxFBConfig(0), glxContext(nullptr)
+      glXCreateContextAttribsARB(nullptr), glxFBConfig(0), glxContext(nullptr),
+      renderGraph(renderTargetPool, frameArena), frameReadback(frameWriter), dynamicResolutionEnabled(false),
+      overlayEnabled(false), lastFrameTime(std::chrono::steady_clock::now()), frameDrawCalls(0), frameTriangles(0), evictionCallback(0), assetMesh(nullptr), gpuInstanceCount(0), frameCount(0), frameHeapAllocations(0), heapAllocationReports(0)
 {
-    if (title == nullptr)
+    // Every program's files are read and preprocessed on the thread pool while X11/GLX is set up
+    if (shaderLibrary.loadManifest("shaders/manifest.json"))
     {
-        // Use default title
-        this->title = new char[strlen("XWindow::OpenGL|Window") + 1];
-        strcpy(this->title, "XWindow::OpenGL|Window");
+        shaderLibrary.preloadSources();
     }
-    else
+
+    // Optional GPU-culled instance grid
+    const char *gpuInstances = getenv("XWGL_GPU_INSTANCES");
+    if (gpuInstances != nullptr && atoi(gpuInstances) > 0)
+    {
+        gpuInstanceCount = atoi(gpuInstances);
+    }
+
+    // On-screen timings, draw counts and memory
+    const char *overlay = getenv("XWGL_OVERLAY");
+    if (overlay != nullptr && atoi(overlay) != 0)
+    {
+        overlayEnabled = true;
+    }
+
+    // Largest on-screen LOD error in pixels
+    const char *lodError = getenv("XWGL_LOD_ERROR");
+    if (lodError != nullptr && atof(lodError) > 0.0)
+    {
+        lodSelection.errorThreshold = (float)atof(lodError);
+    }
+
+    // GPU memory budget: tracked engine allocations above it, or driver-reported
+    // free memory below the reserve, evict unused render targets
+    const char *gpuBudget = getenv("XWGL_GPU_BUDGET_MB");
+    if (gpuBudget != nullptr && atof(gpuBudget) > 0.0)
     {
-        // Allocate memory and copy provided title
-        this->title = new char[strlen(title) + 1];
-        strcpy(this->title, title);
+        memoryBudget.setBudget((int64_t)(atof(gpuBudget) * 1024.0 * 1024.0));
+    }
+    const char *gpuReserve = getenv("XWGL_GPU_RESERVE_MB");
+    if (gpuReserve != nullptr && atof(gpuReserve) > 0.0)
+    {
+        memoryBudget.setDriverReserve((int64_t)(atof(gpuReserve) * 1024.0 * 1024.0));
     }
 
     createWindow();
@@ -52,12 +140,36 @@ WindowManager::~WindowManager()
 
 void WindowManager::initialize()
 {
+#ifdef XWGL_GL_HOOKS
+    // GL capture/instrumentation must see the context setup too
+    hookInitialize();
+#endif
+
     // Setup OpenGL context
     setupGL();
 
     // Setup GLEW
     setupGLEW();
 
+    // Build shaders and geometry once, before the first frame
+    loadResources();
+
+    // Optional session recording
+    const char *recordSpec = getenv("XWGL_RECORD");
+    if (recordSpec != nullptr)
+    {
+        frameWriter.open(recordSpec);
+    }
+
+    // Optional dynamic resolution against a GPU time budget
+    const char *dynamicResolutionBudget = getenv("XWGL_DYNAMIC_RESOLUTION");
+    if (dynamicResolutionBudget != nullptr && atof(dynamicResolutionBudget) > 0.0)
+    {
+        dynamicResolutionEnabled = true;
+        dynamicResolution.setBudgetMs(atof(dynamicResolutionBudget));
+        logger.Info("Dynamic resolution enabled, GPU budget %.2f ms", dynamicResolution.getBudgetMs());
+    }
+
     // warmup resize
     resize(this->width, this->height);
 }
@@ -67,85 +179,18 @@ void WindowManager::run()
     while (running)
     {
         // Handle events (e.g., user input, window events)
-        XEvent event;
-        KeySym keySym;
-        char keys[26];
-
-        while (XPending(display))
-        {
-            memset((void *)&event, 0, sizeof(XEvent));
-            XNextEvent(display, &event);
-
-            switch (event.type)
-            {
-            case MapNotify: // ShowWindow(): WIN32 (WM_CREATE)
-                break;
-            case FocusIn:
-                focused = true;
-                break;
-            case FocusOut:
-                focused = false;
-                break;
-            case ConfigureNotify:
-                resize(event.xconfigure.width, event.xconfigure.height);
-                break;
-            case ButtonPress:
-                switch (event.xbutton.button)
-                {
-                case 1:
-                    break;
-                default:
-                    break;
-                }
-                break;
-            case KeyPress:
-                keySym = XkbKeycodeToKeysym(
-                    display,
-                    event.xkey.keycode, // XWindows KeyCode
-                    0,                  // Keycode Group Representation
-                    0                   // Shift Status
-                );
-                switch (keySym)
-                {
-                case XK_Escape:
-                    running = false;
-                    break;
-                default:
-                    break;
-                }
-
-                XLookupString(
-                    &event.xkey,
-                    keys,
-                    sizeof(keys),
-                    NULL, // Array to save all keySym for every key pressed
-                    NULL  // State persistence of the keys pressed
-                );
-
-                switch (keys[0])
-                {
-                case 'F':
-                case 'f':
-                    fullscreen = !fullscreen;
-                    toggleFullscreen();
-                    break;
-                default:
-                    break;
-                }
-                break;
-            case 33: // atom protocol exit
-                running = true;
-                break;
-            default:
-                break;
-            }
-        }
+        handleEvents();
 
         if (focused)
         {
             // Render
             render();
 
+            if (!startupTracer.isFirstFrameMarked())
+            {
+                startupTracer.markFirstFrame();
+            }
+
             // Update
             update();
         }
@@ -156,6 +201,63 @@ void WindowManager::run()
     exit(0);
 }
 
+void WindowManager::handleEvents()
+{
+    XEvent event;
+    KeySym keySym;
+    char keys[26];
+
+    while (XPending(display))
+    {
+        memset((void *)&event, 0, sizeof(XEvent));
+        XNextEvent(display, &event);
+
+        keySym = NoSymbol;
+        keys[0] = '\0';
+        if (event.type == KeyPress)
+        {
+            keySym = XkbKeycodeToKeysym(
+                display,
+                event.xkey.keycode, // XWindows KeyCode
+                0,                  // Keycode Group Representation
+                0                   // Shift Status
+            );
+            XLookupString(
+                &event.xkey,
+                keys,
+                sizeof(keys),
+                NULL, // Array to save all keySym for every key pressed
+                NULL  // State persistence of the keys pressed
+            );
+        }
+
+        switch (translateEvent(event, keySym, keys[0]))
+        {
+        case WindowAction::Quit:
+            running = false;
+            break;
+        case WindowAction::ToggleFullscreen:
+            fullscreen = !fullscreen;
+            toggleFullscreen();
+            break;
+        case WindowAction::ToggleOverlay:
+            overlayEnabled = !overlayEnabled;
+            break;
+        case WindowAction::Resize:
+            resize(event.xconfigure.width, event.xconfigure.height);
+            break;
+        case WindowAction::GainFocus:
+            focused = true;
+            break;
+        case WindowAction::LoseFocus:
+            focused = false;
+            break;
+        case WindowAction::Ignore:
+            break;
+        }
+    }
+}
+
 void WindowManager::resize(int width, int height)
 {
     // code
@@ -165,21 +267,36 @@ void WindowManager::resize(int width, int height)
     if (height <= 0)
         height = 1;
 
+    // remember the size for the render graph's backbuffer and offscreen targets
+    this->width = width;
+    this->height = height;
+
     // set the viewport as per the window's aspect ratio
     glViewport(0, 0, (GLsizei)width, (GLsizei)height);
+
+    // perspective projection for the new aspect ratio
+    const float fieldOfView = 45.0f * 3.14159265f / 180.0f;
+    projectionMatrix = perspective(fieldOfView, (float)width / (float)height, 0.1f, 100.0f);
+    lodSelection.projectionScale = (float)height / (2.0f * tanf(fieldOfView * 0.5f));
 }
 
-void WindowManager::render()
+void WindowManager::loadResources()
 {
+    StartupPhase phase("loadResources");
 
+    // Submit every program in the manifest; the driver compiles them while the
+    // geometry below is set up, and finishAll() collects the results
+    shaderLibrary.compileAll();
 
-    // Add shaders (from source or file)
-    shaderProgram.addShaderFromFile(ShaderType::Vertex, "shaders/triangle/vertexShader.glsl");
-    shaderProgram.addShaderFromFile(ShaderType::Fragment, "shaders/triangle/fragmentShader.glsl");
-    // Optionally add more shaders like Geometry, Tessellation, or Compute
+    // 1 MB per frame holds ~4000 draws' constants at a 256-byte alignment
+    frameConstants.initialize(1 << 20);
 
-    // Link the shader program
-    shaderProgram.linkProgram();
+    // Free render targets are the one thing that can be recreated on demand
+    RenderTargetPool *targets = &renderTargetPool;
+    evictionCallback = memoryBudget.addEvictionCallback([targets](int64_t bytesToFree)
+                                                        {
+                                                            return (int64_t)targets->evictUnused((size_t)bytesToFree);
+                                                        });
 
     // ---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
     const GLfloat triangle_position[] =
@@ -201,6 +318,7 @@ void WindowManager::render()
 
     // Bind VAO
     glBindVertexArray(vao_triangle);
+    glDebug.label(GL_VERTEX_ARRAY, vao_triangle, "triangle");
 
     // VBO for triangle position
     glGenBuffers(1, &vbo_position_triange);
@@ -210,6 +328,8 @@ void WindowManager::render()
 
     // Push triangle vertices into the buffer
     glBufferData(GL_ARRAY_BUFFER, sizeof(triangle_position), triangle_position, GL_STATIC_DRAW);
+    memoryBudget.trackBuffer(MemoryCategory::Geometry, vbo_position_triange, sizeof(triangle_position));
+    glDebug.label(GL_BUFFER, vbo_position_triange, "triangle positions");
 
     // Specify the data of position attribute pointer
     glVertexAttribPointer(AMC_ATTRIBUTE_POSITION, 3, GL_FLOAT, GL_FALSE, 0, NULL);
@@ -224,36 +344,434 @@ void WindowManager::render()
     glGenBuffers(1, &vbo_color_triangle);
     glBindBuffer(GL_ARRAY_BUFFER, vbo_color_triangle);
     glBufferData(GL_ARRAY_BUFFER, sizeof(triangle_colors), triangle_colors, GL_STATIC_DRAW);
+    memoryBudget.trackBuffer(MemoryCategory::Geometry, vbo_color_triangle, sizeof(triangle_colors));
+    glDebug.label(GL_BUFFER, vbo_color_triangle, "triangle colors");
     glVertexAttribPointer(AMC_ATTRIBUTE_COLOR, 3, GL_FLOAT, GL_FALSE, 0, NULL);
     glEnableVertexAttribArray(AMC_ATTRIBUTE_COLOR);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+    // EBO for indexed (indirect) draws; stays bound to the VAO
+    const GLuint triangle_indices[] = {0, 1, 2};
+    glGenBuffers(1, &ebo_triangle);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_triangle);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(triangle_indices), triangle_indices, GL_STATIC_DRAW);
+    memoryBudget.trackBuffer(MemoryCategory::Geometry, ebo_triangle, sizeof(triangle_indices));
+    glDebug.label(GL_BUFFER, ebo_triangle, "triangle indices");
+
     // Unbind with VAO
     glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // Scene content
+    Entity triangle = scene.create();
+    scene.emplace(triangle, TransformComponent(sceneTransforms.add(InvalidTransformNode)));
+    scene.emplace(triangle, SpinComponent(vec3(0.0f, 1.0f, 0.0f), 1.0f));
+
+    MeshComponent triangleMesh;
+    triangleMesh.vao = vao_triangle;
+    triangleMesh.count = 3;
+    triangleMesh.boundsRadius = 1.4143f; // |(-1, -1, 0)| rounded up
+    scene.emplace(triangle, triangleMesh);
+
+    lodSelection.cameraPosition = vec3(0.0f, 0.0f, 4.0f);
+    viewMatrix = lookAt(lodSelection.cameraPosition, vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+    lastUpdateTime = std::chrono::steady_clock::now();
+
+    shaderLibrary.finishAll();
+    shaderProgram = shaderLibrary.get("triangle", triangleInterface);
+    instancedShaderProgram = shaderLibrary.get("instanced", instancedInterface);
+    meshShaderProgram = shaderLibrary.get("mesh", meshInterface);
+
+    const char *meshPath = getenv("XWGL_MESH");
+    if (meshPath != nullptr)
+    {
+        loadMeshAsset(meshPath);
+    }
 
-    // ---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+    if (gpuInstanceCount > 0)
+    {
+        loadGpuInstances();
+    }
 
-    // Use the shader program
-    shaderProgram.use();
+    // Drivers finish some compilation on first use; do it here rather than in the first frames
+    shaderLibrary.warmUp();
+}
 
-    // Bind wth VAO
-    glBindVertexArray(vao_triangle);
+void WindowManager::loadMeshAsset(const char *filePath)
+{
+    StartupPhase phase("loadMeshAsset");
+
+    if (meshShaderProgram == nullptr)
+    {
+        logger.Error("Failed to load mesh %s: the mesh program did not build", filePath);
+        return;
+    }
+
+    // Parsed in parallel on the first run, a single mmap on later ones
+    MappedMesh cachedMesh;
+    assetMesh = meshPool.create();
+    if (!MeshCache::load(filePath, cachedMesh, threadPool) || !assetMesh->upload(cachedMesh))
+    {
+        logger.Error("Failed to load mesh: %s", filePath);
+        meshPool.destroy(assetMesh);
+        assetMesh = nullptr;
+        return;
+    }
+
+    // Spinning pivot, with the dequantization scale/offset as a child node so
+    // the cached [0, 1] positions need no extra per-draw uniform
+    TransformNode pivot = sceneTransforms.add(InvalidTransformNode, vec3(0.0f, 0.0f, -2.0f));
+    Entity pivotEntity = scene.create();
+    scene.emplace(pivotEntity, TransformComponent(pivot));
+    scene.emplace(pivotEntity, SpinComponent(vec3(0.0f, 1.0f, 0.0f), 0.5f));
+
+    const mat4 &dequantize = assetMesh->getDequantizeMatrix();
+    TransformNode meshNode = sceneTransforms.add(pivot, dequantize[3].xyz(), quat(),
+                                                 vec3(dequantize[0].x, dequantize[1].y, dequantize[2].z));
+    Entity entity = scene.create();
+    scene.emplace(entity, TransformComponent(meshNode));
+
+    MeshComponent mesh;
+    mesh.shader = meshShaderProgram;
+    mesh.vao = assetMesh->getVertexArray();
+    mesh.indexType = assetMesh->getIndexType();
+    mesh.count = assetMesh->getIndexCount();
+    // Bounds of the unit cube the positions were quantized into
+    mesh.boundsCenter = vec3(0.5f);
+    mesh.boundsRadius = 0.8661f;
+    // LOD errors are in object space; DrawList scales them by the node's
+    // largest axis scale, so divide that back out
+    float largestExtent = std::max(dequantize[0].x, std::max(dequantize[1].y, dequantize[2].z));
+    mesh.lodCount = assetMesh->getLodCount();
+    for (unsigned int i = 0; i < mesh.lodCount; i++)
+    {
+        mesh.lods[i] = assetMesh->getLod(i);
+        mesh.lods[i].error /= largestExtent;
+    }
+    scene.emplace(entity, mesh);
+
+    logger.Info("Loaded mesh %s (%d triangles, %u LODs down to %d)", filePath, (int)(assetMesh->getIndexCount() / 3),
+                assetMesh->getLodCount(), (int)(assetMesh->getLod(assetMesh->getLodCount() - 1).indexCount / 3));
+}
+
+void WindowManager::loadGpuInstances()
+{
+    if (instancedShaderProgram == nullptr || !gpuCuller.initialize())
+    {
+        gpuInstanceCount = 0;
+        return;
+    }
+    uint32_t triangleMesh = gpuCuller.addMesh(3, 0, 0);
+
+    // Square grid of triangles receding behind the origin; most of it falls
+    // outside the frustum, which is the point
+    int side = 1;
+    while (side * side < gpuInstanceCount)
+    {
+        side++;
+    }
+
+    std::vector<GpuInstance> instances(gpuInstanceCount);
+    for (int i = 0; i < gpuInstanceCount; i++)
+    {
+        vec3 position(((i % side) - side * 0.5f) * 2.5f, ((i / side) - side * 0.5f) * 2.5f, -8.0f);
+        GpuInstance &instance = instances[i];
+        instance.world = translate(position);
+        instance.boundingSphere[0] = position.x;
+        instance.boundingSphere[1] = position.y;
+        instance.boundingSphere[2] = position.z;
+        instance.boundingSphere[3] = 1.4143f;
+        instance.mesh = triangleMesh;
+        instance.padding[0] = instance.padding[1] = instance.padding[2] = 0;
+    }
+    gpuCuller.setInstances(instances.data(), instances.size());
+
+    logger.Info("GPU culling %d instances", gpuInstanceCount);
+}
+
+void WindowManager::render()
+{
+    HeapCounters heapAtFrameStart = getHeapCounters();
+    std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+    if (overlayEnabled && !perfOverlay.isInitialized() && !perfOverlay.initialize())
+    {
+        overlayEnabled = false;
+    }
+
+    renderTargetPool.beginFrame();
+    frameConstants.beginFrame();
+
+    // Extract this frame's visible meshes from the scene
+    drawList.build(scene, sceneTransforms, projectionMatrix * viewMatrix, lodSelection, threadPool);
+
+    // Hand finished readbacks from earlier frames to the writer thread
+    if (frameWriter.isOpen())
+    {
+        frameReadback.poll();
+    }
+
+    // Declare this frame's passes; compile() culls and orders them, execute() runs them.
+    // Last frame's pass callbacks are destroyed before their arena memory is reused.
+    renderGraph.reset();
+    frameArena.reset();
+    RenderGraphResource backbuffer = renderGraph.importBackbuffer(width, height);
 
-    // Draw geometry
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+    // GPU culling writes the indirect commands the scene pass draws from
+    RenderGraphResource gpuCommands = InvalidRenderGraphResource;
+    RenderGraphResource gpuDrawCount = InvalidRenderGraphResource;
+    if (gpuInstanceCount > 0)
+    {
+        gpuCommands = renderGraph.importBuffer("gpuCommands", gpuCuller.getCommandBuffer());
+        gpuDrawCount = renderGraph.importBuffer("gpuDrawCount", gpuCuller.getCountBuffer());
+
+        mat4 viewProjectionMatrix = projectionMatrix * viewMatrix;
+        renderGraph.addPass("gpuCull", [this, viewProjectionMatrix](RenderGraph &graph)
+                            {
+                                gpuCuller.cull(viewProjectionMatrix);
+                            })
+            .write(gpuCommands, RenderGraphAccess::StorageBuffer)
+            .write(gpuDrawCount, RenderGraphAccess::StorageBuffer);
+    }
+
+    if (dynamicResolutionEnabled)
+    {
+        // Scene at a GPU-time driven scale into transient targets, then upscaled to the window
+        double gpuMs;
+        if (sceneGpuTimer.getLatestMs(gpuMs))
+        {
+            dynamicResolution.update(gpuMs);
+        }
+
+        int renderWidth, renderHeight;
+        dynamicResolution.getRenderSize(width, height, renderWidth, renderHeight);
+
+        RenderGraphResource sceneColor = renderGraph.createTexture(
+            "sceneColor", RenderTargetDesc(GL_RGBA8, renderWidth, renderHeight));
+        RenderGraphResource sceneDepth = renderGraph.createTexture(
+            "sceneDepth", RenderTargetDesc(GL_DEPTH24_STENCIL8, renderWidth, renderHeight));
+
+        RenderGraphPass &scenePass = renderGraph.addPass("scene", [this, sceneColor, sceneDepth](RenderGraph &graph)
+                            {
+                                graph.bindFramebuffer({sceneColor}, sceneDepth);
+                                sceneGpuTimer.begin();
+                                drawScene();
+                                sceneGpuTimer.end();
+                            })
+            .write(sceneColor, RenderGraphAccess::ColorAttachment)
+            .write(sceneDepth, RenderGraphAccess::DepthAttachment);
+        if (gpuInstanceCount > 0)
+        {
+            scenePass.read(gpuCommands, RenderGraphAccess::IndirectBuffer)
+                .read(gpuDrawCount, RenderGraphAccess::IndirectBuffer);
+        }
+
+        int windowWidth = width, windowHeight = height;
+        renderGraph.addPass("upscale", [sceneColor, windowWidth, windowHeight](RenderGraph &graph)
+                            {
+                                const RenderTargetDesc &desc = graph.getDesc(sceneColor);
+                                glBindFramebuffer(GL_READ_FRAMEBUFFER, graph.getFramebuffer({sceneColor}));
+                                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+                                glBlitFramebuffer(0, 0, desc.width, desc.height,
+                                                  0, 0, windowWidth, windowHeight,
+                                                  GL_COLOR_BUFFER_BIT, GL_LINEAR);
+                                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                                glViewport(0, 0, windowWidth, windowHeight);
+                            })
+            .read(sceneColor, RenderGraphAccess::Transfer)
+            .write(backbuffer, RenderGraphAccess::Transfer);
+    }
+    else
+    {
+        RenderGraphPass &scenePass = renderGraph.addPass("scene", [this, backbuffer](RenderGraph &graph)
+                            {
+                                graph.bindFramebuffer({backbuffer});
+                                drawScene();
+                            })
+            .write(backbuffer, RenderGraphAccess::ColorAttachment);
+        if (gpuInstanceCount > 0)
+        {
+            scenePass.read(gpuCommands, RenderGraphAccess::IndirectBuffer)
+                .read(gpuDrawCount, RenderGraphAccess::IndirectBuffer);
+        }
+    }
+
+    if (overlayEnabled)
+    {
+        int overlayWidth = width, overlayHeight = height;
+        renderGraph.addPass("overlay", [this, backbuffer, overlayWidth, overlayHeight](RenderGraph &graph)
+                            {
+                                graph.bindFramebuffer({backbuffer});
+                                perfOverlay.render(overlayWidth, overlayHeight, frameConstants);
+                            })
+            .write(backbuffer, RenderGraphAccess::ColorAttachment);
+    }
+
+    if (frameWriter.isOpen())
+    {
+        int readbackWidth = width, readbackHeight = height;
+        renderGraph.addPass("readback", [this, readbackWidth, readbackHeight](RenderGraph &graph)
+                            {
+                                glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+                                frameReadback.capture(readbackWidth, readbackHeight);
+                            })
+            .read(backbuffer, RenderGraphAccess::Transfer)
+            .sideEffect();
+    }
+
+    renderGraph.compile();
+    if (overlayEnabled)
+    {
+        frameGpuTimer.begin();
+    }
+    renderGraph.execute();
+    if (overlayEnabled)
+    {
+        frameGpuTimer.end();
+    }
+
+    renderTargetPool.endFrame();
+    frameConstants.endFrame();
+    memoryBudget.update();
+
+#ifdef XWGL_GL_HOOKS
+    hookEndFrame();
+#endif
+
+    if (overlayEnabled)
+    {
+        PerfOverlayStats stats;
+        stats.frameMs = std::chrono::duration<double, std::milli>(frameStart - lastFrameTime).count();
+        stats.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        if (!frameGpuTimer.getLatestMs(stats.gpuMs))
+        {
+            stats.gpuMs = -1.0;
+        }
+#ifdef XWGL_GL_STATS
+        // Counted at the GL boundary, so culling, shadow and overlay passes are included
+        stats.drawCalls = (unsigned int)glStats.getLastFrame().drawCalls;
+        stats.triangles = glStats.getLastFrame().triangles;
+#else
+        stats.drawCalls = frameDrawCalls;
+        stats.triangles = frameTriangles;
+#endif
+        stats.gpuMemoryBytes = memoryBudget.getGpuBytes();
+        stats.hostMemoryBytes = memoryBudget.getHostBytes();
+        stats.heapAllocations = getHeapCounters().allocations - heapAtFrameStart.allocations;
+        perfOverlay.addFrame(stats);
+    }
+    lastFrameTime = frameStart;
+
+    // Caches, pools and the arena settle during the first frames; after that a
+    // frame should not touch the heap (swap buffers excluded, that is the driver's)
+    frameHeapAllocations = getHeapCounters().allocations - heapAtFrameStart.allocations;
+    if (++frameCount > 120 && frameHeapAllocations > 0 && heapAllocationReports < 8)
+    {
+        heapAllocationReports++;
+        logger.Debug("Frame %lu: %zu heap allocations (frame arena %zu bytes, %zu spilled)", frameCount,
+                     frameHeapAllocations, frameArena.getCapacity(), frameArena.getLastFrameStats().heapAllocations);
+    }
+
+    glXSwapBuffers(display, window);
+}
+
+void WindowManager::drawScene()
+{
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    mat4 viewProjectionMatrix = projectionMatrix * viewMatrix;
+
+    // Every draw's constants go into the frame's ring region up front; each
+    // draw then only binds its slice
+    const std::vector<DrawItem>& drawItems = drawList.getItems();
+    const GLsizeiptr constantsStride = frameConstants.alignUniform(sizeof(ObjectConstants));
+    GpuAllocation constants = frameConstants.allocateUniform(constantsStride * (GLsizeiptr)drawItems.size());
+    // Out of ring space (already logged): skip the scene draws this frame
+    const size_t numDraws = constants.data != nullptr ? drawItems.size() : 0;
+    frameDrawCalls = (unsigned int)numDraws;
+    frameTriangles = 0;
+    for (size_t i = 0; i < numDraws; ++i)
+    {
+        ObjectConstants *object = (ObjectConstants *)((unsigned char *)constants.data + i * constantsStride);
+        object->modelViewProjection = viewProjectionMatrix * sceneTransforms.getWorldMatrix(drawItems[i].transform);
+    }
+
+    // Draw list is sorted by shader then VAO, so only rebind when they change
+    Shader *boundShader = nullptr;
+    GLuint boundVao = 0;
+    GLint objectBinding = -1;
+    for (size_t i = 0; i < numDraws; ++i)
+    {
+        const DrawItem &item = drawItems[i];
+        Shader *shader = item.shader != nullptr ? item.shader : shaderProgram;
+        if (shader == nullptr)
+        {
+            continue;
+        }
+        if (shader != boundShader)
+        {
+            shader->use();
+            boundShader = shader;
+            objectBinding = shader->getUniformBlockBinding(ObjectConstantsSlot);
+        }
+        if (item.vao != boundVao)
+        {
+            glBindVertexArray(item.vao);
+            boundVao = item.vao;
+        }
+
+        if (objectBinding >= 0)
+        {
+            GpuRingBuffer::bindUniform(objectBinding, constants, i * constantsStride, sizeof(ObjectConstants));
+        }
+
+        // Draw geometry
+        if (item.indexType != 0)
+        {
+            GLsizei indexSize = item.indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+            glDrawElements(item.mode, item.count, item.indexType, (const void *)(size_t)(item.first * indexSize));
+        }
+        else
+        {
+            glDrawArrays(item.mode, item.first, item.count);
+        }
+        if (item.mode == GL_TRIANGLES)
+        {
+            frameTriangles += item.count / 3;
+        }
+    }
+
+    // GPU-culled instances: the culling pass already wrote the draw commands
+    if (gpuInstanceCount > 0)
+    {
+        instancedShaderProgram->use();
+        instancedShaderProgram->setUniformMatrix4(InstancedUniformViewProjection, viewProjectionMatrix.data());
+        glBindVertexArray(vao_triangle);
+        gpuCuller.draw(GL_TRIANGLES);
+        frameDrawCalls++;
+    }
 
     // Unbind with vao
     glBindVertexArray(0);
 
     // unuse shader program object
     glUseProgram(0);
-
-    glXSwapBuffers(display, window);
 }
 
 void WindowManager::update()
 {
     // code
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    float deltaSeconds = std::chrono::duration<float>(now - lastUpdateTime).count();
+    lastUpdateTime = now;
+
+    // advance spinning entities, then refresh world matrices in one pass
+    scene.each<SpinComponent, TransformComponent>(
+        [&](Entity, const SpinComponent &spinComponent, const TransformComponent &transform)
+        {
+            quat spin = angleAxis(deltaSeconds * spinComponent.radiansPerSecond, spinComponent.axis);
+            sceneTransforms.setRotation(transform.node, normalize(spin * sceneTransforms.getRotation(transform.node)));
+        });
+    sceneTransforms.updateWorldMatrices();
 }
 
 void WindowManager::uninitialize()
@@ -261,6 +779,32 @@ void WindowManager::uninitialize()
     // Cleanup OpenGL context and display
     if (glxContext)
     {
+        if (frameWriter.isOpen())
+        {
+            frameReadback.flush();
+            frameWriter.close();
+        }
+        memoryBudget.logSummary();
+        memoryBudget.removeEvictionCallback(evictionCallback);
+
+        frameReadback.cleanup();
+        sceneGpuTimer.cleanup();
+        frameGpuTimer.cleanup();
+        perfOverlay.cleanup();
+        gpuCuller.cleanup();
+        // StaticMesh destructors release their GL objects, so this needs the context
+        meshPool.clear();
+        assetMesh = nullptr;
+        frameConstants.cleanup();
+        renderTargetPool.cleanup();
+        shaderLibrary.cleanup();
+
+        glDebug.shutdown();
+
+#ifdef XWGL_GL_HOOKS
+        hookShutdown();
+#endif
+
         glXMakeCurrent(display, None, NULL);
         glXDestroyContext(display, glxContext);
     }
@@ -276,20 +820,13 @@ void WindowManager::createWindow()
 {
     // local variables
     // PP Related Variables
-    GLXFBConfig *glxFBConfigs;
     GLXFBConfig bestGLXFBConfig;
-    XVisualInfo *tempXVisualInfo = NULL;
-    int numFBConfigs;
     Atom windowManagerDelete;
 
-    int bestFrameBufferConfig = -1,
-        bestNumberOfSamples = -1;
-    int worstFrameBufferConfig = -1,
-        worstNumberOfSamples = 999;
-    int sampleBuffers, samples;
-
     // Open X display
+    int openDisplayPhase = startupTracer.beginPhase("XOpenDisplay");
     display = XOpenDisplay(nullptr);
+    startupTracer.endPhase(openDisplayPhase);
     if (!display)
     {
         logger.Error("Failed to open X display.");
@@ -324,49 +861,10 @@ void WindowManager::createWindow()
         None, // XWindows enforces to end every config array with 0 OR None
     };
 
-    glxFBConfigs = glXChooseFBConfig(display, screen, attribs, &numFBConfigs);
-    if (glxFBConfigs == nullptr)
-    {
-        logger.Error("Failed to Matching FBConfigs!");
-        exit(1);
-    }
-    else
-    {
-        logger.Info("Matching %d FBConfigs found!", numFBConfigs);
-    }
-
-    // b. fnd best matching fbconfig
-    for (int i = 0; i < numFBConfigs; i++)
-    {
-        tempXVisualInfo = glXGetVisualFromFBConfig(display, glxFBConfigs[i]);
-        if (tempXVisualInfo != NULL)
-        {
-            // i. Get Sample Buffers
-            glXGetFBConfigAttrib(display, glxFBConfigs[i], GLX_SAMPLE_BUFFERS, &sampleBuffers);
-            // ii. Get Samples
-            glXGetFBConfigAttrib(display, glxFBConfigs[i], GLX_SAMPLES, &samples);
-
-            if (bestFrameBufferConfig < 0 || (sampleBuffers && samples > bestNumberOfSamples))
-            {
-                bestFrameBufferConfig = i;
-                bestNumberOfSamples = samples;
-            }
-
-            if (worstFrameBufferConfig < 0 || !sampleBuffers || samples < worstNumberOfSamples)
-            {
-                worstFrameBufferConfig = i;
-                worstNumberOfSamples = samples;
-            }
-
-            XFree(tempXVisualInfo);
-            tempXVisualInfo = NULL;
-        }
-    }
-
-    bestGLXFBConfig = glxFBConfigs[bestFrameBufferConfig];
+    bestGLXFBConfig = chooseFBConfig(screen, attribs);
     glxFBConfig = bestGLXFBConfig;
-    XFree(glxFBConfigs);
 
+    int createWindowPhase = startupTracer.beginPhase("XCreateWindow");
     visualInfo = glXGetVisualFromFBConfig(display, bestGLXFBConfig);
     if (!visualInfo)
     {
@@ -430,7 +928,7 @@ void WindowManager::createWindow()
     );
 
     // Set window title
-    XStoreName(display, window, this->title);
+    XStoreName(display, window, title.c_str());
 
     // Map window to display
     XMapWindow(display, window);
@@ -444,15 +942,93 @@ void WindowManager::createWindow()
         window,
         ((screenWidth - this->width) / 2),
         ((screenHeight - this->height) / 2));
+
+    startupTracer.endPhase(createWindowPhase);
+}
+
+GLXFBConfig WindowManager::chooseFBConfig(int screen, const int *attribs)
+{
+    StartupPhase phase("chooseFBConfig");
+
+    // local variables
+    GLXFBConfig *glxFBConfigs;
+    GLXFBConfig bestGLXFBConfig;
+    XVisualInfo *tempXVisualInfo = NULL;
+    int numFBConfigs;
+
+    int bestFrameBufferConfig = -1,
+        bestNumberOfSamples = -1;
+    int worstFrameBufferConfig = -1,
+        worstNumberOfSamples = 999;
+    int sampleBuffers, samples;
+
+    // a. reuse the config picked by a previous run on the same display and driver
+    FBConfigCache fbConfigCache(display, screen, attribs);
+    bestGLXFBConfig = fbConfigCache.lookup();
+    if (bestGLXFBConfig)
+    {
+        logger.Info("Using cached FBConfig.");
+        return bestGLXFBConfig;
+    }
+
+    glxFBConfigs = glXChooseFBConfig(display, screen, attribs, &numFBConfigs);
+    if (glxFBConfigs == nullptr)
+    {
+        logger.Error("Failed to Matching FBConfigs!");
+        exit(1);
+    }
+    else
+    {
+        logger.Info("Matching %d FBConfigs found!", numFBConfigs);
+    }
+
+    // b. fnd best matching fbconfig
+    for (int i = 0; i < numFBConfigs; i++)
+    {
+        tempXVisualInfo = glXGetVisualFromFBConfig(display, glxFBConfigs[i]);
+        if (tempXVisualInfo != NULL)
+        {
+            // i. Get Sample Buffers
+            glXGetFBConfigAttrib(display, glxFBConfigs[i], GLX_SAMPLE_BUFFERS, &sampleBuffers);
+            // ii. Get Samples
+            glXGetFBConfigAttrib(display, glxFBConfigs[i], GLX_SAMPLES, &samples);
+
+            if (bestFrameBufferConfig < 0 || (sampleBuffers && samples > bestNumberOfSamples))
+            {
+                bestFrameBufferConfig = i;
+                bestNumberOfSamples = samples;
+            }
+
+            if (worstFrameBufferConfig < 0 || !sampleBuffers || samples < worstNumberOfSamples)
+            {
+                worstFrameBufferConfig = i;
+                worstNumberOfSamples = samples;
+            }
+
+            XFree(tempXVisualInfo);
+            tempXVisualInfo = NULL;
+        }
+    }
+
+    bestGLXFBConfig = glxFBConfigs[bestFrameBufferConfig];
+    XFree(glxFBConfigs);
+
+    fbConfigCache.store(bestGLXFBConfig);
+
+    return bestGLXFBConfig;
 }
 
 void WindowManager::setupGL()
 {
+    // XWGL_GL_DEBUG asks for a debug context
+    glDebug.configure();
+
     // local variables
     int context_attribs_new[] = {
         GLX_CONTEXT_MAJOR_VERSION_ARB, 4,
         GLX_CONTEXT_MINOR_VERSION_ARB, 6,
         GLX_CONTEXT_PROFILE_MASK_ARB, GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+        GLX_CONTEXT_FLAGS_ARB, glDebug.wantsDebugContext() ? GLX_CONTEXT_DEBUG_BIT_ARB : 0,
         None};
     int context_attribs_old[] = {
         GLX_CONTEXT_MAJOR_VERSION_ARB, 1,
@@ -468,6 +1044,7 @@ void WindowManager::setupGL()
         exit(1);
     }
 
+    int createContextPhase = startupTracer.beginPhase("glXCreateContext");
     glxContext = glXCreateContextAttribsARB(display, this->glxFBConfig, 0, True, context_attribs_new);
     if (!glxContext)
     {
@@ -490,6 +1067,7 @@ void WindowManager::setupGL()
     {
         logger.Info("Core profile GLXContext found and obtained successfully!");
     }
+    startupTracer.endPhase(createContextPhase);
 
     // check if the context supports direct rendering
     if (!glXIsDirect(display, glxContext))
@@ -523,17 +1101,24 @@ void WindowManager::setupGL()
 void WindowManager::setupGLEW()
 {
     // initialize GLEW (GLSL Extension Wrangler)
+    int glewPhase = startupTracer.beginPhase("glewInit");
     if (glewInit() != GLEW_OK)
     {
         logger.Error("glewInit(): Failed to initialize GLEW");
         exit(1);
     }
+    startupTracer.endPhase(glewPhase);
+
+    // Driver messages from here on, including shader compiles in loadResources()
+    glDebug.initialize();
 
     printGLInfo();
 }
 
 void WindowManager::printGLInfo()
 {
+    StartupPhase phase("printGLInfo");
+
     // variable declarations
     GLint numExtensions;
 
@@ -553,11 +1138,22 @@ void WindowManager::printGLInfo()
     glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
 
     // Log supported extensions
-    logger.Info("Supported Extensions (%d) are:\n", numExtensions);
-    for (int i = 0; i < numExtensions; i++)
+    // The full list is several hundred lines of I/O on the startup path, so only dump it on request
+    logger.Info("Supported Extensions: %d\n", numExtensions);
+    if (getenv("XWGL_LOG_EXTENSIONS") != nullptr)
+    {
+        for (int i = 0; i < numExtensions; i++)
+        {
+            const char *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+            logger.Info("%s\n", extension);
+        }
+    }
+
+    DriverMemoryInfo memoryInfo;
+    if (memoryBudget.queryDriver(memoryInfo))
     {
-        const char *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
-        logger.Info("%s\n", extension);
+        logger.Info("GPU Memory (%s) : %lld MB free of %lld MB\n", memoryInfo.source,
+                    (long long)(memoryInfo.freeBytes >> 20), (long long)(memoryInfo.totalBytes >> 20));
     }
 
     logger.Info("----------------------\n\n");
@@ -3,12 +3,32 @@
 #include <GL/gl.h>
 #include <GL/glx.h>
 
+#include "DrawList.h"
+#include "DynamicResolution.h"
+#include "EntityRegistry.h"
+#include "FrameArena.h"
+#include "FrameReadback.h"
+#include "GpuCulling.h"
+#include "GpuRingBuffer.h"
+#include "GpuTimer.h"
+#include "FrameWriter.h"
+#include "ObjectPool.h"
+#include "PerfOverlay.h"
+#include "RenderGraph.h"
+#include "RenderTargetPool.h"
+#include "StaticMesh.h"
+#include "TransformHierarchy.h"
+#include "VectorMath.h"
+
+#include <chrono>
+#include <string>
+
 typedef GLXContext (*glXCreateContextAttribsARBProc)(Display *, GLXFBConfig, GLXContext, Bool, const int *);
 
 class WindowManager
 {
 public:
-    WindowManager(int width, int height, char *title);
+    WindowManager(int width, int height, const char *title);
     ~WindowManager();
 
     void initialize();
@@ -20,7 +40,7 @@ public:
 
 private:
     int width, height;
-    char *title;
+    std::string title;
     bool fullscreen;
     bool running;
     bool focused;
@@ -33,8 +53,55 @@ private:
     glXCreateContextAttribsARBProc glXCreateContextAttribsARB = NULL;
     GLXFBConfig glxFBConfig;
     GLXContext glxContext = NULL;
+    // Offscreen targets
+    RenderTargetPool renderTargetPool;
+    // Per-frame allocations (render graph callbacks); must outlive renderGraph
+    FrameArena frameArena;
+    RenderGraph renderGraph;
+    // Frame recording (XWGL_RECORD=png:<pattern>|raw:<file>|pipe:<command>)
+    FrameWriter frameWriter;
+    FrameReadback frameReadback;
+    // Dynamic resolution (XWGL_DYNAMIC_RESOLUTION=<GPU budget in ms>)
+    bool dynamicResolutionEnabled;
+    DynamicResolution dynamicResolution;
+    GpuTimer sceneGpuTimer;
+    // Performance overlay (XWGL_OVERLAY=1, toggled with 'o')
+    bool overlayEnabled;
+    PerfOverlay perfOverlay;
+    GpuTimer frameGpuTimer;
+    std::chrono::steady_clock::time_point lastFrameTime;
+    unsigned int frameDrawCalls;
+    uint64_t frameTriangles;
+    // Scene
+    EntityRegistry scene;
+    TransformHierarchy sceneTransforms;
+    DrawList drawList;
+    // Per-frame uniform/storage data (per-draw ObjectConstants)
+    GpuRingBuffer frameConstants;
+    // MemoryBudget eviction hook (XWGL_GPU_BUDGET_MB / XWGL_GPU_RESERVE_MB)
+    int evictionCallback;
+    // Screen-space LOD error threshold (XWGL_LOD_ERROR=<pixels>)
+    LodSelection lodSelection;
+    // GL mesh objects; optional asset from XWGL_MESH=<file.obj|.gltf|.glb>
+    ObjectPool<StaticMesh, 8> meshPool;
+    StaticMesh *assetMesh;
+    // GPU-driven instanced grid (XWGL_GPU_INSTANCES=<count>)
+    int gpuInstanceCount;
+    GpuCuller gpuCuller;
+    mat4 projectionMatrix;
+    mat4 viewMatrix;
+    std::chrono::steady_clock::time_point lastUpdateTime;
+    // Steady-state allocation check (heap counts need -DXWGL_TRACK_HEAP=ON)
+    unsigned long frameCount;
+    size_t frameHeapAllocations;
+    unsigned int heapAllocationReports;
 
     void createWindow();
+    GLXFBConfig chooseFBConfig(int screen, const int *attribs);
+    void loadResources();
+    void loadGpuInstances();
+    void loadMeshAsset(const char *filePath);
+    void drawScene();
     void setupGL();
     void setupGLEW();
     void printGLInfo();
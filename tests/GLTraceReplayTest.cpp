@@ -0,0 +1,124 @@
+// Mapped buffer writes are recorded at the end of a frame but have to replay
+// before the frame's draws, and not before their buffer exists: in frame 0 the
+// ring buffer is created after the capture started, so its write goes right
+// after the buffer's storage rather than to the start of the frame.
+
+#include "GLTrace.h"
+#include "GLTraceReplay.h"
+#include "TestCheck.h"
+
+namespace {
+
+const char* const TracePath = "glTraceReplayTest.trace";
+const GLuint RingBuffer = 7;
+// Created before the capture started
+const GLuint OlderBuffer = 9;
+
+void writeMappedBufferWrite(GLTraceWriter& writer, GLuint buffer) {
+    const unsigned char bytes[16] = {};
+    writer.beginRecord(GLTraceOp::MappedBufferWrite);
+    writer.write(buffer);
+    writer.write(static_cast<int64_t>(0));
+    writer.write(static_cast<int64_t>(sizeof(bytes)));
+    writer.write(bytes, sizeof(bytes));
+    writer.endRecord();
+}
+
+void writeDraw(GLTraceWriter& writer) {
+    writer.beginRecord(GLTraceOp::DrawArrays);
+    writer.write(static_cast<GLenum>(GL_TRIANGLES));
+    writer.write(static_cast<GLint>(0));
+    writer.write(static_cast<GLsizei>(3));
+    writer.endRecord();
+}
+
+bool writeTrace(const char* filePath) {
+    GLTraceWriter writer;
+    if (!writer.open(filePath, 0)) {
+        return false;
+    }
+
+    // Frame 0: what GpuRingBuffer::initialize() and the first frame record
+    writer.beginRecord(GLTraceOp::ClearColor); // 0
+    for (int i = 0; i < 4; ++i) {
+        writer.write(0.0f);
+    }
+    writer.endRecord();
+    writer.beginRecord(GLTraceOp::GenBuffers); // 1
+    writer.write(static_cast<GLsizei>(1));
+    writer.write(RingBuffer);
+    writer.endRecord();
+    writer.beginRecord(GLTraceOp::BindBuffer); // 2
+    writer.write(static_cast<GLenum>(GL_COPY_WRITE_BUFFER));
+    writer.write(RingBuffer);
+    writer.endRecord();
+    writer.beginRecord(GLTraceOp::BufferStorage); // 3
+    writer.write(static_cast<GLenum>(GL_COPY_WRITE_BUFFER));
+    writer.write(static_cast<int64_t>(4096));
+    writer.write(static_cast<GLbitfield>(GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT));
+    writer.write(static_cast<uint8_t>(0));
+    writer.endRecord();
+    writer.beginRecord(GLTraceOp::MapBufferRange); // 4
+    writer.write(static_cast<GLenum>(GL_COPY_WRITE_BUFFER));
+    writer.write(static_cast<int64_t>(0));
+    writer.write(static_cast<int64_t>(4096));
+    writer.write(static_cast<GLbitfield>(GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT));
+    writer.endRecord();
+    writer.beginRecord(GLTraceOp::BindBuffer); // 5
+    writer.write(static_cast<GLenum>(GL_COPY_WRITE_BUFFER));
+    writer.write(static_cast<GLuint>(0));
+    writer.endRecord();
+    writer.beginRecord(GLTraceOp::BindBufferRange); // 6
+    writer.write(static_cast<GLenum>(GL_UNIFORM_BUFFER));
+    writer.write(static_cast<GLuint>(0));
+    writer.write(RingBuffer);
+    writer.write(static_cast<int64_t>(0));
+    writer.write(static_cast<int64_t>(256));
+    writer.endRecord();
+    writeDraw(writer);                          // 7
+    writeMappedBufferWrite(writer, RingBuffer);  // 8
+    writeMappedBufferWrite(writer, OlderBuffer); // 9
+    writer.endFrame();
+
+    // Frame 1: the ring buffer exists, so its write goes first
+    writeDraw(writer);                         // 0
+    writeMappedBufferWrite(writer, RingBuffer); // 1
+    writer.endFrame();
+
+    writer.close();
+    return true;
+}
+
+} // namespace
+
+int main() {
+    if (!writeTrace(TracePath)) {
+        fprintf(stderr, "GLTraceReplayTest: cannot write %s\n", TracePath);
+        return 1;
+    }
+
+    GLTraceReplayer replayer;
+    CHECK(replayer.load(TracePath));
+    CHECK(replayer.getNumFrames() == 2);
+    if (replayer.getNumFrames() != 2) {
+        return testResult("GLTraceReplayTest");
+    }
+
+    std::vector<size_t> records;
+    replayer.getReplayOrder(0, records);
+    const size_t expectedFrame0[] = {9, 0, 1, 2, 3, 8, 4, 5, 6, 7};
+    CHECK(records.size() == sizeof(expectedFrame0) / sizeof(expectedFrame0[0]));
+    for (size_t i = 0; i < records.size() && i < sizeof(expectedFrame0) / sizeof(expectedFrame0[0]); ++i) {
+        CHECK(records[i] == expectedFrame0[i]);
+    }
+
+    replayer.getReplayOrder(1, records);
+    CHECK(records.size() == 2);
+    if (records.size() == 2) {
+        CHECK(records[0] == 1);
+        CHECK(records[1] == 0);
+    }
+
+    remove(TracePath);
+    return testResult("GLTraceReplayTest");
+}
@@ -0,0 +1,89 @@
+// loadObj() must not depend on how the file is chunked: a grid written
+// without normals, parsed as many small chunks and as a single chunk, has to
+// give the same vertices (one per grid point, with seam-free generated
+// normals) and the same indices.
+
+#include "MeshLoader.h"
+#include "TestCheck.h"
+#include "ThreadPool.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+const int GridSize = 201;
+const char* const GridPath = "objLoaderTest.obj";
+
+// Height field on the xz plane; every other row of quads uses negative
+// (relative) indices so those are resolved across chunk borders too
+bool writeGrid(const char* filePath) {
+    FILE* file = fopen(filePath, "w");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "# %dx%d grid\n", GridSize, GridSize);
+    for (int z = 0; z < GridSize; ++z) {
+        for (int x = 0; x < GridSize; ++x) {
+            fprintf(file, "v %d %.6f %d\n", x, std::sin(x * 0.1) * std::cos(z * 0.07), z);
+        }
+    }
+    const int numVertices = GridSize * GridSize;
+    for (int z = 0; z + 1 < GridSize; ++z) {
+        for (int x = 0; x + 1 < GridSize; ++x) {
+            int v00 = z * GridSize + x + 1;
+            int v10 = v00 + 1;
+            int v01 = v00 + GridSize;
+            int v11 = v01 + 1;
+            if (z % 2 == 0) {
+                fprintf(file, "f %d %d %d %d\n", v00, v01, v11, v10);
+            } else {
+                fprintf(file, "f %d %d %d %d\n", v00 - numVertices - 1, v01 - numVertices - 1, v11 - numVertices - 1,
+                        v10 - numVertices - 1);
+            }
+        }
+    }
+    return fclose(file) == 0;
+}
+
+} // namespace
+
+int main() {
+    if (!writeGrid(GridPath)) {
+        fprintf(stderr, "ObjLoaderTest: cannot write %s\n", GridPath);
+        return 1;
+    }
+
+    ThreadPool threadPool(4);
+    MeshData chunked;
+    MeshData single;
+    CHECK(loadObj(GridPath, chunked, threadPool, 16 * 1024));
+    CHECK(loadObj(GridPath, single, threadPool, SIZE_MAX));
+    remove(GridPath);
+
+    const size_t expectedVertices = static_cast<size_t>(GridSize) * GridSize;
+    const size_t expectedIndices = static_cast<size_t>(GridSize - 1) * (GridSize - 1) * 6;
+    CHECK(single.vertices.size() == expectedVertices);
+    CHECK(chunked.vertices.size() == expectedVertices);
+    CHECK(chunked.indices.size() == expectedIndices);
+
+    CHECK(chunked.vertices.size() == single.vertices.size());
+    CHECK(chunked.indices == single.indices);
+    if (chunked.vertices.size() == single.vertices.size()) {
+        CHECK(memcmp(chunked.vertices.data(), single.vertices.data(), single.vertices.size() * sizeof(MeshVertex)) == 0);
+    }
+
+    // Generated normals are unit length and face up on this height field
+    for (size_t i = 0; i < chunked.vertices.size(); ++i) {
+        const float* normal = chunked.vertices[i].normal;
+        float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (std::fabs(length - 1.0f) > 1e-4f || normal[1] <= 0.0f) {
+            fprintf(stderr, "  vertex %zu: normal (%f, %f, %f)\n", i, normal[0], normal[1], normal[2]);
+            CHECK(false);
+            break;
+        }
+    }
+
+    return testResult("ObjLoaderTest");
+}
@@ -0,0 +1,114 @@
+// RenderGraph::compile() ordering: passes declared out of dependency order
+// are sorted, independent passes keep declaration order, reads of imported
+// resources run before they are overwritten, and cycles fail to compile.
+// Only compile() runs, so no GL context is needed.
+
+#include "RenderGraph.h"
+#include "TestCheck.h"
+
+namespace {
+
+void emptyPass(RenderGraph&) {
+}
+
+// Declaration indices in execution order
+std::vector<int> executionOrder(const RenderGraph& graph) {
+    std::vector<int> order;
+    for (int position = 0; position < graph.getNumPasses(); ++position) {
+        order.push_back(graph.getExecutionOrder(position));
+    }
+    return order;
+}
+
+std::vector<int> expectedOrder(std::initializer_list<int> passes) {
+    return std::vector<int>(passes);
+}
+
+void testOutOfOrderDeclaration(RenderGraph& graph) {
+    graph.reset();
+    RenderGraphResource backbuffer = graph.importBackbuffer(64, 64);
+    RenderGraphResource gbuffer = graph.createTexture("gbuffer", RenderTargetDesc(GL_RGBA8, 64, 64));
+    RenderGraphResource lit = graph.createTexture("lit", RenderTargetDesc(GL_RGBA16F, 64, 64));
+
+    // Consumers first, producers last
+    graph.addPass("composite", emptyPass)
+        .read(lit, RenderGraphAccess::Sampled)
+        .write(backbuffer, RenderGraphAccess::ColorAttachment);
+    graph.addPass("lighting", emptyPass)
+        .read(gbuffer, RenderGraphAccess::Sampled)
+        .write(lit, RenderGraphAccess::ColorAttachment);
+    graph.addPass("geometry", emptyPass).write(gbuffer, RenderGraphAccess::ColorAttachment);
+
+    CHECK(graph.compile());
+    CHECK(executionOrder(graph) == expectedOrder({2, 1, 0}));
+    CHECK(graph.getNumCulledPasses() == 0);
+}
+
+void testIndependentPassesKeepDeclarationOrder(RenderGraph& graph) {
+    graph.reset();
+    RenderGraphResource backbuffer = graph.importBackbuffer(64, 64);
+    RenderGraphResource shadow = graph.createTexture("shadow", RenderTargetDesc(GL_DEPTH_COMPONENT32F, 64, 64));
+    RenderGraphResource ao = graph.createTexture("ao", RenderTargetDesc(GL_R8, 64, 64));
+
+    graph.addPass("shadow", emptyPass).write(shadow, RenderGraphAccess::DepthAttachment);
+    graph.addPass("ao", emptyPass).write(ao, RenderGraphAccess::StorageImage);
+    graph.addPass("scene", emptyPass)
+        .read(shadow, RenderGraphAccess::Sampled)
+        .read(ao, RenderGraphAccess::Sampled)
+        .write(backbuffer, RenderGraphAccess::ColorAttachment);
+    graph.addPass("overlay", emptyPass).write(backbuffer, RenderGraphAccess::ColorAttachment);
+
+    CHECK(graph.compile());
+    CHECK(executionOrder(graph) == expectedOrder({0, 1, 2, 3}));
+}
+
+void testImportedReadBeforeOverwrite(RenderGraph& graph) {
+    graph.reset();
+    RenderGraphResource backbuffer = graph.importBackbuffer(64, 64);
+    RenderGraphResource history = graph.importTexture("history", 0);
+    RenderGraphResource lit = graph.createTexture("lit", RenderTargetDesc(GL_RGBA16F, 64, 64));
+    graph.markOutput(history);
+
+    // "resolve" reads last frame's history and waits for "lighting", so it
+    // has to hold back "storeHistory" even though that one is ready earlier
+    graph.addPass("resolve", emptyPass)
+        .read(history, RenderGraphAccess::Sampled)
+        .read(lit, RenderGraphAccess::Sampled)
+        .write(backbuffer, RenderGraphAccess::ColorAttachment);
+    graph.addPass("storeHistory", emptyPass).write(history, RenderGraphAccess::Transfer);
+    graph.addPass("lighting", emptyPass).write(lit, RenderGraphAccess::ColorAttachment);
+
+    CHECK(graph.compile());
+    CHECK(executionOrder(graph) == expectedOrder({2, 0, 1}));
+}
+
+void testCycleFails(RenderGraph& graph) {
+    graph.reset();
+    RenderGraphResource backbuffer = graph.importBackbuffer(64, 64);
+    RenderGraphResource a = graph.createTexture("a", RenderTargetDesc(GL_RGBA8, 64, 64));
+    RenderGraphResource b = graph.createTexture("b", RenderTargetDesc(GL_RGBA8, 64, 64));
+
+    graph.addPass("first", emptyPass).read(a, RenderGraphAccess::Sampled).write(b, RenderGraphAccess::ColorAttachment);
+    graph.addPass("second", emptyPass).read(b, RenderGraphAccess::Sampled).write(a, RenderGraphAccess::ColorAttachment);
+    graph.addPass("present", emptyPass)
+        .read(a, RenderGraphAccess::Sampled)
+        .write(backbuffer, RenderGraphAccess::ColorAttachment);
+
+    CHECK(!graph.compile());
+}
+
+} // namespace
+
+int main() {
+    RenderTargetPool renderTargetPool;
+    FrameArena frameArena;
+    RenderGraph graph(renderTargetPool, frameArena);
+
+    testOutOfOrderDeclaration(graph);
+    testIndependentPassesKeepDeclarationOrder(graph);
+    testImportedReadBeforeOverwrite(graph);
+    testCycleFails(graph);
+
+    graph.reset();
+    return testResult("RenderGraphTest");
+}
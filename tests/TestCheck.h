@@ -0,0 +1,29 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <cstdio>
+
+// Minimal assertions for the ctest executables: a failed CHECK prints the
+// expression and location and the test keeps going; main() returns
+// testResult() so ctest sees the failure.
+
+static int testFailures = 0;
+
+#define CHECK(expression)                                                                           \
+    do {                                                                                            \
+        if (!(expression)) {                                                                        \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expression);          \
+            ++testFailures;                                                                         \
+        }                                                                                           \
+    } while (false)
+
+inline int testResult(const char* name) {
+    if (testFailures > 0) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, testFailures);
+        return 1;
+    }
+    printf("%s: all checks passed\n", name);
+    return 0;
+}
+
+#endif // TEST_CHECK_H
@@ -0,0 +1,82 @@
+// mat4 * mat4 and mat4 * vec4 against a plain scalar reference, so the
+// SIMD path the build selected (SSE, or AVX with XWGL_AVX) is checked on
+// the matrices the renderer actually multiplies.
+
+#include "TestCheck.h"
+#include "VectorMath.h"
+
+#include <cmath>
+
+namespace {
+
+// Column-major reference: r[c][row] = sum over k of a[k][row] * b[c][k]
+mat4 referenceMultiply(const mat4& a, const mat4& b) {
+    mat4 r;
+    for (int c = 0; c < 4; ++c) {
+        for (int row = 0; row < 4; ++row) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k) {
+                sum += a.data()[k * 4 + row] * b.data()[c * 4 + k];
+            }
+            r.data()[c * 4 + row] = sum;
+        }
+    }
+    return r;
+}
+
+bool nearlyEqual(const float* a, const float* b, int count) {
+    for (int i = 0; i < count; ++i) {
+        float tolerance = 1e-5f * std::fmax(1.0f, std::fabs(b[i]));
+        if (std::fabs(a[i] - b[i]) > tolerance) {
+            fprintf(stderr, "  element %d: %.9g != %.9g\n", i, a[i], b[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+void testMultiply(const mat4& a, const mat4& b) {
+    mat4 product = a * b;
+    mat4 expected = referenceMultiply(a, b);
+    CHECK(nearlyEqual(product.data(), expected.data(), 16));
+
+    vec4 v(0.25f, -3.0f, 7.5f, 1.0f);
+    vec4 transformed = a * v;
+    mat4 column(v, vec4(0.0f), vec4(0.0f), vec4(0.0f));
+    CHECK(nearlyEqual(transformed.data(), referenceMultiply(a, column).data(), 4));
+}
+
+} // namespace
+
+int main() {
+#if defined(__AVX__)
+    printf("VectorMathTest: AVX path\n");
+#elif defined(XWGL_MATH_SSE)
+    printf("VectorMathTest: SSE path\n");
+#else
+    printf("VectorMathTest: scalar path\n");
+#endif
+
+    mat4 projection = perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+    mat4 view = lookAt(vec3(0.0f, 2.0f, 5.0f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+    mat4 model = composeTRS(vec3(1.0f, -2.0f, 3.0f), angleAxis(0.7f, normalize(vec3(1.0f, 1.0f, 0.0f))),
+                            vec3(2.0f, 0.5f, 1.5f));
+
+    testMultiply(projection, view);
+    testMultiply(view, model);
+    testMultiply(projection * view, model);
+    testMultiply(model, inverse(model));
+    testMultiply(mat4(), orthographic(-4.0f, 4.0f, -3.0f, 3.0f, 0.1f, 50.0f));
+
+    // Every element distinct, so a swapped lane or column shows up
+    mat4 a;
+    mat4 b;
+    for (int i = 0; i < 16; ++i) {
+        a.data()[i] = 0.5f * i - 3.0f;
+        b.data()[i] = 1.0f / (i + 1) + (i % 3);
+    }
+    testMultiply(a, b);
+    testMultiply(b, a);
+
+    return testResult("VectorMathTest");
+}
@@ -0,0 +1,98 @@
+// Offline mesh optimizer: loads an OBJ/glTF asset, runs the MeshOptimizer
+// pipeline (dedupe, vertex cache, overdraw, LODs, vertex fetch) and writes a
+// quantized .mesh file with its LOD chain that the engine maps directly. Usage:
+//   meshopt <input> <output.mesh> [--no-overdraw] [--cache-size N] [--lods N] [--lod-error E]
+// --lods 1 disables LOD generation; E is relative to the bounding box diagonal.
+// The build runs it over assets/meshes/ (see the `meshes` target).
+
+#include "MeshCache.h"
+#include "MeshLoader.h"
+#include "MeshOptimizer.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+#include <vector>
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <input> <output.mesh> [--no-overdraw] [--cache-size N] [--lods N] [--lod-error E]\n",
+                argv[0]);
+        return 1;
+    }
+
+    const char *inputPath = argv[1];
+    const char *outputPath = argv[2];
+    MeshOptimizeOptions options;
+
+    for (int i = 3; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--no-overdraw") == 0)
+        {
+            options.optimizeOverdraw = false;
+        }
+        else if (strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc)
+        {
+            options.cacheSize = static_cast<unsigned int>(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--lods") == 0 && i + 1 < argc)
+        {
+            options.maxLods = static_cast<unsigned int>(std::max(1, atoi(argv[++i])));
+        }
+        else if (strcmp(argv[i], "--lod-error") == 0 && i + 1 < argc)
+        {
+            options.lodMaxError = static_cast<float>(atof(argv[++i]));
+        }
+    }
+
+    struct stat sourceInfo;
+    if (stat(inputPath, &sourceInfo) != 0)
+    {
+        fprintf(stderr, "meshopt: cannot stat %s\n", inputPath);
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    MeshData mesh;
+    if (!loadMesh(inputPath, mesh, threadPool))
+    {
+        fprintf(stderr, "meshopt: cannot load %s (see logs/error.log)\n", inputPath);
+        return 1;
+    }
+
+    size_t inputVertices = mesh.vertices.size();
+    float acmrBefore = computeAcmr(mesh.indices, mesh.vertices.size(), options.cacheSize);
+
+    optimizeMesh(mesh, options);
+    const MeshLod &fullDetail = mesh.lods[0];
+    std::vector<uint32_t> fullDetailIndices(mesh.indices.begin() + fullDetail.firstIndex,
+                                            mesh.indices.begin() + fullDetail.firstIndex + fullDetail.indexCount);
+    float acmrAfter = computeAcmr(fullDetailIndices, mesh.vertices.size(), options.cacheSize);
+
+    QuantizedMesh quantized;
+    quantizeMesh(mesh, quantized);
+    if (!MeshCache::write(outputPath, quantized, static_cast<uint64_t>(sourceInfo.st_size),
+                          static_cast<int64_t>(sourceInfo.st_mtime)))
+    {
+        fprintf(stderr, "meshopt: cannot write %s\n", outputPath);
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%s: %zu triangles, vertices %zu -> %zu, ACMR(%u) %.3f -> %.3f, vertex bytes %zu -> %zu, %.2f s\n",
+           inputPath, fullDetailIndices.size() / 3, inputVertices, mesh.vertices.size(), options.cacheSize, acmrBefore,
+           acmrAfter, mesh.vertices.size() * sizeof(MeshVertex), quantized.vertices.size() * sizeof(QuantizedVertex),
+           seconds);
+    for (size_t i = 0; i < mesh.lods.size(); i++)
+    {
+        printf("  LOD %zu: %8u triangles, error %g\n", i, mesh.lods[i].indexCount / 3, mesh.lods[i].error);
+    }
+    return 0;
+}
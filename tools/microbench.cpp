@@ -0,0 +1,437 @@
+// CPU-side micro-benchmarks; no display or GL context needed. Usage:
+//   microbench [--filter <substring>] [--min-time MS] [--repetitions N] [--cpu N] [--json <file>] [--list]
+// Each benchmark is first run with a doubling iteration count until one run
+// takes at least --min-time (default 100 ms); that count is then repeated N
+// times (default 5). The report shows the median and the spread in ns/op,
+// plus heap allocations and bytes per op. Those count global operator new
+// (this target is built with XWGL_TRACK_HEAP); malloc calls made inside libc
+// are not included. --cpu pins the process to one core to reduce noise.
+
+#include "FrustumCulling.h"
+#include "HeapTracking.h"
+#include "Logger.h"
+#include "Shader.h"
+#include "VectorMath.h"
+#include "WindowEvents.h"
+
+#include <X11/keysym.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sched.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Keeps the optimizer from discarding a result that is otherwise unused
+template <typename T>
+static inline void doNotOptimize(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct MicroBenchmark
+{
+    const char *name;
+    bool (*setup)();
+    void (*run)(size_t iterations);
+    void (*teardown)();
+};
+
+struct MicroResult
+{
+    const char *name;
+    size_t iterations;
+    double nsPerOp;
+    double minNsPerOp;
+    double maxNsPerOp;
+    double allocationsPerOp;
+    double bytesPerOp;
+};
+
+// Logger
+
+// The logger opens logs/*.log relative to the working directory at static
+// initialization and silently drops messages when that failed
+static bool setupLogger()
+{
+    if (access("logs/info.log", W_OK) != 0)
+    {
+        fprintf(stderr, "microbench: logs/info.log is not writable; run from a directory with a logs/ folder\n");
+        return false;
+    }
+    return true;
+}
+
+static void runLoggerInfo(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; i++)
+    {
+        logger.Info("frame %zu: %.3f ms, %u draws, %s", i, 16.667, 1234u, "steady");
+    }
+}
+
+// Shader source loading: a shader with one #include, read and expanded each op
+
+static char shaderDirectory[] = "/tmp/microbench-XXXXXX";
+static std::string shaderPath;
+static std::string includePath;
+
+static bool writeFile(const std::string &path, const char *contents)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+    fputs(contents, file);
+    fclose(file);
+    return true;
+}
+
+static bool setupShaderSource()
+{
+    if (!mkdtemp(shaderDirectory))
+    {
+        return false;
+    }
+    shaderPath = std::string(shaderDirectory) + "/vertexShader.glsl";
+    includePath = std::string(shaderDirectory) + "/common.glsl";
+
+    std::string common = "// Shared declarations\n";
+    for (int i = 0; i < 32; i++)
+    {
+        char line[128];
+        snprintf(line, sizeof(line), "uniform vec4 uParameter%d;\n", i);
+        common += line;
+    }
+    return writeFile(includePath, common.c_str()) &&
+           writeFile(shaderPath, "#version 460 core\n"
+                                 "#include \"common.glsl\"\n"
+                                 "layout(location = 0) in vec4 aPosition;\n"
+                                 "uniform mat4 uMVPMatrix;\n"
+                                 "void main() {\n"
+                                 "    gl_Position = uMVPMatrix * (aPosition + uParameter0);\n"
+                                 "}\n");
+}
+
+static void runShaderLoadSource(size_t iterations)
+{
+    std::string source;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        Shader::loadSource(shaderPath.c_str(), source);
+        doNotOptimize(source.data());
+    }
+}
+
+static void teardownShaderSource()
+{
+    unlink(shaderPath.c_str());
+    unlink(includePath.c_str());
+    rmdir(shaderDirectory);
+}
+
+// Event dispatch over a fixed mix of synthetic events
+
+static const size_t NumEvents = 64;
+static XEvent events[NumEvents];
+static KeySym eventKeySyms[NumEvents];
+static char eventKeys[NumEvents];
+
+static bool setupEvents()
+{
+    static const char typedKeys[] = "wasdWASDqe";
+    memset(events, 0, sizeof(events));
+    for (size_t i = 0; i < NumEvents; i++)
+    {
+        eventKeySyms[i] = NoSymbol;
+        eventKeys[i] = '\0';
+        switch (i % 8)
+        {
+        case 0:
+            events[i].type = ConfigureNotify;
+            events[i].xconfigure.width = 800 + static_cast<int>(i);
+            events[i].xconfigure.height = 600;
+            break;
+        case 1:
+            events[i].type = FocusIn;
+            break;
+        case 2:
+            events[i].type = ButtonPress;
+            events[i].xbutton.button = 1;
+            break;
+        case 3:
+            events[i].type = KeyPress;
+            eventKeySyms[i] = XK_o;
+            eventKeys[i] = 'o';
+            break;
+        default:
+            events[i].type = KeyPress;
+            eventKeys[i] = typedKeys[i % (sizeof(typedKeys) - 1)];
+            eventKeySyms[i] = static_cast<KeySym>(eventKeys[i]);
+            break;
+        }
+    }
+    return true;
+}
+
+static void runEventDispatch(size_t iterations)
+{
+    unsigned int actions = 0;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        size_t index = i % NumEvents;
+        actions += static_cast<unsigned int>(translateEvent(events[index], eventKeySyms[index], eventKeys[index]));
+    }
+    doNotOptimize(actions);
+}
+
+// Math
+
+static void runMat4Multiply(size_t iterations)
+{
+    mat4 projection = perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+    mat4 view = lookAt(vec3(0.0f, 2.0f, 5.0f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+    for (size_t i = 0; i < iterations; i++)
+    {
+        mat4 viewProjection = projection * view;
+        doNotOptimize(viewProjection);
+        view[3].x += 1.0e-6f;
+    }
+}
+
+static void runMat4Inverse(size_t iterations)
+{
+    mat4 matrix = perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f) *
+                  lookAt(vec3(0.0f, 2.0f, 5.0f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+    for (size_t i = 0; i < iterations; i++)
+    {
+        mat4 result = inverse(matrix);
+        doNotOptimize(result);
+        matrix[3].x += 1.0e-6f;
+    }
+}
+
+// Frustum culling of 4096 spheres per op
+
+static const size_t NumSpheres = 4096;
+static BoundingSphereSet *spheres = nullptr;
+static std::vector<uint32_t> visibleIndices;
+static Frustum frustum;
+
+static bool setupCulling()
+{
+    spheres = new BoundingSphereSet();
+    spheres->reserve(NumSpheres);
+    uint32_t state = 1;
+    for (size_t i = 0; i < NumSpheres; i++)
+    {
+        float coordinates[3];
+        for (int c = 0; c < 3; c++)
+        {
+            state = state * 1664525u + 1013904223u;
+            coordinates[c] = static_cast<float>(state >> 8) / 16777216.0f * 200.0f - 100.0f;
+        }
+        spheres->add(coordinates[0], coordinates[1], coordinates[2], 1.0f);
+    }
+    visibleIndices.resize(spheres->size());
+
+    mat4 viewProjection = perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f) *
+                          lookAt(vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f));
+    frustum = Frustum::fromMatrix(viewProjection.data());
+    return true;
+}
+
+static void runCulling(size_t iterations)
+{
+    FrustumCuller culler;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        size_t visible = culler.cull(frustum, *spheres, visibleIndices.data());
+        doNotOptimize(visible);
+    }
+}
+
+static void teardownCulling()
+{
+    delete spheres;
+    spheres = nullptr;
+    std::vector<uint32_t>().swap(visibleIndices);
+}
+
+static const MicroBenchmark benchmarks[] = {
+    {"logger.info", setupLogger, runLoggerInfo, nullptr},
+    {"shader.loadSource", setupShaderSource, runShaderLoadSource, teardownShaderSource},
+    {"events.translate", setupEvents, runEventDispatch, nullptr},
+    {"math.mat4Multiply", nullptr, runMat4Multiply, nullptr},
+    {"math.mat4Inverse", nullptr, runMat4Inverse, nullptr},
+    {"culling.spheres4096", setupCulling, runCulling, teardownCulling},
+};
+
+static double timeRun(const MicroBenchmark &benchmark, size_t iterations, HeapCounters &heapUsed)
+{
+    HeapCounters before = getHeapCounters();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    benchmark.run(iterations);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    HeapCounters after = getHeapCounters();
+
+    heapUsed.allocations = after.allocations - before.allocations;
+    heapUsed.frees = after.frees - before.frees;
+    heapUsed.bytesAllocated = after.bytesAllocated - before.bytesAllocated;
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+static MicroResult measure(const MicroBenchmark &benchmark, double minTimeNs, int repetitions)
+{
+    HeapCounters heapUsed;
+
+    // Calibration doubles as warm-up for caches, the branch predictor and lazy allocations
+    size_t iterations = 1;
+    while (timeRun(benchmark, iterations, heapUsed) < minTimeNs && iterations < (size_t(1) << 40))
+    {
+        iterations *= 2;
+    }
+
+    std::vector<double> nsPerOp;
+    std::vector<double> allocationsPerOp;
+    std::vector<double> bytesPerOp;
+    for (int r = 0; r < repetitions; r++)
+    {
+        double ns = timeRun(benchmark, iterations, heapUsed);
+        nsPerOp.push_back(ns / iterations);
+        allocationsPerOp.push_back(static_cast<double>(heapUsed.allocations) / iterations);
+        bytesPerOp.push_back(static_cast<double>(heapUsed.bytesAllocated) / iterations);
+    }
+
+    MicroResult result;
+    result.name = benchmark.name;
+    result.iterations = iterations;
+    result.minNsPerOp = *std::min_element(nsPerOp.begin(), nsPerOp.end());
+    result.maxNsPerOp = *std::max_element(nsPerOp.begin(), nsPerOp.end());
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    std::sort(allocationsPerOp.begin(), allocationsPerOp.end());
+    std::sort(bytesPerOp.begin(), bytesPerOp.end());
+    result.nsPerOp = nsPerOp[nsPerOp.size() / 2];
+    result.allocationsPerOp = allocationsPerOp[allocationsPerOp.size() / 2];
+    result.bytesPerOp = bytesPerOp[bytesPerOp.size() / 2];
+    return result;
+}
+
+static bool writeJson(const char *path, const std::vector<MicroResult> &results)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        fprintf(stderr, "microbench: cannot write %s\n", path);
+        return false;
+    }
+    fprintf(file, "{\n  \"heapTracking\": %s,\n  \"benchmarks\": {\n", isHeapTrackingEnabled() ? "true" : "false");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const MicroResult &r = results[i];
+        fprintf(file,
+                "    \"%s\": {\"iterations\": %zu, \"nsPerOp\": %.3f, \"minNsPerOp\": %.3f, \"maxNsPerOp\": %.3f, "
+                "\"allocationsPerOp\": %.4f, \"bytesPerOp\": %.2f}%s\n",
+                r.name, r.iterations, r.nsPerOp, r.minNsPerOp, r.maxNsPerOp, r.allocationsPerOp, r.bytesPerOp,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  }\n}\n");
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *filter = nullptr;
+    const char *jsonPath = nullptr;
+    double minTimeMs = 100.0;
+    int repetitions = 5;
+    int cpu = -1;
+    const size_t numBenchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+        {
+            minTimeMs = std::max(1.0, atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+        {
+            repetitions = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc)
+        {
+            cpu = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--list") == 0)
+        {
+            for (size_t b = 0; b < numBenchmarks; b++)
+            {
+                printf("%s\n", benchmarks[b].name);
+            }
+            return 0;
+        }
+    }
+
+    if (cpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0)
+        {
+            fprintf(stderr, "microbench: cannot pin to cpu %d\n", cpu);
+        }
+    }
+    if (!isHeapTrackingEnabled())
+    {
+        fprintf(stderr, "microbench: built without XWGL_TRACK_HEAP, allocation counts read zero\n");
+    }
+
+    printf("%-24s %12s %10s %10s %12s %12s\n", "benchmark", "iterations", "ns/op", "spread", "allocs/op",
+           "bytes/op");
+    std::vector<MicroResult> results;
+    for (size_t b = 0; b < numBenchmarks; b++)
+    {
+        const MicroBenchmark &benchmark = benchmarks[b];
+        if (filter && !strstr(benchmark.name, filter))
+        {
+            continue;
+        }
+        if (benchmark.setup && !benchmark.setup())
+        {
+            fprintf(stderr, "microbench: %s failed to set up\n", benchmark.name);
+            continue;
+        }
+
+        MicroResult result = measure(benchmark, minTimeMs * 1.0e6, repetitions);
+        if (benchmark.teardown)
+        {
+            benchmark.teardown();
+        }
+
+        double spread = result.nsPerOp > 0.0 ? (result.maxNsPerOp - result.minNsPerOp) / result.nsPerOp : 0.0;
+        printf("%-24s %12zu %10.1f %9.1f%% %12.3f %12.1f\n", result.name, result.iterations, result.nsPerOp,
+               spread * 100.0, result.allocationsPerOp, result.bytesPerOp);
+        results.push_back(result);
+    }
+
+    if (jsonPath && !writeJson(jsonPath, results))
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,443 @@
+// Runs the standard render workloads (src/RenderBenchmark.h) on a headless
+// context and writes frame-time distributions as JSON. Usage:
+//   renderbench [--scene a,b,...] [--frames N] [--warmup N] [--size WxH] [--scale F]
+//               [--out <result.json>] [--baseline <baseline.json>] [--require-baseline]
+//               [--threshold F]
+//   renderbench --compare <baseline.json> <result.json> [--threshold F]
+// Each frame is bracketed by glFinish() so CPU time includes the GPU work;
+// GPU time comes from GL_TIME_ELAPSED queries. With a baseline, scenes whose
+// p50 or p95 frame time got more than F (default 0.10) slower are reported and
+// the exit status is 2. The exit status is 1 when a scene fails to set up or
+// reports failures (e.g. programs that did not build), when a selected
+// baseline scene is missing from the results, and with --require-baseline
+// when there is no baseline (otherwise only a warning). Meant to run on Mesa
+// llvmpipe under Xvfb (see the `bench` target) so the numbers are comparable
+// between GPU-less machines.
+
+#include "Json.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "RenderBenchmark.h"
+// After Json.h: Xlib defines Bool as a macro
+#include "HeadlessContext.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Differences below this are timer noise on any machine
+static const double NoiseFloorMs = 0.05;
+
+struct Distribution
+{
+    double min, mean, p50, p90, p95, p99, max, stddev;
+};
+
+struct SceneResult
+{
+    std::string name;
+    std::string workUnit;
+    uint64_t workPerFrame;
+    std::vector<double> cpuMs;
+    std::vector<double> gpuMs;
+};
+
+static double percentile(const std::vector<double> &sorted, double fraction)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+static Distribution summarize(std::vector<double> values)
+{
+    Distribution result;
+    memset(&result, 0, sizeof(result));
+    if (values.empty())
+    {
+        return result;
+    }
+    std::sort(values.begin(), values.end());
+
+    double sum = 0.0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        sum += values[i];
+    }
+    result.mean = sum / values.size();
+    double variance = 0.0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        variance += (values[i] - result.mean) * (values[i] - result.mean);
+    }
+    result.stddev = std::sqrt(variance / values.size());
+
+    result.min = values.front();
+    result.p50 = percentile(values, 0.50);
+    result.p90 = percentile(values, 0.90);
+    result.p95 = percentile(values, 0.95);
+    result.p99 = percentile(values, 0.99);
+    result.max = values.back();
+    return result;
+}
+
+static void writeDistribution(FILE *file, const char *name, const Distribution &d)
+{
+    fprintf(file,
+            "      \"%s\": {\"min\": %.4f, \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p95\": %.4f, "
+            "\"p99\": %.4f, \"max\": %.4f, \"stddev\": %.4f}",
+            name, d.min, d.mean, d.p50, d.p90, d.p95, d.p99, d.max, d.stddev);
+}
+
+static void writeSamples(FILE *file, const char *name, const std::vector<double> &values)
+{
+    fprintf(file, "      \"%s\": [", name);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        fprintf(file, "%s%.4f", i ? ", " : "", values[i]);
+    }
+    fprintf(file, "]");
+}
+
+// Strings here are driver names and scene names; only quotes and backslashes need escaping
+static std::string escapeJson(const char *text)
+{
+    std::string result;
+    for (; *text; text++)
+    {
+        if (*text == '"' || *text == '\\')
+        {
+            result += '\\';
+        }
+        if (static_cast<unsigned char>(*text) >= 0x20)
+        {
+            result += *text;
+        }
+    }
+    return result;
+}
+
+static bool writeResults(const char *path, const std::vector<SceneResult> &results, int width, int height,
+                         int frames, int warmup, double scale)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        fprintf(stderr, "renderbench: cannot write %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"version\": 1,\n");
+    fprintf(file, "  \"renderer\": \"%s\",\n",
+            escapeJson(reinterpret_cast<const char *>(glGetString(GL_RENDERER))).c_str());
+    fprintf(file, "  \"glVersion\": \"%s\",\n",
+            escapeJson(reinterpret_cast<const char *>(glGetString(GL_VERSION))).c_str());
+    fprintf(file, "  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %d,\n  \"warmup\": %d,\n  \"scale\": %g,\n",
+            width, height, frames, warmup, scale);
+    fprintf(file, "  \"scenes\": {\n");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const SceneResult &result = results[i];
+        fprintf(file, "    \"%s\": {\n", escapeJson(result.name.c_str()).c_str());
+        fprintf(file, "      \"workUnit\": \"%s\",\n", escapeJson(result.workUnit.c_str()).c_str());
+        fprintf(file, "      \"workPerFrame\": %llu,\n", static_cast<unsigned long long>(result.workPerFrame));
+        writeDistribution(file, "cpuMs", summarize(result.cpuMs));
+        fprintf(file, ",\n");
+        writeDistribution(file, "gpuMs", summarize(result.gpuMs));
+        fprintf(file, ",\n");
+        writeSamples(file, "cpuSamplesMs", result.cpuMs);
+        fprintf(file, ",\n");
+        writeSamples(file, "gpuSamplesMs", result.gpuMs);
+        fprintf(file, "\n    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  }\n}\n");
+    fclose(file);
+    return true;
+}
+
+static bool sceneSelected(const char *list, const char *name)
+{
+    if (!list)
+    {
+        return true;
+    }
+    size_t length = strlen(name);
+    for (const char *entry = list; *entry;)
+    {
+        const char *end = strchr(entry, ',');
+        size_t entryLength = end ? static_cast<size_t>(end - entry) : strlen(entry);
+        if (entryLength == length && strncmp(entry, name, length) == 0)
+        {
+            return true;
+        }
+        entry += entryLength + (end ? 1 : 0);
+    }
+    return false;
+}
+
+static bool loadResults(const char *path, JsonValue &document)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        return false;
+    }
+    std::string error;
+    if (!JsonValue::parse(file.data(), file.size(), document, error))
+    {
+        fprintf(stderr, "renderbench: %s: %s\n", path, error.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Returns the number of regressed metrics and counts the selected baseline
+// scenes the current results lack in missing; prints one line per scene and metric
+static int compareResults(const JsonValue &baseline, const JsonValue &current, double threshold,
+                          const char *sceneList, int &missing)
+{
+    if (baseline["renderer"].asString() != current["renderer"].asString())
+    {
+        printf("warning: renderer differs (baseline \"%s\", current \"%s\"); numbers may not be comparable\n",
+               baseline["renderer"].asString().c_str(), current["renderer"].asString().c_str());
+    }
+    if (baseline["width"].asInt() != current["width"].asInt() ||
+        baseline["height"].asInt() != current["height"].asInt() ||
+        baseline["scale"].asNumber() != current["scale"].asNumber())
+    {
+        printf("warning: size or scale differs from the baseline\n");
+    }
+
+    static const char *const metrics[][2] = {{"cpuMs", "p50"}, {"cpuMs", "p95"}, {"gpuMs", "p50"}, {"gpuMs", "p95"}};
+    int regressions = 0;
+    const JsonValue &baseScenes = baseline["scenes"];
+    const JsonValue &currentScenes = current["scenes"];
+    for (size_t i = 0; i < baseScenes.size(); i++)
+    {
+        const std::string &name = baseScenes.getKey(i);
+        if (!sceneSelected(sceneList, name.c_str()))
+        {
+            continue;
+        }
+        if (!currentScenes.has(name.c_str()))
+        {
+            printf("%-10s  NOT RUN\n", name.c_str());
+            missing++;
+            continue;
+        }
+        const JsonValue &baseScene = baseScenes[i];
+        const JsonValue &currentScene = currentScenes[name.c_str()];
+        for (size_t m = 0; m < sizeof(metrics) / sizeof(metrics[0]); m++)
+        {
+            double before = baseScene[metrics[m][0]][metrics[m][1]].asNumber();
+            double after = currentScene[metrics[m][0]][metrics[m][1]].asNumber();
+            double change = before > 0.0 ? (after - before) / before : 0.0;
+            bool regressed = change > threshold && after - before > NoiseFloorMs;
+            printf("%-10s  %s %s  %9.3f -> %9.3f ms  %+6.1f%%%s\n", name.c_str(), metrics[m][0], metrics[m][1],
+                   before, after, change * 100.0, regressed ? "  REGRESSION" : "");
+            if (regressed)
+            {
+                regressions++;
+            }
+        }
+    }
+    return regressions;
+}
+
+// 0 when every selected baseline scene ran without regressing, 1 when one is
+// missing, 2 on regressions
+static int runCompare(const char *baselinePath, const char *currentPath, double threshold, const char *sceneList)
+{
+    JsonValue baseline, current;
+    if (!loadResults(baselinePath, baseline) || !loadResults(currentPath, current))
+    {
+        fprintf(stderr, "renderbench: cannot read %s or %s\n", baselinePath, currentPath);
+        return 1;
+    }
+    int missing = 0;
+    int regressions = compareResults(baseline, current, threshold, sceneList, missing);
+    printf("%d regression(s) beyond %.0f%%\n", regressions, threshold * 100.0);
+    if (missing > 0)
+    {
+        fprintf(stderr, "renderbench: %d baseline scene(s) missing from %s\n", missing, currentPath);
+        return 1;
+    }
+    return regressions > 0 ? 2 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *sceneList = nullptr;
+    const char *outputPath = "renderbench.json";
+    const char *baselinePath = nullptr;
+    bool requireBaseline = false;
+    int frames = 200, warmup = 20;
+    int width = 800, height = 600;
+    double scale = 1.0;
+    double threshold = 0.10;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+        {
+            threshold = atof(argv[++i]);
+        }
+    }
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--compare") == 0)
+        {
+            if (i + 2 >= argc)
+            {
+                fprintf(stderr, "usage: %s --compare <baseline.json> <result.json> [--threshold F]\n", argv[0]);
+                return 1;
+            }
+            return runCompare(argv[i + 1], argv[i + 2], threshold, nullptr);
+        }
+        else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+        {
+            sceneList = argv[++i];
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            frames = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+        {
+            warmup = std::max(0, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            sscanf(argv[++i], "%dx%d", &width, &height);
+        }
+        else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+        {
+            scale = std::max(0.001, atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            outputPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+        {
+            baselinePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--require-baseline") == 0)
+        {
+            requireBaseline = true;
+        }
+    }
+
+    HeadlessContext context;
+    if (!context.create(width, height))
+    {
+        fprintf(stderr, "renderbench: cannot create a headless GL context (see logs/error.log)\n");
+        return 1;
+    }
+    printf("renderer: %s\n", reinterpret_cast<const char *>(glGetString(GL_RENDERER)));
+
+    GLuint timerQuery = 0;
+    glGenQueries(1, &timerQuery);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    std::vector<std::unique_ptr<BenchmarkScene>> scenes = createBenchmarkScenes(scale);
+    std::vector<SceneResult> results;
+    int failedScenes = 0;
+    for (size_t s = 0; s < scenes.size(); s++)
+    {
+        BenchmarkScene &scene = *scenes[s];
+        if (!sceneSelected(sceneList, scene.getName()))
+        {
+            continue;
+        }
+        if (!scene.setup(width, height))
+        {
+            fprintf(stderr, "renderbench: scene %s failed to set up (see logs/error.log)\n", scene.getName());
+            scene.cleanup();
+            failedScenes++;
+            continue;
+        }
+
+        SceneResult result;
+        result.name = scene.getName();
+        result.workUnit = scene.getWorkUnit();
+        result.workPerFrame = scene.getWorkPerFrame();
+
+        // Warm-up frames settle driver caches and lazy allocations and are not recorded
+        for (int frame = 0; frame < warmup + frames; frame++)
+        {
+            glFinish();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            glBeginQuery(GL_TIME_ELAPSED, timerQuery);
+            scene.renderFrame(static_cast<unsigned int>(frame));
+            glEndQuery(GL_TIME_ELAPSED);
+            context.swapBuffers();
+            glFinish();
+
+            double cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            GLuint64 gpuNs = 0;
+            glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &gpuNs);
+            if (frame >= warmup)
+            {
+                result.cpuMs.push_back(cpuMs);
+                result.gpuMs.push_back(gpuNs / 1.0e6);
+            }
+        }
+        scene.cleanup();
+        if (scene.getFailures() > 0)
+        {
+            fprintf(stderr, "renderbench: scene %s had %llu failure(s) (see logs/error.log)\n", scene.getName(),
+                    static_cast<unsigned long long>(scene.getFailures()));
+            failedScenes++;
+        }
+
+        Distribution cpu = summarize(result.cpuMs);
+        Distribution gpu = summarize(result.gpuMs);
+        printf("%-10s %10llu %-14s cpu ms: p50 %8.3f p95 %8.3f max %8.3f  gpu ms: p50 %8.3f p95 %8.3f\n",
+               result.name.c_str(), static_cast<unsigned long long>(result.workPerFrame), result.workUnit.c_str(),
+               cpu.p50, cpu.p95, cpu.max, gpu.p50, gpu.p95);
+        results.push_back(result);
+    }
+
+    bool written = writeResults(outputPath, results, width, height, frames, warmup, scale);
+    glDeleteQueries(1, &timerQuery);
+    context.destroy();
+    if (!written)
+    {
+        return 1;
+    }
+    printf("wrote %s\n", outputPath);
+
+    int status = 0;
+    if (baselinePath)
+    {
+        FILE *baselineFile = fopen(baselinePath, "r");
+        if (!baselineFile)
+        {
+            fprintf(stderr, "renderbench: %s: no baseline at %s, nothing was compared; record one with the "
+                    "bench-baseline target\n", requireBaseline ? "error" : "warning", baselinePath);
+            status = requireBaseline ? 1 : 0;
+        }
+        else
+        {
+            fclose(baselineFile);
+            status = runCompare(baselinePath, outputPath, threshold, sceneList);
+        }
+    }
+    if (failedScenes > 0)
+    {
+        fprintf(stderr, "renderbench: %d scene(s) failed\n", failedScenes);
+        return 1;
+    }
+    return status;
+}
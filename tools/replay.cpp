@@ -0,0 +1,132 @@
+// Re-executes a GLTrace capture (see src/GLTrace.h) on a headless context and
+// reports per-frame timings. Usage:
+//   replay <trace> [--repeat N] [--size WxH] [--csv <file>]
+// Each frame is bracketed by glFinish() so CPU time includes the GPU work;
+// GPU time comes from GL_TIME_ELAPSED queries.
+
+#include "GLTraceReplay.h"
+#include "HeadlessContext.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static double percentile(std::vector<double> values, double fraction)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <trace> [--repeat N] [--size WxH] [--csv <file>]\n", argv[0]);
+        return 1;
+    }
+
+    const char *tracePath = argv[1];
+    const char *csvPath = nullptr;
+    int repeat = 1;
+    int width = 800, height = 600;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            repeat = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            sscanf(argv[++i], "%dx%d", &width, &height);
+        }
+        else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+        {
+            csvPath = argv[++i];
+        }
+    }
+
+    HeadlessContext context;
+    if (!context.create(width, height))
+    {
+        fprintf(stderr, "replay: cannot create a headless GL context (see logs/error.log)\n");
+        return 1;
+    }
+
+    GLTraceReplayer replayer;
+    if (!replayer.load(tracePath))
+    {
+        fprintf(stderr, "replay: cannot load %s (see logs/error.log)\n", tracePath);
+        return 1;
+    }
+
+    FILE *csv = csvPath ? fopen(csvPath, "w") : nullptr;
+    if (csv)
+    {
+        fprintf(csv, "run,frame,cpu_ms,gpu_ms\n");
+    }
+
+    GLuint timerQuery = 0;
+    glGenQueries(1, &timerQuery);
+
+    std::vector<double> cpuTimes;
+    std::vector<double> gpuTimes;
+
+    for (int run = 0; run < repeat; run++)
+    {
+        for (int frame = 0; frame < replayer.getNumFrames(); frame++)
+        {
+            glFinish();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            glBeginQuery(GL_TIME_ELAPSED, timerQuery);
+            bool ok = replayer.replayFrame(frame);
+            glEndQuery(GL_TIME_ELAPSED);
+            context.swapBuffers();
+            glFinish();
+
+            double cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            GLuint64 gpuNs = 0;
+            glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &gpuNs);
+            double gpuMs = gpuNs / 1.0e6;
+
+            if (!ok)
+            {
+                fprintf(stderr, "replay: frame %d is malformed, stopping\n", frame);
+                return 1;
+            }
+
+            cpuTimes.push_back(cpuMs);
+            gpuTimes.push_back(gpuMs);
+            printf("run %d frame %4d  cpu %8.3f ms  gpu %8.3f ms\n", run, frame, cpuMs, gpuMs);
+            if (csv)
+            {
+                fprintf(csv, "%d,%d,%.4f,%.4f\n", run, frame, cpuMs, gpuMs);
+            }
+        }
+
+        replayer.reset();
+    }
+
+    printf("frames %zu  cpu ms: min %.3f p50 %.3f p95 %.3f max %.3f  gpu ms: p50 %.3f p95 %.3f\n",
+           cpuTimes.size(), percentile(cpuTimes, 0.0), percentile(cpuTimes, 0.5), percentile(cpuTimes, 0.95),
+           percentile(cpuTimes, 1.0), percentile(gpuTimes, 0.5), percentile(gpuTimes, 0.95));
+
+    if (csv)
+    {
+        fclose(csv);
+    }
+    glDeleteQueries(1, &timerQuery);
+    context.destroy();
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+// Build-time shader compiler: compiles every program stage listed in the
+// shader manifest to SPIR-V for ShaderLibrary's GL_ARB_gl_spirv path. Usage:
+//   shaderbuild <manifest.json> <output dir> --glslang <glslangValidator> [--spirv-opt <spirv-opt>]
+// Each stage is preprocessed the way the runtime does it (#includes expanded,
+// the entry's defines inserted) into <output dir>/<program>.<stage>, compiled
+// by glslang for OpenGL, then validated and optimized by spirv-opt into
+// <output dir>/<program>.<stage>.spv. Any error fails the build. Run from the
+// directory the manifest's paths are relative to (see the `shaders` target).
+
+#include "ShaderLibrary.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+
+namespace
+{
+
+std::string quote(const std::string &argument)
+{
+    std::string quoted = "'";
+    for (size_t i = 0; i < argument.size(); i++)
+    {
+        if (argument[i] == '\'')
+        {
+            quoted += "'\\''";
+        }
+        else
+        {
+            quoted += argument[i];
+        }
+    }
+    return quoted + "'";
+}
+
+bool run(const std::string &command)
+{
+    int status = system(command.c_str());
+    return status == 0;
+}
+
+bool writeFile(const std::string &path, const std::string &contents)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    bool written = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    return fclose(file) == 0 && written;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <manifest.json> <output dir> --glslang <glslangValidator> [--spirv-opt <spirv-opt>]\n",
+                argv[0]);
+        return 1;
+    }
+
+    const char *manifestPath = argv[1];
+    std::string outputDirectory = argv[2];
+    std::string glslang;
+    std::string spirvOpt;
+
+    for (int i = 3; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--glslang") == 0 && i + 1 < argc)
+        {
+            glslang = argv[++i];
+        }
+        else if (strcmp(argv[i], "--spirv-opt") == 0 && i + 1 < argc)
+        {
+            spirvOpt = argv[++i];
+        }
+    }
+    if (glslang.empty())
+    {
+        fprintf(stderr, "shaderbuild: --glslang is required\n");
+        return 1;
+    }
+
+    mkdir(outputDirectory.c_str(), 0755);
+    if (!shaderLibrary.loadManifest(manifestPath))
+    {
+        fprintf(stderr, "shaderbuild: cannot load %s (see logs/error.log)\n", manifestPath);
+        return 1;
+    }
+
+    int compiled = 0;
+    int failed = 0;
+    for (size_t program = 0; program < shaderLibrary.getProgramCount(); program++)
+    {
+        const std::string &name = shaderLibrary.getProgramName(program);
+        for (int stage = 0; stage < static_cast<int>(ShaderType::NumShaderTypes); stage++)
+        {
+            ShaderType type = static_cast<ShaderType>(stage);
+            const std::string &sourcePath = shaderLibrary.getStagePath(program, type);
+            if (sourcePath.empty())
+            {
+                continue;
+            }
+
+            std::string source;
+            std::string extension = ShaderLibrary::getStageExtension(type);
+            std::string preprocessedPath = outputDirectory + "/" + name + "." + extension;
+            std::string spirvPath = ShaderLibrary::getSpirvPath(outputDirectory, name, type);
+            std::string unoptimizedPath = spirvPath + ".unoptimized";
+            if (!shaderLibrary.getStageSource(program, type, source) || !writeFile(preprocessedPath, source))
+            {
+                fprintf(stderr, "shaderbuild: cannot preprocess %s for %s\n", sourcePath.c_str(), name.c_str());
+                failed++;
+                continue;
+            }
+
+            // -G: SPIR-V for OpenGL semantics (GL_ARB_gl_spirv), which needs
+            // explicit locations on every non-opaque uniform and varying
+            bool built = run(quote(glslang) + " -G -S " + extension + " -o " + quote(unoptimizedPath) + " " +
+                             quote(preprocessedPath));
+            if (built && !spirvOpt.empty())
+            {
+                // spirv-opt validates its input before optimizing
+                built = run(quote(spirvOpt) + " -O " + quote(unoptimizedPath) + " -o " + quote(spirvPath));
+            }
+            else if (built)
+            {
+                built = rename(unoptimizedPath.c_str(), spirvPath.c_str()) == 0;
+            }
+            remove(unoptimizedPath.c_str());
+
+            if (!built)
+            {
+                fprintf(stderr, "shaderbuild: %s (%s) failed, preprocessed source in %s\n", name.c_str(),
+                        sourcePath.c_str(), preprocessedPath.c_str());
+                remove(spirvPath.c_str());
+                failed++;
+                continue;
+            }
+            compiled++;
+        }
+    }
+
+    printf("shaderbuild: %d stages compiled to SPIR-V in %s%s, %d failed\n", compiled, outputDirectory.c_str(),
+           spirvOpt.empty() ? " (not optimized: no spirv-opt)" : "", failed);
+    return failed == 0 ? 0 : 1;
+}